@@ -0,0 +1,408 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file oran_arena.c
+*
+* Allocator for the SDNet control-plane drivers on the standalone BSP.
+*
+* The drivers allocate their table and CAM state with malloc, calloc,
+* realloc and free, almost all of it in XilSdnetTargetInit and the CAM init
+* calls and the rest (TCAM) as entries are added. The 8 KB BSP heap holds
+* none of it. a53_standalone.mak builds libsdnetdrv with those four calls
+* renamed to OranArena*, which serve them from one static buffer of
+* ORAN_ARENA_SIZE bytes:
+*
+*	- blocks are carved off the top in order, each behind a 16-byte
+*	  header holding its size; there is no free list to walk
+*	- freeing or growing the topmost block gives back or takes the space
+*	  in place, so the temporaries of an init call and a growing TCAM
+*	  array cost nothing
+*	- a block freed below the top is stranded until every block is
+*	  free, when the arena starts over from the bottom; nothing is ever
+*	  split or merged, so the arena does not fragment
+*
+* OranSdnetInitEnv and OranEaxcInit reserve what their tables need before
+* bringing the drivers up, estimated from the table configurations by
+* OranArenaTargetBytes and OranArenaCamBytes, and fail at once if the
+* arena is too small rather than when a table fills. OranArenaPrint shows
+* the estimate next to the high-water mark so ORAN_ARENA_SIZE can be set
+* from a real run.
+*
+* Built only with ORAN_SDNET_ARENA, the default on the standalone BSP.
+*
+*****************************************************************************/
+
+/***************************** Include Files ********************************/
+
+#include <string.h>
+#include "xil_printf.h"
+#include "xstatus.h"
+#include "oran_sdnet.h"
+
+#if ORAN_SDNET_CTRL && ORAN_SDNET_ARENA
+
+/************************** Constant Definitions ****************************/
+
+#define ORAN_ARENA_HEADER	ORAN_ARENA_ALIGN
+
+/*
+ * Estimates per table: the driver context, each action, and each CAM
+ * beyond its entries. A ternary CAM is counted twice over for the arrays
+ * it regrows while entries are added.
+ */
+#define ORAN_ARENA_TARGET_BYTES	1024
+#define ORAN_ARENA_TABLE_BYTES	512
+#define ORAN_ARENA_ACTION_BYTES	64
+#define ORAN_ARENA_CAM_BYTES	1024
+#define ORAN_ARENA_ENTRY_BYTES	16
+
+/**************************** Type Definitions ******************************/
+
+typedef struct {
+	u32 Size;		/* bytes after the header */
+	u32 Prev;		/* offset of the block below */
+	u32 Live;
+	u8 Pad[ORAN_ARENA_HEADER - 12];
+} OranArenaHeader;
+
+/************************** Variable Definitions ****************************/
+
+static u8 ArenaBuf[ORAN_ARENA_SIZE]
+	__attribute__((aligned(ORAN_ARENA_ALIGN)));
+static OranArenaStats Arena = { .Size = ORAN_ARENA_SIZE };
+static u32 ArenaTop;		/* offset of the topmost block's header */
+
+/*****************************************************************************/
+/*
+ * Header of the block at Ptr, or NULL if Ptr is not an arena block
+ */
+static OranArenaHeader *OranArenaBlock(void *Ptr)
+{
+	UINTPTR Addr = (UINTPTR)Ptr;
+
+	if ((Addr < (UINTPTR)ArenaBuf + ORAN_ARENA_HEADER) ||
+	    (Addr >= (UINTPTR)ArenaBuf + Arena.Used) ||
+	    (Addr & (ORAN_ARENA_ALIGN - 1))) {
+		return NULL;
+	}
+	return (OranArenaHeader *)(Addr - ORAN_ARENA_HEADER);
+}
+
+static u32 OranArenaRound(size_t Size)
+{
+	return (u32)((Size + ORAN_ARENA_ALIGN - 1) &
+		     ~(size_t)(ORAN_ARENA_ALIGN - 1));
+}
+
+/*
+ * Moves Used down over freed blocks at the top, or back to the bottom
+ * once nothing is live, when the reservations go too
+ */
+static void OranArenaTrim(void)
+{
+	OranArenaHeader *HeaderPtr = (OranArenaHeader *)&ArenaBuf[ArenaTop];
+
+	if (Arena.Live == 0) {
+		Arena.Used = 0;
+		Arena.Stranded = 0;
+		Arena.Reserved = 0;
+		ArenaTop = 0;
+		return;
+	}
+
+	while (!HeaderPtr->Live) {
+		Arena.Stranded -= HeaderPtr->Size + ORAN_ARENA_HEADER;
+		Arena.Used = ArenaTop;
+		ArenaTop = HeaderPtr->Prev;
+		HeaderPtr = (OranArenaHeader *)&ArenaBuf[ArenaTop];
+	}
+}
+
+/****************************************************************************/
+/**
+*
+* malloc for libsdnetdrv.
+*
+* @param	Size is the number of bytes.
+*
+* @return	The block, aligned to ORAN_ARENA_ALIGN, or NULL if the arena
+*		is full.
+*
+* @note		None.
+*
+*****************************************************************************/
+void *OranArenaMalloc(size_t Size)
+{
+	OranArenaHeader *HeaderPtr;
+	u32 Rounded = OranArenaRound(Size);
+
+	if ((Size > ORAN_ARENA_SIZE) ||
+	    (Rounded + ORAN_ARENA_HEADER > ORAN_ARENA_SIZE - Arena.Used)) {
+		Arena.Failures++;
+		return NULL;
+	}
+
+	HeaderPtr = (OranArenaHeader *)&ArenaBuf[Arena.Used];
+	HeaderPtr->Size = Rounded;
+	HeaderPtr->Prev = ArenaTop;
+	HeaderPtr->Live = 1;
+	ArenaTop = Arena.Used;
+	Arena.Used += ORAN_ARENA_HEADER + Rounded;
+	Arena.Live++;
+	Arena.Allocs++;
+	if (Arena.Used > Arena.HighWater) {
+		Arena.HighWater = Arena.Used;
+	}
+
+	return HeaderPtr + 1;
+}
+
+/****************************************************************************/
+/**
+*
+* calloc for libsdnetdrv.
+*
+* @param	Count is the number of elements.
+* @param	Size is the size of one element.
+*
+* @return	The zeroed block, or NULL if the arena is full.
+*
+* @note		None.
+*
+*****************************************************************************/
+void *OranArenaCalloc(size_t Count, size_t Size)
+{
+	void *Ptr;
+
+	if ((Size != 0) && (Count > ORAN_ARENA_SIZE / Size)) {
+		Arena.Failures++;
+		return NULL;
+	}
+
+	Ptr = OranArenaMalloc(Count * Size);
+	if (Ptr != NULL) {
+		memset(Ptr, 0, Count * Size);
+	}
+	return Ptr;
+}
+
+/****************************************************************************/
+/**
+*
+* free for libsdnetdrv.
+*
+* @param	Ptr is a block from the arena, or NULL.
+*
+* @return	None.
+*
+* @note		Pointers that are not arena blocks are ignored.
+*
+*****************************************************************************/
+void OranArenaFree(void *Ptr)
+{
+	OranArenaHeader *HeaderPtr = OranArenaBlock(Ptr);
+
+	if ((HeaderPtr == NULL) || !HeaderPtr->Live) {
+		return;
+	}
+
+	HeaderPtr->Live = 0;
+	Arena.Live--;
+	Arena.Stranded += HeaderPtr->Size + ORAN_ARENA_HEADER;
+	OranArenaTrim();
+}
+
+/****************************************************************************/
+/**
+*
+* realloc for libsdnetdrv. The topmost block is resized in place; any other
+* is moved to the top.
+*
+* @param	Ptr is a block from the arena, or NULL to allocate.
+* @param	Size is the new size in bytes.
+*
+* @return	The block, or NULL if the arena is full, in which case Ptr
+*		is left as it was.
+*
+* @note		None.
+*
+*****************************************************************************/
+void *OranArenaRealloc(void *Ptr, size_t Size)
+{
+	OranArenaHeader *HeaderPtr;
+	void *NewPtr;
+	u32 Rounded = OranArenaRound(Size);
+
+	if (Ptr == NULL) {
+		return OranArenaMalloc(Size);
+	}
+	HeaderPtr = OranArenaBlock(Ptr);
+	if ((HeaderPtr == NULL) || !HeaderPtr->Live) {
+		Arena.Failures++;
+		return NULL;
+	}
+
+	if ((u8 *)HeaderPtr == &ArenaBuf[ArenaTop]) {
+		if ((Size > ORAN_ARENA_SIZE) || (Rounded + ORAN_ARENA_HEADER >
+						 ORAN_ARENA_SIZE - ArenaTop)) {
+			Arena.Failures++;
+			return NULL;
+		}
+		HeaderPtr->Size = Rounded;
+		Arena.Used = ArenaTop + ORAN_ARENA_HEADER + Rounded;
+		if (Arena.Used > Arena.HighWater) {
+			Arena.HighWater = Arena.Used;
+		}
+		return Ptr;
+	}
+
+	if (Rounded <= HeaderPtr->Size) {
+		return Ptr;
+	}
+	NewPtr = OranArenaMalloc(Size);
+	if (NewPtr != NULL) {
+		memcpy(NewPtr, Ptr, HeaderPtr->Size);
+		OranArenaFree(Ptr);
+	}
+	return NewPtr;
+}
+
+/****************************************************************************/
+/**
+*
+* Estimates the arena space the CAM driver takes for one CAM.
+*
+* @param	CamConfigPtr is the CAM configuration.
+* @param	Mode is the table mode; ternary modes count double.
+*
+* @return	Bytes, including block headers.
+*
+* @note		An estimate with margin, not the driver's own figure;
+*		compare it with the high-water mark of OranArenaPrint.
+*
+*****************************************************************************/
+u32 OranArenaCamBytes(const XilSdnetCamConfig *CamConfigPtr,
+		      XilSdnetTableMode Mode)
+{
+	uint32_t KeyBits = 0;
+	u32 Entry;
+	u32 Bytes;
+
+	(void)XilSdnetCamGetKeyLengthInBits(CamConfigPtr->FormatStringPtr,
+					    &KeyBits);
+	Entry = OranArenaRound(2 * ((KeyBits + 7) / 8) +
+			       (CamConfigPtr->ResponseSizeBits + 7) / 8 + 4) +
+		ORAN_ARENA_ENTRY_BYTES;
+	Bytes = CamConfigPtr->NumEntries * Entry;
+	if ((Mode == XIL_SDNET_TABLE_MODE_TCAM) ||
+	    (Mode == XIL_SDNET_TABLE_MODE_STCAM) ||
+	    (Mode == XIL_SDNET_TABLE_MODE_TINY_TCAM)) {
+		Bytes *= 2;
+	}
+
+	return Bytes + ORAN_ARENA_CAM_BYTES;
+}
+
+/****************************************************************************/
+/**
+*
+* Estimates the arena space XilSdnetTargetInit takes for a target.
+*
+* @param	ConfigPtr is the target configuration.
+*
+* @return	Bytes, including block headers.
+*
+* @note		See OranArenaCamBytes.
+*
+*****************************************************************************/
+u32 OranArenaTargetBytes(const XilSdnetTargetConfig *ConfigPtr)
+{
+	const XilSdnetTableConfig *TablePtr;
+	u32 Bytes = ORAN_ARENA_TARGET_BYTES;
+	u32 Index;
+
+	for (Index = 0; Index < ConfigPtr->TableListSize; Index++) {
+		TablePtr = &ConfigPtr->TableListPtr[Index]->Config;
+		Bytes += ORAN_ARENA_TABLE_BYTES +
+			 TablePtr->ActionListSize * ORAN_ARENA_ACTION_BYTES +
+			 OranArenaCamBytes(&TablePtr->CamConfig,
+					   TablePtr->Mode);
+	}
+
+	return Bytes;
+}
+
+/****************************************************************************/
+/**
+*
+* Sets aside arena space for drivers about to be brought up.
+*
+* @param	Bytes is the estimate, from OranArenaTargetBytes or
+*		OranArenaCamBytes.
+* @param	WhatPtr names the drivers in the error message.
+*
+* @return	XST_SUCCESS if everything reserved so far fits in
+*		ORAN_ARENA_SIZE, otherwise XST_FAILURE.
+*
+* @note		Nothing is allocated; the reservation only makes an
+*		undersized arena fail at start-up.
+*
+*****************************************************************************/
+LONG OranArenaReserve(u32 Bytes, const char *WhatPtr)
+{
+	if (Bytes > ORAN_ARENA_SIZE - Arena.Reserved) {
+		xil_printf("sdnet arena: %s needs %d bytes, %d of %d left; "
+			   "raise ORAN_ARENA_SIZE\r\n", WhatPtr, (int)Bytes,
+			   (int)(ORAN_ARENA_SIZE - Arena.Reserved),
+			   ORAN_ARENA_SIZE);
+		return XST_FAILURE;
+	}
+
+	Arena.Reserved += Bytes;
+	return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/**
+*
+* Returns the arena counters.
+*
+* @param	StatsPtr receives them.
+*
+* @return	None.
+*
+* @note		None.
+*
+*****************************************************************************/
+void OranArenaGetStats(OranArenaStats *StatsPtr)
+{
+	*StatsPtr = Arena;
+}
+
+/****************************************************************************/
+/**
+*
+* Prints the arena counters.
+*
+* @param	None.
+*
+* @return	None.
+*
+* @note		None.
+*
+*****************************************************************************/
+void OranArenaPrint(void)
+{
+	xil_printf("sdnet arena: %d of %d bytes used, high water %d, "
+		   "estimate %d\r\n", (int)Arena.Used, (int)Arena.Size,
+		   (int)Arena.HighWater, (int)Arena.Reserved);
+	xil_printf("sdnet arena: %d allocations, %d live, %d bytes "
+		   "stranded, %d failed\r\n", (int)Arena.Allocs,
+		   (int)Arena.Live, (int)Arena.Stranded, (int)Arena.Failures);
+}
+
+#endif /* ORAN_SDNET_CTRL && ORAN_SDNET_ARENA */
@@ -0,0 +1,503 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file oran_buf.c
+*
+* Size-class packet buffer pool, see oran_buf.h.
+*
+* A free list is a stack of buffer indexes linked through the Next array
+* of the class. Its head word holds the index of the top buffer plus one
+* (0 for an empty list) in the low half and a tag in the high half, which
+* every push and pop increments, so a pop that read a top and its link
+* before another core popped and pushed that same buffer again sees the
+* head changed and retries instead of linking in a stale next. Lists sit
+* on cache lines of their own so that the cores do not contend for a line.
+* The statistics are kept per core in the rest of the line of that core's
+* list and only summed by OranBufGetStats, so taking and freeing a buffer
+* writes no line another core writes too, except when it steals and when
+* it frees a buffer another core took.
+*
+* Each line also counts the buffers its core took that are still in use
+* (Held) and the most there have been (Peak). A buffer remembers the core
+* that took it, and the last free takes it off that core's Held. The
+* buffers in use are the sum of every core's Held, so no moment had more
+* of them than the sum of the peaks, which OranBufGetStats reports as
+* HighWater. With one core taking the buffers of a class, as the GEM3 RX
+* path does, that is the true peak.
+*
+* The core is read from MPIDR_EL1 on the standalone BSP and from
+* sched_getcpu on Linux, where a thread may move between cores at any
+* time; that only costs a steal later, as any core may pop any list.
+*
+*****************************************************************************/
+
+#if defined(__linux__)
+#define _GNU_SOURCE		/* sched_getcpu */
+#endif
+
+/***************************** Include Files ********************************/
+
+#include <string.h>
+#include "xil_printf.h"
+#include "oran_buf.h"
+#if defined(__linux__)
+#include <sched.h>
+#elif defined(__aarch64__)
+#include "xpseudo_asm.h"
+#endif
+
+/************************** Constant Definitions ****************************/
+
+#if ((ORAN_BUF_SMALL_SIZE % ORAN_BUF_LINE) != 0) || \
+    ((ORAN_BUF_MEDIUM_SIZE % ORAN_BUF_LINE) != 0) || \
+    ((ORAN_BUF_LARGE_SIZE % ORAN_BUF_LINE) != 0)
+#error buffer sizes must be multiples of ORAN_BUF_LINE
+#endif
+#if (ORAN_BUF_SMALL_SIZE >= ORAN_BUF_MEDIUM_SIZE) || \
+    (ORAN_BUF_MEDIUM_SIZE >= ORAN_BUF_LARGE_SIZE)
+#error buffer classes must grow in size
+#endif
+
+#define ORAN_BUF_INDEX_MASK	0xFFFFFFFFULL
+#define ORAN_BUF_TAG_ONE	0x100000000ULL
+
+/**************************** Type Definitions ******************************/
+
+typedef struct {
+	u64 Head;	/* tag, then top index plus one */
+	u64 Allocs;	/* counts of this core, see OranBufStats */
+	u64 Frees;	/* buffers this core put back with the last reference */
+	u32 Failures;
+	u32 Steals;
+	u32 BadFrees;
+	u32 Held;	/* buffers this core took that are still in use */
+	u32 Peak;	/* most Held has been */
+	u8 Pad[ORAN_BUF_LINE - 3 * sizeof(u64) - 5 * sizeof(u32)];
+} __attribute__ ((aligned(ORAN_BUF_LINE))) OranBufList;
+
+typedef struct {
+	OranBufList List[ORAN_BUF_CORES];
+	u8 *MemPtr;
+	u32 *NextPtr;	/* link of each free buffer, index plus one */
+	u32 *RefsPtr;
+	u8 *OwnerPtr;	/* core that took each buffer in use */
+	u32 Size;
+	u32 Count;
+} OranBufClassState;
+
+/************************** Variable Definitions ****************************/
+
+static u8 BufSmall[ORAN_BUF_SMALL_CNT][ORAN_BUF_SMALL_SIZE]
+	__attribute__ ((aligned(ORAN_BUF_LINE)));
+static u8 BufMedium[ORAN_BUF_MEDIUM_CNT][ORAN_BUF_MEDIUM_SIZE]
+	__attribute__ ((aligned(ORAN_BUF_LINE)));
+static u8 BufLarge[ORAN_BUF_LARGE_CNT][ORAN_BUF_LARGE_SIZE]
+	__attribute__ ((aligned(ORAN_BUF_LINE)));
+
+static u32 BufNext[ORAN_BUF_SMALL_CNT + ORAN_BUF_MEDIUM_CNT +
+		   ORAN_BUF_LARGE_CNT];
+static u32 BufRefs[ORAN_BUF_SMALL_CNT + ORAN_BUF_MEDIUM_CNT +
+		   ORAN_BUF_LARGE_CNT];
+static u8 BufOwner[ORAN_BUF_SMALL_CNT + ORAN_BUF_MEDIUM_CNT +
+		   ORAN_BUF_LARGE_CNT];
+
+static OranBufClassState BufClass[ORAN_BUF_CLASS_CNT];
+
+/*****************************************************************************/
+/*
+ * Core the caller runs on, as a free list number
+ */
+static u32 OranBufCore(void)
+{
+#if defined(__linux__)
+	int Cpu = sched_getcpu();
+
+	return (Cpu > 0) ? (u32)Cpu % ORAN_BUF_CORES : 0;
+#elif defined(__aarch64__)
+	return (u32)(mfcp(MPIDR_EL1) & 0xFF) % ORAN_BUF_CORES;
+#else
+	return 0;
+#endif
+}
+
+static void OranBufPush(OranBufClassState *ClassPtr, u32 Core, u32 Index)
+{
+	u64 *HeadPtr = &ClassPtr->List[Core].Head;
+	u64 Head = __atomic_load_n(HeadPtr, __ATOMIC_RELAXED);
+
+	do {
+		__atomic_store_n(&ClassPtr->NextPtr[Index],
+				 (u32)(Head & ORAN_BUF_INDEX_MASK),
+				 __ATOMIC_RELAXED);
+	} while (!__atomic_compare_exchange_n(HeadPtr, &Head,
+			((Head & ~ORAN_BUF_INDEX_MASK) + ORAN_BUF_TAG_ONE) |
+			(Index + 1), 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+/*
+ * Index plus one of the buffer popped, 0 if the list is empty
+ */
+static u32 OranBufPop(OranBufClassState *ClassPtr, u32 Core)
+{
+	u64 *HeadPtr = &ClassPtr->List[Core].Head;
+	u64 Head = __atomic_load_n(HeadPtr, __ATOMIC_ACQUIRE);
+	u32 Top;
+	u32 Next;
+
+	do {
+		Top = (u32)(Head & ORAN_BUF_INDEX_MASK);
+		if (Top == 0) {
+			return 0;
+		}
+		Next = __atomic_load_n(&ClassPtr->NextPtr[Top - 1],
+				       __ATOMIC_RELAXED);
+	} while (!__atomic_compare_exchange_n(HeadPtr, &Head,
+			((Head & ~ORAN_BUF_INDEX_MASK) + ORAN_BUF_TAG_ONE) |
+			Next, 1, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE));
+
+	return Top;
+}
+
+/*
+ * Class and index of the buffer BufPtr points into, or the class count
+ * for memory outside the pool
+ */
+static u32 OranBufFind(const u8 *BufPtr, u32 *IndexPtr)
+{
+	OranBufClassState *ClassPtr;
+	UINTPTR Offset;
+	u32 Class;
+
+	for (Class = 0; Class < ORAN_BUF_CLASS_CNT; Class++) {
+		ClassPtr = &BufClass[Class];
+		Offset = (UINTPTR)BufPtr - (UINTPTR)ClassPtr->MemPtr;
+		if (((UINTPTR)BufPtr >= (UINTPTR)ClassPtr->MemPtr) &&
+		    (Offset < (UINTPTR)ClassPtr->Size * ClassPtr->Count)) {
+			*IndexPtr = (u32)(Offset / ClassPtr->Size);
+			return Class;
+		}
+	}
+
+	return ORAN_BUF_CLASS_CNT;
+}
+
+/****************************************************************************/
+/**
+*
+* Puts every buffer on the free lists of the calling core.
+*
+* @param	None.
+*
+* @return	None.
+*
+* @note		Call once, before any other core or thread uses the pool.
+*		Clears the statistics.
+*
+*****************************************************************************/
+void OranBufInit(void)
+{
+	static const u32 Size[ORAN_BUF_CLASS_CNT] = {
+		ORAN_BUF_SMALL_SIZE, ORAN_BUF_MEDIUM_SIZE, ORAN_BUF_LARGE_SIZE
+	};
+	static const u32 Count[ORAN_BUF_CLASS_CNT] = {
+		ORAN_BUF_SMALL_CNT, ORAN_BUF_MEDIUM_CNT, ORAN_BUF_LARGE_CNT
+	};
+	u8 *const MemPtr[ORAN_BUF_CLASS_CNT] = {
+		&BufSmall[0][0], &BufMedium[0][0], &BufLarge[0][0]
+	};
+	OranBufClassState *ClassPtr;
+	u32 Core = OranBufCore();
+	u32 First = 0;
+	u32 Class;
+	u32 Index;
+
+	memset(BufClass, 0, sizeof(BufClass));
+	for (Class = 0; Class < ORAN_BUF_CLASS_CNT; Class++) {
+		ClassPtr = &BufClass[Class];
+		ClassPtr->MemPtr = MemPtr[Class];
+		ClassPtr->NextPtr = &BufNext[First];
+		ClassPtr->RefsPtr = &BufRefs[First];
+		ClassPtr->OwnerPtr = &BufOwner[First];
+		ClassPtr->Size = Size[Class];
+		ClassPtr->Count = Count[Class];
+		for (Index = Count[Class]; Index != 0; Index--) {
+			ClassPtr->RefsPtr[Index - 1] = 0;
+			OranBufPush(ClassPtr, Core, Index - 1);
+		}
+		First += Count[Class];
+	}
+}
+
+/****************************************************************************/
+/**
+*
+* Tells which class serves buffers of a size.
+*
+* @param	Bytes is the size asked for.
+*
+* @return	The smallest class whose buffers hold Bytes, or
+*		ORAN_BUF_CLASS_CNT if none does.
+*
+* @note		None.
+*
+*****************************************************************************/
+u32 OranBufClass(u32 Bytes)
+{
+	if (Bytes <= ORAN_BUF_SMALL_SIZE) {
+		return ORAN_BUF_CLASS_SMALL;
+	}
+	if (Bytes <= ORAN_BUF_MEDIUM_SIZE) {
+		return ORAN_BUF_CLASS_MEDIUM;
+	}
+	if (Bytes <= ORAN_BUF_LARGE_SIZE) {
+		return ORAN_BUF_CLASS_LARGE;
+	}
+
+	return ORAN_BUF_CLASS_CNT;
+}
+
+/****************************************************************************/
+/**
+*
+* Takes a buffer of the smallest class that holds Bytes, with one
+* reference.
+*
+* @param	Bytes is the size needed.
+*
+* @return	The buffer, aligned to ORAN_BUF_LINE, or NULL if no class
+*		holds Bytes or that class is empty.
+*
+* @note		A class that runs out does not fall back on a larger one:
+*		its Failures count says it is too small.
+*
+*****************************************************************************/
+u8 *OranBufAlloc(u32 Bytes)
+{
+	OranBufClassState *ClassPtr;
+	OranBufList *ListPtr;
+	u32 Class = OranBufClass(Bytes);
+	u32 Core;
+	u32 Other;
+	u32 Top;
+	u32 Held;
+	u32 Peak;
+
+	if (Class >= ORAN_BUF_CLASS_CNT) {
+		return NULL;
+	}
+
+	ClassPtr = &BufClass[Class];
+	Core = OranBufCore();
+	ListPtr = &ClassPtr->List[Core];
+	Top = OranBufPop(ClassPtr, Core);
+	for (Other = 1; (Top == 0) && (Other < ORAN_BUF_CORES); Other++) {
+		Top = OranBufPop(ClassPtr, (Core + Other) % ORAN_BUF_CORES);
+		if (Top != 0) {
+			__atomic_fetch_add(&ListPtr->Steals, 1,
+					   __ATOMIC_RELAXED);
+		}
+	}
+	if (Top == 0) {
+		/* Every list was empty, so every buffer was in use */
+		__atomic_fetch_add(&ListPtr->Failures, 1, __ATOMIC_RELAXED);
+		return NULL;
+	}
+
+	__atomic_store_n(&ClassPtr->RefsPtr[Top - 1], 1, __ATOMIC_RELAXED);
+	__atomic_store_n(&ClassPtr->OwnerPtr[Top - 1], (u8)Core,
+			 __ATOMIC_RELAXED);
+	__atomic_fetch_add(&ListPtr->Allocs, 1, __ATOMIC_RELAXED);
+
+	/* On Linux another thread may share the line, hence the CAS */
+	Held = __atomic_add_fetch(&ListPtr->Held, 1, __ATOMIC_RELAXED);
+	Peak = __atomic_load_n(&ListPtr->Peak, __ATOMIC_RELAXED);
+	while ((Held > Peak) &&
+	       !__atomic_compare_exchange_n(&ListPtr->Peak, &Peak, Held, 1,
+					    __ATOMIC_RELAXED,
+					    __ATOMIC_RELAXED)) {
+	}
+
+	return ClassPtr->MemPtr + (UINTPTR)(Top - 1) * ClassPtr->Size;
+}
+
+/****************************************************************************/
+/**
+*
+* Adds a reference to a buffer, for each more place it is queued or kept.
+*
+* @param	BufPtr points anywhere into the buffer.
+*
+* @return	None.
+*
+* @note		Memory outside the pool is ignored.
+*
+*****************************************************************************/
+void OranBufRef(const u8 *BufPtr)
+{
+	u32 Index;
+	u32 Class = OranBufFind(BufPtr, &Index);
+
+	if (Class < ORAN_BUF_CLASS_CNT) {
+		__atomic_fetch_add(&BufClass[Class].RefsPtr[Index], 1,
+				   __ATOMIC_RELAXED);
+	}
+}
+
+/****************************************************************************/
+/**
+*
+* Drops a reference to a buffer, and returns it to the free list of the
+* calling core with the last one.
+*
+* @param	BufPtr points anywhere into the buffer.
+*
+* @return	None.
+*
+* @note		Memory outside the pool is ignored, so frames sent from
+*		other memory can be released the same way. A buffer with no
+*		reference left is counted in BadFrees and not freed again.
+*
+*****************************************************************************/
+void OranBufFree(u8 *BufPtr)
+{
+	OranBufClassState *ClassPtr;
+	u32 Index;
+	u32 Class = OranBufFind(BufPtr, &Index);
+	u32 Core;
+	u32 Refs;
+
+	if (Class >= ORAN_BUF_CLASS_CNT) {
+		return;
+	}
+
+	ClassPtr = &BufClass[Class];
+	Core = OranBufCore();
+	Refs = __atomic_load_n(&ClassPtr->RefsPtr[Index], __ATOMIC_RELAXED);
+	do {
+		if (Refs == 0) {
+			__atomic_fetch_add(&ClassPtr->List[Core].BadFrees, 1,
+					   __ATOMIC_RELAXED);
+			return;
+		}
+	} while (!__atomic_compare_exchange_n(&ClassPtr->RefsPtr[Index], &Refs,
+					      Refs - 1, 1, __ATOMIC_ACQ_REL,
+					      __ATOMIC_RELAXED));
+	if (Refs != 1) {
+		return;
+	}
+
+	__atomic_fetch_add(&ClassPtr->List[Core].Frees, 1, __ATOMIC_RELAXED);
+	__atomic_fetch_sub(&ClassPtr->List[ClassPtr->OwnerPtr[Index]].Held, 1,
+			   __ATOMIC_RELAXED);
+	OranBufPush(ClassPtr, Core, Index);
+}
+
+/****************************************************************************/
+/**
+*
+* Tells the size of the buffer BufPtr points into.
+*
+* @param	BufPtr points anywhere into the buffer.
+*
+* @return	The size of its class, 0 for memory outside the pool.
+*
+* @note		None.
+*
+*****************************************************************************/
+u32 OranBufSize(const u8 *BufPtr)
+{
+	u32 Index;
+	u32 Class = OranBufFind(BufPtr, &Index);
+
+	return (Class < ORAN_BUF_CLASS_CNT) ? BufClass[Class].Size : 0;
+}
+
+/****************************************************************************/
+/**
+*
+* Reads the use of a class.
+*
+* @param	Class is ORAN_BUF_CLASS_SMALL, _MEDIUM or _LARGE.
+* @param	StatsPtr receives the statistics, zeroed for a bad class.
+*
+* @return	None.
+*
+* @note		Sums the counts of every core. Read while other cores
+*		allocate, the fields need not agree with each other.
+*		HighWater is the sum of the per-core peaks, an upper bound
+*		on the most buffers in use at once (see the top of this
+*		file), capped at Count.
+*
+*****************************************************************************/
+void OranBufGetStats(u32 Class, OranBufStats *StatsPtr)
+{
+	OranBufClassState *ClassPtr;
+	OranBufList *ListPtr;
+	u64 Frees = 0;
+	u32 High = 0;
+	u32 Core;
+
+	memset(StatsPtr, 0, sizeof(*StatsPtr));
+	if (Class >= ORAN_BUF_CLASS_CNT) {
+		return;
+	}
+
+	ClassPtr = &BufClass[Class];
+	StatsPtr->Size = ClassPtr->Size;
+	StatsPtr->Count = ClassPtr->Count;
+	/* Frees before allocs, so that a free is not seen without its alloc */
+	for (Core = 0; Core < ORAN_BUF_CORES; Core++) {
+		Frees += __atomic_load_n(&ClassPtr->List[Core].Frees,
+					 __ATOMIC_RELAXED);
+	}
+	for (Core = 0; Core < ORAN_BUF_CORES; Core++) {
+		ListPtr = &ClassPtr->List[Core];
+		StatsPtr->Allocs += __atomic_load_n(&ListPtr->Allocs,
+						    __ATOMIC_RELAXED);
+		StatsPtr->Failures += __atomic_load_n(&ListPtr->Failures,
+						      __ATOMIC_RELAXED);
+		StatsPtr->Steals += __atomic_load_n(&ListPtr->Steals,
+						    __ATOMIC_RELAXED);
+		StatsPtr->BadFrees += __atomic_load_n(&ListPtr->BadFrees,
+						      __ATOMIC_RELAXED);
+		High += __atomic_load_n(&ListPtr->Peak, __ATOMIC_RELAXED);
+	}
+	StatsPtr->InUse = (StatsPtr->Allocs > Frees) ?
+			  (u32)(StatsPtr->Allocs - Frees) : 0;
+	if (High > ClassPtr->Count) {
+		High = ClassPtr->Count;
+	}
+	StatsPtr->HighWater = (StatsPtr->InUse > High) ? StatsPtr->InUse : High;
+}
+
+/****************************************************************************/
+/**
+*
+* Prints the use of every class.
+*
+* @param	None.
+*
+* @return	None.
+*
+* @note		None.
+*
+*****************************************************************************/
+void OranBufPrint(void)
+{
+	OranBufStats Stats;
+	u32 Class;
+
+	for (Class = 0; Class < ORAN_BUF_CLASS_CNT; Class++) {
+		OranBufGetStats(Class, &Stats);
+		xil_printf("buffers of %d bytes: %d of %d in use, most %d, "
+			   "%d taken, %d failed, %d stolen, %d bad frees\r\n",
+			   (int)Stats.Size, (int)Stats.InUse, (int)Stats.Count,
+			   (int)Stats.HighWater, (int)Stats.Allocs,
+			   (int)Stats.Failures, (int)Stats.Steals,
+			   (int)Stats.BadFrees);
+	}
+}
@@ -0,0 +1,103 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file oran_buf.h
+*
+* Packet buffers in three size classes, each a fixed array of buffers
+* aligned to the cache line, so that a 64-byte eCPRI control frame takes
+* 256 bytes and not a jumbo buffer, and the DMA never shares a line with
+* anything else.
+*
+* OranBufAlloc takes a buffer of the smallest class that holds the bytes
+* asked for. Every class keeps a free list per core, a lock-free stack
+* with a tag against ABA: a core takes from and returns to its own list,
+* and takes from the others only when its own is empty. A buffer holds a
+* reference count, one from OranBufAlloc, one more per OranBufRef, so a
+* frame can be queued on several rings at once without a copy; it goes
+* back to a free list at the last OranBufFree.
+*
+* Call OranBufInit once, before the first buffer is taken.
+*
+*****************************************************************************/
+#ifndef ORAN_BUF_H
+#define ORAN_BUF_H
+
+/***************************** Include Files ********************************/
+
+#include "xil_types.h"
+
+/************************** Constant Definitions ****************************/
+
+#define ORAN_BUF_LINE		64	/* cache line of the A53 */
+
+/*
+ * Sizes and counts of the classes, multiples of ORAN_BUF_LINE. The small
+ * class holds C-plane and PTP frames, the medium one a VLAN-tagged frame
+ * of 1518 bytes and the GEM3 ring buffers, the large one the most the GEM
+ * writes into one RX buffer with jumbo frames enabled
+ * (XEMACPS_RX_BUF_SIZE_JUMBO).
+ */
+#ifndef ORAN_BUF_SMALL_SIZE
+#define ORAN_BUF_SMALL_SIZE	256
+#endif
+#ifndef ORAN_BUF_SMALL_CNT
+#define ORAN_BUF_SMALL_CNT	512
+#endif
+#ifndef ORAN_BUF_MEDIUM_SIZE
+#define ORAN_BUF_MEDIUM_SIZE	2048
+#endif
+#ifndef ORAN_BUF_MEDIUM_CNT
+#define ORAN_BUF_MEDIUM_CNT	1536
+#endif
+#ifndef ORAN_BUF_LARGE_SIZE
+#define ORAN_BUF_LARGE_SIZE	10240
+#endif
+#ifndef ORAN_BUF_LARGE_CNT
+#define ORAN_BUF_LARGE_CNT	4
+#endif
+
+#define ORAN_BUF_CLASS_SMALL	0
+#define ORAN_BUF_CLASS_MEDIUM	1
+#define ORAN_BUF_CLASS_LARGE	2
+#define ORAN_BUF_CLASS_CNT	3
+
+/* Free lists per class, one per core of the A53 cluster */
+#ifndef ORAN_BUF_CORES
+#define ORAN_BUF_CORES		4
+#endif
+
+/**************************** Type Definitions ******************************/
+
+/*
+ * Use of one class, see OranBufGetStats
+ */
+typedef struct {
+	u32 Size;
+	u32 Count;
+	u32 InUse;	/* taken and not freed yet */
+	u32 HighWater;	/* bound on the most in use, see OranBufGetStats */
+	u64 Allocs;
+	u32 Failures;	/* class empty */
+	u32 Steals;	/* taken from another core's free list */
+	u32 BadFrees;	/* freed with no reference left */
+} OranBufStats;
+
+/************************** Function Prototypes *****************************/
+
+/*
+ * Buffer pool, implemented in oran_buf.c
+ */
+void OranBufInit(void);
+u32 OranBufClass(u32 Bytes);
+u8 *OranBufAlloc(u32 Bytes);
+void OranBufRef(const u8 *BufPtr);
+void OranBufFree(u8 *BufPtr);
+u32 OranBufSize(const u8 *BufPtr);
+void OranBufGetStats(u32 Class, OranBufStats *StatsPtr);
+void OranBufPrint(void);
+
+#endif /* ORAN_BUF_H */
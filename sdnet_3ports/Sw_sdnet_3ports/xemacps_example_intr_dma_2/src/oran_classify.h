@@ -0,0 +1,661 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/*
+ * Generated by p4gen from main.json. Do not edit; regenerate after changing
+ * the P4 program or the default entries.
+ */
+#ifndef ORAN_CLASSIFY_H
+#define ORAN_CLASSIFY_H
+
+#include <stdint.h>
+
+/* Parser error codes (standard_metadata.parser_error) */
+#define ORAN_CLASSIFY_ERR_NO_ERROR	0
+#define ORAN_CLASSIFY_ERR_PACKET_TOO_SHORT	1
+#define ORAN_CLASSIFY_ERR_NO_MATCH	2
+#define ORAN_CLASSIFY_ERR_STACK_OUT_OF_BOUNDS	3
+#define ORAN_CLASSIFY_ERR_HEADER_TOO_SHORT	4
+#define ORAN_CLASSIFY_ERR_PARSER_TIMEOUT	5
+#define ORAN_CLASSIFY_ERR_HEADER_DEPTH_LIMIT_EXCEEDED	6
+#define ORAN_CLASSIFY_ERR_INVALID_IPPACKET	7
+
+/* Action ids, as used by the SDNet table driver */
+#define ORAN_CLASSIFY_ACTION_NO_ACTION	0
+#define ORAN_CLASSIFY_ACTION_SET_PLANE	1
+#define ORAN_CLASSIFY_ACTION_COUNT_PLANE	2
+#define ORAN_CLASSIFY_ACTION_METER_PORT	3
+
+/*
+ * Metadata in and out of the pipeline. Zero it and set the sideband
+ * inputs (e.g. the ingress port) before calling OranClassify.
+ */
+typedef struct {
+	uint8_t drop;
+	uint64_t ingress_timestamp;
+	uint8_t parser_error;
+	uint32_t metadata_axis_tdest;
+	uint8_t metadata_axis_tid;
+	uint8_t metadata_prio;
+} OranClassifyMeta;
+
+/*
+ * MyProcessing.plane_classify entries, in priority order (first match wins).
+ * The key fields are packed MSB first into 64-bit words:
+ *   word 0 bits 45..38: metadata.axis_tid
+ *   word 0 bits 37..22: eth.type
+ *   word 0 bits 21..21: vlan[0].$valid$
+ *   word 0 bits 20..18: vlan[0].pcp
+ *   word 0 bits 17..17: ecpri.$valid$
+ *   word 0 bits 16..9: ecpri.message_type
+ *   word 0 bits 8..8: roe.$valid$
+ *   word 0 bits 7..0: roe.RoEsubType
+ * Value must already be masked.
+ */
+typedef struct {
+	uint64_t Value[1];
+	uint64_t Mask[1];
+	uint32_t Action;
+	uint64_t Params[2];
+} OranClassifyPlaneClassifyEntry;
+
+typedef struct {
+	uint32_t NumEntries;
+	const OranClassifyPlaneClassifyEntry *Entries;
+} OranClassifyPlaneClassifyTable;
+
+/*
+ * MyProcessing.eaxc_steer entries, in priority order (first match wins).
+ * The key fields are packed MSB first into 64-bit words:
+ *   word 0 bits 23..16: metadata.axis_tid
+ *   word 0 bits 15..0: ecpri_id.pc_id
+ * Value must already be masked.
+ */
+typedef struct {
+	uint64_t Value[1];
+	uint64_t Mask[1];
+	uint32_t Action;
+	uint64_t Params[2];
+} OranClassifyEaxcSteerEntry;
+
+typedef struct {
+	uint32_t NumEntries;
+	const OranClassifyEaxcSteerEntry *Entries;
+} OranClassifyEaxcSteerTable;
+
+/*
+ * MyProcessing.plane_count entries, in priority order (first match wins).
+ * The key fields are packed MSB first into 64-bit words:
+ * Value must already be masked.
+ */
+typedef struct {
+	uint64_t Value[1];
+	uint64_t Mask[1];
+	uint32_t Action;
+	uint64_t Params[1];
+} OranClassifyPlaneCountEntry;
+
+typedef struct {
+	uint32_t NumEntries;
+	const OranClassifyPlaneCountEntry *Entries;
+} OranClassifyPlaneCountTable;
+
+/*
+ * MyProcessing.port_police entries, in priority order (first match wins).
+ * The key fields are packed MSB first into 64-bit words:
+ * Value must already be masked.
+ */
+typedef struct {
+	uint64_t Value[1];
+	uint64_t Mask[1];
+	uint32_t Action;
+	uint64_t Params[1];
+} OranClassifyPortPoliceEntry;
+
+typedef struct {
+	uint32_t NumEntries;
+	const OranClassifyPortPoliceEntry *Entries;
+} OranClassifyPortPoliceTable;
+
+/* One counter extern cell */
+typedef struct {
+	uint64_t Packets;
+	uint64_t Bytes;
+} OranClassifyCounter;
+
+#define ORAN_CLASSIFY_PLANE_STATS_SIZE	32
+
+/*
+ * One two-rate three-color meter cell. The caller sets Cir/Pir (bit/s,
+ * or packet/s for packet meters) and Cbs/Pbs (bytes or packets); the
+ * rest is bucket state and starts zeroed. Pir == 0 colors everything
+ * green.
+ */
+typedef struct {
+	uint64_t Cir;
+	uint64_t Cbs;
+	uint64_t Pir;
+	uint64_t Pbs;
+	uint64_t Tc;
+	uint64_t Tp;
+	uint64_t Last;
+	uint32_t Primed;
+} OranClassifyMeter;
+
+#define ORAN_CLASSIFY_COLOR_GREEN	0
+#define ORAN_CLASSIFY_COLOR_YELLOW	1
+#define ORAN_CLASSIFY_COLOR_RED	2
+#define ORAN_CLASSIFY_PORT_METER_SIZE	32
+
+/*
+ * Everything the pipeline matches against or updates. Counter and meter
+ * arrays may be left null to skip counting and metering.
+ */
+typedef struct {
+	OranClassifyPlaneClassifyTable PlaneClassify;
+	OranClassifyEaxcSteerTable EaxcSteer;
+	OranClassifyPlaneCountTable PlaneCount;
+	OranClassifyPortPoliceTable PortPolice;
+	OranClassifyCounter *PlaneStats;
+	OranClassifyMeter *PortMeter;
+} OranClassifyTables;
+
+static const uint64_t OranClassifyPlaneClassifyDefaultParams[2] = { 0x0, 0x0 };
+
+static const OranClassifyPlaneClassifyEntry OranClassifyPlaneClassifyDefaults[15] = {
+	/* priority 10 */
+	{ { 0x20000 }, { 0x3fc00003fe00 },
+	  ORAN_CLASSIFY_ACTION_SET_PLANE, { 0x1, 0x2 } },
+	/* priority 10 */
+	{ { 0x4000020000 }, { 0x3fc00003fe00 },
+	  ORAN_CLASSIFY_ACTION_SET_PLANE, { 0x0, 0x2 } },
+	/* priority 10 */
+	{ { 0x20400 }, { 0x3fc00003fe00 },
+	  ORAN_CLASSIFY_ACTION_SET_PLANE, { 0x1, 0x3 } },
+	/* priority 10 */
+	{ { 0x4000020400 }, { 0x3fc00003fe00 },
+	  ORAN_CLASSIFY_ACTION_SET_PLANE, { 0x0, 0x3 } },
+	/* priority 10 */
+	{ { 0x20a00 }, { 0x3fc00003fe00 },
+	  ORAN_CLASSIFY_ACTION_SET_PLANE, { 0x1, 0x3 } },
+	/* priority 10 */
+	{ { 0x4000020a00 }, { 0x3fc00003fe00 },
+	  ORAN_CLASSIFY_ACTION_SET_PLANE, { 0x0, 0x3 } },
+	/* priority 10 */
+	{ { 0x180 }, { 0x3fc0000001fc },
+	  ORAN_CLASSIFY_ACTION_SET_PLANE, { 0x1, 0x2 } },
+	/* priority 10 */
+	{ { 0x4000000180 }, { 0x3fc0000001fc },
+	  ORAN_CLASSIFY_ACTION_SET_PLANE, { 0x0, 0x2 } },
+	/* priority 20 */
+	{ { 0x20000 }, { 0x3fa00 },
+	  ORAN_CLASSIFY_ACTION_NO_ACTION, { 0x0, 0x0 } },
+	/* priority 20 */
+	{ { 0x20a00 }, { 0x3fe00 },
+	  ORAN_CLASSIFY_ACTION_NO_ACTION, { 0x0, 0x0 } },
+	/* priority 20 */
+	{ { 0x180 }, { 0x1fc },
+	  ORAN_CLASSIFY_ACTION_NO_ACTION, { 0x0, 0x0 } },
+	/* priority 30 */
+	{ { 0x223dc00000 }, { 0x3fffffc00000 },
+	  ORAN_CLASSIFY_ACTION_SET_PLANE, { 0x2, 0x4 } },
+	/* priority 30 */
+	{ { 0xa23dc00000 }, { 0x3fffffc00000 },
+	  ORAN_CLASSIFY_ACTION_SET_PLANE, { 0x0, 0x4 } },
+	/* priority 40 */
+	{ { 0x0 }, { 0x3fc000000000 },
+	  ORAN_CLASSIFY_ACTION_SET_PLANE, { 0x2, 0x1 } },
+	/* priority 40 */
+	{ { 0x8000000000 }, { 0x3fc000000000 },
+	  ORAN_CLASSIFY_ACTION_SET_PLANE, { 0x0, 0x1 } },
+};
+
+static const uint64_t OranClassifyEaxcSteerDefaultParams[2] = { 0x0, 0x0 };
+
+static const uint64_t OranClassifyPlaneCountDefaultParams[1] = { 0x0 };
+
+static const uint64_t OranClassifyPortPoliceDefaultParams[1] = { 0x0 };
+
+/* Tables as loaded by p4gen -e */
+static const OranClassifyTables OranClassifyDefaultTables = {
+	{ 15, OranClassifyPlaneClassifyDefaults },
+	{ 0, 0 },
+	{ 0, 0 },
+	{ 0, 0 },
+	0,
+	0,
+};
+
+/* Big-endian load of N (1..8) bytes */
+static inline uint64_t OranClassifyLoad(const uint8_t *P, unsigned N)
+{
+	uint64_t V = 0;
+	unsigned I;
+
+	for (I = 0; I < N; I++) {
+		V = (V << 8) | P[I];
+	}
+	return V;
+}
+
+static inline uint64_t OranClassifyShl(uint64_t A, uint64_t B)
+{
+	return (B >= 64) ? 0 : A << B;
+}
+
+static inline uint64_t OranClassifyShr(uint64_t A, uint64_t B)
+{
+	return (B >= 64) ? 0 : A >> B;
+}
+
+static inline void OranClassifyRefill(uint64_t *T, uint64_t Rate, uint64_t Cap,
+		uint64_t Dt)
+{
+	if (*T >= Cap || Rate == 0) {
+		return;
+	}
+	*T = (Dt > (Cap - *T) / Rate) ? Cap : *T + Rate * Dt;
+}
+
+/*
+ * RFC 2698 color-blind marking. Size is the frame in bits or packets,
+ * Unit what one burst unit is in the same terms, Now the time in ns.
+ */
+static inline uint64_t OranClassifyMeterColor(OranClassifyMeter *M,
+		uint64_t Size, uint64_t Unit, uint64_t Now)
+{
+	const uint64_t NsPerS = UINT64_C(1000000000);
+	uint64_t Cbs = M->Cbs * Unit * NsPerS;
+	uint64_t Pbs = M->Pbs * Unit * NsPerS;
+	uint64_t Dt = 0;
+
+	if (M->Pir == 0) {
+		return ORAN_CLASSIFY_COLOR_GREEN;
+	}
+	Size *= NsPerS;
+	if (!M->Primed) {
+		M->Tc = Cbs;
+		M->Tp = Pbs;
+		M->Primed = 1;
+	} else if (Now > M->Last) {
+		Dt = Now - M->Last;
+	}
+	M->Last = Now;
+	OranClassifyRefill(&M->Tc, M->Cir, Cbs, Dt);
+	OranClassifyRefill(&M->Tp, M->Pir, Pbs, Dt);
+
+	if (M->Tp < Size) {
+		return ORAN_CLASSIFY_COLOR_RED;
+	}
+	M->Tp -= Size;
+	if (M->Tc < Size) {
+		return ORAN_CLASSIFY_COLOR_YELLOW;
+	}
+	M->Tc -= Size;
+	return ORAN_CLASSIFY_COLOR_GREEN;
+}
+
+/*
+ * Runs a frame through the parser and the ingress pipeline.
+ *
+ * Pkt/Len is the frame from the destination MAC on, Tables the entries
+ * to match (OranClassifyDefaultTables or the caller's), Meta the metadata
+ * in and out. Returns the parser error code, also left in
+ * Meta->parser_error when the program declares that field.
+ */
+static inline uint32_t OranClassify(const uint8_t *Pkt, uint32_t Len,
+		const OranClassifyTables *Tables, OranClassifyMeta *Meta)
+{
+	uint32_t Off = 0;
+	uint32_t Err = 0;
+	uint32_t Steps = 0;
+	uint64_t Key;
+	uint32_t VlBits;
+	uint32_t n_vlan = 0;
+	uint64_t h_scalars_tmp = 0;
+	uint64_t h_scalars_tmp_0 = 0;
+	uint64_t h_scalars_stat_idx = 0;
+	uint64_t h_scalars_meter_color = 0;
+	uint64_t h_standard_metadata_t_drop = Meta->drop & UINT64_C(0x1);
+	uint64_t h_standard_metadata_t_ingress_timestamp = Meta->ingress_timestamp & UINT64_C(0xffffffffffffffff);
+	uint64_t h_standard_metadata_t_parser_error = Meta->parser_error & UINT64_C(0x7);
+	uint64_t h_eth_type = 0;
+	uint64_t h_ipv4_version = 0;
+	uint64_t h_ipv4_hdr_len = 0;
+	uint64_t h_ipv4_protocol = 0;
+	uint8_t v_ecpri = 0;
+	uint64_t h_ecpri_message_type = 0;
+	uint8_t v_roe = 0;
+	uint64_t h_roe_RoEsubType = 0;
+	uint8_t v_vlan_0 = 0;
+	uint64_t h_vlan_0_pcp = 0;
+	uint64_t h_vlan_0_tpid = 0;
+	uint64_t h_vlan_1_tpid = 0;
+	uint64_t h_metadata_axis_tdest = Meta->metadata_axis_tdest & UINT64_C(0xffffffff);
+	uint64_t h_metadata_axis_tid = Meta->metadata_axis_tid & UINT64_C(0xff);
+	uint64_t h_metadata_prio = Meta->metadata_prio & UINT64_C(0xff);
+	uint8_t v_ecpri_id = 0;
+	uint64_t h_ecpri_id_pc_id = 0;
+
+	(void)Key;
+
+	/* Parser */
+	goto S_start;
+
+S_start:
+	if (++Steps > 64) {
+		Err = ORAN_CLASSIFY_ERR_PARSER_TIMEOUT;
+		goto Parsed;
+	}
+	if (Len - Off < 14) {
+		Err = ORAN_CLASSIFY_ERR_PACKET_TOO_SHORT;
+		goto Parsed;
+	}
+	h_eth_type = OranClassifyLoad(Pkt + Off + 12, 2);
+	Off += 14;
+	Key = ((h_eth_type & UINT64_C(0xffff)) << 0);
+	switch (Key) {
+	case UINT64_C(0x8100):
+		goto S_parse_vlan;
+	case UINT64_C(0x800):
+		goto S_parse_ipv4;
+	case UINT64_C(0xaefe):
+		goto S_parse_ecpri;
+	case UINT64_C(0xfc3d):
+		goto S_parse_roe;
+	default:
+		goto Parsed;
+	}
+
+S_parse_vlan:
+	if (++Steps > 64) {
+		Err = ORAN_CLASSIFY_ERR_PARSER_TIMEOUT;
+		goto Parsed;
+	}
+	if (n_vlan >= 2) {
+		Err = ORAN_CLASSIFY_ERR_STACK_OUT_OF_BOUNDS;
+		goto Parsed;
+	}
+	if (Len - Off < 4) {
+		Err = ORAN_CLASSIFY_ERR_PACKET_TOO_SHORT;
+		goto Parsed;
+	}
+	switch (n_vlan) {
+	case 0:
+		h_vlan_0_pcp = OranClassifyLoad(Pkt + Off + 0, 1) >> 5 & UINT64_C(0x7);
+		h_vlan_0_tpid = OranClassifyLoad(Pkt + Off + 2, 2);
+		v_vlan_0 = 1;
+		break;
+	case 1:
+		h_vlan_1_tpid = OranClassifyLoad(Pkt + Off + 2, 2);
+		break;
+	}
+	n_vlan++;
+	Off += 4;
+	Key = (((n_vlan <= 1 ? h_vlan_0_tpid : h_vlan_1_tpid) & UINT64_C(0xffff)) << 0);
+	switch (Key) {
+	case UINT64_C(0x8100):
+		goto S_parse_vlan;
+	case UINT64_C(0x800):
+		goto S_parse_ipv4;
+	case UINT64_C(0xaefe):
+		goto S_parse_ecpri;
+	case UINT64_C(0xfc3d):
+		goto S_parse_roe;
+	default:
+		goto Parsed;
+	}
+
+S_parse_ipv4:
+	if (++Steps > 64) {
+		Err = ORAN_CLASSIFY_ERR_PARSER_TIMEOUT;
+		goto Parsed;
+	}
+	if (Len - Off < 20) {
+		Err = ORAN_CLASSIFY_ERR_PACKET_TOO_SHORT;
+		goto Parsed;
+	}
+	h_ipv4_version = OranClassifyLoad(Pkt + Off + 0, 1) >> 4 & UINT64_C(0xf);
+	h_ipv4_hdr_len = OranClassifyLoad(Pkt + Off + 0, 1) & UINT64_C(0xf);
+	h_ipv4_protocol = OranClassifyLoad(Pkt + Off + 9, 1);
+	Off += 20;
+	h_scalars_tmp = (uint64_t)((uint64_t)((uint64_t)(h_ipv4_version == UINT64_C(0x4)) && (uint64_t)(h_ipv4_hdr_len >= UINT64_C(0x5))) != 0) & UINT64_C(0x1);
+	if (!((uint64_t)(h_scalars_tmp != 0))) {
+		Err = (uint32_t)UINT64_C(0x7);
+		goto Parsed;
+	}
+	h_scalars_tmp_0 = (OranClassifyShl((((h_ipv4_hdr_len & UINT64_C(0xffffffff)) + UINT64_C(0xfffffffb)) & UINT64_C(0xffffffff)), UINT64_C(0x5)) & UINT64_C(0xffffffff)) & UINT64_C(0xffffffff);
+	VlBits = (uint32_t)h_scalars_tmp_0;
+	if ((VlBits & 7) != 0 || VlBits > 320) {
+		Err = ORAN_CLASSIFY_ERR_HEADER_TOO_SHORT;
+		goto Parsed;
+	}
+	if (Len - Off < (VlBits >> 3)) {
+		Err = ORAN_CLASSIFY_ERR_PACKET_TOO_SHORT;
+		goto Parsed;
+	}
+	Off += VlBits >> 3;
+	Key = ((h_ipv4_protocol & UINT64_C(0xff)) << 0);
+	switch (Key) {
+	case UINT64_C(0x11):
+		goto S_parse_udp;
+	default:
+		goto Parsed;
+	}
+
+S_parse_udp:
+	if (++Steps > 64) {
+		Err = ORAN_CLASSIFY_ERR_PARSER_TIMEOUT;
+		goto Parsed;
+	}
+	if (Len - Off < 8) {
+		Err = ORAN_CLASSIFY_ERR_PACKET_TOO_SHORT;
+		goto Parsed;
+	}
+	Off += 8;
+	goto Parsed;
+
+S_parse_ecpri:
+	if (++Steps > 64) {
+		Err = ORAN_CLASSIFY_ERR_PARSER_TIMEOUT;
+		goto Parsed;
+	}
+	if (Len - Off < 4) {
+		Err = ORAN_CLASSIFY_ERR_PACKET_TOO_SHORT;
+		goto Parsed;
+	}
+	h_ecpri_message_type = OranClassifyLoad(Pkt + Off + 1, 1);
+	v_ecpri = 1;
+	Off += 4;
+	Key = ((h_ecpri_message_type & UINT64_C(0xff)) << 0);
+	if ((Key & UINT64_C(0xfd)) == UINT64_C(0x0)) {
+		goto S_parse_ecpri_id;
+	}
+	goto Parsed;
+
+S_parse_roe:
+	if (++Steps > 64) {
+		Err = ORAN_CLASSIFY_ERR_PARSER_TIMEOUT;
+		goto Parsed;
+	}
+	if (Len - Off < 8) {
+		Err = ORAN_CLASSIFY_ERR_PACKET_TOO_SHORT;
+		goto Parsed;
+	}
+	h_roe_RoEsubType = OranClassifyLoad(Pkt + Off + 0, 1);
+	v_roe = 1;
+	Off += 8;
+	goto Parsed;
+
+S_parse_ecpri_id:
+	if (++Steps > 64) {
+		Err = ORAN_CLASSIFY_ERR_PARSER_TIMEOUT;
+		goto Parsed;
+	}
+	if (Len - Off < 4) {
+		Err = ORAN_CLASSIFY_ERR_PACKET_TOO_SHORT;
+		goto Parsed;
+	}
+	h_ecpri_id_pc_id = OranClassifyLoad(Pkt + Off + 0, 2);
+	v_ecpri_id = 1;
+	Off += 4;
+	goto Parsed;
+
+Parsed:
+	if (Err != 0) {
+		h_standard_metadata_t_parser_error = Err & UINT64_C(0x7);
+	}
+
+	/* Ingress pipeline */
+	goto T_MyProcessing_plane_classify;
+
+T_MyProcessing_plane_classify: {
+	const OranClassifyPlaneClassifyEntry *E = Tables->PlaneClassify.Entries;
+	const OranClassifyPlaneClassifyEntry *End = E + Tables->PlaneClassify.NumEntries;
+	const uint64_t *Prm = OranClassifyPlaneClassifyDefaultParams;
+	uint32_t Act = 0;
+	uint64_t K[1];
+
+	K[0] = ((h_metadata_axis_tid & UINT64_C(0xff)) << 38) |
+	       ((h_eth_type & UINT64_C(0xffff)) << 22) |
+	       (((uint64_t)v_vlan_0 & UINT64_C(0x1)) << 21) |
+	       ((h_vlan_0_pcp & UINT64_C(0x7)) << 18) |
+	       (((uint64_t)v_ecpri & UINT64_C(0x1)) << 17) |
+	       ((h_ecpri_message_type & UINT64_C(0xff)) << 9) |
+	       (((uint64_t)v_roe & UINT64_C(0x1)) << 8) |
+	       ((h_roe_RoEsubType & UINT64_C(0xff)) << 0);
+	for (; E < End; E++) {
+		if ((K[0] & E->Mask[0]) == E->Value[0]) {
+			Act = E->Action;
+			Prm = E->Params;
+			break;
+		}
+	}
+	(void)Prm;
+	switch (Act) {
+	case ORAN_CLASSIFY_ACTION_SET_PLANE:
+		h_metadata_axis_tdest = Prm[0] & UINT64_C(0xffffffff);
+		h_metadata_prio = Prm[1] & UINT64_C(0xff);
+		goto C_node_4;
+	case ORAN_CLASSIFY_ACTION_NO_ACTION:
+		goto C_node_4;
+	default:
+		goto Done;
+	}
+}
+
+T_MyProcessing_eaxc_steer: {
+	const OranClassifyEaxcSteerEntry *E = Tables->EaxcSteer.Entries;
+	const OranClassifyEaxcSteerEntry *End = E + Tables->EaxcSteer.NumEntries;
+	const uint64_t *Prm = OranClassifyEaxcSteerDefaultParams;
+	uint32_t Act = 0;
+	uint64_t K[1];
+
+	K[0] = ((h_metadata_axis_tid & UINT64_C(0xff)) << 16) |
+	       ((h_ecpri_id_pc_id & UINT64_C(0xffff)) << 0);
+	for (; E < End; E++) {
+		if ((K[0] & E->Mask[0]) == E->Value[0]) {
+			Act = E->Action;
+			Prm = E->Params;
+			break;
+		}
+	}
+	(void)Prm;
+	switch (Act) {
+	case ORAN_CLASSIFY_ACTION_SET_PLANE:
+		h_metadata_axis_tdest = Prm[0] & UINT64_C(0xffffffff);
+		h_metadata_prio = Prm[1] & UINT64_C(0xff);
+		goto T_MyProcessing_plane_count;
+	case ORAN_CLASSIFY_ACTION_NO_ACTION:
+		goto T_MyProcessing_plane_count;
+	default:
+		goto Done;
+	}
+}
+
+T_MyProcessing_plane_count: {
+	const OranClassifyPlaneCountEntry *E = Tables->PlaneCount.Entries;
+	const OranClassifyPlaneCountEntry *End = E + Tables->PlaneCount.NumEntries;
+	const uint64_t *Prm = OranClassifyPlaneCountDefaultParams;
+	uint32_t Act = 2;
+	uint64_t K[1];
+
+	K[0] = 0;
+	for (; E < End; E++) {
+		if ((K[0] & E->Mask[0]) == E->Value[0]) {
+			Act = E->Action;
+			Prm = E->Params;
+			break;
+		}
+	}
+	(void)Prm;
+	switch (Act) {
+	case ORAN_CLASSIFY_ACTION_COUNT_PLANE:
+		h_scalars_stat_idx = ((OranClassifyShl(((uint64_t)(h_standard_metadata_t_parser_error != UINT64_C(0x0)) ? UINT64_C(0x6) : ((uint64_t)((uint64_t)v_roe != 0) ? UINT64_C(0x4) : ((uint64_t)((uint64_t)v_ecpri != 0) ? ((uint64_t)(h_ecpri_message_type == UINT64_C(0x0)) ? UINT64_C(0x1) : ((uint64_t)(h_ecpri_message_type == UINT64_C(0x2)) ? UINT64_C(0x2) : UINT64_C(0x3))) : ((uint64_t)(h_eth_type == UINT64_C(0x88f7)) ? UINT64_C(0x5) : UINT64_C(0x0))))), UINT64_C(0x2)) | (h_metadata_axis_tid & UINT64_C(0x3))) & UINT64_C(0xff)) & UINT64_C(0xff);
+		if (Tables->PlaneStats != 0) {
+			uint64_t Idx = h_scalars_stat_idx;
+
+			if (Idx < 32) {
+				Tables->PlaneStats[Idx].Packets++;
+				Tables->PlaneStats[Idx].Bytes += Len;
+			}
+		}
+		goto T_MyProcessing_port_police;
+	default:
+		goto Done;
+	}
+}
+
+T_MyProcessing_port_police: {
+	const OranClassifyPortPoliceEntry *E = Tables->PortPolice.Entries;
+	const OranClassifyPortPoliceEntry *End = E + Tables->PortPolice.NumEntries;
+	const uint64_t *Prm = OranClassifyPortPoliceDefaultParams;
+	uint32_t Act = 3;
+	uint64_t K[1];
+
+	K[0] = 0;
+	for (; E < End; E++) {
+		if ((K[0] & E->Mask[0]) == E->Value[0]) {
+			Act = E->Action;
+			Prm = E->Params;
+			break;
+		}
+	}
+	(void)Prm;
+	switch (Act) {
+	case ORAN_CLASSIFY_ACTION_METER_PORT:
+		h_scalars_meter_color = ORAN_CLASSIFY_COLOR_GREEN;
+		if (Tables->PortMeter != 0) {
+			uint64_t Idx = h_scalars_stat_idx;
+
+			if (Idx < 32) {
+				h_scalars_meter_color = OranClassifyMeterColor(&Tables->PortMeter[Idx],
+					8 * (uint64_t)Len, 8, h_standard_metadata_t_ingress_timestamp);
+			}
+		}
+		h_metadata_prio = ((uint64_t)(h_scalars_meter_color == UINT64_C(0x1)) ? UINT64_C(0x0) : h_metadata_prio) & UINT64_C(0xff);
+		h_standard_metadata_t_drop = ((uint64_t)(h_scalars_meter_color == UINT64_C(0x2)) ? UINT64_C(0x1) : h_standard_metadata_t_drop) & UINT64_C(0x1);
+		goto Done;
+	default:
+		goto Done;
+	}
+}
+
+C_node_4:
+	if ((uint64_t)((uint64_t)v_ecpri_id != 0)) {
+		goto T_MyProcessing_eaxc_steer;
+	}
+	goto T_MyProcessing_plane_count;
+
+Done:
+	Meta->drop = (uint8_t)h_standard_metadata_t_drop;
+	Meta->ingress_timestamp = (uint64_t)h_standard_metadata_t_ingress_timestamp;
+	Meta->parser_error = (uint8_t)h_standard_metadata_t_parser_error;
+	Meta->metadata_axis_tdest = (uint32_t)h_metadata_axis_tdest;
+	Meta->metadata_axis_tid = (uint8_t)h_metadata_axis_tid;
+	Meta->metadata_prio = (uint8_t)h_metadata_prio;
+	return Err;
+}
+
+#endif /* ORAN_CLASSIFY_H */
@@ -0,0 +1,906 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file oran_eaxc.c
+*
+* Run-time programming of the eaxc_steer table in sdnet_0.
+*
+* plane_classify puts every U-plane frame of a port in one class. With
+* multi-carrier RUs that lets a heavy carrier delay a latency-critical one,
+* so eaxc_steer gives individual eAxC streams (PC_ID/RTC_ID) their own tdest
+* and priority. A hit overrides what plane_classify chose for that one
+* stream and a miss leaves it alone. The table is a BCAM and starts empty,
+* which keeps plane_classify's choice for every stream.
+*
+* Entries go through the table driver instance XilSdnetTargetInit created
+* for eaxc_steer, the one instance that owns the table, its shadow copy and
+* its memory. Every entry runs set_plane with prio in the first parameter
+* byte and tdest after it, as plane_classify does.
+*
+* With ORAN_EAXC_INDEX set, this file keeps its own copy of the table with
+* two indexes: by key, and by response (tdest and prio). OranEaxcGetRule
+* and OranEaxcGetByResponse answer from it without going through the table
+* driver, whose response search is a linear walk of its shadow for every
+* call. OranEaxcAudit checks the copy against the driver.
+*
+* Changes are made under EaxcLock, held across the table driver calls. The
+* queries answered from the copy take no lock and retry if the copy
+* changed under them (oran_lock.c); without ORAN_EAXC_INDEX they go to the
+* driver's shadow and take the lock like a change.
+*
+*****************************************************************************/
+
+/***************************** Include Files ********************************/
+
+#include <string.h>
+#include "xil_printf.h"
+#include "xstatus.h"
+#include "xtime_l.h"
+#include "oran_sdnet.h"
+
+#if ORAN_SDNET_CTRL
+
+/************************** Variable Definitions ****************************/
+
+static XilSdnetTableCtx *EaxcTablePtr;
+static u32 EaxcActionSet;
+static OranEaxcRule EaxcBenchRules[ORAN_EAXC_DEPTH];
+static OranLock EaxcLock;
+
+#if ORAN_EAXC_INDEX
+/*
+ * Copy of eaxc_steer. An entry keeps its slot for as long as it exists;
+ * free slots are chained through EaxcKeyNext. Each slot is on one key
+ * chain and on one doubly linked response chain.
+ */
+static OranEaxcRule EaxcRules[ORAN_EAXC_DEPTH];
+static u16 EaxcKeyHead[ORAN_EAXC_HASH_SIZE];
+static u16 EaxcKeyNext[ORAN_EAXC_DEPTH];
+static u16 EaxcRespHead[ORAN_EAXC_HASH_SIZE];
+static u16 EaxcRespNext[ORAN_EAXC_DEPTH];
+static u16 EaxcRespPrev[ORAN_EAXC_DEPTH];
+static u16 EaxcFree;
+static u32 EaxcCount;
+#endif
+
+/*****************************************************************************/
+/*
+ * Key is axis_tid(8) : pc_id(16), so byte 0 holds the low byte of PC_ID
+ */
+static void OranEaxcPackKey(u8 AxisTid, u16 PcId, u8 *BytePtr)
+{
+	BytePtr[0] = (u8)PcId;
+	BytePtr[1] = (u8)(PcId >> 8);
+	BytePtr[2] = AxisTid;
+}
+
+/*
+ * set_plane parameters: prio(8), then tdest(32) from its low byte up
+ */
+static void OranEaxcPackParams(const OranEaxcRule *RulePtr, u8 *BytePtr)
+{
+	BytePtr[0] = RulePtr->Prio;
+	BytePtr[1] = (u8)(RulePtr->Tdest);
+	BytePtr[2] = (u8)(RulePtr->Tdest >> 8);
+	BytePtr[3] = (u8)(RulePtr->Tdest >> 16);
+	BytePtr[4] = (u8)(RulePtr->Tdest >> 24);
+}
+
+static void OranEaxcUnpackKey(const u8 *BytePtr, OranEaxcRule *RulePtr)
+{
+	RulePtr->PcId = (u16)(BytePtr[0] | (BytePtr[1] << 8));
+	RulePtr->AxisTid = BytePtr[2];
+}
+
+#if ORAN_EAXC_INDEX
+/*****************************************************************************/
+/*
+ * Multiplicative hashes of the key and of the response
+ */
+static u32 OranEaxcKeyHash(u8 AxisTid, u16 PcId)
+{
+	return ((((u32)AxisTid << 16) | PcId) * 2654435761U) >>
+	       (32 - ORAN_EAXC_HASH_BITS);
+}
+
+static u32 OranEaxcRespHash(u32 Tdest, u8 Prio)
+{
+	return (((Tdest << 8) | Prio) * 2654435761U) >>
+	       (32 - ORAN_EAXC_HASH_BITS);
+}
+
+static void OranEaxcIndexClear(void)
+{
+	u32 Slot;
+
+	OranLockChangeBegin(&EaxcLock);
+	memset(EaxcKeyHead, 0xFF, sizeof(EaxcKeyHead));
+	memset(EaxcRespHead, 0xFF, sizeof(EaxcRespHead));
+	for (Slot = 0; Slot < ORAN_EAXC_DEPTH; Slot++) {
+		EaxcKeyNext[Slot] = (u16)(Slot + 1);
+	}
+	EaxcKeyNext[ORAN_EAXC_DEPTH - 1] = ORAN_EAXC_NONE;
+	EaxcFree = 0;
+	EaxcCount = 0;
+	OranLockChangeEnd(&EaxcLock);
+}
+
+/*
+ * Lock-free readers may walk a chain while it is relinked, so the walk is
+ * bounded and a slot is checked before it is used.
+ */
+static u32 OranEaxcIndexFind(u8 AxisTid, u16 PcId)
+{
+	u32 Slot = EaxcKeyHead[OranEaxcKeyHash(AxisTid, PcId)];
+	u32 Steps;
+
+	for (Steps = 0; (Slot < ORAN_EAXC_DEPTH) && (Steps < ORAN_EAXC_DEPTH);
+	     Steps++) {
+		if ((EaxcRules[Slot].AxisTid == AxisTid) &&
+		    (EaxcRules[Slot].PcId == PcId)) {
+			return Slot;
+		}
+		Slot = EaxcKeyNext[Slot];
+	}
+
+	return ORAN_EAXC_NONE;
+}
+
+static void OranEaxcRespLink(u32 Slot)
+{
+	u32 Hash = OranEaxcRespHash(EaxcRules[Slot].Tdest,
+				    EaxcRules[Slot].Prio);
+
+	EaxcRespPrev[Slot] = ORAN_EAXC_NONE;
+	EaxcRespNext[Slot] = EaxcRespHead[Hash];
+	if (EaxcRespHead[Hash] != ORAN_EAXC_NONE) {
+		EaxcRespPrev[EaxcRespHead[Hash]] = (u16)Slot;
+	}
+	EaxcRespHead[Hash] = (u16)Slot;
+}
+
+static void OranEaxcRespUnlink(u32 Slot)
+{
+	u32 Hash = OranEaxcRespHash(EaxcRules[Slot].Tdest,
+				    EaxcRules[Slot].Prio);
+
+	if (EaxcRespPrev[Slot] == ORAN_EAXC_NONE) {
+		EaxcRespHead[Hash] = EaxcRespNext[Slot];
+	} else {
+		EaxcRespNext[EaxcRespPrev[Slot]] = EaxcRespNext[Slot];
+	}
+	if (EaxcRespNext[Slot] != ORAN_EAXC_NONE) {
+		EaxcRespPrev[EaxcRespNext[Slot]] = EaxcRespPrev[Slot];
+	}
+}
+
+static void OranEaxcIndexAdd(const OranEaxcRule *RulePtr)
+{
+	u32 Hash = OranEaxcKeyHash(RulePtr->AxisTid, RulePtr->PcId);
+	u32 Slot = EaxcFree;
+
+	if (Slot == ORAN_EAXC_NONE) {
+		return;
+	}
+
+	OranLockChangeBegin(&EaxcLock);
+	EaxcFree = EaxcKeyNext[Slot];
+	EaxcRules[Slot] = *RulePtr;
+	EaxcKeyNext[Slot] = EaxcKeyHead[Hash];
+	EaxcKeyHead[Hash] = (u16)Slot;
+	OranEaxcRespLink(Slot);
+	EaxcCount++;
+	OranLockChangeEnd(&EaxcLock);
+}
+
+static void OranEaxcIndexUpdate(const OranEaxcRule *RulePtr)
+{
+	u32 Slot = OranEaxcIndexFind(RulePtr->AxisTid, RulePtr->PcId);
+
+	if (Slot == ORAN_EAXC_NONE) {
+		return;
+	}
+
+	OranLockChangeBegin(&EaxcLock);
+	OranEaxcRespUnlink(Slot);
+	EaxcRules[Slot].Tdest = RulePtr->Tdest;
+	EaxcRules[Slot].Prio = RulePtr->Prio;
+	OranEaxcRespLink(Slot);
+	OranLockChangeEnd(&EaxcLock);
+}
+
+static void OranEaxcIndexRemove(u8 AxisTid, u16 PcId)
+{
+	u16 *LinkPtr = &EaxcKeyHead[OranEaxcKeyHash(AxisTid, PcId)];
+	u32 Slot;
+
+	while ((Slot = *LinkPtr) != ORAN_EAXC_NONE) {
+		if ((EaxcRules[Slot].AxisTid == AxisTid) &&
+		    (EaxcRules[Slot].PcId == PcId)) {
+			OranLockChangeBegin(&EaxcLock);
+			*LinkPtr = EaxcKeyNext[Slot];
+			OranEaxcRespUnlink(Slot);
+			EaxcKeyNext[Slot] = EaxcFree;
+			EaxcFree = (u16)Slot;
+			EaxcCount--;
+			OranLockChangeEnd(&EaxcLock);
+			return;
+		}
+		LinkPtr = &EaxcKeyNext[Slot];
+	}
+}
+#else
+static void OranEaxcIndexClear(void)
+{
+}
+
+static void OranEaxcIndexAdd(const OranEaxcRule *RulePtr)
+{
+	(void)RulePtr;
+}
+
+static void OranEaxcIndexUpdate(const OranEaxcRule *RulePtr)
+{
+	(void)RulePtr;
+}
+
+static void OranEaxcIndexRemove(u8 AxisTid, u16 PcId)
+{
+	(void)AxisTid;
+	(void)PcId;
+}
+
+static void OranEaxcUnpackParams(const u8 *BytePtr, OranEaxcRule *RulePtr)
+{
+	RulePtr->Prio = BytePtr[0];
+	RulePtr->Tdest = (u32)BytePtr[1] | ((u32)BytePtr[2] << 8) |
+			 ((u32)BytePtr[3] << 16) | ((u32)BytePtr[4] << 24);
+}
+#endif
+
+/****************************************************************************/
+/**
+*
+* Finds the eaxc_steer table among those of the SDNet target, checks it is
+* the exact-match table this file expects and clears it.
+*
+* @param	None.
+*
+* @return	XST_SUCCESS to indicate success, otherwise XST_FAILURE.
+*
+* @note		OranSdnetInit must have been called first. The table stays
+*		with the target; nothing is allocated here.
+*
+*****************************************************************************/
+LONG OranEaxcInit(void)
+{
+	XilSdnetTargetCtx *TargetPtr = OranSdnetTarget();
+	XilSdnetTableCtx *TablePtr;
+	XilSdnetTableMode Mode;
+	XilSdnetReturnType Result;
+	u32 KeyBits;
+
+	if (TargetPtr == NULL) {
+		xil_printf("SDNet target not initialized\r\n");
+		return XST_FAILURE;
+	}
+	OranLockInit(&EaxcLock);
+	EaxcTablePtr = NULL;
+
+	Result = XilSdnetTargetGetTableByName(TargetPtr, ORAN_EAXC_TABLE_NAME,
+					      &TablePtr);
+	if (Result == XIL_SDNET_SUCCESS) {
+		Result = XilSdnetTableGetMode(TablePtr, &Mode);
+	}
+	if (Result == XIL_SDNET_SUCCESS) {
+		Result = XilSdnetTableGetKeySizeBits(TablePtr, &KeyBits);
+	}
+	if (Result == XIL_SDNET_SUCCESS) {
+		Result = XilSdnetTableGetActionId(TablePtr,
+						  ORAN_POLICY_ACTION_SET,
+						  &EaxcActionSet);
+	}
+	if (Result != XIL_SDNET_SUCCESS) {
+		xil_printf("eaxc_steer lookup failed: %s\r\n",
+			   XilSdnetReturnTypeToString(Result));
+		return XST_FAILURE;
+	}
+	if ((Mode != XIL_SDNET_TABLE_MODE_BCAM) ||
+	    (KeyBits != ORAN_EAXC_KEY_BITS)) {
+		xil_printf("%s is not a %d-bit BCAM\r\n",
+			   ORAN_EAXC_TABLE_NAME, ORAN_EAXC_KEY_BITS);
+		return XST_FAILURE;
+	}
+	EaxcTablePtr = TablePtr;
+
+	return OranEaxcReset();
+}
+
+/****************************************************************************/
+/**
+*
+* Adds one eAxC stream to eaxc_steer.
+*
+* @param	RulePtr is the entry to add.
+*
+* @return	XST_SUCCESS to indicate success, otherwise XST_FAILURE.
+*
+* @note		Fails if the stream already has an entry; use
+*		OranEaxcUpdateRule to move it.
+*
+*****************************************************************************/
+LONG OranEaxcInsertRule(const OranEaxcRule *RulePtr)
+{
+	u8 Key[ORAN_EAXC_KEY_BYTES];
+	u8 Params[ORAN_POLICY_PARAM_BYTES];
+	XilSdnetReturnType Result;
+
+	if (EaxcTablePtr == NULL) {
+		return XST_FAILURE;
+	}
+
+	OranEaxcPackKey(RulePtr->AxisTid, RulePtr->PcId, Key);
+	OranEaxcPackParams(RulePtr, Params);
+
+	OranLockWrite(&EaxcLock);
+	Result = ORAN_SDNET_CALL(ORAN_CALL_TABLE_INSERT,
+		XilSdnetTableInsert(EaxcTablePtr, Key, NULL, 0, EaxcActionSet,
+				    Params));
+	if (Result == XIL_SDNET_SUCCESS) {
+		OranEaxcIndexAdd(RulePtr);
+	}
+	OranUnlockWrite(&EaxcLock);
+	if (Result != XIL_SDNET_SUCCESS) {
+		xil_printf("eaxc_steer insert of PC_ID 0x%04x failed: %s\r\n",
+			   RulePtr->PcId, XilSdnetReturnTypeToString(Result));
+		return XST_FAILURE;
+	}
+
+	return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/**
+*
+* Changes the tdest and priority of an eAxC stream already in eaxc_steer.
+* The entry is rewritten in place, so frames of the stream never fall back
+* to plane_classify in between.
+*
+* @param	RulePtr is the new entry.
+*
+* @return	XST_SUCCESS to indicate success, otherwise XST_FAILURE.
+*
+* @note		None.
+*
+*****************************************************************************/
+LONG OranEaxcUpdateRule(const OranEaxcRule *RulePtr)
+{
+	u8 Key[ORAN_EAXC_KEY_BYTES];
+	u8 Params[ORAN_POLICY_PARAM_BYTES];
+	XilSdnetReturnType Result;
+
+	if (EaxcTablePtr == NULL) {
+		return XST_FAILURE;
+	}
+
+	OranEaxcPackKey(RulePtr->AxisTid, RulePtr->PcId, Key);
+	OranEaxcPackParams(RulePtr, Params);
+
+	OranLockWrite(&EaxcLock);
+	Result = ORAN_SDNET_CALL(ORAN_CALL_TABLE_UPDATE,
+		XilSdnetTableUpdate(EaxcTablePtr, Key, NULL, EaxcActionSet,
+				    Params));
+	if (Result == XIL_SDNET_SUCCESS) {
+		OranEaxcIndexUpdate(RulePtr);
+	}
+	OranUnlockWrite(&EaxcLock);
+	if (Result != XIL_SDNET_SUCCESS) {
+		xil_printf("eaxc_steer update of PC_ID 0x%04x failed: %s\r\n",
+			   RulePtr->PcId, XilSdnetReturnTypeToString(Result));
+		return XST_FAILURE;
+	}
+
+	return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/**
+*
+* Removes an eAxC stream from eaxc_steer; its frames go back to the class
+* chosen by plane_classify.
+*
+* @param	AxisTid is the ingress port of the stream.
+* @param	PcId is the PC_ID/RTC_ID of the stream.
+*
+* @return	XST_SUCCESS to indicate success, otherwise XST_FAILURE.
+*
+* @note		None.
+*
+*****************************************************************************/
+LONG OranEaxcDeleteRule(u8 AxisTid, u16 PcId)
+{
+	u8 Key[ORAN_EAXC_KEY_BYTES];
+	XilSdnetReturnType Result;
+
+	if (EaxcTablePtr == NULL) {
+		return XST_FAILURE;
+	}
+
+	OranEaxcPackKey(AxisTid, PcId, Key);
+
+	OranLockWrite(&EaxcLock);
+	Result = ORAN_SDNET_CALL(ORAN_CALL_TABLE_DELETE,
+				 XilSdnetTableDelete(EaxcTablePtr, Key, NULL));
+	if (Result == XIL_SDNET_SUCCESS) {
+		OranEaxcIndexRemove(AxisTid, PcId);
+	}
+	OranUnlockWrite(&EaxcLock);
+	if (Result != XIL_SDNET_SUCCESS) {
+		xil_printf("eaxc_steer delete of PC_ID 0x%04x failed: %s\r\n",
+			   PcId, XilSdnetReturnTypeToString(Result));
+		return XST_FAILURE;
+	}
+
+	return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/**
+*
+* Removes every entry from eaxc_steer.
+*
+* @param	None.
+*
+* @return	XST_SUCCESS to indicate success, otherwise XST_FAILURE.
+*
+* @note		None.
+*
+*****************************************************************************/
+LONG OranEaxcReset(void)
+{
+	if (EaxcTablePtr == NULL) {
+		return XST_FAILURE;
+	}
+
+	OranLockWrite(&EaxcLock);
+	if (ORAN_SDNET_CALL(ORAN_CALL_TABLE_RESET,
+			    XilSdnetTableReset(EaxcTablePtr)) !=
+	    XIL_SDNET_SUCCESS) {
+		OranUnlockWrite(&EaxcLock);
+		return XST_FAILURE;
+	}
+	OranEaxcIndexClear();
+	OranUnlockWrite(&EaxcLock);
+
+	return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/**
+*
+* Looks up the entry of one eAxC stream.
+*
+* @param	AxisTid is the ingress port of the stream.
+* @param	PcId is the PC_ID/RTC_ID of the stream.
+* @param	RulePtr receives the entry.
+*
+* @return	XST_SUCCESS if the stream has an entry, otherwise XST_FAILURE.
+*
+* @note		Does not access sdnet_0. With ORAN_EAXC_INDEX it takes no
+*		lock and may run alongside changes to the table.
+*
+*****************************************************************************/
+LONG OranEaxcGetRule(u8 AxisTid, u16 PcId, OranEaxcRule *RulePtr)
+{
+#if ORAN_EAXC_INDEX
+	u32 Seq;
+	u32 Slot;
+
+	if (EaxcTablePtr == NULL) {
+		return XST_FAILURE;
+	}
+
+	do {
+		Seq = OranLockReadBegin(&EaxcLock);
+		Slot = OranEaxcIndexFind(AxisTid, PcId);
+		if (Slot != ORAN_EAXC_NONE) {
+			*RulePtr = EaxcRules[Slot];
+		}
+	} while (OranLockReadRetry(&EaxcLock, Seq));
+	if (Slot == ORAN_EAXC_NONE) {
+		return XST_FAILURE;
+	}
+#else
+	u8 Key[ORAN_EAXC_KEY_BYTES];
+	u8 Params[ORAN_POLICY_PARAM_BYTES];
+	XilSdnetReturnType Result;
+	u32 ActionId;
+
+	if (EaxcTablePtr == NULL) {
+		return XST_FAILURE;
+	}
+
+	OranEaxcPackKey(AxisTid, PcId, Key);
+	OranLockWrite(&EaxcLock);
+	Result = XilSdnetTableGetByKey(EaxcTablePtr, Key, NULL, NULL,
+				       &ActionId, Params);
+	OranUnlockWrite(&EaxcLock);
+	if (Result != XIL_SDNET_SUCCESS) {
+		return XST_FAILURE;
+	}
+	RulePtr->AxisTid = AxisTid;
+	RulePtr->PcId = PcId;
+	OranEaxcUnpackParams(Params, RulePtr);
+#endif
+
+	return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/**
+*
+* Lists the eAxC streams steered to one tdest with one priority.
+*
+* @param	Tdest is the tdest to look for.
+* @param	Prio is the priority to look for.
+* @param	RulePtr receives up to MaxCount entries. May be NULL to only
+*		count them.
+* @param	MaxCount is the size of the RulePtr array.
+*
+* @return	The number of matching entries, which may be more than
+*		MaxCount.
+*
+* @note		With ORAN_EAXC_INDEX the cost is in proportion to the number
+*		of matches, not to the size of the table.
+*
+*****************************************************************************/
+u32 OranEaxcGetByResponse(u32 Tdest, u8 Prio, OranEaxcRule *RulePtr,
+			  u32 MaxCount)
+{
+	u32 Found = 0;
+#if ORAN_EAXC_INDEX
+	u32 Seq;
+	u32 Slot;
+	u32 Steps;
+
+	if (EaxcTablePtr == NULL) {
+		return 0;
+	}
+
+	do {
+		Seq = OranLockReadBegin(&EaxcLock);
+		Found = 0;
+		Slot = EaxcRespHead[OranEaxcRespHash(Tdest, Prio)];
+		for (Steps = 0; (Slot < ORAN_EAXC_DEPTH) &&
+		     (Steps < ORAN_EAXC_DEPTH); Steps++) {
+			if ((EaxcRules[Slot].Tdest == Tdest) &&
+			    (EaxcRules[Slot].Prio == Prio)) {
+				if ((RulePtr != NULL) && (Found < MaxCount)) {
+					RulePtr[Found] = EaxcRules[Slot];
+				}
+				Found++;
+			}
+			Slot = EaxcRespNext[Slot];
+		}
+	} while (OranLockReadRetry(&EaxcLock, Seq));
+#else
+	OranEaxcRule Match;
+	u8 Key[ORAN_EAXC_KEY_BYTES];
+	u8 Params[ORAN_POLICY_PARAM_BYTES];
+	u8 Mask[ORAN_POLICY_PARAM_BYTES];
+	u32 Position = 0;
+
+	if (EaxcTablePtr == NULL) {
+		return 0;
+	}
+
+	Match.Tdest = Tdest;
+	Match.Prio = Prio;
+	OranEaxcPackParams(&Match, Params);
+	memset(Mask, 0xFF, sizeof(Mask));
+	OranLockWrite(&EaxcLock);
+	while (XilSdnetTableGetByResponse(EaxcTablePtr, EaxcActionSet, Params,
+					  Mask, &Position, Key, NULL) ==
+	       XIL_SDNET_SUCCESS) {
+		if ((RulePtr != NULL) && (Found < MaxCount)) {
+			OranEaxcUnpackKey(Key, &RulePtr[Found]);
+			RulePtr[Found].Tdest = Tdest;
+			RulePtr[Found].Prio = Prio;
+		}
+		Found++;
+	}
+	OranUnlockWrite(&EaxcLock);
+#endif
+
+	return Found;
+}
+
+/****************************************************************************/
+/**
+*
+* Copies out every entry of eaxc_steer.
+*
+* @param	RulePtr receives up to MaxCount entries. May be NULL to only
+*		count them.
+* @param	MaxCount is the size of the RulePtr array.
+*
+* @return	The number of entries in the table, which may be more than
+*		MaxCount.
+*
+* @note		Without ORAN_EAXC_INDEX this walks the table driver's
+*		shadow once per entry.
+*
+*****************************************************************************/
+u32 OranEaxcGetRules(OranEaxcRule *RulePtr, u32 MaxCount)
+{
+	u32 Found = 0;
+#if ORAN_EAXC_INDEX
+	u32 Seq;
+	u32 Hash;
+	u32 Slot;
+
+	if (EaxcTablePtr == NULL) {
+		return 0;
+	}
+
+	/* No consistent copy has more than ORAN_EAXC_DEPTH entries */
+	do {
+		Seq = OranLockReadBegin(&EaxcLock);
+		Found = 0;
+		for (Hash = 0; Hash < ORAN_EAXC_HASH_SIZE; Hash++) {
+			for (Slot = EaxcKeyHead[Hash];
+			     (Slot < ORAN_EAXC_DEPTH) &&
+			     (Found < ORAN_EAXC_DEPTH);
+			     Slot = EaxcKeyNext[Slot]) {
+				if ((RulePtr != NULL) && (Found < MaxCount)) {
+					RulePtr[Found] = EaxcRules[Slot];
+				}
+				Found++;
+			}
+		}
+	} while (OranLockReadRetry(&EaxcLock, Seq));
+#else
+	OranEaxcRule Entry;
+	u8 Key[ORAN_EAXC_KEY_BYTES];
+	u8 Params[ORAN_POLICY_PARAM_BYTES];
+	u8 Mask[ORAN_POLICY_PARAM_BYTES];
+	u32 Position = 0;
+
+	if (EaxcTablePtr == NULL) {
+		return 0;
+	}
+
+	/* Every entry runs set_plane; a zero mask matches any parameters */
+	memset(Params, 0, sizeof(Params));
+	memset(Mask, 0, sizeof(Mask));
+	OranLockWrite(&EaxcLock);
+	while (XilSdnetTableGetByResponse(EaxcTablePtr, EaxcActionSet, Params,
+					  Mask, &Position, Key, NULL) ==
+	       XIL_SDNET_SUCCESS) {
+		if ((RulePtr != NULL) && (Found < MaxCount)) {
+			OranEaxcUnpackKey(Key, &Entry);
+			if (OranEaxcGetRule(Entry.AxisTid, Entry.PcId,
+					    &RulePtr[Found]) != XST_SUCCESS) {
+				continue;
+			}
+		}
+		Found++;
+	}
+	OranUnlockWrite(&EaxcLock);
+#endif
+
+	return Found;
+}
+
+/*****************************************************************************/
+/*
+ * Body of OranEaxcAudit, run under EaxcLock
+ */
+static LONG OranEaxcAuditCopy(void)
+{
+#if ORAN_EAXC_INDEX
+	OranEaxcRule Entry;
+	u8 Key[ORAN_EAXC_KEY_BYTES];
+	u8 Params[ORAN_POLICY_PARAM_BYTES];
+	u8 Expected[ORAN_POLICY_PARAM_BYTES];
+	u8 Mask[ORAN_POLICY_PARAM_BYTES];
+	u32 Position = 0;
+	u32 ActionId;
+	u32 Hash;
+	u32 Slot;
+	u32 Walk;
+	u32 Listed = 0;
+
+	if (EaxcTablePtr == NULL) {
+		return XST_FAILURE;
+	}
+
+	for (Hash = 0; Hash < ORAN_EAXC_HASH_SIZE; Hash++) {
+		for (Slot = EaxcKeyHead[Hash]; Slot != ORAN_EAXC_NONE;
+		     Slot = EaxcKeyNext[Slot]) {
+			Entry = EaxcRules[Slot];
+			if ((Listed++ == EaxcCount) ||
+			    (OranEaxcKeyHash(Entry.AxisTid, Entry.PcId) !=
+			     Hash)) {
+				xil_printf("eaxc_steer index: key chain %d "
+					   "broken\r\n", (int)Hash);
+				return XST_FAILURE;
+			}
+
+			Walk = EaxcRespHead[OranEaxcRespHash(Entry.Tdest,
+							     Entry.Prio)];
+			while ((Walk != ORAN_EAXC_NONE) && (Walk != Slot)) {
+				Walk = EaxcRespNext[Walk];
+			}
+			if (Walk == ORAN_EAXC_NONE) {
+				xil_printf("eaxc_steer index: PC_ID 0x%04x "
+					   "missing from response chain\r\n",
+					   Entry.PcId);
+				return XST_FAILURE;
+			}
+
+			OranEaxcPackKey(Entry.AxisTid, Entry.PcId, Key);
+			OranEaxcPackParams(&Entry, Expected);
+			if ((XilSdnetTableGetByKey(EaxcTablePtr, Key, NULL,
+						   NULL, &ActionId, Params) !=
+			     XIL_SDNET_SUCCESS) ||
+			    (ActionId != EaxcActionSet) ||
+			    (memcmp(Params, Expected, sizeof(Params)) != 0)) {
+				xil_printf("eaxc_steer: PC_ID 0x%04x differs "
+					   "from the driver\r\n", Entry.PcId);
+				return XST_FAILURE;
+			}
+		}
+	}
+	if (Listed != EaxcCount) {
+		xil_printf("eaxc_steer index: %d entries listed, %d counted\r\n",
+			   (int)Listed, (int)EaxcCount);
+		return XST_FAILURE;
+	}
+
+	/* Every entry runs set_plane; a zero mask matches any parameters */
+	memset(Params, 0, sizeof(Params));
+	memset(Mask, 0, sizeof(Mask));
+	Listed = 0;
+	while (XilSdnetTableGetByResponse(EaxcTablePtr, EaxcActionSet, Params,
+					  Mask, &Position, Key, NULL) ==
+	       XIL_SDNET_SUCCESS) {
+		OranEaxcUnpackKey(Key, &Entry);
+		if (OranEaxcIndexFind(Entry.AxisTid, Entry.PcId) ==
+		    ORAN_EAXC_NONE) {
+			xil_printf("eaxc_steer: PC_ID 0x%04x only in the "
+				   "driver\r\n", Entry.PcId);
+			return XST_FAILURE;
+		}
+		Listed++;
+	}
+	if (Listed != EaxcCount) {
+		xil_printf("eaxc_steer: driver holds %d entries, index %d\r\n",
+			   (int)Listed, (int)EaxcCount);
+		return XST_FAILURE;
+	}
+#endif
+
+	return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/**
+*
+* Checks the copy of eaxc_steer kept here: both indexes against the entry
+* slots, and every entry against the table driver and back.
+*
+* @param	None.
+*
+* @return	XST_SUCCESS if everything agrees, otherwise XST_FAILURE.
+*
+* @note		Prints the first disagreement found. Without
+*		ORAN_EAXC_INDEX there is nothing to check.
+*
+*****************************************************************************/
+LONG OranEaxcAudit(void)
+{
+	LONG Status;
+
+	OranLockWrite(&EaxcLock);
+	Status = OranEaxcAuditCopy();
+	OranUnlockWrite(&EaxcLock);
+
+	return Status;
+}
+
+/****************************************************************************/
+/**
+*
+* Stops changes to eaxc_steer through this file. Entries in hardware are
+* left as they are.
+*
+* @param	None.
+*
+* @return	None.
+*
+* @note		The table driver instance belongs to the SDNet target and
+*		goes with it.
+*
+*****************************************************************************/
+void OranEaxcExit(void)
+{
+	EaxcTablePtr = NULL;
+}
+
+/*****************************************************************************/
+/*
+ * Prints rate and register traffic of one benchmark pass
+ */
+static void OranEaxcBenchReport(const char *NamePtr, u32 Count, XTime Ticks,
+				u32 Reads, u32 Writes)
+{
+	u64 Rate = 0;
+
+	if (Ticks != 0) {
+		Rate = ((u64)Count * COUNTS_PER_SECOND) / Ticks;
+	}
+	xil_printf("eaxc_steer %s: %d entries, %d entries/s, "
+		   "%d reads and %d writes per entry\r\n", NamePtr, (int)Count,
+		   (int)Rate, (int)(Reads / Count), (int)(Writes / Count));
+}
+
+/****************************************************************************/
+/**
+*
+* Measures how fast eaxc_steer is filled with single inserts, and the
+* register accesses each one takes. The pass starts from an empty table and
+* the table is left empty.
+*
+* @param	Count is the number of entries, at most ORAN_EAXC_DEPTH.
+*
+* @return	XST_SUCCESS to indicate success, otherwise XST_FAILURE.
+*
+* @note		Frames whose PC_ID matches one of the test entries are
+*		steered to the 10G port while it runs, so run it before
+*		traffic starts.
+*
+*****************************************************************************/
+LONG OranEaxcBench(u32 Count)
+{
+	XTime Start;
+	XTime End;
+	u32 Reads;
+	u32 Writes;
+	u32 Index;
+
+	if ((EaxcTablePtr == NULL) || (Count == 0) ||
+	    (Count > ORAN_EAXC_DEPTH)) {
+		return XST_FAILURE;
+	}
+
+	for (Index = 0; Index < Count; Index++) {
+		EaxcBenchRules[Index].AxisTid = ORAN_TID_10G_0;
+		EaxcBenchRules[Index].PcId = (u16)Index;
+		EaxcBenchRules[Index].Tdest = 1;
+		EaxcBenchRules[Index].Prio = ORAN_PRIO_UPLANE;
+	}
+
+	if (OranEaxcReset() != XST_SUCCESS) {
+		return XST_FAILURE;
+	}
+	OranSdnetMmioCounts(NULL, NULL, 1);
+	XTime_GetTime(&Start);
+	for (Index = 0; Index < Count; Index++) {
+		if (OranEaxcInsertRule(&EaxcBenchRules[Index]) != XST_SUCCESS) {
+			(void)OranEaxcReset();
+			return XST_FAILURE;
+		}
+	}
+	XTime_GetTime(&End);
+	OranSdnetMmioCounts(&Reads, &Writes, 1);
+	OranEaxcBenchReport("insert", Count, End - Start, Reads, Writes);
+
+	return OranEaxcReset();
+}
+
+#endif /* ORAN_SDNET_CTRL */
@@ -0,0 +1,316 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file oran_env_uio.c
+*
+* SDNet environment interface for a Linux agent on the A53s, in place of
+* the Xil_Out32/Xil_In32 callbacks of the bare-metal application.
+*
+* OranEnvUioOpen maps the sdnet_0 AXI-Lite window into the process, from
+* a UIO device (/dev/uioN, found by name with OranEnvUioFind), from
+* /dev/mem at the physical base address, or from an ordinary or /dev/shm
+* file standing in for the registers when there is no hardware. Accesses
+* are single 32-bit loads and stores through the mapping:
+*
+*	write	barrier, store
+*	read	load, barrier
+*
+* The barrier before a store keeps it behind earlier accesses to memory
+* the hardware may look at; the one after a load keeps later accesses
+* behind it. Inside a write sequence (OranEnvUioSequence, driven by
+* OranSdnetWriteSequenceBegin/End through OranSdnetInitEnv) stores are
+* queued instead and issued back to back behind a single barrier when the
+* queue fills, before any read, and when the sequence ends. The order of
+* the accesses on the bus is unchanged; only the barriers between stores
+* go, which is most of the cost of a run of table writes.
+*
+* This file is only built for Linux; the standalone build skips it.
+*
+*****************************************************************************/
+
+#if defined(__linux__)
+
+#define _FILE_OFFSET_BITS	64
+#define _DEFAULT_SOURCE
+
+/***************************** Include Files ********************************/
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "xstatus.h"
+#include "oran_sdnet.h"
+
+#if ORAN_SDNET_CTRL
+
+/***************** Macros (Inline Functions) Definitions ********************/
+
+#if defined(__aarch64__)
+#define ORAN_UIO_WMB()	__asm__ volatile("dmb oshst" ::: "memory")
+#define ORAN_UIO_RMB()	__asm__ volatile("dmb oshld" ::: "memory")
+#else
+#define ORAN_UIO_WMB()	__sync_synchronize()
+#define ORAN_UIO_RMB()	__sync_synchronize()
+#endif
+
+/*****************************************************************************/
+/*
+ * Issues the queued stores behind one barrier
+ */
+static void OranEnvUioDrain(OranEnvUio *UioPtr)
+{
+	u32 Index;
+
+	if (UioPtr->Pending == 0) {
+		return;
+	}
+
+	ORAN_UIO_WMB();
+	for (Index = 0; Index < UioPtr->Pending; Index++) {
+		UioPtr->RegPtr[UioPtr->PendAddress[Index] / 4] =
+			UioPtr->PendValue[Index];
+	}
+	UioPtr->Pending = 0;
+	UioPtr->Flushes++;
+}
+
+/*****************************************************************************/
+/*
+ * XilSdnetEnvIf callbacks. The drivers keep their own copy of the
+ * interface, so the mapping is reached through UserCtx.
+ */
+static XilSdnetReturnType OranEnvUioWrite32(XilSdnetEnvIf *EnvIfPtr,
+					    XilSdnetAddressType Address,
+					    uint32_t WriteValue)
+{
+	OranEnvUio *UioPtr = (OranEnvUio *)EnvIfPtr->UserCtx;
+
+	if ((Address & 3) || (Address > UioPtr->Size - 4)) {
+		return XIL_SDNET_GENERAL_ERR_INTERNAL_ASSERTION;
+	}
+
+	UioPtr->Writes++;
+	if (!UioPtr->Batch) {
+		ORAN_UIO_WMB();
+		UioPtr->RegPtr[Address / 4] = WriteValue;
+		return XIL_SDNET_SUCCESS;
+	}
+
+	if (UioPtr->Pending == ORAN_ENV_UIO_BATCH) {
+		OranEnvUioDrain(UioPtr);
+	}
+	UioPtr->PendAddress[UioPtr->Pending] = (u32)Address;
+	UioPtr->PendValue[UioPtr->Pending] = WriteValue;
+	UioPtr->Pending++;
+
+	return XIL_SDNET_SUCCESS;
+}
+
+static XilSdnetReturnType OranEnvUioRead32(XilSdnetEnvIf *EnvIfPtr,
+					   XilSdnetAddressType Address,
+					   uint32_t *ReadValuePtr)
+{
+	OranEnvUio *UioPtr = (OranEnvUio *)EnvIfPtr->UserCtx;
+
+	if ((Address & 3) || (Address > UioPtr->Size - 4)) {
+		return XIL_SDNET_GENERAL_ERR_INTERNAL_ASSERTION;
+	}
+
+	UioPtr->Reads++;
+	OranEnvUioDrain(UioPtr);
+	*ReadValuePtr = UioPtr->RegPtr[Address / 4];
+	ORAN_UIO_RMB();
+
+	return XIL_SDNET_SUCCESS;
+}
+
+static XilSdnetReturnType OranEnvUioLogError(XilSdnetEnvIf *EnvIfPtr,
+					     const char *MessagePtr)
+{
+	(void)EnvIfPtr;
+	fprintf(stderr, "sdnet error: %s\n", MessagePtr);
+	return XIL_SDNET_SUCCESS;
+}
+
+static XilSdnetReturnType OranEnvUioLogInfo(XilSdnetEnvIf *EnvIfPtr,
+					    const char *MessagePtr)
+{
+	(void)EnvIfPtr;
+	printf("sdnet: %s\n", MessagePtr);
+	return XIL_SDNET_SUCCESS;
+}
+
+/****************************************************************************/
+/**
+*
+* Looks up the UIO device whose name (from the device tree node, in
+* /sys/class/uio/uioN/name) is NamePtr.
+*
+* @param	NamePtr is the UIO device name, such as "sdnet".
+* @param	PathPtr receives the device path, /dev/uioN.
+* @param	PathSize is the size of the PathPtr buffer.
+*
+* @return	XST_SUCCESS if the device was found, otherwise XST_FAILURE.
+*
+* @note		None.
+*
+*****************************************************************************/
+LONG OranEnvUioFind(const char *NamePtr, char *PathPtr, u32 PathSize)
+{
+	char File[300];
+	char Name[64];
+	struct dirent *EntryPtr;
+	DIR *DirPtr;
+	FILE *FilePtr;
+	LONG Status = XST_FAILURE;
+
+	DirPtr = opendir("/sys/class/uio");
+	if (DirPtr == NULL) {
+		return XST_FAILURE;
+	}
+
+	while ((Status != XST_SUCCESS) &&
+	       ((EntryPtr = readdir(DirPtr)) != NULL)) {
+		if (strncmp(EntryPtr->d_name, "uio", 3) != 0) {
+			continue;
+		}
+		snprintf(File, sizeof(File), "/sys/class/uio/%s/name",
+			 EntryPtr->d_name);
+		FilePtr = fopen(File, "r");
+		if (FilePtr == NULL) {
+			continue;
+		}
+		if ((fgets(Name, sizeof(Name), FilePtr) != NULL) &&
+		    (strncmp(Name, NamePtr, strlen(NamePtr)) == 0) &&
+		    ((Name[strlen(NamePtr)] == '\n') ||
+		     (Name[strlen(NamePtr)] == '\0'))) {
+			snprintf(PathPtr, PathSize, "/dev/%s",
+				 EntryPtr->d_name);
+			Status = XST_SUCCESS;
+		}
+		fclose(FilePtr);
+	}
+	closedir(DirPtr);
+
+	return Status;
+}
+
+/****************************************************************************/
+/**
+*
+* Maps the sdnet_0 register window and fills in an environment interface
+* for it.
+*
+* @param	UioPtr is the mapping to set up. It must stay valid while
+*		the drivers use the interface.
+* @param	EnvIfPtr is the interface to fill in.
+* @param	PathPtr is /dev/uioN (Offset 0 selects map 0), /dev/mem
+*		(Offset is the physical base address) or a register mock
+*		file, which must be at least Offset + Size bytes long.
+* @param	Offset is where the window starts in PathPtr, a multiple of
+*		the page size.
+* @param	Size is the size of the window in bytes.
+*
+* @return	XST_SUCCESS if the window is mapped, otherwise XST_FAILURE.
+*
+* @note		Writes are not queued until OranEnvUioSequence starts a
+*		sequence.
+*
+*****************************************************************************/
+LONG OranEnvUioOpen(OranEnvUio *UioPtr, XilSdnetEnvIf *EnvIfPtr,
+		    const char *PathPtr, u64 Offset, u32 Size)
+{
+	void *MapPtr;
+
+	if ((UioPtr == NULL) || (EnvIfPtr == NULL) || (PathPtr == NULL) ||
+	    (Size < 4)) {
+		return XST_FAILURE;
+	}
+
+	memset(UioPtr, 0, sizeof(*UioPtr));
+	UioPtr->Fd = open(PathPtr, O_RDWR | O_SYNC);
+	if (UioPtr->Fd < 0) {
+		perror(PathPtr);
+		return XST_FAILURE;
+	}
+
+	MapPtr = mmap(NULL, Size, PROT_READ | PROT_WRITE, MAP_SHARED,
+		      UioPtr->Fd, (off_t)Offset);
+	if (MapPtr == MAP_FAILED) {
+		perror(PathPtr);
+		close(UioPtr->Fd);
+		UioPtr->Fd = -1;
+		return XST_FAILURE;
+	}
+	UioPtr->RegPtr = (volatile u32 *)MapPtr;
+	UioPtr->Size = Size;
+
+	EnvIfPtr->UserCtx = (XilSdnetUserCtxType)UioPtr;
+	EnvIfPtr->WordWrite32 = OranEnvUioWrite32;
+	EnvIfPtr->WordRead32 = OranEnvUioRead32;
+	EnvIfPtr->LogError = OranEnvUioLogError;
+	EnvIfPtr->LogInfo = OranEnvUioLogInfo;
+
+	return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/**
+*
+* Starts or ends a write sequence on the interface set up by
+* OranEnvUioOpen. Pass it to OranSdnetInitEnv as the sequence hook.
+*
+* @param	EnvIfPtr is the interface.
+* @param	Begin is 1 to start queueing writes, 0 to issue the queue
+*		and stop.
+*
+* @return	None.
+*
+* @note		None.
+*
+*****************************************************************************/
+void OranEnvUioSequence(XilSdnetEnvIf *EnvIfPtr, u8 Begin)
+{
+	OranEnvUio *UioPtr = (OranEnvUio *)EnvIfPtr->UserCtx;
+
+	if (!Begin) {
+		OranEnvUioDrain(UioPtr);
+	}
+	UioPtr->Batch = Begin;
+}
+
+/****************************************************************************/
+/**
+*
+* Unmaps the register window, issuing queued writes first.
+*
+* @param	UioPtr is the mapping set up by OranEnvUioOpen.
+*
+* @return	None.
+*
+* @note		None.
+*
+*****************************************************************************/
+void OranEnvUioClose(OranEnvUio *UioPtr)
+{
+	if (UioPtr->RegPtr == NULL) {
+		return;
+	}
+
+	OranEnvUioDrain(UioPtr);
+	munmap((void *)UioPtr->RegPtr, UioPtr->Size);
+	close(UioPtr->Fd);
+	UioPtr->RegPtr = NULL;
+	UioPtr->Fd = -1;
+}
+
+#endif /* ORAN_SDNET_CTRL */
+
+#endif /* __linux__ */
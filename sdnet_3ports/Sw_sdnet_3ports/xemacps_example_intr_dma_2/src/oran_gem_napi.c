@@ -0,0 +1,391 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file oran_gem_napi.c
+*
+* Interrupt-driven service of the GEM3 RX ring of oran_gem_ring.c, taking
+* one interrupt per burst of frames rather than one per frame.
+*
+* OranGemNapiIntrHandler takes the place of XEmacPs_IntrHandler on the GEM3
+* interrupt. It reads the interrupt status once, masks the RX interrupts,
+* acknowledges them and marks the ring scheduled; no frame is touched in
+* interrupt context. Any other status, TX completion and errors, is
+* acknowledged and passed to the send and error handlers of the instance as
+* XEmacPs_IntrHandler would. The main loop then drains the ring with
+* OranGemNapiPoll in passes of at most the budget. Only when a pass leaves
+* the ring empty are the RX interrupts acknowledged and unmasked again, and
+* the ring is looked at once more afterwards, so that a frame that came in
+* meanwhile is not left waiting for the next one.
+*
+* Two thresholds moderate the interrupt rate:
+*
+*	- time: the GEM holds back an RX interrupt until Usecs after the
+*	  previous one (int_moderation, in steps of 800 ns at 1 Gb/s), so
+*	  frames arriving in the meantime are taken by the same poll
+*	- frame count: a pass that found the ring empty after at least
+*	  Frames frames since the last time it did goes on polling instead
+*	  of re-arming, so a loaded port stays in poll mode and a quiet one
+*	  returns to interrupt mode
+*
+* Both at 0 give an interrupt for every frame the poll loop does not catch
+* on its own, which is what XEmacPs_IntrHandler does.
+*
+*****************************************************************************/
+
+/***************************** Include Files ********************************/
+
+#include <string.h>
+#include "xil_printf.h"
+#include "xtime_l.h"
+#include "oran_gem_ring.h"
+
+/************************** Constant Definitions ****************************/
+
+/*
+ * Interrupt moderation register of the ZynqMP GEM, not in emacps v3_12:
+ * RX in bits 7:0 and TX in bits 23:16, in steps of 800 ns
+ */
+#define ORAN_GEM_INTMOD_OFFSET	0x0000005CU
+#define ORAN_GEM_INTMOD_RX_MASK	0x000000FFU
+#define ORAN_GEM_INTMOD_STEP_NS	800
+
+#define ORAN_GEM_NAPI_IXR_MASK	(XEMACPS_IXR_FRAMERX_MASK | \
+				 XEMACPS_IXR_RX_ERR_MASK)
+
+/************************** Variable Definitions ****************************/
+
+static XEmacPs *NapiInstPtr;
+static volatile u32 NapiScheduled;
+static u32 NapiFrames;
+static u32 NapiBudget;
+static u32 NapiSinceEmpty;	/* frames since the ring last ran empty */
+static OranGemNapiCounters NapiCounters;
+
+/*****************************************************************************/
+/*
+ * Back to interrupt mode, unless a frame is already waiting
+ */
+static void OranGemNapiRearm(void)
+{
+	UINTPTR Base = NapiInstPtr->Config.BaseAddress;
+
+	NapiScheduled = FALSE;
+	XEmacPs_WriteReg(Base, XEMACPS_ISR_OFFSET, ORAN_GEM_NAPI_IXR_MASK);
+	XEmacPs_WriteReg(Base, XEMACPS_IER_OFFSET, ORAN_GEM_NAPI_IXR_MASK);
+	ORAN_GEM_SYNC();
+	if (OranGemRingRxPending() != FALSE) {
+		XEmacPs_WriteReg(Base, XEMACPS_IDR_OFFSET,
+				 ORAN_GEM_NAPI_IXR_MASK);
+		NapiScheduled = TRUE;
+		NapiCounters.Races++;
+	} else {
+		NapiCounters.Rearms++;
+	}
+}
+
+/*
+ * Nanoseconds per event of a tick count
+ */
+static u32 OranGemNapiNs(u64 Ticks, u64 Events)
+{
+	if (Events == 0) {
+		return 0;
+	}
+
+	return (u32)((((Ticks * 1000) / Events) * 1000000) /
+		     COUNTS_PER_SECOND);
+}
+
+/****************************************************************************/
+/**
+*
+* Switches the RX ring from continuous polling to interrupt-driven polling.
+*
+* @param	InstancePtr is the instance the rings were started on.
+* @param	Usecs is the interrupt moderation time, 0 to 204.
+* @param	Frames is the frame count that keeps the ring in poll mode,
+*		0 to re-arm the interrupt whenever the ring runs empty.
+* @param	Budget is the most frames one OranGemNapiPoll takes.
+*
+* @return	None.
+*
+* @note		Connect OranGemNapiIntrHandler to the GEM3 interrupt
+*		first. The ring starts scheduled, so the first poll takes
+*		what is waiting and arms the interrupt. Clears the counters.
+*
+*****************************************************************************/
+void OranGemNapiStart(XEmacPs *InstancePtr, u32 Usecs, u32 Frames,
+		      u32 Budget)
+{
+	u32 Steps = (Usecs * 1000) / ORAN_GEM_INTMOD_STEP_NS;
+	u32 Reg;
+
+	NapiInstPtr = InstancePtr;
+	NapiFrames = Frames;
+	NapiBudget = (Budget != 0) ? Budget : 1;
+	NapiSinceEmpty = 0;
+	memset(&NapiCounters, 0, sizeof(NapiCounters));
+
+	if (InstancePtr->Version > 2) {
+		Reg = XEmacPs_ReadReg(InstancePtr->Config.BaseAddress,
+				      ORAN_GEM_INTMOD_OFFSET);
+		Reg &= ~ORAN_GEM_INTMOD_RX_MASK;
+		Reg |= (Steps < ORAN_GEM_INTMOD_RX_MASK) ? Steps :
+		       ORAN_GEM_INTMOD_RX_MASK;
+		XEmacPs_WriteReg(InstancePtr->Config.BaseAddress,
+				 ORAN_GEM_INTMOD_OFFSET, Reg);
+	}
+
+	NapiScheduled = TRUE;
+}
+
+/****************************************************************************/
+/**
+*
+* Masks the RX interrupts, leaving the ring to be polled with
+* OranGemRingRecv.
+*
+* @param	None.
+*
+* @return	None.
+*
+* @note		The counters stay readable.
+*
+*****************************************************************************/
+void OranGemNapiStop(void)
+{
+	XEmacPs_WriteReg(NapiInstPtr->Config.BaseAddress, XEMACPS_IDR_OFFSET,
+			 ORAN_GEM_NAPI_IXR_MASK);
+	NapiScheduled = FALSE;
+}
+
+/*
+ * The status XEmacPs_IntrHandler would handle besides RX: TX completion
+ * and errors on queue 0 and, on the ZynqMP GEM, queue 1
+ */
+static void OranGemNapiIntrOther(u32 Isr)
+{
+	UINTPTR Base = NapiInstPtr->Config.BaseAddress;
+	u32 Q1Isr = 0;
+	u32 Sr;
+
+	if (NapiInstPtr->Version > 2) {
+		Q1Isr = XEmacPs_ReadReg(Base, XEMACPS_INTQ1_STS_OFFSET);
+	}
+	if (Isr != 0) {
+		XEmacPs_WriteReg(Base, XEMACPS_ISR_OFFSET, Isr);
+	}
+
+	if ((Q1Isr & XEMACPS_INTQ1SR_TXCOMPL_MASK) != 0) {
+		XEmacPs_WriteReg(Base, XEMACPS_INTQ1_STS_OFFSET,
+				 XEMACPS_INTQ1SR_TXCOMPL_MASK);
+		XEmacPs_WriteReg(Base, XEMACPS_TXSR_OFFSET,
+				 XEMACPS_TXSR_TXCOMPL_MASK |
+				 XEMACPS_TXSR_USEDREAD_MASK);
+		NapiInstPtr->SendHandler(NapiInstPtr->SendRef);
+	}
+	if ((Isr & XEMACPS_IXR_TXCOMPL_MASK) != 0) {
+		XEmacPs_WriteReg(Base, XEMACPS_TXSR_OFFSET,
+				 XEMACPS_TXSR_TXCOMPL_MASK |
+				 XEMACPS_TXSR_USEDREAD_MASK);
+		NapiInstPtr->SendHandler(NapiInstPtr->SendRef);
+	}
+
+	/* A used bit read comes with every completion and is no error then */
+	if (((Q1Isr & XEMACPS_INTQ1SR_TXERR_MASK) != 0) &&
+	    ((Q1Isr & XEMACPS_INTQ1SR_TXCOMPL_MASK) != 0)) {
+		XEmacPs_WriteReg(Base, XEMACPS_INTQ1_STS_OFFSET, Q1Isr);
+		NapiInstPtr->ErrorHandler(NapiInstPtr->ErrorRef, XEMACPS_SEND,
+					  Q1Isr);
+	}
+	if (((Isr & XEMACPS_IXR_TX_ERR_MASK) != 0) &&
+	    ((Isr & XEMACPS_IXR_TXCOMPL_MASK) == 0)) {
+		Sr = XEmacPs_ReadReg(Base, XEMACPS_TXSR_OFFSET);
+		XEmacPs_WriteReg(Base, XEMACPS_TXSR_OFFSET, Sr);
+		NapiInstPtr->ErrorHandler(NapiInstPtr->ErrorRef, XEMACPS_SEND,
+					  Sr);
+	}
+}
+
+/****************************************************************************/
+/**
+*
+* GEM3 interrupt handler. Masks the RX interrupts and schedules the ring
+* for OranGemNapiPoll; passes any other status to the handlers set with
+* XEmacPs_SetHandler.
+*
+* @param	CallbackRef is unused.
+*
+* @return	None.
+*
+* @note		Only the RX interrupts of ORAN_GEM_NAPI_IXR_MASK are
+*		masked and acknowledged with them. An RX error has its
+*		status cleared, is counted and goes to the error handler.
+*		TX completion is not enabled, OranGemRingSend reclaims, but
+*		the status is latched all the same: set the send and error
+*		handlers of the instance before connecting this one.
+*
+*****************************************************************************/
+void OranGemNapiIntrHandler(void *CallbackRef)
+{
+	UINTPTR Base = NapiInstPtr->Config.BaseAddress;
+	XTime Start;
+	XTime End;
+	u32 Isr;
+	u32 Sr;
+
+	(void)CallbackRef;
+	XTime_GetTime(&Start);
+
+	Isr = XEmacPs_ReadReg(Base, XEMACPS_ISR_OFFSET);
+	if ((Isr & ORAN_GEM_NAPI_IXR_MASK) != 0) {
+		XEmacPs_WriteReg(Base, XEMACPS_IDR_OFFSET,
+				 ORAN_GEM_NAPI_IXR_MASK);
+		XEmacPs_WriteReg(Base, XEMACPS_ISR_OFFSET,
+				 Isr & ORAN_GEM_NAPI_IXR_MASK);
+		NapiScheduled = TRUE;
+		NapiCounters.Interrupts++;
+	}
+	if ((Isr & XEMACPS_IXR_RX_ERR_MASK) != 0) {
+		Sr = XEmacPs_ReadReg(Base, XEMACPS_RXSR_OFFSET);
+		XEmacPs_WriteReg(Base, XEMACPS_RXSR_OFFSET, Sr);
+		/* Flushes a frame held for want of a buffer (CR 692702) */
+		if ((Isr & XEMACPS_IXR_RXUSED_MASK) != 0) {
+			XEmacPs_WriteReg(Base, XEMACPS_NWCTRL_OFFSET,
+				XEmacPs_ReadReg(Base, XEMACPS_NWCTRL_OFFSET) |
+				XEMACPS_NWCTRL_FLUSH_DPRAM_MASK);
+		}
+		NapiCounters.IntrErrors++;
+		if ((Sr & XEMACPS_RXSR_ERROR_MASK) != 0) {
+			NapiInstPtr->ErrorHandler(NapiInstPtr->ErrorRef,
+						  XEMACPS_RECV,
+						  Sr & XEMACPS_RXSR_ERROR_MASK);
+		}
+	}
+	OranGemNapiIntrOther(Isr & ~ORAN_GEM_NAPI_IXR_MASK);
+
+	XTime_GetTime(&End);
+	NapiCounters.IntrTicks += End - Start;
+}
+
+/****************************************************************************/
+/**
+*
+* Tells whether the ring is in poll mode.
+*
+* @param	None.
+*
+* @return	TRUE if OranGemNapiPoll has work, FALSE if the port waits
+*		for an interrupt.
+*
+* @note		Check it with interrupts disabled before waiting for one.
+*
+*****************************************************************************/
+u32 OranGemNapiScheduled(void)
+{
+	return NapiScheduled;
+}
+
+/****************************************************************************/
+/**
+*
+* Takes one pass of frames from the RX ring when it is scheduled, and
+* re-arms the RX interrupt when the pass leaves it empty.
+*
+* @param	FramesPtr receives the frames, as from OranGemRingRecv.
+* @param	Max is the size of FramesPtr.
+*
+* @return	The number of frames in FramesPtr, 0 if the ring is not
+*		scheduled.
+*
+* @note		Cheap when not scheduled: one variable is read.
+*
+*****************************************************************************/
+u32 OranGemNapiPoll(OranGemFrame *FramesPtr, u32 Max)
+{
+	XTime Start;
+	XTime End;
+	u32 Count;
+
+	if (NapiScheduled == FALSE) {
+		return 0;
+	}
+
+	XTime_GetTime(&Start);
+	Count = OranGemRingRecv(FramesPtr, (Max < NapiBudget) ? Max :
+					   NapiBudget);
+	NapiCounters.Polls++;
+	NapiCounters.PollFrames += Count;
+	if (Count == 0) {
+		NapiCounters.EmptyPolls++;
+	}
+
+	NapiSinceEmpty += Count;
+	if (OranGemRingRxPending() == FALSE) {
+		if ((NapiFrames != 0) && (NapiSinceEmpty >= NapiFrames)) {
+			NapiCounters.Stays++;
+		} else {
+			OranGemNapiRearm();
+		}
+		NapiSinceEmpty = 0;
+	}
+
+	XTime_GetTime(&End);
+	NapiCounters.PollTicks += End - Start;
+
+	return Count;
+}
+
+/****************************************************************************/
+/**
+*
+* Reads the counters of the interrupt and poll modes.
+*
+* @param	CountersPtr receives the counters.
+*
+* @return	None.
+*
+* @note		None.
+*
+*****************************************************************************/
+void OranGemNapiGetCounters(OranGemNapiCounters *CountersPtr)
+{
+	*CountersPtr = NapiCounters;
+}
+
+/****************************************************************************/
+/**
+*
+* Prints the counters read by OranGemNapiGetCounters, with the time each
+* mode takes per interrupt and per frame.
+*
+* @param	CountersPtr is the counters.
+*
+* @return	None.
+*
+* @note		None.
+*
+*****************************************************************************/
+void OranGemNapiPrint(const OranGemNapiCounters *CountersPtr)
+{
+	xil_printf("GEM3 interrupt mode: %d interrupts, %d errors, "
+		   "%d ns each\r\n", (int)CountersPtr->Interrupts,
+		   (int)CountersPtr->IntrErrors,
+		   (int)OranGemNapiNs(CountersPtr->IntrTicks,
+				      CountersPtr->Interrupts));
+	xil_printf("GEM3 poll mode: %d polls, %d empty, %d frames, "
+		   "%d ns per frame\r\n", (int)CountersPtr->Polls,
+		   (int)CountersPtr->EmptyPolls, (int)CountersPtr->PollFrames,
+		   (int)OranGemNapiNs(CountersPtr->PollTicks,
+				      CountersPtr->PollFrames));
+	xil_printf("GEM3 re-armed %d times, kept polling %d times, %d races,"
+		   " %d frames per interrupt\r\n", (int)CountersPtr->Rearms,
+		   (int)CountersPtr->Stays, (int)CountersPtr->Races,
+		   (CountersPtr->Interrupts != 0) ?
+		   (int)(CountersPtr->PollFrames / CountersPtr->Interrupts) :
+		   0);
+}
@@ -0,0 +1,1184 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file oran_gem_ring.c
+*
+* Multi-descriptor RX and TX rings of GEM3 on buffers of the packet buffer
+* pool, see oran_gem_ring.h.
+*
+* Descriptors move through the states of the emacps driver
+* (xemacps_bdring.c). Every RX descriptor is kept with the GEM: a batch
+* taken back by XEmacPs_BdRingFromHwRx is freed, allocated again (the same
+* descriptors, as no others are free) and handed back within the same
+* OranGemRingRecv call, each with a new buffer or, if the frame was dropped,
+* its old one. A descriptor belongs to the GEM once its RX new bit or TX
+* used bit is clear, so those are written last, after a barrier; the rest
+* of the descriptor is written while the bit still keeps the GEM away.
+*
+* The descriptors live in the uncached bd_space. Frame buffers are cached:
+* RX buffers are invalidated in full before they are posted, as the next
+* frame may fill them, and again over the received length only before the
+* application reads them; TX frames are cleaned before they are queued.
+* This is done line by line for a whole batch, ended by the one barrier
+* the batch needs anyway before its descriptors go to the GEM, instead of
+* the barrier and interrupt masking of each Xil_DCache*Range call. None of
+* it is done if the GEM is cache coherent.
+*
+* TX queue 0 runs on the instance's TX ring, as in the driver; queue 1,
+* which the emacps instance has no ring for, on one of its own. The driver
+* functions used on the rings take the ring, not the instance, so both are
+* handled alike. RX queue 1 is parked on a descriptor the GEM never owns.
+*
+*****************************************************************************/
+
+/***************************** Include Files ********************************/
+
+#include <string.h>
+#include "xil_cache.h"
+#include "xil_printf.h"
+#include "xstatus.h"
+#include "xtime_l.h"
+#include "oran_gem_ring.h"
+
+/************************** Constant Definitions ****************************/
+
+#if (ORAN_GEM_BUF_SIZE % XEMACPS_RX_BUF_UNIT) != 0
+#error ORAN_GEM_BUF_SIZE must be a multiple of XEMACPS_RX_BUF_UNIT
+#endif
+
+#define ORAN_GEM_TX_ERROR_MASK	(XEMACPS_TXBUF_RETRY_MASK | \
+				 XEMACPS_TXBUF_URUN_MASK | \
+				 XEMACPS_TXBUF_EXH_MASK | \
+				 XEMACPS_TXBUF_TCP_MASK)
+#define ORAN_GEM_RX_FRAME_MASK	(XEMACPS_RXBUF_SOF_MASK | \
+				 XEMACPS_RXBUF_EOF_MASK)
+
+#define ORAN_GEM_CACHE_LINE	64	/* of the A53 */
+/* Operations of OranGemCacheRange */
+#define ORAN_GEM_CACHE_CLEAN	0	/* for the GEM to read */
+#define ORAN_GEM_CACHE_INVAL	1	/* for the GEM to write */
+
+#define ORAN_GEM_ETH_OVERHEAD	24	/* FCS, preamble and gap, bytes */
+#define ORAN_GEM_LINE_MBPS	1000
+
+/**************************** Type Definitions ******************************/
+
+/*
+ * What one run of OranGemRingQueueBench saw of its PTP frames
+ */
+typedef struct {
+	u32 Sent;
+	u32 Back;
+	XTime MinDelay;
+	XTime MaxDelay;
+	XTime SumDelay;
+	u64 BulkBytes;	/* M-plane bytes back */
+} OranGemQueueBenchStats;
+
+/************************** Variable Definitions ****************************/
+
+static XEmacPs *GemInstPtr;
+static OranGemRingCounters GemCounters;
+
+static XEmacPs_BdRing GemTxQ1Ring;
+static XEmacPs_BdRing *GemTxRingPtr[ORAN_GEM_TXQ_CNT];
+static u32 GemTxQueues;
+static OranGemClassifyFn GemClassifyFn = OranGemClassifyDefault;
+static u8 GemClassQueue[ORAN_GEM_CLASS_COUNT] = {
+	0,	/* M-plane */
+	1,	/* C-plane */
+	1	/* S-plane */
+};
+
+static const u8 GemBenchSrc[6] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x03 };
+static const u8 GemBenchPtpDst[6] = { 0x01, 0x1B, 0x19, 0x00, 0x00, 0x00 };
+
+/*****************************************************************************/
+/*
+ * Buffer a descriptor points at, without the RX ownership and wrap bits
+ */
+static u8 *OranGemBdBuf(XEmacPs_Bd *BdPtr)
+{
+	UINTPTR Addr;
+
+	Addr = XEmacPs_BdRead(BdPtr, XEMACPS_BD_ADDR_OFFSET) &
+	       XEMACPS_RXBUF_ADD_MASK;
+#if defined(__aarch64__) || defined(__arch64__)
+	Addr |= (UINTPTR)XEmacPs_BdRead(BdPtr, XEMACPS_BD_ADDR_HI_OFFSET) << 32;
+#endif
+
+	return (u8 *)Addr;
+}
+
+/*
+ * Cleans, or cleans and invalidates, the cache lines of a buffer for the
+ * DMA, without a barrier: the caller issues ORAN_GEM_SYNC once for the
+ * batch before the GEM or the application may touch the buffers
+ */
+static void OranGemCacheRange(const u8 *BufPtr, u32 Bytes, u32 Op)
+{
+	UINTPTR Line = (UINTPTR)BufPtr & ~(UINTPTR)(ORAN_GEM_CACHE_LINE - 1);
+	UINTPTR End = (UINTPTR)BufPtr + Bytes;
+
+	GemCounters.CacheLines += (End - Line + ORAN_GEM_CACHE_LINE - 1) /
+				  ORAN_GEM_CACHE_LINE;
+#if defined(__aarch64__) && !defined(__linux__)
+	for (; Line < End; Line += ORAN_GEM_CACHE_LINE) {
+		if (Op == ORAN_GEM_CACHE_INVAL) {
+			mtcpdc(CIVAC, Line);
+		} else {
+			mtcpdc(CVAC, Line);
+		}
+	}
+#else
+	if (Op == ORAN_GEM_CACHE_INVAL) {
+		Xil_DCacheInvalidateRange((INTPTR)Line, (INTPTR)(End - Line));
+	} else {
+		Xil_DCacheFlushRange((INTPTR)Line, (INTPTR)(End - Line));
+	}
+#endif
+}
+
+/*
+ * Builds a TX ring whose descriptors all carry the used bit, so the GEM
+ * stops at each until it is queued
+ */
+static LONG OranGemTxRingCreate(XEmacPs_BdRing *RingPtr, UINTPTR Space,
+				u32 Count)
+{
+	XEmacPs_Bd Template;
+	LONG Status;
+
+	XEmacPs_BdClear(&Template);
+	XEmacPs_BdSetStatus(&Template, XEMACPS_TXBUF_USED_MASK);
+	Status = XEmacPs_BdRingCreate(RingPtr, Space, Space,
+				      XEMACPS_BD_ALIGNMENT, Count);
+	if (Status == XST_SUCCESS) {
+		Status = XEmacPs_BdRingClone(RingPtr, &Template, XEMACPS_SEND);
+	}
+
+	return Status;
+}
+
+/****************************************************************************/
+/**
+*
+* Builds the RX and TX rings of GEM3 in uncached memory and posts a buffer
+* from the pool on every RX descriptor.
+*
+* @param	InstancePtr is the initialized, stopped emacps instance.
+* @param	BdSpace is the uncached memory for the descriptors, aligned
+*		to XEMACPS_BD_ALIGNMENT.
+* @param	BdSpaceBytes is its size, at least ORAN_GEM_BD_SPACE_BYTES.
+*
+* @return	XST_SUCCESS to indicate success, otherwise XST_FAILURE.
+*
+* @note		Sets the RX buffer size of the DMA to ORAN_GEM_BUF_SIZE, so
+*		call it after the options are set: the jumbo option sets it
+*		to 10240. Start the GEM with OranGemRingStart. The pool
+*		must have been set up by OranBufInit.
+*
+*****************************************************************************/
+LONG OranGemRingInit(XEmacPs *InstancePtr, UINTPTR BdSpace, u32 BdSpaceBytes)
+{
+	XEmacPs_BdRing *RxRingPtr = &XEmacPs_GetRxRing(InstancePtr);
+	XEmacPs_BdRing *TxRingPtr = &XEmacPs_GetTxRing(InstancePtr);
+	UINTPTR TxSpace = BdSpace + ORAN_GEM_RING_BYTES(ORAN_GEM_RXBD_CNT);
+	UINTPTR Q1Space = TxSpace + ORAN_GEM_RING_BYTES(ORAN_GEM_TXBD_CNT);
+	UINTPTR ParkSpace = Q1Space + ORAN_GEM_RING_BYTES(ORAN_GEM_TXQ1BD_CNT);
+	XEmacPs_Bd *ParkPtr;
+	XEmacPs_Bd Template;
+	XEmacPs_Bd *BdPtr;
+	XEmacPs_Bd *CurBdPtr;
+	u8 *BufPtr;
+	u32 Index;
+	u32 Reg;
+	LONG Status;
+
+	if ((BdSpaceBytes < ORAN_GEM_BD_SPACE_BYTES) ||
+	    ((BdSpace % XEMACPS_BD_ALIGNMENT) != 0)) {
+		xil_printf("GEM3 rings need %d aligned bytes of BD space\r\n",
+			   (int)ORAN_GEM_BD_SPACE_BYTES);
+		return XST_FAILURE;
+	}
+
+	GemInstPtr = InstancePtr;
+	memset(&GemCounters, 0, sizeof(GemCounters));
+	GemTxRingPtr[0] = TxRingPtr;
+	GemTxRingPtr[1] = &GemTxQ1Ring;
+	GemTxQueues = (InstancePtr->Version > 2) ? ORAN_GEM_TXQ_CNT : 1;
+
+	XEmacPs_BdClear(&Template);
+	Status = XEmacPs_BdRingCreate(RxRingPtr, BdSpace, BdSpace,
+				      XEMACPS_BD_ALIGNMENT, ORAN_GEM_RXBD_CNT);
+	if (Status == XST_SUCCESS) {
+		Status = XEmacPs_BdRingClone(RxRingPtr, &Template,
+					     XEMACPS_RECV);
+	}
+	if (Status == XST_SUCCESS) {
+		Status = OranGemTxRingCreate(TxRingPtr, TxSpace,
+					     ORAN_GEM_TXBD_CNT);
+	}
+	if ((Status == XST_SUCCESS) && (GemTxQueues > 1)) {
+		Status = OranGemTxRingCreate(&GemTxQ1Ring, Q1Space,
+					     ORAN_GEM_TXQ1BD_CNT);
+	}
+	if (Status == XST_SUCCESS) {
+		Status = XEmacPs_BdRingAlloc(RxRingPtr, ORAN_GEM_RXBD_CNT,
+					     &BdPtr);
+	}
+	if (Status != XST_SUCCESS) {
+		xil_printf("GEM3 ring setup failed (%d)\r\n", (int)Status);
+		GemInstPtr = NULL;
+		return XST_FAILURE;
+	}
+
+	/* The GEM is stopped, so the new bits may be cleared in any order */
+	CurBdPtr = BdPtr;
+	for (Index = 0; Index < ORAN_GEM_RXBD_CNT; Index++) {
+		BufPtr = OranGemBufAlloc();
+		if (InstancePtr->Config.IsCacheCoherent == 0) {
+			OranGemCacheRange(BufPtr, ORAN_GEM_BUF_SIZE,
+					  ORAN_GEM_CACHE_INVAL);
+		}
+		XEmacPs_BdSetAddressRx(CurBdPtr, (UINTPTR)BufPtr);
+		CurBdPtr = XEmacPs_BdRingNext(RxRingPtr, CurBdPtr);
+	}
+	ORAN_GEM_SYNC();
+	(void)XEmacPs_BdRingToHw(RxRingPtr, ORAN_GEM_RXBD_CNT, BdPtr);
+
+	if (InstancePtr->Version > 2) {
+		ParkPtr = (XEmacPs_Bd *)ParkSpace;
+		XEmacPs_BdClear(ParkPtr);
+		XEmacPs_BdSetAddressRx(ParkPtr, (XEMACPS_RXBUF_NEW_MASK |
+						 XEMACPS_RXBUF_WRAP_MASK));
+		XEmacPs_Out32(InstancePtr->Config.BaseAddress +
+			      XEMACPS_RXQ1BASE_OFFSET, (u32)ParkSpace);
+	}
+
+	Reg = XEmacPs_ReadReg(InstancePtr->Config.BaseAddress,
+			      XEMACPS_DMACR_OFFSET);
+	Reg &= ~XEMACPS_DMACR_RXBUF_MASK;
+	Reg |= ((ORAN_GEM_BUF_SIZE / XEMACPS_RX_BUF_UNIT) <<
+		XEMACPS_DMACR_RXBUF_SHIFT) & XEMACPS_DMACR_RXBUF_MASK;
+	XEmacPs_WriteReg(InstancePtr->Config.BaseAddress, XEMACPS_DMACR_OFFSET,
+			 Reg);
+
+	return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/**
+*
+* Points the GEM at the rings and starts it.
+*
+* @param	None.
+*
+* @return	None.
+*
+* @note		The rings are polled: the GEM interrupts XEmacPs_Start
+*		enables are masked again.
+*
+*****************************************************************************/
+void OranGemRingStart(void)
+{
+	XEmacPs_SetQueuePtr(GemInstPtr, GemInstPtr->RxBdRing.BaseBdAddr, 0,
+			    XEMACPS_RECV);
+	XEmacPs_SetQueuePtr(GemInstPtr, GemInstPtr->TxBdRing.BaseBdAddr, 0,
+			    XEMACPS_SEND);
+	if (GemTxQueues > 1) {
+		XEmacPs_SetQueuePtr(GemInstPtr, GemTxQ1Ring.BaseBdAddr, 1,
+				    XEMACPS_SEND);
+	}
+
+	XEmacPs_Start(GemInstPtr);
+
+	XEmacPs_IntDisable(GemInstPtr, XEMACPS_IXR_ALL_MASK);
+	if (GemInstPtr->Version > 2) {
+		XEmacPs_IntQ1Disable(GemInstPtr, XEMACPS_INTQ1_IXR_ALL_MASK);
+	}
+}
+
+/****************************************************************************/
+/**
+*
+* Takes the frames the GEM has received and hands their descriptors back
+* with fresh buffers.
+*
+* @param	FramesPtr receives the frames. Each buffer now belongs to the
+*		caller, to free with OranGemBufFree or send with
+*		OranGemRingSend.
+* @param	Max is the size of FramesPtr.
+*
+* @return	The number of frames in FramesPtr.
+*
+* @note		A frame is dropped, and its buffer posted again, when it is
+*		longer than a buffer or the pool is empty. Fewer than Max
+*		frames may be returned while more are waiting.
+*
+*****************************************************************************/
+u32 OranGemRingRecv(OranGemFrame *FramesPtr, u32 Max)
+{
+	XEmacPs_BdRing *RingPtr = &XEmacPs_GetRxRing(GemInstPtr);
+	u8 Coherent = GemInstPtr->Config.IsCacheCoherent;
+	XEmacPs_Bd *BdPtr;
+	XEmacPs_Bd *CurBdPtr;
+	u8 *BufPtr;
+	u8 *NewPtr;
+	u32 Status;
+	u32 Count = 0;
+	u32 Num;
+	u32 Index;
+
+	Num = XEmacPs_BdRingFromHwRx(RingPtr, Max, &BdPtr);
+	if (Num == 0) {
+		return 0;
+	}
+
+	CurBdPtr = BdPtr;
+	for (Index = 0; Index < Num; Index++) {
+		BufPtr = OranGemBdBuf(CurBdPtr);
+		Status = XEmacPs_BdGetStatus(CurBdPtr);
+		NewPtr = BufPtr;
+		if ((Status & ORAN_GEM_RX_FRAME_MASK) !=
+		    ORAN_GEM_RX_FRAME_MASK) {
+			if ((Status & XEMACPS_RXBUF_EOF_MASK) != 0) {
+				GemCounters.RxLong++;
+			}
+		} else if ((NewPtr = OranGemBufAlloc()) == NULL) {
+			GemCounters.RxNoBuf++;
+			NewPtr = BufPtr;
+		} else {
+			FramesPtr[Count].BufPtr = BufPtr;
+			FramesPtr[Count].Length = Status &
+						  GemInstPtr->RxBufMask;
+			if (Coherent == 0) {
+				OranGemCacheRange(BufPtr,
+						  FramesPtr[Count].Length,
+						  ORAN_GEM_CACHE_INVAL);
+				OranGemCacheRange(NewPtr, ORAN_GEM_BUF_SIZE,
+						  ORAN_GEM_CACHE_INVAL);
+			}
+			GemCounters.RxFrames++;
+			GemCounters.RxBytes += FramesPtr[Count].Length;
+			Count++;
+			XEmacPs_BdSetAddressRx(CurBdPtr, (UINTPTR)NewPtr);
+		}
+		CurBdPtr = XEmacPs_BdRingNext(RingPtr, CurBdPtr);
+	}
+
+	(void)XEmacPs_BdRingFree(RingPtr, Num, BdPtr);
+	(void)XEmacPs_BdRingAlloc(RingPtr, Num, &BdPtr);
+	ORAN_GEM_SYNC();
+	CurBdPtr = BdPtr;
+	for (Index = 0; Index < Num; Index++) {
+		XEmacPs_BdClearRxNew(CurBdPtr);
+		CurBdPtr = XEmacPs_BdRingNext(RingPtr, CurBdPtr);
+	}
+	(void)XEmacPs_BdRingToHw(RingPtr, Num, BdPtr);
+
+	return Count;
+}
+
+/****************************************************************************/
+/**
+*
+* Tells whether the GEM has finished a descriptor OranGemRingRecv has not
+* taken yet.
+*
+* @param	None.
+*
+* @return	TRUE if a frame, or part of one, is waiting, otherwise FALSE.
+*
+* @note		Reads one descriptor word, no GEM register.
+*
+*****************************************************************************/
+u32 OranGemRingRxPending(void)
+{
+	XEmacPs_BdRing *RingPtr = &XEmacPs_GetRxRing(GemInstPtr);
+
+	return ((XEmacPs_BdRead(RingPtr->HwHead, XEMACPS_BD_ADDR_OFFSET) &
+		 XEMACPS_RXBUF_NEW_MASK) != 0) ? TRUE : FALSE;
+}
+
+/*
+ * Takes back the sent run at the head of a TX ring and returns the buffers
+ * to the pool
+ */
+static u32 OranGemTxReclaim(XEmacPs_BdRing *RingPtr)
+{
+	XEmacPs_Bd *BdPtr;
+	XEmacPs_Bd *CurBdPtr;
+	u32 Status;
+	u32 Num;
+	u32 Index;
+
+	/*
+	 * XEmacPs_BdRingFromHwTx looks past a descriptor not yet sent for a
+	 * later one with the used bit set, and finds the ones already freed,
+	 * so it is only asked for the sent run at the head of the ring. Each
+	 * frame takes one descriptor, so each of them carries the used bit.
+	 */
+	CurBdPtr = RingPtr->HwHead;
+	for (Num = 0; Num < RingPtr->HwCnt; Num++) {
+		if ((XEmacPs_BdRead(CurBdPtr, XEMACPS_BD_STAT_OFFSET) &
+		     XEMACPS_TXBUF_USED_MASK) == 0) {
+			break;
+		}
+		CurBdPtr = XEmacPs_BdRingNext(RingPtr, CurBdPtr);
+	}
+	if ((Num == 0) ||
+	    (XEmacPs_BdRingFromHwTx(RingPtr, Num, &BdPtr) != Num)) {
+		return 0;
+	}
+
+	CurBdPtr = BdPtr;
+	for (Index = 0; Index < Num; Index++) {
+		Status = XEmacPs_BdGetStatus(CurBdPtr);
+		if ((Status & ORAN_GEM_TX_ERROR_MASK) != 0) {
+			GemCounters.TxErrors++;
+		} else {
+			GemCounters.TxFrames++;
+			GemCounters.TxBytes += Status & XEMACPS_TXBUF_LEN_MASK;
+		}
+		OranGemBufFree(OranGemBdBuf(CurBdPtr));
+		CurBdPtr = XEmacPs_BdRingNext(RingPtr, CurBdPtr);
+	}
+	(void)XEmacPs_BdRingFree(RingPtr, Num, BdPtr);
+	GemCounters.TxReclaims++;
+
+	return Num;
+}
+
+/*
+ * TX queue of a frame, through the classifier and the class map
+ */
+static u32 OranGemTxQueueOf(const OranGemFrame *FramePtr)
+{
+	u32 Class = GemClassifyFn(FramePtr);
+
+	if (Class >= ORAN_GEM_CLASS_COUNT) {
+		Class = ORAN_GEM_CLASS_MPLANE;
+	}
+
+	return GemClassQueue[Class];
+}
+
+/****************************************************************************/
+/**
+*
+* Queues frames on the TX queues their classes are mapped to and starts
+* the transmitter.
+*
+* @param	FramesPtr are the frames, each of 1 to XEMACPS_TXBUF_LEN_MASK
+*		bytes in one buffer. Pool buffers go back to the pool once
+*		sent; other memory must stay valid until then.
+* @param	Count is the number of frames.
+*
+* @return	The number of frames queued, from the first. The caller keeps
+*		the rest.
+*
+* @note		Frames of one class keep their order. A run of frames for
+*		one queue is queued with one OranGemRingSendQueue, and the
+*		first run that does not fit ends the call.
+*
+*****************************************************************************/
+u32 OranGemRingSend(const OranGemFrame *FramesPtr, u32 Count)
+{
+	u32 Done = 0;
+	u32 Queue;
+	u32 Next;
+	u32 Run;
+	u32 Sent;
+
+	if (Count == 0) {
+		return 0;
+	}
+
+	Queue = OranGemTxQueueOf(&FramesPtr[0]);
+	while (Done < Count) {
+		Next = Queue;
+		for (Run = 1; Done + Run < Count; Run++) {
+			Next = OranGemTxQueueOf(&FramesPtr[Done + Run]);
+			if (Next != Queue) {
+				break;
+			}
+		}
+		Sent = OranGemRingSendQueue(Queue, &FramesPtr[Done], Run);
+		Done += Sent;
+		if (Sent < Run) {
+			/* the refused rest of the run is already counted */
+			GemCounters.TxFull += Count - Done - (Run - Sent);
+			break;
+		}
+		Queue = Next;
+	}
+
+	return Done;
+}
+
+/****************************************************************************/
+/**
+*
+* Queues frames on one TX queue and starts the transmitter.
+*
+* @param	Queue is the TX queue, below OranGemRingTxQueues(), or the
+*		last one if higher.
+* @param	FramesPtr are the frames, as for OranGemRingSend.
+* @param	Count is the number of frames.
+*
+* @return	The number of frames queued, from the first. The caller keeps
+*		the rest.
+*
+* @note		Reclaims sent descriptors of the queue first when fewer than
+*		ORAN_GEM_TX_RECLAIM, or fewer than Count, are free.
+*
+*****************************************************************************/
+u32 OranGemRingSendQueue(u32 Queue, const OranGemFrame *FramesPtr,
+			 u32 Count)
+{
+	XEmacPs_BdRing *RingPtr;
+	XEmacPs_Bd *BdPtr;
+	XEmacPs_Bd *CurBdPtr;
+	u32 Free;
+	u32 Status;
+	u32 Num;
+	u32 Index;
+
+	if (Queue >= GemTxQueues) {
+		Queue = GemTxQueues - 1;
+	}
+	RingPtr = GemTxRingPtr[Queue];
+	Free = XEmacPs_BdRingGetFreeCnt(RingPtr);
+	if ((Free < ORAN_GEM_TX_RECLAIM) || (Free < Count)) {
+		(void)OranGemTxReclaim(RingPtr);
+		Free = XEmacPs_BdRingGetFreeCnt(RingPtr);
+	}
+	Num = (Count < Free) ? Count : Free;
+	GemCounters.TxFull += Count - Num;
+	if ((Num == 0) ||
+	    (XEmacPs_BdRingAlloc(RingPtr, Num, &BdPtr) != XST_SUCCESS)) {
+		return 0;
+	}
+
+	CurBdPtr = BdPtr;
+	for (Index = 0; Index < Num; Index++) {
+		if (GemInstPtr->Config.IsCacheCoherent == 0) {
+			OranGemCacheRange(FramesPtr[Index].BufPtr,
+					  FramesPtr[Index].Length,
+					  ORAN_GEM_CACHE_CLEAN);
+		}
+		XEmacPs_BdSetAddressTx(CurBdPtr,
+				       (UINTPTR)FramesPtr[Index].BufPtr);
+		CurBdPtr = XEmacPs_BdRingNext(RingPtr, CurBdPtr);
+	}
+	ORAN_GEM_SYNC();
+	CurBdPtr = BdPtr;
+	for (Index = 0; Index < Num; Index++) {
+		Status = XEmacPs_BdGetStatus(CurBdPtr) &
+			 XEMACPS_TXBUF_WRAP_MASK;
+		Status |= (FramesPtr[Index].Length & XEMACPS_TXBUF_LEN_MASK) |
+			  XEMACPS_TXBUF_LAST_MASK;
+		XEmacPs_BdWrite(CurBdPtr, XEMACPS_BD_STAT_OFFSET, Status);
+		CurBdPtr = XEmacPs_BdRingNext(RingPtr, CurBdPtr);
+	}
+	(void)XEmacPs_BdRingToHw(RingPtr, Num, BdPtr);
+	ORAN_GEM_SYNC();
+	XEmacPs_Transmit(GemInstPtr);
+	GemCounters.TxQueued[Queue] += Num;
+
+	return Num;
+}
+
+/****************************************************************************/
+/**
+*
+* Takes back every TX descriptor the GEM has sent, on every queue, and
+* returns the buffers to the pool.
+*
+* @param	None.
+*
+* @return	The number of descriptors reclaimed.
+*
+* @note		OranGemRingSendQueue calls this for its queue when the ring
+*		runs short. Call it when idle to return buffers sooner.
+*
+*****************************************************************************/
+u32 OranGemRingReclaim(void)
+{
+	u32 Num = 0;
+	u32 Queue;
+
+	for (Queue = 0; Queue < GemTxQueues; Queue++) {
+		Num += OranGemTxReclaim(GemTxRingPtr[Queue]);
+	}
+
+	return Num;
+}
+
+/****************************************************************************/
+/**
+*
+* Tells how many TX queues the GEM has.
+*
+* @param	None.
+*
+* @return	ORAN_GEM_TXQ_CNT on ZynqMP, 1 on older GEMs.
+*
+* @note		Valid after OranGemRingInit.
+*
+*****************************************************************************/
+u32 OranGemRingTxQueues(void)
+{
+	return GemTxQueues;
+}
+
+/****************************************************************************/
+/**
+*
+* Sets the function OranGemRingSend classifies frames with.
+*
+* @param	ClassifyFn returns the OranGemClass of a frame; a class out
+*		of range counts as ORAN_GEM_CLASS_MPLANE. NULL restores
+*		OranGemClassifyDefault.
+*
+* @return	None.
+*
+* @note		It runs for every frame sent, in the sending thread.
+*
+*****************************************************************************/
+void OranGemRingSetClassifier(OranGemClassifyFn ClassifyFn)
+{
+	GemClassifyFn = (ClassifyFn != NULL) ? ClassifyFn :
+			OranGemClassifyDefault;
+}
+
+/****************************************************************************/
+/**
+*
+* Maps a frame class to a TX queue.
+*
+* @param	Class is the OranGemClass.
+* @param	Queue is the TX queue. A queue the GEM does not have sends
+*		on its last one.
+*
+* @return	None.
+*
+* @note		By default S-plane and C-plane frames go on queue 1 and
+*		M-plane frames on queue 0.
+*
+*****************************************************************************/
+void OranGemRingMapClass(u32 Class, u32 Queue)
+{
+	if (Class < ORAN_GEM_CLASS_COUNT) {
+		GemClassQueue[Class] = (u8)((Queue < ORAN_GEM_TXQ_CNT) ?
+					    Queue : ORAN_GEM_TXQ_CNT - 1);
+	}
+}
+
+/****************************************************************************/
+/**
+*
+* Classifies a frame by its EtherType, behind at most one VLAN tag.
+*
+* @param	FramePtr is the frame.
+*
+* @return	ORAN_GEM_CLASS_SPLANE for PTP and slow protocols (ESMC),
+*		ORAN_GEM_CLASS_CPLANE for eCPRI, otherwise
+*		ORAN_GEM_CLASS_MPLANE.
+*
+* @note		A classifier set with OranGemRingSetClassifier can fall
+*		back on it for the frames it does not handle itself.
+*
+*****************************************************************************/
+u32 OranGemClassifyDefault(const OranGemFrame *FramePtr)
+{
+	const u8 *BufPtr = FramePtr->BufPtr;
+	u32 Offset = 12;
+	u32 EthType;
+
+	if (FramePtr->Length < Offset + 2) {
+		return ORAN_GEM_CLASS_MPLANE;
+	}
+	EthType = ((u32)BufPtr[Offset] << 8) | BufPtr[Offset + 1];
+	if ((EthType == ORAN_GEM_ETHTYPE_VLAN) &&
+	    (FramePtr->Length >= Offset + 6)) {
+		Offset += 4;
+		EthType = ((u32)BufPtr[Offset] << 8) | BufPtr[Offset + 1];
+	}
+
+	switch (EthType) {
+	case ORAN_GEM_ETHTYPE_PTP:
+	case ORAN_GEM_ETHTYPE_SLOW:
+		return ORAN_GEM_CLASS_SPLANE;
+	case ORAN_GEM_ETHTYPE_ECPRI:
+		return ORAN_GEM_CLASS_CPLANE;
+	default:
+		return ORAN_GEM_CLASS_MPLANE;
+	}
+}
+
+/****************************************************************************/
+/**
+*
+* Takes a buffer of ORAN_GEM_BUF_SIZE bytes from the pool.
+*
+* @param	None.
+*
+* @return	The buffer, aligned to a cache line, with one reference, or
+*		NULL if its class of the pool is empty.
+*
+* @note		None.
+*
+*****************************************************************************/
+u8 *OranGemBufAlloc(void)
+{
+	return OranBufAlloc(ORAN_GEM_BUF_SIZE);
+}
+
+/****************************************************************************/
+/**
+*
+* Drops a reference to a buffer, returning it to the pool with the last.
+*
+* @param	BufPtr points anywhere into the buffer.
+*
+* @return	None.
+*
+* @note		Memory outside the pool is ignored, so frames sent from
+*		other memory can be reclaimed the same way. A buffer sent on
+*		more than one queue needs an OranBufRef for each extra one.
+*
+*****************************************************************************/
+void OranGemBufFree(u8 *BufPtr)
+{
+	OranBufFree(BufPtr);
+}
+
+/****************************************************************************/
+/**
+*
+* Reads the counters of the rings and the pool.
+*
+* @param	CountersPtr receives the counters.
+*
+* @return	None.
+*
+* @note		The counters start at zero in OranGemRingInit, but for the
+*		buffer ones, which read the medium class of the pool and so
+*		include buffers other code holds.
+*
+*****************************************************************************/
+void OranGemRingGetCounters(OranGemRingCounters *CountersPtr)
+{
+	OranBufStats Stats;
+
+	OranBufGetStats(ORAN_BUF_CLASS_MEDIUM, &Stats);
+	*CountersPtr = GemCounters;
+	CountersPtr->BufFree = Stats.Count - Stats.InUse;
+	CountersPtr->BufLow = Stats.Count - Stats.HighWater;
+}
+
+/****************************************************************************/
+/**
+*
+* Prints the counters read by OranGemRingGetCounters.
+*
+* @param	CountersPtr is the counters.
+*
+* @return	None.
+*
+* @note		None.
+*
+*****************************************************************************/
+void OranGemRingPrint(const OranGemRingCounters *CountersPtr)
+{
+	xil_printf("GEM3 rx: %d frames, %d bytes, %d without buffer, "
+		   "%d too long\r\n", (int)CountersPtr->RxFrames,
+		   (int)CountersPtr->RxBytes, (int)CountersPtr->RxNoBuf,
+		   (int)CountersPtr->RxLong);
+	xil_printf("GEM3 tx: %d frames, %d bytes, %d errors, %d refused, "
+		   "%d reclaims\r\n", (int)CountersPtr->TxFrames,
+		   (int)CountersPtr->TxBytes, (int)CountersPtr->TxErrors,
+		   (int)CountersPtr->TxFull, (int)CountersPtr->TxReclaims);
+	xil_printf("GEM3 tx queues: %d frames on queue 0, %d on queue 1\r\n",
+		   (int)CountersPtr->TxQueued[0],
+		   (int)CountersPtr->TxQueued[1]);
+	xil_printf("GEM3 cache: %d lines maintained\r\n",
+		   (int)CountersPtr->CacheLines);
+	xil_printf("GEM3 pool: %d of %d buffers free, fewest %d\r\n",
+		   (int)CountersPtr->BufFree, (int)ORAN_BUF_MEDIUM_CNT,
+		   (int)CountersPtr->BufLow);
+}
+
+/*****************************************************************************/
+/*
+ * Builds up to Max benchmark frames in pool buffers
+ */
+static u32 OranGemBenchFrames(OranGemFrame *FramesPtr, u32 Max,
+			      u32 FrameBytes, u32 *SeqPtr)
+{
+	u8 *BufPtr;
+	u32 Count;
+
+	for (Count = 0; Count < Max; Count++) {
+		BufPtr = OranGemBufAlloc();
+		if (BufPtr == NULL) {
+			break;
+		}
+		memset(BufPtr, 0xFF, 6);
+		memcpy(BufPtr + 6, GemBenchSrc, sizeof(GemBenchSrc));
+		BufPtr[12] = (u8)(ORAN_GEM_BENCH_ETHTYPE >> 8);
+		BufPtr[13] = (u8)ORAN_GEM_BENCH_ETHTYPE;
+		memcpy(BufPtr + 14, SeqPtr, sizeof(*SeqPtr));
+		(*SeqPtr)++;
+		FramesPtr[Count].BufPtr = BufPtr;
+		FramesPtr[Count].Length = FrameBytes;
+	}
+
+	return Count;
+}
+
+/****************************************************************************/
+/**
+*
+* Measures the sustained rate of the rings. Half a TX ring of broadcast
+* frames is kept in flight: every frame that comes back is sent again from
+* the buffer it arrived in, and frames that do not come back are replaced.
+*
+* @param	Milliseconds is how long to measure.
+* @param	FrameBytes is the frame length without FCS, 60 to
+*		ORAN_GEM_BUF_SIZE.
+*
+* @return	XST_SUCCESS if frames came back and all of them intact,
+*		otherwise XST_FAILURE.
+*
+* @note		Needs the rings started and the frames looped back, by the
+*		PHY or the GEM. Prints frames/s, the L2 rate and the share
+*		of the 1 Gb/s line rate, counting FCS, preamble and gap.
+*
+*****************************************************************************/
+LONG OranGemRingBench(u32 Milliseconds, u32 FrameBytes)
+{
+	OranGemFrame Frames[ORAN_GEM_BATCH];
+	OranGemRingCounters Before;
+	OranGemRingCounters After;
+	XTime IdleTicks = ORAN_GEM_BENCH_IDLE_MS * (COUNTS_PER_SECOND / 1000);
+	XTime Start;
+	XTime End;
+	XTime Now;
+	XTime LastRx;
+	XTime Elapsed;
+	u32 Target = ORAN_GEM_TXBD_CNT / 2;
+	u32 InFlight = 0;
+	u32 Lost = 0;
+	u32 Bad = 0;
+	u32 Seq = 0;
+	u32 Count;
+	u32 Good;
+	u32 Sent;
+	u32 Index;
+	u64 Frames64;
+	u64 Rate;
+	u64 WireMbps;
+
+	if ((GemInstPtr == NULL) || (Milliseconds == 0) || (FrameBytes < 60) ||
+	    (FrameBytes > ORAN_GEM_BUF_SIZE)) {
+		return XST_FAILURE;
+	}
+
+	OranGemRingGetCounters(&Before);
+	XTime_GetTime(&Start);
+	End = Start + Milliseconds * (COUNTS_PER_SECOND / 1000);
+	LastRx = Start;
+	do {
+		while (InFlight < Target) {
+			Count = OranGemBenchFrames(Frames,
+						   (Target - InFlight <
+						    ORAN_GEM_BATCH) ?
+						   Target - InFlight :
+						   ORAN_GEM_BATCH,
+						   FrameBytes, &Seq);
+			Sent = OranGemRingSend(Frames, Count);
+			for (Index = Sent; Index < Count; Index++) {
+				OranGemBufFree(Frames[Index].BufPtr);
+			}
+			InFlight += Sent;
+			if (Sent < ORAN_GEM_BATCH) {
+				break;
+			}
+		}
+
+		Count = OranGemRingRecv(Frames, ORAN_GEM_BATCH);
+		XTime_GetTime(&Now);
+		if (Count == 0) {
+			if ((InFlight != 0) && (Now - LastRx > IdleTicks)) {
+				Lost += InFlight;
+				InFlight = 0;
+				LastRx = Now;
+			}
+			continue;
+		}
+
+		LastRx = Now;
+		InFlight -= (Count < InFlight) ? Count : InFlight;
+		Good = 0;
+		for (Index = 0; Index < Count; Index++) {
+			if ((Frames[Index].Length != FrameBytes) ||
+			    (Frames[Index].BufPtr[12] !=
+			     (u8)(ORAN_GEM_BENCH_ETHTYPE >> 8)) ||
+			    (Frames[Index].BufPtr[13] !=
+			     (u8)ORAN_GEM_BENCH_ETHTYPE)) {
+				Bad++;
+				OranGemBufFree(Frames[Index].BufPtr);
+			} else {
+				Frames[Good++] = Frames[Index];
+			}
+		}
+		Sent = OranGemRingSend(Frames, Good);
+		for (Index = Sent; Index < Good; Index++) {
+			OranGemBufFree(Frames[Index].BufPtr);
+		}
+		InFlight += Sent;
+	} while (Now < End);
+	OranGemRingGetCounters(&After);
+	Elapsed = Now - Start;
+
+	/* Let the frames in flight come back before the next run */
+	LastRx = Now;
+	while (InFlight != 0) {
+		Count = OranGemRingRecv(Frames, ORAN_GEM_BATCH);
+		XTime_GetTime(&Now);
+		if (Count != 0) {
+			LastRx = Now;
+		} else if (Now - LastRx > IdleTicks) {
+			break;
+		}
+		InFlight -= (Count < InFlight) ? Count : InFlight;
+		for (Index = 0; Index < Count; Index++) {
+			OranGemBufFree(Frames[Index].BufPtr);
+		}
+	}
+	Lost += InFlight;
+	(void)OranGemRingReclaim();
+
+	Frames64 = After.RxFrames - Before.RxFrames;
+	Rate = (Frames64 * COUNTS_PER_SECOND) / Elapsed;
+	WireMbps = (Rate * (FrameBytes + ORAN_GEM_ETH_OVERHEAD) * 8) / 1000000;
+	xil_printf("GEM3 ring bench, %d-byte frames: %d frames/s, %d Mb/s, "
+		   "%d%% of line rate, %d lost, %d bad\r\n", (int)FrameBytes,
+		   (int)Rate, (int)((Rate * FrameBytes * 8) / 1000000),
+		   (int)((WireMbps * 100) / ORAN_GEM_LINE_MBPS), (int)Lost,
+		   (int)Bad);
+
+	return ((Frames64 != 0) && (Bad == 0)) ? XST_SUCCESS : XST_FAILURE;
+}
+
+/*****************************************************************************/
+/*
+ * Takes the frames back during OranGemRingQueueBench, timing the PTP ones
+ */
+static void OranGemQueueBenchRecv(OranGemQueueBenchStats *StatsPtr)
+{
+	OranGemFrame Frames[ORAN_GEM_BATCH];
+	XTime Now;
+	XTime Stamp;
+	XTime Delay;
+	u32 Count;
+	u32 Index;
+	u8 *BufPtr;
+
+	Count = OranGemRingRecv(Frames, ORAN_GEM_BATCH);
+	XTime_GetTime(&Now);
+	for (Index = 0; Index < Count; Index++) {
+		BufPtr = Frames[Index].BufPtr;
+		if (OranGemClassifyDefault(&Frames[Index]) ==
+		    ORAN_GEM_CLASS_SPLANE) {
+			memcpy(&Stamp, BufPtr + 16, sizeof(Stamp));
+			Delay = Now - Stamp;
+			if (Delay < StatsPtr->MinDelay) {
+				StatsPtr->MinDelay = Delay;
+			}
+			if (Delay > StatsPtr->MaxDelay) {
+				StatsPtr->MaxDelay = Delay;
+			}
+			StatsPtr->SumDelay += Delay;
+			StatsPtr->Back++;
+		} else {
+			StatsPtr->BulkBytes += Frames[Index].Length;
+		}
+		OranGemBufFree(BufPtr);
+	}
+}
+
+/*
+ * Builds a PTP frame carrying the time it is due to be sent
+ */
+static u8 *OranGemQueueBenchSync(void)
+{
+	XTime Stamp;
+	u8 *BufPtr;
+
+	BufPtr = OranGemBufAlloc();
+	if (BufPtr == NULL) {
+		return NULL;
+	}
+	memset(BufPtr, 0, ORAN_GEM_BENCH_SYNC_BYTES);
+	memcpy(BufPtr, GemBenchPtpDst, sizeof(GemBenchPtpDst));
+	memcpy(BufPtr + 6, GemBenchSrc, sizeof(GemBenchSrc));
+	BufPtr[12] = (u8)(ORAN_GEM_ETHTYPE_PTP >> 8);
+	BufPtr[13] = (u8)ORAN_GEM_ETHTYPE_PTP;
+	XTime_GetTime(&Stamp);
+	memcpy(BufPtr + 16, &Stamp, sizeof(Stamp));
+
+	return BufPtr;
+}
+
+/*
+ * One run of OranGemRingQueueBench, with S-plane frames on Queue
+ */
+static LONG OranGemQueueBenchRun(u32 Milliseconds, u32 Queue)
+{
+	OranGemFrame Frames[ORAN_GEM_BATCH];
+	OranGemFrame Sync = { NULL, ORAN_GEM_BENCH_SYNC_BYTES };
+	OranGemQueueBenchStats Stats;
+	XTime Period = ORAN_GEM_BENCH_SYNC_USECS *
+		       (COUNTS_PER_SECOND / 1000000);
+	XTime IdleTicks = ORAN_GEM_BENCH_IDLE_MS * (COUNTS_PER_SECOND / 1000);
+	XTime Start;
+	XTime End;
+	XTime Now;
+	XTime NextSync;
+	XTime LastRx;
+	u32 Seq = 0;
+	u32 Held = 0;	/* M-plane frames built, from First on not queued */
+	u32 First = 0;
+	u32 Back;
+	u32 Index;
+	u64 Bytes;
+	u64 Mbps;
+
+	memset(&Stats, 0, sizeof(Stats));
+	Stats.MinDelay = ~(XTime)0;
+	OranGemRingMapClass(ORAN_GEM_CLASS_SPLANE, Queue);
+
+	XTime_GetTime(&Start);
+	End = Start + Milliseconds * (COUNTS_PER_SECOND / 1000);
+	NextSync = Start;
+	do {
+		/* A PTP frame is timed from when it is due, not queued */
+		XTime_GetTime(&Now);
+		if ((Sync.BufPtr == NULL) && (Now >= NextSync)) {
+			Sync.BufPtr = OranGemQueueBenchSync();
+			NextSync = (NextSync + Period > Now) ?
+				   NextSync + Period : Now + Period;
+		}
+		if ((Sync.BufPtr != NULL) && (OranGemRingSend(&Sync, 1) == 1)) {
+			Stats.Sent++;
+			Sync.BufPtr = NULL;
+		}
+
+		/* Keep queue 0 full of M-plane frames */
+		for (;;) {
+			if (First == Held) {
+				Held = OranGemBenchFrames(Frames,
+					ORAN_GEM_BATCH,
+					ORAN_GEM_BENCH_BULK_BYTES, &Seq);
+				First = 0;
+			}
+			First += OranGemRingSend(&Frames[First], Held - First);
+			if ((Held == 0) || (First != Held)) {
+				break;
+			}
+		}
+
+		OranGemQueueBenchRecv(&Stats);
+		XTime_GetTime(&Now);
+	} while (Now < End);
+	for (Index = First; Index < Held; Index++) {
+		OranGemBufFree(Frames[Index].BufPtr);
+	}
+	if (Sync.BufPtr != NULL) {
+		OranGemBufFree(Sync.BufPtr);
+	}
+	Mbps = (Stats.BulkBytes * 8 * COUNTS_PER_SECOND) /
+	       ((Now - Start) * 1000000);
+
+	/* Wait for the PTP frames still queued behind the load */
+	LastRx = Now;
+	while ((Stats.Back < Stats.Sent) && (Now - LastRx <= IdleTicks)) {
+		Back = Stats.Back;
+		OranGemQueueBenchRecv(&Stats);
+		XTime_GetTime(&Now);
+		if (Stats.Back != Back) {
+			LastRx = Now;
+		}
+	}
+	/* and for the load, so that the next run starts on empty queues */
+	LastRx = Now;
+	while (Now - LastRx <= IdleTicks) {
+		Bytes = Stats.BulkBytes;
+		OranGemQueueBenchRecv(&Stats);
+		XTime_GetTime(&Now);
+		if (Stats.BulkBytes != Bytes) {
+			LastRx = Now;
+		}
+	}
+	(void)OranGemRingReclaim();
+
+	xil_printf("GEM3 TX queue bench, S-plane on queue %d: %d of %d frames "
+		   "back, %d/%d/%d us min/avg/max, M-plane %d Mb/s\r\n",
+		   (int)Queue, (int)Stats.Back, (int)Stats.Sent,
+		   (int)((Stats.Back != 0) ? (Stats.MinDelay * 1000000) /
+			 COUNTS_PER_SECOND : 0),
+		   (int)((Stats.Back != 0) ? (Stats.SumDelay * 1000000) /
+			 (Stats.Back * COUNTS_PER_SECOND) : 0),
+		   (int)((Stats.MaxDelay * 1000000) / COUNTS_PER_SECOND),
+		   (int)Mbps);
+
+	return ((Stats.Sent != 0) && (Stats.Back == Stats.Sent)) ?
+	       XST_SUCCESS : XST_FAILURE;
+}
+
+/****************************************************************************/
+/**
+*
+* Measures how long PTP frames wait to be sent while M-plane frames keep
+* TX queue 0 full: once with the PTP frames queued behind them on queue 0,
+* as with a single queue, and once on queue 1. A PTP frame carrying the
+* time it was queued goes out every ORAN_GEM_BENCH_SYNC_USECS.
+*
+* @param	Milliseconds is how long each run lasts.
+*
+* @return	XST_SUCCESS if every PTP frame came back, otherwise
+*		XST_FAILURE.
+*
+* @note		Needs the rings started and the frames looped back, by the
+*		PHY or the GEM. The delay runs from OranGemRingSend to
+*		OranGemRingRecv, so it includes the RX polling. The S-plane
+*		class is mapped to queue 1 afterwards.
+*
+*****************************************************************************/
+LONG OranGemRingQueueBench(u32 Milliseconds)
+{
+	LONG Status;
+	u32 Queue;
+
+	if ((GemInstPtr == NULL) || (Milliseconds == 0)) {
+		return XST_FAILURE;
+	}
+
+	Status = XST_SUCCESS;
+	for (Queue = 0; Queue < GemTxQueues; Queue++) {
+		if (OranGemQueueBenchRun(Milliseconds, Queue) != XST_SUCCESS) {
+			Status = XST_FAILURE;
+		}
+	}
+	OranGemRingMapClass(ORAN_GEM_CLASS_SPLANE, 1);
+
+	return Status;
+}
@@ -0,0 +1,254 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file oran_gem_ring.h
+*
+* DMA datapath of the GEM3 PS port, for M-plane and punted traffic that the
+* PS terminates itself instead of bridging it to the PL over the FIFO
+* interface.
+*
+* The RX ring holds ORAN_GEM_RXBD_CNT descriptors, each posted with a
+* buffer of ORAN_GEM_BUF_SIZE bytes from the medium class of the packet
+* buffer pool (oran_buf.h), so call OranBufInit first. OranGemRingRecv
+* hands the application the pool buffers frames arrived in and posts fresh
+* ones in their place, so a frame is never copied: the application keeps
+* the buffer until it frees it or passes it to OranGemRingSend, which puts
+* it on the TX ring as it is. Sent buffers go back to the pool when their
+* descriptors are reclaimed through XEmacPs_BdRingFromHwTx, which is done
+* in one batch for every descriptor the GEM has finished once fewer than
+* ORAN_GEM_TX_RECLAIM are left free.
+*
+* On ZynqMP the GEM has two TX queues, each with its ring, and its DMA
+* takes the next frame from queue 1 whenever that has one. OranGemRingSend
+* classifies each frame (OranGemRingSetClassifier) and puts it on the queue
+* its class is mapped to (OranGemRingMapClass): by default S-plane and
+* C-plane frames on queue 1, so that they wait for at most the frame on
+* the wire instead of every M-plane frame queued before them.
+*
+* Frames longer than a buffer span several descriptors; they are dropped
+* and counted. The rings belong to one thread, which polls them, either
+* all the time or, through oran_gem_napi.c, after an RX interrupt.
+*
+*****************************************************************************/
+#ifndef ORAN_GEM_RING_H
+#define ORAN_GEM_RING_H
+
+/***************************** Include Files ********************************/
+
+#include "xil_types.h"
+#include "xemacps.h"
+#include "oran_buf.h"
+
+#if defined(__aarch64__) && !defined(__linux__)
+#include "xpseudo_asm.h"
+#endif
+
+/************************** Constant Definitions ****************************/
+
+/*
+ * Descriptors of each ring. 512 RX descriptors hold 0.5 ms of minimum-size
+ * frames at 1 Gb/s.
+ */
+#ifndef ORAN_GEM_RXBD_CNT
+#define ORAN_GEM_RXBD_CNT	512
+#endif
+#ifndef ORAN_GEM_TXBD_CNT
+#define ORAN_GEM_TXBD_CNT	512
+#endif
+
+/*
+ * TX queues, on GEM versions above 2: queue 0 has ORAN_GEM_TXBD_CNT
+ * descriptors for bulk traffic, queue 1 ORAN_GEM_TXQ1BD_CNT for the frames
+ * that go first. Older GEMs have queue 0 only, and every class is sent
+ * there.
+ */
+#define ORAN_GEM_TXQ_CNT	2
+#ifndef ORAN_GEM_TXQ1BD_CNT
+#define ORAN_GEM_TXQ1BD_CNT	64
+#endif
+
+/*
+ * Size of a ring buffer, a multiple of XEMACPS_RX_BUF_UNIT that holds a
+ * VLAN-tagged frame of 1518 bytes. The buffers on the RX ring and in TX
+ * flight come from the medium class of the pool, which must leave at
+ * least ORAN_GEM_BUF_SPARE more for the application to hold.
+ */
+#ifndef ORAN_GEM_BUF_SIZE
+#define ORAN_GEM_BUF_SIZE	1536
+#endif
+#ifndef ORAN_GEM_BUF_SPARE
+#define ORAN_GEM_BUF_SPARE	256
+#endif
+#define ORAN_GEM_BUF_CNT	(ORAN_GEM_RXBD_CNT + ORAN_GEM_TXBD_CNT + \
+				 ORAN_GEM_TXQ1BD_CNT + ORAN_GEM_BUF_SPARE)
+#if (ORAN_GEM_BUF_SIZE > ORAN_BUF_MEDIUM_SIZE) || \
+    (ORAN_GEM_BUF_SIZE <= ORAN_BUF_SMALL_SIZE)
+#error ORAN_GEM_BUF_SIZE must fall in the medium buffer class
+#endif
+#if ORAN_GEM_BUF_CNT > ORAN_BUF_MEDIUM_CNT
+#error ORAN_BUF_MEDIUM_CNT too small for the GEM3 rings
+#endif
+
+/* OranGemRingSend reclaims sent descriptors of a queue when fewer are free */
+#ifndef ORAN_GEM_TX_RECLAIM
+#define ORAN_GEM_TX_RECLAIM	64
+#endif
+
+/*
+ * Orders descriptor writes before the GEM is told about them, and register
+ * writes before descriptor reads
+ */
+#if defined(__aarch64__) && !defined(__linux__)
+#define ORAN_GEM_SYNC()		dsb()
+#else
+#define ORAN_GEM_SYNC()		__sync_synchronize()
+#endif
+
+/* Frames per OranGemRingRecv call in the service loop and the benchmark */
+#define ORAN_GEM_BATCH		32
+
+/*
+ * Uncached memory the rings take, at XEMACPS_BD_ALIGNMENT, with one more
+ * descriptor to park RX queue 1, which they do not use
+ */
+#define ORAN_GEM_RING_BYTES(Count) \
+	((XEmacPs_BdRingMemCalc(XEMACPS_BD_ALIGNMENT, (Count)) + \
+	  XEMACPS_BD_ALIGNMENT - 1) & ~(XEMACPS_BD_ALIGNMENT - 1))
+#define ORAN_GEM_BD_SPACE_BYTES	(ORAN_GEM_RING_BYTES(ORAN_GEM_RXBD_CNT) + \
+				 ORAN_GEM_RING_BYTES(ORAN_GEM_TXBD_CNT) + \
+				 ORAN_GEM_RING_BYTES(ORAN_GEM_TXQ1BD_CNT) + \
+				 ORAN_GEM_RING_BYTES(1))
+
+/*
+ * Defaults of OranGemNapiStart. ORAN_GEM_NAPI_USECS holds back an RX
+ * interrupt until that long after the previous one (the GEM's interrupt
+ * moderation, 0 to 204). While the ring keeps yielding at least
+ * ORAN_GEM_NAPI_FRAMES frames between two times it runs empty, polling
+ * goes on without re-arming the interrupt (0 re-arms whenever it is
+ * empty). ORAN_GEM_NAPI_BUDGET caps the frames of one OranGemNapiPoll.
+ */
+#ifndef ORAN_GEM_NAPI_USECS
+#define ORAN_GEM_NAPI_USECS	20
+#endif
+#ifndef ORAN_GEM_NAPI_FRAMES
+#define ORAN_GEM_NAPI_FRAMES	16
+#endif
+#ifndef ORAN_GEM_NAPI_BUDGET
+#define ORAN_GEM_NAPI_BUDGET	64
+#endif
+
+/* EtherTypes of the default classifier */
+#define ORAN_GEM_ETHTYPE_VLAN	0x8100
+#define ORAN_GEM_ETHTYPE_ECPRI	0xAEFE
+#define ORAN_GEM_ETHTYPE_PTP	0x88F7
+#define ORAN_GEM_ETHTYPE_SLOW	0x8809	/* slow protocols, ESMC among them */
+
+/* Frames of OranGemRingBench and OranGemRingQueueBench */
+#define ORAN_GEM_BENCH_ETHTYPE	0x88B5	/* local experimental */
+#define ORAN_GEM_BENCH_IDLE_MS	10	/* no frame back: count the rest lost */
+#define ORAN_GEM_BENCH_BULK_BYTES	1514	/* M-plane load */
+#define ORAN_GEM_BENCH_SYNC_BYTES	86	/* a PTP Sync message */
+#define ORAN_GEM_BENCH_SYNC_USECS	250	/* between two of them */
+
+/**************************** Type Definitions ******************************/
+
+/*
+ * A frame in a pool buffer
+ */
+typedef struct {
+	u8 *BufPtr;	/* first byte of the frame */
+	u32 Length;	/* bytes, without FCS */
+} OranGemFrame;
+
+/*
+ * Classes of the frames OranGemRingSend queues
+ */
+typedef enum {
+	ORAN_GEM_CLASS_MPLANE,	/* management, and anything not below */
+	ORAN_GEM_CLASS_CPLANE,	/* eCPRI */
+	ORAN_GEM_CLASS_SPLANE,	/* PTP over Ethernet and ESMC */
+	ORAN_GEM_CLASS_COUNT
+} OranGemClass;
+
+/*
+ * Returns the OranGemClass of a frame about to be sent
+ */
+typedef u32 (*OranGemClassifyFn)(const OranGemFrame *FramePtr);
+
+typedef struct {
+	u64 RxFrames;
+	u64 RxBytes;
+	u32 RxNoBuf;	/* dropped to keep the descriptor posted */
+	u32 RxLong;	/* longer than a buffer */
+	u64 TxFrames;	/* completed */
+	u64 TxBytes;
+	u32 TxErrors;	/* retry limit, underrun or late collision */
+	u32 TxFull;	/* refused by OranGemRingSend */
+	u32 TxReclaims;	/* batches through XEmacPs_BdRingFromHwTx */
+	u64 TxQueued[ORAN_GEM_TXQ_CNT];	/* frames put on each queue */
+	u64 CacheLines;	/* cleaned or invalidated for the DMA */
+	u32 BufFree;	/* medium buffers in the pool now */
+	u32 BufLow;	/* fewest medium buffers free, at most */
+} OranGemRingCounters;
+
+/*
+ * What the RX interrupt path costs, split between the two modes the port
+ * is in: interrupt mode, armed, and poll mode, masked. Ticks are XTime
+ * counts spent in OranGemNapiIntrHandler and in OranGemNapiPoll calls
+ * with the ring scheduled; interrupt entry and exit are not included.
+ */
+typedef struct {
+	u32 Interrupts;	/* with RX status, the ring scheduled */
+	u32 IntrErrors;	/* overrun, no RX buffer or AMBA error */
+	u64 IntrTicks;
+	u32 Polls;	/* OranGemNapiPoll calls with the ring scheduled */
+	u32 EmptyPolls;	/* of which found no frame */
+	u64 PollFrames;
+	u64 PollTicks;
+	u32 Rearms;	/* back to interrupt mode */
+	u32 Stays;	/* ring empty, polling on over ORAN_GEM_NAPI_FRAMES */
+	u32 Races;	/* frame came in while re-arming: polling on */
+} OranGemNapiCounters;
+
+/************************** Function Prototypes *****************************/
+
+/*
+ * GEM3 DMA rings and buffer pool, implemented in oran_gem_ring.c
+ */
+LONG OranGemRingInit(XEmacPs *InstancePtr, UINTPTR BdSpace, u32 BdSpaceBytes);
+void OranGemRingStart(void);
+u32 OranGemRingRecv(OranGemFrame *FramesPtr, u32 Max);
+u32 OranGemRingRxPending(void);
+u32 OranGemRingSend(const OranGemFrame *FramesPtr, u32 Count);
+u32 OranGemRingSendQueue(u32 Queue, const OranGemFrame *FramesPtr,
+			 u32 Count);
+u32 OranGemRingReclaim(void);
+u32 OranGemRingTxQueues(void);
+void OranGemRingSetClassifier(OranGemClassifyFn ClassifyFn);
+void OranGemRingMapClass(u32 Class, u32 Queue);
+u32 OranGemClassifyDefault(const OranGemFrame *FramePtr);
+u8 *OranGemBufAlloc(void);
+void OranGemBufFree(u8 *BufPtr);
+void OranGemRingGetCounters(OranGemRingCounters *CountersPtr);
+void OranGemRingPrint(const OranGemRingCounters *CountersPtr);
+LONG OranGemRingBench(u32 Milliseconds, u32 FrameBytes);
+LONG OranGemRingQueueBench(u32 Milliseconds);
+
+/*
+ * RX interrupt moderation and budgeted polling, implemented in
+ * oran_gem_napi.c
+ */
+void OranGemNapiStart(XEmacPs *InstancePtr, u32 Usecs, u32 Frames,
+		      u32 Budget);
+void OranGemNapiStop(void);
+void OranGemNapiIntrHandler(void *CallbackRef);
+u32 OranGemNapiScheduled(void);
+u32 OranGemNapiPoll(OranGemFrame *FramesPtr, u32 Max);
+void OranGemNapiGetCounters(OranGemNapiCounters *CountersPtr);
+void OranGemNapiPrint(const OranGemNapiCounters *CountersPtr);
+
+#endif /* ORAN_GEM_RING_H */
@@ -0,0 +1,322 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file oran_lock.c
+*
+* Locks for changing and querying the SDNet tables from several threads,
+* as a Linux agent on the A53 cluster does.
+*
+* Each table has an OranLock. A thread that changes the table holds its
+* Writer mutex across the driver calls, so writers of one table take
+* turns. The mutex is recursive: OranPolicyLoadRules, for example, calls
+* the other policy functions with it held.
+*
+* Queries answered from the copy of a table kept in the application take
+* no lock. The writer makes Seq odd while it changes the copy and even
+* again when the copy is consistent; a reader notes Seq before it looks
+* and looks again if Seq has moved by the time it is done. Reads therefore
+* scale with the number of cores and are not held up by a writer waiting
+* for sdnet_0, only by the short time it spends on the copy itself.
+* Code walking a chain of the copy lock-free must bound the walk and check
+* indexes before using them, as it may see a chain half changed. What the
+* table driver reports about a table's layout (XilSdnetTableGetActionId,
+* XilSdnetTableGetKeySizeBits and the like) is fixed once the target is up
+* and needs no lock either.
+*
+* Writers of different tables still meet at the register interface. The
+* environment interface OranLockWrap builds takes the bus lock around each
+* register access, and OranSdnetWriteSequenceBegin holds it for the whole
+* sequence, so that the writes a sequence queues are issued by the thread
+* that queued them. Lock order is table, then bus.
+*
+* Built without ORAN_SDNET_THREADS the mutexes are left out; Seq is still
+* kept, so the same query code runs single threaded.
+*
+*****************************************************************************/
+
+#if defined(__linux__)
+#define _DEFAULT_SOURCE		/* PTHREAD_MUTEX_RECURSIVE */
+#endif
+
+/***************************** Include Files ********************************/
+
+#include "oran_sdnet.h"
+#if ORAN_SDNET_THREADS
+#include <sched.h>
+#endif
+
+#if ORAN_SDNET_CTRL
+
+/************************** Variable Definitions ****************************/
+
+static OranLock LockBus;
+#if ORAN_SDNET_THREADS
+static XilSdnetEnvIf *LockInnerPtr;
+static XilSdnetEnvIf LockEnvIf;
+
+/*****************************************************************************/
+/*
+ * Register accesses of the drivers, one at a time
+ */
+static XilSdnetReturnType OranLockWrite32(XilSdnetEnvIf *EnvIfPtr,
+					  XilSdnetAddressType Address,
+					  uint32_t WriteValue)
+{
+	XilSdnetReturnType Result;
+
+	(void)EnvIfPtr;
+	OranLockBus();
+	Result = LockInnerPtr->WordWrite32(LockInnerPtr, Address, WriteValue);
+	OranUnlockBus();
+	return Result;
+}
+
+static XilSdnetReturnType OranLockRead32(XilSdnetEnvIf *EnvIfPtr,
+					 XilSdnetAddressType Address,
+					 uint32_t *ReadValuePtr)
+{
+	XilSdnetReturnType Result;
+
+	(void)EnvIfPtr;
+	OranLockBus();
+	Result = LockInnerPtr->WordRead32(LockInnerPtr, Address, ReadValuePtr);
+	OranUnlockBus();
+	return Result;
+}
+#endif
+
+/****************************************************************************/
+/**
+*
+* Prepares a lock for use.
+*
+* @param	LockPtr is the lock.
+*
+* @return	None.
+*
+* @note		Does nothing for a lock already prepared, so table init
+*		functions can run again. Must not race with other users of
+*		the lock.
+*
+*****************************************************************************/
+void OranLockInit(OranLock *LockPtr)
+{
+#if ORAN_SDNET_THREADS
+	pthread_mutexattr_t Attr;
+#endif
+
+	if (LockPtr->Ready) {
+		return;
+	}
+
+#if ORAN_SDNET_THREADS
+	(void)pthread_mutexattr_init(&Attr);
+	(void)pthread_mutexattr_settype(&Attr, PTHREAD_MUTEX_RECURSIVE);
+	(void)pthread_mutex_init(&LockPtr->Writer, &Attr);
+	(void)pthread_mutexattr_destroy(&Attr);
+#endif
+	LockPtr->Seq = 0;
+	LockPtr->Ready = 1;
+}
+
+/****************************************************************************/
+/**
+*
+* Takes the writer side of a lock.
+*
+* @param	LockPtr is the lock.
+*
+* @return	None.
+*
+* @note		May be taken again by the thread holding it. A lock not yet
+*		prepared by OranLockInit is not taken.
+*
+*****************************************************************************/
+void OranLockWrite(OranLock *LockPtr)
+{
+#if ORAN_SDNET_THREADS
+	if (LockPtr->Ready) {
+		(void)pthread_mutex_lock(&LockPtr->Writer);
+	}
+#else
+	(void)LockPtr;
+#endif
+}
+
+/****************************************************************************/
+/**
+*
+* Releases the writer side of a lock, once for each OranLockWrite.
+*
+* @param	LockPtr is the lock.
+*
+* @return	None.
+*
+* @note		None.
+*
+*****************************************************************************/
+void OranUnlockWrite(OranLock *LockPtr)
+{
+#if ORAN_SDNET_THREADS
+	if (LockPtr->Ready) {
+		(void)pthread_mutex_unlock(&LockPtr->Writer);
+	}
+#else
+	(void)LockPtr;
+#endif
+}
+
+/****************************************************************************/
+/**
+*
+* Marks the start of a change to the copy a lock protects. Lock-free
+* readers that overlap the change look again.
+*
+* @param	LockPtr is the lock. The writer side must be held.
+*
+* @return	None.
+*
+* @note		Changes do not nest.
+*
+*****************************************************************************/
+void OranLockChangeBegin(OranLock *LockPtr)
+{
+	__atomic_store_n(&LockPtr->Seq, LockPtr->Seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+/****************************************************************************/
+/**
+*
+* Marks the end of a change started by OranLockChangeBegin.
+*
+* @param	LockPtr is the lock. The writer side must be held.
+*
+* @return	None.
+*
+* @note		None.
+*
+*****************************************************************************/
+void OranLockChangeEnd(OranLock *LockPtr)
+{
+	__atomic_store_n(&LockPtr->Seq, LockPtr->Seq + 1, __ATOMIC_RELEASE);
+}
+
+/****************************************************************************/
+/**
+*
+* Starts a lock-free read of the copy a lock protects, waiting out a change
+* in progress.
+*
+* @param	LockPtr is the lock.
+*
+* @return	The value to hand to OranLockReadRetry.
+*
+* @note		A thread holding the writer side reads without this.
+*
+*****************************************************************************/
+u32 OranLockReadBegin(const OranLock *LockPtr)
+{
+	u32 Seq;
+
+	while ((Seq = __atomic_load_n(&LockPtr->Seq, __ATOMIC_ACQUIRE)) & 1) {
+#if ORAN_SDNET_THREADS
+		(void)sched_yield();
+#endif
+	}
+
+	return Seq;
+}
+
+/****************************************************************************/
+/**
+*
+* Ends a lock-free read started by OranLockReadBegin.
+*
+* @param	LockPtr is the lock.
+* @param	Seq is what OranLockReadBegin returned.
+*
+* @return	Non-zero if the copy changed during the read, which must then
+*		be done again and its result dropped.
+*
+* @note		None.
+*
+*****************************************************************************/
+u8 OranLockReadRetry(const OranLock *LockPtr, u32 Seq)
+{
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	return __atomic_load_n(&LockPtr->Seq, __ATOMIC_RELAXED) != Seq;
+}
+
+/****************************************************************************/
+/**
+*
+* Builds an environment interface that takes the bus lock around every
+* register access of another one.
+*
+* @param	InnerPtr is the interface that performs the accesses. It
+*		must stay valid while the returned one is in use.
+*
+* @return	The interface to hand to the drivers in place of InnerPtr.
+*		Without ORAN_SDNET_THREADS this is InnerPtr itself.
+*
+* @note		There is one such interface; wrapping again replaces the
+*		interface it forwards to. Only register accesses are
+*		serialized: the log callbacks run as the drivers call them.
+*
+*****************************************************************************/
+XilSdnetEnvIf *OranLockWrap(XilSdnetEnvIf *InnerPtr)
+{
+#if ORAN_SDNET_THREADS
+	OranLockInit(&LockBus);
+	LockInnerPtr = InnerPtr;
+	LockEnvIf = *InnerPtr;
+	LockEnvIf.WordWrite32 = OranLockWrite32;
+	LockEnvIf.WordRead32 = OranLockRead32;
+
+	return &LockEnvIf;
+#else
+	return InnerPtr;
+#endif
+}
+
+/****************************************************************************/
+/**
+*
+* Takes the lock on the sdnet_0 register interface.
+*
+* @param	None.
+*
+* @return	None.
+*
+* @note		May be taken again by the thread holding it. Table locks must
+*		not be taken while it is held.
+*
+*****************************************************************************/
+void OranLockBus(void)
+{
+	OranLockWrite(&LockBus);
+}
+
+/****************************************************************************/
+/**
+*
+* Releases the lock taken by OranLockBus.
+*
+* @param	None.
+*
+* @return	None.
+*
+* @note		None.
+*
+*****************************************************************************/
+void OranUnlockBus(void)
+{
+	OranUnlockWrite(&LockBus);
+}
+
+#endif /* ORAN_SDNET_CTRL */
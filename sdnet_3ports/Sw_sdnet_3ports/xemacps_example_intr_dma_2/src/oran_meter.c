@@ -0,0 +1,215 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file oran_meter.c
+*
+* Run-time configuration of the port_meter extern of sdnet_0, a two-rate
+* three-color meter (RFC 2698, color-blind, on bytes) per plane and ingress
+* port. A yellow frame leaves with ORAN_PRIO_BEST_EFFORT and a red one is
+* dropped. Cells that are not configured color every frame green.
+*
+* GEM3 carries M-plane and other best-effort traffic at up to 1G towards the
+* 10G ports. A software download or a burst of NETCONF traffic arriving
+* there would otherwise be queued by the egress arbiter next to U-plane
+* symbols, which have no slack for it. OranMeterLoadDefaults therefore
+* limits that cell: traffic above the committed rate is demoted to best
+* effort and traffic above the peak rate is dropped in the pipeline, before
+* it reaches any queue. S-plane frames from GEM3 are counted as a plane of
+* their own and are not metered.
+*
+* Register accesses go through the SDNet environment interface, the same
+* path the table drivers use. The file is only built with ORAN_SDNET_METER,
+* see oran_sdnet.h.
+*
+*****************************************************************************/
+
+/***************************** Include Files ********************************/
+
+#include "xil_printf.h"
+#include "xstatus.h"
+#include "oran_sdnet.h"
+
+#if ORAN_SDNET_CTRL && ORAN_SDNET_METER
+
+/************************** Type Definitions ********************************/
+
+typedef struct {
+	u8 Plane;
+	u8 AxisTid;
+	OranMeterConfig Config;
+} OranMeterDefault;
+
+/************************** Variable Definitions ****************************/
+
+/* Kept in step with the meter lines of tools/p4tools/plane_policy.txt */
+static const OranMeterDefault OranMeterDefaults[] = {
+	/* M-plane and other traffic from GEM3 */
+	{ ORAN_STATS_PLANE_OTHER, ORAN_TID_GEM3,
+	  { 200000, 32768, 400000, 65536 } },
+};
+
+/*****************************************************************************/
+/*
+ * Writes the staging registers and applies them to one cell
+ */
+static LONG OranMeterWrite(u8 Plane, u8 AxisTid,
+			   const OranMeterConfig *ConfigPtr)
+{
+	XilSdnetEnvIf *EnvIfPtr = OranSdnetEnvIf();
+	XilSdnetReturnType Result;
+	uint32_t Status;
+	u32 Cell = (u32)Plane * ORAN_STATS_NUM_TIDS + AxisTid;
+	u32 Poll;
+
+	if (EnvIfPtr == NULL) {
+		return XST_FAILURE;
+	}
+
+	Result = EnvIfPtr->WordWrite32(EnvIfPtr,
+				       ORAN_METER_OFFSET + ORAN_METER_CIR_REG,
+				       ConfigPtr->CirKbps);
+	if (Result == XIL_SDNET_SUCCESS) {
+		Result = EnvIfPtr->WordWrite32(EnvIfPtr, ORAN_METER_OFFSET +
+					       ORAN_METER_CBS_REG,
+					       ConfigPtr->Cbs);
+	}
+	if (Result == XIL_SDNET_SUCCESS) {
+		Result = EnvIfPtr->WordWrite32(EnvIfPtr, ORAN_METER_OFFSET +
+					       ORAN_METER_PIR_REG,
+					       ConfigPtr->PirKbps);
+	}
+	if (Result == XIL_SDNET_SUCCESS) {
+		Result = EnvIfPtr->WordWrite32(EnvIfPtr, ORAN_METER_OFFSET +
+					       ORAN_METER_PBS_REG,
+					       ConfigPtr->Pbs);
+	}
+	if (Result == XIL_SDNET_SUCCESS) {
+		Result = EnvIfPtr->WordWrite32(EnvIfPtr, ORAN_METER_OFFSET +
+					       ORAN_METER_CTRL_REG,
+					       ORAN_METER_CTRL_APPLY | Cell);
+	}
+	if (Result != XIL_SDNET_SUCCESS) {
+		return XST_FAILURE;
+	}
+
+	for (Poll = 0; Poll < ORAN_METER_APPLY_POLLS; Poll++) {
+		Result = EnvIfPtr->WordRead32(EnvIfPtr, ORAN_METER_OFFSET +
+					      ORAN_METER_STATUS_REG, &Status);
+		if ((Result != XIL_SDNET_SUCCESS) ||
+		    !(Status & ORAN_METER_STATUS_BUSY)) {
+			break;
+		}
+	}
+	if ((Result != XIL_SDNET_SUCCESS) || (Poll == ORAN_METER_APPLY_POLLS)) {
+		xil_printf("port_meter cell %d update timed out\r\n", (int)Cell);
+		return XST_FAILURE;
+	}
+
+	return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/**
+*
+* Sets the rates of the meter for one plane and ingress port. The new rates
+* take effect with full buckets.
+*
+* @param	Plane is one of ORAN_STATS_PLANE_*.
+* @param	AxisTid is the ingress port, one of ORAN_TID_*.
+* @param	ConfigPtr holds the rates. PirKbps must not be below CirKbps
+*		and both bursts must hold at least ORAN_METER_MIN_BURST
+*		bytes.
+*
+* @return	XST_SUCCESS to indicate success, otherwise XST_FAILURE.
+*
+* @note		OranSdnetInit must have been called first.
+*
+*****************************************************************************/
+LONG OranMeterSet(u8 Plane, u8 AxisTid, const OranMeterConfig *ConfigPtr)
+{
+	if ((Plane >= ORAN_STATS_NUM_PLANES) ||
+	    (AxisTid >= ORAN_STATS_NUM_TIDS)) {
+		return XST_FAILURE;
+	}
+	if ((ConfigPtr->PirKbps == 0) ||
+	    (ConfigPtr->PirKbps < ConfigPtr->CirKbps) ||
+	    (ConfigPtr->Cbs < ORAN_METER_MIN_BURST) ||
+	    (ConfigPtr->Pbs < ORAN_METER_MIN_BURST)) {
+		xil_printf("Invalid port_meter rates for plane %d tid %d\r\n",
+			   (int)Plane, (int)AxisTid);
+		return XST_FAILURE;
+	}
+
+	return OranMeterWrite(Plane, AxisTid, ConfigPtr);
+}
+
+/****************************************************************************/
+/**
+*
+* Stops metering one plane and ingress port; its frames are all green
+* again.
+*
+* @param	Plane is one of ORAN_STATS_PLANE_*.
+* @param	AxisTid is the ingress port, one of ORAN_TID_*.
+*
+* @return	XST_SUCCESS to indicate success, otherwise XST_FAILURE.
+*
+* @note		None.
+*
+*****************************************************************************/
+LONG OranMeterClear(u8 Plane, u8 AxisTid)
+{
+	static const OranMeterConfig Unmetered = { 0, 0, 0, 0 };
+
+	if ((Plane >= ORAN_STATS_NUM_PLANES) ||
+	    (AxisTid >= ORAN_STATS_NUM_TIDS)) {
+		return XST_FAILURE;
+	}
+
+	return OranMeterWrite(Plane, AxisTid, &Unmetered);
+}
+
+/****************************************************************************/
+/**
+*
+* Clears every port_meter cell and configures the default limits.
+*
+* @param	None.
+*
+* @return	XST_SUCCESS to indicate success, otherwise XST_FAILURE.
+*
+* @note		None.
+*
+*****************************************************************************/
+LONG OranMeterLoadDefaults(void)
+{
+	u32 Plane;
+	u32 Tid;
+	u32 Index;
+
+	for (Plane = 0; Plane < ORAN_STATS_NUM_PLANES; Plane++) {
+		for (Tid = 0; Tid < ORAN_STATS_NUM_TIDS; Tid++) {
+			if (OranMeterClear((u8)Plane, (u8)Tid) != XST_SUCCESS) {
+				return XST_FAILURE;
+			}
+		}
+	}
+
+	for (Index = 0; Index < sizeof(OranMeterDefaults) /
+				sizeof(OranMeterDefaults[0]); Index++) {
+		const OranMeterDefault *DefaultPtr = &OranMeterDefaults[Index];
+
+		if (OranMeterSet(DefaultPtr->Plane, DefaultPtr->AxisTid,
+				 &DefaultPtr->Config) != XST_SUCCESS) {
+			return XST_FAILURE;
+		}
+	}
+
+	return XST_SUCCESS;
+}
+
+#endif /* ORAN_SDNET_CTRL && ORAN_SDNET_METER */
@@ -0,0 +1,776 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file oran_policy.c
+*
+* Run-time programming of the plane_classify table in sdnet_0.
+*
+* OranPolicyLoadDefaults installs entries that reproduce the steering that
+* used to be compiled into the pipeline as node_80..node_92 and adds a
+* priority class to each of them:
+*
+*	eCPRI msg 0/2/5 or RoE subtype 0x80-0x83:
+*		tid 0 -> tdest 1, tid 1 -> tdest 0, any other tid unchanged
+*	anything else:
+*		tid 0 -> tdest 2, tid 2 -> tdest 0
+*
+* Key, mask and action parameter byte arrays use XIL_SDNET_LITTLE_ENDIAN,
+* which is what p4c-sdnet emits for the table configuration.
+*
+* A copy of the entries in the table is kept here, so that a policy change
+* can be staged as a whole (OranPolicyBegin, OranPolicyStageInsert,
+* OranPolicyStageDelete) and handed to OranTableCommit as the difference
+* between two complete sets. Reloading the defaults on a running site goes
+* the same way. While a change is staged, single-entry inserts and deletes
+* are refused; they would be undone by the commit.
+*
+* Changes are made under PolicyLock. OranPolicyBegin takes it and the
+* commit or abort releases it, so a thread staging a change has the table
+* to itself and other threads' changes wait for it rather than fail.
+* OranPolicyGetRules takes no lock (see oran_lock.c).
+*
+*****************************************************************************/
+
+/***************************** Include Files ********************************/
+
+#include <string.h>
+#include "xil_printf.h"
+#include "xstatus.h"
+#include "oran_sdnet.h"
+
+#if ORAN_SDNET_CTRL
+
+/************************** Constant Definitions ****************************/
+
+/*
+ * Entry priorities used by the default policy; lowest wins
+ */
+#define ORAN_RULE_PRIO_PLANE	10
+#define ORAN_RULE_PRIO_KEEP	20
+#define ORAN_RULE_PRIO_TIMING	30
+#define ORAN_RULE_PRIO_DEFAULT	40
+
+/*
+ * One packed entry: key, mask, then action parameters
+ */
+#define ORAN_POLICY_ENTRY_BYTES	(2 * ORAN_POLICY_KEY_BYTES + \
+				 ORAN_POLICY_PARAM_BYTES)
+
+/************************** Variable Definitions ****************************/
+
+static XilSdnetTableCtx *PolicyTablePtr;
+static u32 PolicyActionSet;
+static u32 PolicyActionNop;
+
+/* Entries in the table, and the set staged to replace them */
+static OranPolicyRule PolicyRules[ORAN_POLICY_DEPTH];
+static u32 PolicyCount;
+static OranPolicyRule PolicyStaged[ORAN_POLICY_DEPTH];
+static u32 PolicyStagedCount;
+static u8 PolicyTxnOpen;
+static OranLock PolicyLock;
+
+/* Packed copies of both sets for OranTableCommit */
+static u8 PolicyOldBytes[ORAN_POLICY_DEPTH][ORAN_POLICY_ENTRY_BYTES];
+static u8 PolicyNewBytes[ORAN_POLICY_DEPTH][ORAN_POLICY_ENTRY_BYTES];
+static OranTableEntry PolicyOldEntries[ORAN_POLICY_DEPTH];
+static OranTableEntry PolicyNewEntries[ORAN_POLICY_DEPTH];
+
+static const OranPolicyRule OranDefaultRules[] = {
+	/* eCPRI IQ data (U-plane) */
+	{ { ORAN_TID_10G_0, 0, 0, 0, 1, 0x00, 0, 0 },
+	  { 0xFF, 0, 0, 0, 1, 0xFF, 0, 0 },
+	  ORAN_RULE_PRIO_PLANE, 1, ORAN_PRIO_UPLANE, 0 },
+	{ { ORAN_TID_10G_1, 0, 0, 0, 1, 0x00, 0, 0 },
+	  { 0xFF, 0, 0, 0, 1, 0xFF, 0, 0 },
+	  ORAN_RULE_PRIO_PLANE, 0, ORAN_PRIO_UPLANE, 0 },
+	/* eCPRI real-time control (C-plane) */
+	{ { ORAN_TID_10G_0, 0, 0, 0, 1, 0x02, 0, 0 },
+	  { 0xFF, 0, 0, 0, 1, 0xFF, 0, 0 },
+	  ORAN_RULE_PRIO_PLANE, 1, ORAN_PRIO_CPLANE, 0 },
+	{ { ORAN_TID_10G_1, 0, 0, 0, 1, 0x02, 0, 0 },
+	  { 0xFF, 0, 0, 0, 1, 0xFF, 0, 0 },
+	  ORAN_RULE_PRIO_PLANE, 0, ORAN_PRIO_CPLANE, 0 },
+	/* eCPRI one-way delay measurement */
+	{ { ORAN_TID_10G_0, 0, 0, 0, 1, 0x05, 0, 0 },
+	  { 0xFF, 0, 0, 0, 1, 0xFF, 0, 0 },
+	  ORAN_RULE_PRIO_PLANE, 1, ORAN_PRIO_CPLANE, 0 },
+	{ { ORAN_TID_10G_1, 0, 0, 0, 1, 0x05, 0, 0 },
+	  { 0xFF, 0, 0, 0, 1, 0xFF, 0, 0 },
+	  ORAN_RULE_PRIO_PLANE, 0, ORAN_PRIO_CPLANE, 0 },
+	/* RoE subtypes 0x80-0x83 */
+	{ { ORAN_TID_10G_0, 0, 0, 0, 0, 0, 1, 0x80 },
+	  { 0xFF, 0, 0, 0, 0, 0, 1, 0xFC },
+	  ORAN_RULE_PRIO_PLANE, 1, ORAN_PRIO_UPLANE, 0 },
+	{ { ORAN_TID_10G_1, 0, 0, 0, 0, 0, 1, 0x80 },
+	  { 0xFF, 0, 0, 0, 0, 0, 1, 0xFC },
+	  ORAN_RULE_PRIO_PLANE, 0, ORAN_PRIO_UPLANE, 0 },
+	/* Same frames from any other port pass through untouched */
+	{ { 0, 0, 0, 0, 1, 0x00, 0, 0 },
+	  { 0, 0, 0, 0, 1, 0xFD, 0, 0 },
+	  ORAN_RULE_PRIO_KEEP, 0, 0, 1 },
+	{ { 0, 0, 0, 0, 1, 0x05, 0, 0 },
+	  { 0, 0, 0, 0, 1, 0xFF, 0, 0 },
+	  ORAN_RULE_PRIO_KEEP, 0, 0, 1 },
+	{ { 0, 0, 0, 0, 0, 0, 1, 0x80 },
+	  { 0, 0, 0, 0, 0, 0, 1, 0xFC },
+	  ORAN_RULE_PRIO_KEEP, 0, 0, 1 },
+	/* PTP (S-plane), steered like M-plane but ranked above it */
+	{ { ORAN_TID_10G_0, ORAN_ETHTYPE_PTP, 0, 0, 0, 0, 0, 0 },
+	  { 0xFF, 0xFFFF, 0, 0, 0, 0, 0, 0 },
+	  ORAN_RULE_PRIO_TIMING, 2, ORAN_PRIO_SPLANE, 0 },
+	{ { ORAN_TID_GEM3, ORAN_ETHTYPE_PTP, 0, 0, 0, 0, 0, 0 },
+	  { 0xFF, 0xFFFF, 0, 0, 0, 0, 0, 0 },
+	  ORAN_RULE_PRIO_TIMING, 0, ORAN_PRIO_SPLANE, 0 },
+	/* Everything else between the 10G port and GEM3 */
+	{ { ORAN_TID_10G_0, 0, 0, 0, 0, 0, 0, 0 },
+	  { 0xFF, 0, 0, 0, 0, 0, 0, 0 },
+	  ORAN_RULE_PRIO_DEFAULT, 2, ORAN_PRIO_MPLANE, 0 },
+	{ { ORAN_TID_GEM3, 0, 0, 0, 0, 0, 0, 0 },
+	  { 0xFF, 0, 0, 0, 0, 0, 0, 0 },
+	  ORAN_RULE_PRIO_DEFAULT, 0, ORAN_PRIO_MPLANE, 0 },
+};
+
+/****************************************************************************/
+/**
+*
+* Packs a plane_classify key (or mask) into the little-endian byte layout
+* expected by the table driver.
+*
+* @param	KeyPtr is the key to pack.
+* @param	BytePtr receives ORAN_POLICY_KEY_BYTES bytes.
+*
+* @return	None.
+*
+* @note		The first key field ends up in the most significant bits, so
+*		BytePtr[0] holds the low byte of RoEsubType.
+*
+*****************************************************************************/
+void OranPolicyPackKey(const OranPolicyKey *KeyPtr, u8 *BytePtr)
+{
+	u64 Value;
+	u32 Index;
+
+	Value = (u64)KeyPtr->AxisTid;
+	Value = (Value << 16) | KeyPtr->EthType;
+	Value = (Value << 1) | (KeyPtr->VlanValid & 0x1);
+	Value = (Value << 3) | (KeyPtr->VlanPcp & 0x7);
+	Value = (Value << 1) | (KeyPtr->EcpriValid & 0x1);
+	Value = (Value << 8) | KeyPtr->EcpriMsgType;
+	Value = (Value << 1) | (KeyPtr->RoeValid & 0x1);
+	Value = (Value << 8) | KeyPtr->RoeSubType;
+
+	for (Index = 0; Index < ORAN_POLICY_KEY_BYTES; Index++) {
+		BytePtr[Index] = (u8)(Value >> (8 * Index));
+	}
+}
+
+/*
+ * set_plane(tdest, prio): prio is the last parameter, so it is byte 0
+ */
+static void OranPolicyPackParams(const OranPolicyRule *RulePtr, u8 *BytePtr)
+{
+	BytePtr[0] = RulePtr->Prio;
+	BytePtr[1] = (u8)(RulePtr->Tdest);
+	BytePtr[2] = (u8)(RulePtr->Tdest >> 8);
+	BytePtr[3] = (u8)(RulePtr->Tdest >> 16);
+	BytePtr[4] = (u8)(RulePtr->Tdest >> 24);
+}
+
+/*
+ * Packs a rule into ORAN_POLICY_ENTRY_BYTES at BytePtr and points the
+ * table entry at it
+ */
+static void OranPolicyPackEntry(const OranPolicyRule *RulePtr,
+				OranTableEntry *EntryPtr, u8 *BytePtr)
+{
+	u8 *MaskPtr = BytePtr + ORAN_POLICY_KEY_BYTES;
+	u8 *ParamsPtr = MaskPtr + ORAN_POLICY_KEY_BYTES;
+
+	OranPolicyPackKey(&RulePtr->Key, BytePtr);
+	OranPolicyPackKey(&RulePtr->Mask, MaskPtr);
+	memset(ParamsPtr, 0, ORAN_POLICY_PARAM_BYTES);
+	if (!RulePtr->Keep) {
+		OranPolicyPackParams(RulePtr, ParamsPtr);
+	}
+
+	EntryPtr->KeyPtr = BytePtr;
+	EntryPtr->MaskPtr = MaskPtr;
+	EntryPtr->Priority = RulePtr->Priority;
+	EntryPtr->ActionId = RulePtr->Keep ? PolicyActionNop : PolicyActionSet;
+	EntryPtr->ParamsPtr = ParamsPtr;
+}
+
+/*
+ * Index of the rule with the same key and mask as RulePtr, or Count
+ */
+static u32 OranPolicyFind(const OranPolicyRule *RulesPtr, u32 Count,
+			  const OranPolicyRule *RulePtr)
+{
+	u8 Key[2 * ORAN_POLICY_KEY_BYTES];
+	u8 Other[2 * ORAN_POLICY_KEY_BYTES];
+	u32 Index;
+
+	OranPolicyPackKey(&RulePtr->Key, Key);
+	OranPolicyPackKey(&RulePtr->Mask, Key + ORAN_POLICY_KEY_BYTES);
+	for (Index = 0; Index < Count; Index++) {
+		OranPolicyPackKey(&RulesPtr[Index].Key, Other);
+		OranPolicyPackKey(&RulesPtr[Index].Mask,
+				  Other + ORAN_POLICY_KEY_BYTES);
+		if (memcmp(Key, Other, sizeof(Key)) == 0) {
+			break;
+		}
+	}
+
+	return Index;
+}
+
+static u8 OranPolicyTxnBusy(void)
+{
+	if (PolicyTxnOpen) {
+		xil_printf("plane_classify has a change staged\r\n");
+	}
+	return PolicyTxnOpen;
+}
+
+/****************************************************************************/
+/**
+*
+* Looks up plane_classify and its action IDs on the target set up by
+* OranSdnetInit.
+*
+* @param	None.
+*
+* @return	XST_SUCCESS to indicate success, otherwise XST_FAILURE.
+*
+* @note		None.
+*
+*****************************************************************************/
+LONG OranPolicyInit(void)
+{
+	XilSdnetTargetCtx *TargetPtr = OranSdnetTarget();
+	XilSdnetReturnType Result;
+	uint32_t KeySizeBits;
+
+	if (TargetPtr == NULL) {
+		xil_printf("SDNet target not initialized\r\n");
+		return XST_FAILURE;
+	}
+	OranLockInit(&PolicyLock);
+
+	Result = XilSdnetTargetGetTableByName(TargetPtr,
+					      ORAN_POLICY_TABLE_NAME,
+					      &PolicyTablePtr);
+	if (Result != XIL_SDNET_SUCCESS) {
+		xil_printf("Table %s not found: %s\r\n", ORAN_POLICY_TABLE_NAME,
+			   XilSdnetReturnTypeToString(Result));
+		return XST_FAILURE;
+	}
+
+	Result = XilSdnetTableGetKeySizeBits(PolicyTablePtr, &KeySizeBits);
+	if ((Result != XIL_SDNET_SUCCESS) ||
+	    (KeySizeBits != ORAN_POLICY_KEY_BITS)) {
+		xil_printf("Unexpected %s key size %d\r\n",
+			   ORAN_POLICY_TABLE_NAME, (int)KeySizeBits);
+		return XST_FAILURE;
+	}
+
+	Result = XilSdnetTableGetActionId(PolicyTablePtr,
+					  ORAN_POLICY_ACTION_SET,
+					  &PolicyActionSet);
+	if (Result == XIL_SDNET_SUCCESS) {
+		Result = XilSdnetTableGetActionId(PolicyTablePtr,
+						  ORAN_POLICY_ACTION_NOP,
+						  &PolicyActionNop);
+	}
+	if (Result != XIL_SDNET_SUCCESS) {
+		xil_printf("plane_classify action lookup failed: %s\r\n",
+			   XilSdnetReturnTypeToString(Result));
+		return XST_FAILURE;
+	}
+
+	OranLockChangeBegin(&PolicyLock);
+	PolicyCount = 0;
+	OranLockChangeEnd(&PolicyLock);
+	PolicyTxnOpen = 0;
+
+	return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/**
+*
+* Adds one entry to plane_classify. Takes effect on the next frame; frames
+* already in the pipeline are not affected.
+*
+* @param	RulePtr is the entry to add.
+*
+* @return	XST_SUCCESS to indicate success, otherwise XST_FAILURE.
+*
+* @note		An entry with the same key and mask must not already exist;
+*		delete it first to change its action, or stage the change
+*		with OranPolicyBegin.
+*
+*****************************************************************************/
+LONG OranPolicyInsertRule(const OranPolicyRule *RulePtr)
+{
+	u8 Bytes[ORAN_POLICY_ENTRY_BYTES];
+	OranTableEntry Entry;
+	XilSdnetReturnType Result;
+
+	if (PolicyTablePtr == NULL) {
+		return XST_FAILURE;
+	}
+
+	OranLockWrite(&PolicyLock);
+	if (OranPolicyTxnBusy() || (PolicyCount == ORAN_POLICY_DEPTH)) {
+		OranUnlockWrite(&PolicyLock);
+		return XST_FAILURE;
+	}
+
+	OranPolicyPackEntry(RulePtr, &Entry, Bytes);
+	Result = ORAN_SDNET_CALL(ORAN_CALL_TABLE_INSERT,
+		XilSdnetTableInsert(PolicyTablePtr, Entry.KeyPtr,
+				    Entry.MaskPtr, Entry.Priority,
+				    Entry.ActionId, Entry.ParamsPtr));
+	if (Result == XIL_SDNET_SUCCESS) {
+		OranLockChangeBegin(&PolicyLock);
+		PolicyRules[PolicyCount++] = *RulePtr;
+		OranLockChangeEnd(&PolicyLock);
+	}
+	OranUnlockWrite(&PolicyLock);
+	if (Result != XIL_SDNET_SUCCESS) {
+		xil_printf("plane_classify insert failed: %s\r\n",
+			   XilSdnetReturnTypeToString(Result));
+		return XST_FAILURE;
+	}
+
+	return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/**
+*
+* Adds an array of entries to plane_classify, one driver insert per entry
+* inside a single write sequence.
+*
+* @param	RulePtr points to Count entries.
+* @param	Count is the number of entries.
+*
+* @return	XST_SUCCESS to indicate success, otherwise XST_FAILURE.
+*
+* @note		Stops at the first entry that fails; the ones before it stay
+*		in the table.
+*
+*****************************************************************************/
+LONG OranPolicyInsertRules(const OranPolicyRule *RulePtr, u32 Count)
+{
+	u8 Bytes[ORAN_POLICY_ENTRY_BYTES];
+	OranTableEntry Entry;
+	XilSdnetReturnType Result = XIL_SDNET_SUCCESS;
+	u32 Index;
+
+	if (PolicyTablePtr == NULL) {
+		return XST_FAILURE;
+	}
+
+	OranLockWrite(&PolicyLock);
+	if (OranPolicyTxnBusy() || (Count > ORAN_POLICY_DEPTH - PolicyCount)) {
+		OranUnlockWrite(&PolicyLock);
+		return XST_FAILURE;
+	}
+
+	OranSdnetWriteSequenceBegin();
+	for (Index = 0; Index < Count; Index++) {
+		OranPolicyPackEntry(&RulePtr[Index], &Entry, Bytes);
+		Result = ORAN_SDNET_CALL(ORAN_CALL_TABLE_INSERT,
+			XilSdnetTableInsert(PolicyTablePtr, Entry.KeyPtr,
+					    Entry.MaskPtr, Entry.Priority,
+					    Entry.ActionId, Entry.ParamsPtr));
+		if (Result != XIL_SDNET_SUCCESS) {
+			break;
+		}
+		OranLockChangeBegin(&PolicyLock);
+		PolicyRules[PolicyCount++] = RulePtr[Index];
+		OranLockChangeEnd(&PolicyLock);
+	}
+	OranSdnetWriteSequenceEnd();
+	OranUnlockWrite(&PolicyLock);
+	if (Result != XIL_SDNET_SUCCESS) {
+		xil_printf("plane_classify insert stopped at entry %d of %d: "
+			   "%s\r\n", (int)Index, (int)Count,
+			   XilSdnetReturnTypeToString(Result));
+		return XST_FAILURE;
+	}
+
+	return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/**
+*
+* Removes the plane_classify entry with the same key and mask as RulePtr.
+*
+* @param	RulePtr is the entry to remove. Only Key and Mask are used.
+*
+* @return	XST_SUCCESS to indicate success, otherwise XST_FAILURE.
+*
+* @note		None.
+*
+*****************************************************************************/
+LONG OranPolicyDeleteRule(const OranPolicyRule *RulePtr)
+{
+	u8 Bytes[ORAN_POLICY_ENTRY_BYTES];
+	OranTableEntry Entry;
+	XilSdnetReturnType Result;
+	u32 Index;
+
+	if (PolicyTablePtr == NULL) {
+		return XST_FAILURE;
+	}
+
+	OranLockWrite(&PolicyLock);
+	if (OranPolicyTxnBusy()) {
+		OranUnlockWrite(&PolicyLock);
+		return XST_FAILURE;
+	}
+
+	OranPolicyPackEntry(RulePtr, &Entry, Bytes);
+	Result = ORAN_SDNET_CALL(ORAN_CALL_TABLE_DELETE,
+		XilSdnetTableDelete(PolicyTablePtr, Entry.KeyPtr,
+				    Entry.MaskPtr));
+	if (Result == XIL_SDNET_SUCCESS) {
+		Index = OranPolicyFind(PolicyRules, PolicyCount, RulePtr);
+		if (Index < PolicyCount) {
+			OranLockChangeBegin(&PolicyLock);
+			PolicyRules[Index] = PolicyRules[--PolicyCount];
+			OranLockChangeEnd(&PolicyLock);
+		}
+	}
+	OranUnlockWrite(&PolicyLock);
+	if (Result != XIL_SDNET_SUCCESS) {
+		xil_printf("plane_classify delete failed: %s\r\n",
+			   XilSdnetReturnTypeToString(Result));
+		return XST_FAILURE;
+	}
+
+	return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/**
+*
+* Starts staging a change to plane_classify. The staged set starts as a
+* copy of the entries in the table; nothing reaches the table until
+* OranPolicyCommit.
+*
+* @param	None.
+*
+* @return	XST_SUCCESS to indicate success, otherwise XST_FAILURE if a
+*		change is already staged.
+*
+* @note		Holds the table lock until OranPolicyCommit or
+*		OranPolicyAbort, which must be called from the same thread.
+*
+*****************************************************************************/
+LONG OranPolicyBegin(void)
+{
+	if (PolicyTablePtr == NULL) {
+		return XST_FAILURE;
+	}
+
+	OranLockWrite(&PolicyLock);
+	if (OranPolicyTxnBusy()) {
+		OranUnlockWrite(&PolicyLock);
+		return XST_FAILURE;
+	}
+
+	memcpy(PolicyStaged, PolicyRules, PolicyCount * sizeof(PolicyRules[0]));
+	PolicyStagedCount = PolicyCount;
+	PolicyTxnOpen = 1;
+
+	return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/**
+*
+* Empties the staged set, so that the change replaces the whole table.
+*
+* @param	None.
+*
+* @return	None.
+*
+* @note		None.
+*
+*****************************************************************************/
+void OranPolicyStageClear(void)
+{
+	OranLockWrite(&PolicyLock);
+	PolicyStagedCount = 0;
+	OranUnlockWrite(&PolicyLock);
+}
+
+/****************************************************************************/
+/**
+*
+* Adds an entry to the staged set. An entry with the same key and mask is
+* replaced.
+*
+* @param	RulePtr is the entry to stage.
+*
+* @return	XST_SUCCESS to indicate success, otherwise XST_FAILURE.
+*
+* @note		None.
+*
+*****************************************************************************/
+LONG OranPolicyStageInsert(const OranPolicyRule *RulePtr)
+{
+	u32 Index;
+	LONG Status = XST_FAILURE;
+
+	OranLockWrite(&PolicyLock);
+	if (PolicyTxnOpen) {
+		Index = OranPolicyFind(PolicyStaged, PolicyStagedCount,
+				       RulePtr);
+		if (Index < ORAN_POLICY_DEPTH) {
+			if (Index == PolicyStagedCount) {
+				PolicyStagedCount++;
+			}
+			PolicyStaged[Index] = *RulePtr;
+			Status = XST_SUCCESS;
+		}
+	}
+	OranUnlockWrite(&PolicyLock);
+
+	return Status;
+}
+
+/****************************************************************************/
+/**
+*
+* Removes the entry with the same key and mask as RulePtr from the staged
+* set.
+*
+* @param	RulePtr is the entry to remove. Only Key and Mask are used.
+*
+* @return	XST_SUCCESS to indicate success, otherwise XST_FAILURE if no
+*		such entry is staged.
+*
+* @note		None.
+*
+*****************************************************************************/
+LONG OranPolicyStageDelete(const OranPolicyRule *RulePtr)
+{
+	u32 Index;
+	LONG Status = XST_FAILURE;
+
+	OranLockWrite(&PolicyLock);
+	if (PolicyTxnOpen) {
+		Index = OranPolicyFind(PolicyStaged, PolicyStagedCount,
+				       RulePtr);
+		if (Index < PolicyStagedCount) {
+			PolicyStaged[Index] =
+				PolicyStaged[--PolicyStagedCount];
+			Status = XST_SUCCESS;
+		}
+	}
+	OranUnlockWrite(&PolicyLock);
+
+	return Status;
+}
+
+/****************************************************************************/
+/**
+*
+* Applies the staged set to plane_classify with OranTableCommit and ends the
+* change.
+*
+* @param	None.
+*
+* @return	XST_SUCCESS if the table now holds the staged set, otherwise
+*		XST_FAILURE with the table unchanged.
+*
+* @note		The table must have room for the entries added while the ones
+*		removed are still in it.
+*
+*****************************************************************************/
+LONG OranPolicyCommit(void)
+{
+	u32 Index;
+	LONG Status;
+
+	OranLockWrite(&PolicyLock);
+	if (!PolicyTxnOpen) {
+		OranUnlockWrite(&PolicyLock);
+		return XST_FAILURE;
+	}
+	PolicyTxnOpen = 0;
+
+	for (Index = 0; Index < PolicyCount; Index++) {
+		OranPolicyPackEntry(&PolicyRules[Index],
+				    &PolicyOldEntries[Index],
+				    PolicyOldBytes[Index]);
+	}
+	for (Index = 0; Index < PolicyStagedCount; Index++) {
+		OranPolicyPackEntry(&PolicyStaged[Index],
+				    &PolicyNewEntries[Index],
+				    PolicyNewBytes[Index]);
+	}
+
+	Status = OranTableCommit(PolicyTablePtr, ORAN_POLICY_KEY_BYTES,
+				 ORAN_POLICY_PARAM_BYTES, PolicyOldEntries,
+				 PolicyCount, PolicyNewEntries,
+				 PolicyStagedCount);
+	if (Status == XST_SUCCESS) {
+		OranLockChangeBegin(&PolicyLock);
+		memcpy(PolicyRules, PolicyStaged,
+		       PolicyStagedCount * sizeof(PolicyStaged[0]));
+		PolicyCount = PolicyStagedCount;
+		OranLockChangeEnd(&PolicyLock);
+	}
+
+	/* Once for this call and once for OranPolicyBegin */
+	OranUnlockWrite(&PolicyLock);
+	OranUnlockWrite(&PolicyLock);
+
+	return Status;
+}
+
+/****************************************************************************/
+/**
+*
+* Drops the staged set without touching plane_classify.
+*
+* @param	None.
+*
+* @return	None.
+*
+* @note		None.
+*
+*****************************************************************************/
+void OranPolicyAbort(void)
+{
+	OranLockWrite(&PolicyLock);
+	if (PolicyTxnOpen) {
+		PolicyTxnOpen = 0;
+		OranUnlockWrite(&PolicyLock);
+	}
+	OranUnlockWrite(&PolicyLock);
+}
+
+/****************************************************************************/
+/**
+*
+* Installs a complete set of entries in place of whatever plane_classify
+* holds.
+*
+* @param	RulePtr points to Count entries.
+* @param	Count is the number of entries, at most ORAN_POLICY_DEPTH.
+*
+* @return	XST_SUCCESS to indicate success, otherwise XST_FAILURE.
+*
+* @note		An empty table is reset and filled entry by entry;
+*		otherwise the set is committed as a change, without
+*		disturbing traffic.
+*
+*****************************************************************************/
+LONG OranPolicyLoadRules(const OranPolicyRule *RulePtr, u32 Count)
+{
+	u32 Index;
+	LONG Status = XST_SUCCESS;
+
+	if ((PolicyTablePtr == NULL) || (Count > ORAN_POLICY_DEPTH)) {
+		return XST_FAILURE;
+	}
+
+	OranLockWrite(&PolicyLock);
+	if (OranPolicyTxnBusy()) {
+		Status = XST_FAILURE;
+	} else if (PolicyCount == 0) {
+		if (ORAN_SDNET_CALL(ORAN_CALL_TABLE_RESET,
+				    XilSdnetTableReset(PolicyTablePtr)) !=
+		    XIL_SDNET_SUCCESS) {
+			Status = XST_FAILURE;
+		} else {
+			Status = OranPolicyInsertRules(RulePtr, Count);
+		}
+	} else {
+		(void)OranPolicyBegin();
+		OranPolicyStageClear();
+		for (Index = 0; (Index < Count) && (Status == XST_SUCCESS);
+		     Index++) {
+			Status = OranPolicyStageInsert(&RulePtr[Index]);
+		}
+		if (Status == XST_SUCCESS) {
+			Status = OranPolicyCommit();
+		} else {
+			OranPolicyAbort();
+		}
+	}
+	OranUnlockWrite(&PolicyLock);
+
+	return Status;
+}
+
+/****************************************************************************/
+/**
+*
+* Installs the default O-RAN plane policy in place of whatever
+* plane_classify holds.
+*
+* @param	None.
+*
+* @return	XST_SUCCESS to indicate success, otherwise XST_FAILURE.
+*
+* @note		Until this first runs every frame misses the table and keeps
+*		its ingress tdest. The first load clears the table; later ones
+*		are committed as a change, without disturbing traffic.
+*
+*****************************************************************************/
+LONG OranPolicyLoadDefaults(void)
+{
+	return OranPolicyLoadRules(OranDefaultRules,
+				   sizeof(OranDefaultRules) /
+				   sizeof(OranDefaultRules[0]));
+}
+
+/****************************************************************************/
+/**
+*
+* Copies out the entries plane_classify holds.
+*
+* @param	RulePtr receives up to MaxCount entries. May be NULL to only
+*		count them.
+* @param	MaxCount is the size of the RulePtr array.
+*
+* @return	The number of entries in the table, which may be more than
+*		MaxCount.
+*
+* @note		Does not access sdnet_0 and takes no lock. A staged change
+*		is not included.
+*
+*****************************************************************************/
+u32 OranPolicyGetRules(OranPolicyRule *RulePtr, u32 MaxCount)
+{
+	u32 Seq;
+	u32 Count;
+
+	do {
+		Seq = OranLockReadBegin(&PolicyLock);
+		Count = PolicyCount;
+		if ((RulePtr != NULL) && (Count <= ORAN_POLICY_DEPTH)) {
+			memcpy(RulePtr, PolicyRules, ((Count < MaxCount) ?
+						      Count : MaxCount) *
+			       sizeof(PolicyRules[0]));
+		}
+	} while (OranLockReadRetry(&PolicyLock, Seq));
+
+	return Count;
+}
+
+#endif /* ORAN_SDNET_CTRL */
@@ -0,0 +1,335 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file oran_sdnet.c
+*
+* Brings up the SDNet control-plane driver for sdnet_0. Register accesses
+* from the driver are offsets into the sdnet_0 AXI-Lite window; the base
+* address is kept in the environment UserCtx so the callbacks stay free of
+* globals.
+*
+* The callbacks also count register reads and writes, which is how table
+* update costs are measured (see OranSdnetMmioCounts). Between
+* OranSdnetWriteSequenceBegin and OranSdnetWriteSequenceEnd, driver error
+* messages are counted and only the first one is printed, so a failing
+* batch of thousands of entries does not spend seconds on the UART.
+*
+* A Linux agent brings the driver up with OranSdnetInitEnv and the
+* mmap-based interface of oran_env_uio.c instead of OranSdnetInit.
+*
+*****************************************************************************/
+
+/***************************** Include Files ********************************/
+
+#include "xil_io.h"
+#include "xil_printf.h"
+#include "xstatus.h"
+#include "oran_sdnet.h"
+
+#if ORAN_SDNET_CTRL
+
+/************************** Variable Definitions ****************************/
+
+static XilSdnetEnvIf OranEnvIf;
+static XilSdnetTargetCtx OranTargetCtx;
+static XilSdnetEnvIf *OranDriverEnvIfPtr;
+static XilSdnetEnvIf *OranUserEnvIfPtr;
+static OranSdnetSequenceFn OranSeqFn;
+static UINTPTR OranBaseAddress;
+static u8 OranTargetUp;
+static u32 OranMmioReads;
+static u32 OranMmioWrites;
+static u32 OranSeqDepth;
+static u32 OranSeqErrors;
+
+/*****************************************************************************/
+/*
+ * XilSdnetEnvIf callbacks
+ */
+static XilSdnetReturnType OranWordWrite32(XilSdnetEnvIf *EnvIfPtr,
+					  XilSdnetAddressType Address,
+					  uint32_t WriteValue)
+{
+	UINTPTR Base = *(UINTPTR *)EnvIfPtr->UserCtx;
+
+	OranMmioWrites++;
+	Xil_Out32(Base + Address, WriteValue);
+	return XIL_SDNET_SUCCESS;
+}
+
+static XilSdnetReturnType OranWordRead32(XilSdnetEnvIf *EnvIfPtr,
+					 XilSdnetAddressType Address,
+					 uint32_t *ReadValuePtr)
+{
+	UINTPTR Base = *(UINTPTR *)EnvIfPtr->UserCtx;
+
+	OranMmioReads++;
+	*ReadValuePtr = Xil_In32(Base + Address);
+	return XIL_SDNET_SUCCESS;
+}
+
+static XilSdnetReturnType OranLogError(XilSdnetEnvIf *EnvIfPtr,
+				       const char *MessagePtr)
+{
+	(void)EnvIfPtr;
+	/* Waits for another thread's sequence to end */
+	OranLockBus();
+	if ((OranSeqDepth == 0) || (OranSeqErrors++ == 0)) {
+		xil_printf("sdnet error: %s\r\n", MessagePtr);
+	}
+	OranUnlockBus();
+	return XIL_SDNET_SUCCESS;
+}
+
+static XilSdnetReturnType OranLogInfo(XilSdnetEnvIf *EnvIfPtr,
+				      const char *MessagePtr)
+{
+	(void)EnvIfPtr;
+	xil_printf("sdnet: %s\r\n", MessagePtr);
+	return XIL_SDNET_SUCCESS;
+}
+
+/****************************************************************************/
+/**
+*
+* Initializes the SDNet target driver for sdnet_0 and every table it holds.
+*
+* @param	BaseAddress is the AXI-Lite base address of sdnet_0, normally
+*		ORAN_SDNET_BASEADDR.
+*
+* @return	XST_SUCCESS to indicate success, otherwise XST_FAILURE.
+*
+* @note		Must be called before any OranPolicy* function.
+*
+*****************************************************************************/
+LONG OranSdnetInit(UINTPTR BaseAddress)
+{
+	XilSdnetReturnType Result;
+
+	if (OranTargetUp) {
+		return XST_SUCCESS;
+	}
+
+	OranBaseAddress = BaseAddress;
+
+	Result = XilSdnetStubEnvIf(&OranEnvIf);
+	if (Result != XIL_SDNET_SUCCESS) {
+		xil_printf("Error stubbing SDNet env: %s\r\n",
+			   XilSdnetReturnTypeToString(Result));
+		return XST_FAILURE;
+	}
+	OranEnvIf.UserCtx = (XilSdnetUserCtxType)&OranBaseAddress;
+	OranEnvIf.WordWrite32 = OranWordWrite32;
+	OranEnvIf.WordRead32 = OranWordRead32;
+	OranEnvIf.LogError = OranLogError;
+	OranEnvIf.LogInfo = OranLogInfo;
+
+	return OranSdnetInitEnv(&OranEnvIf, NULL);
+}
+
+/****************************************************************************/
+/**
+*
+* Initializes the SDNet target driver on an environment interface supplied
+* by the caller, such as the Linux one of oran_env_uio.c.
+*
+* @param	EnvIfPtr is the interface. It must stay valid until
+*		OranSdnetExit.
+* @param	SequenceFn is told when write sequences start and end, so
+*		that the interface can batch the writes in them. May be NULL.
+*
+* @return	XST_SUCCESS to indicate success, otherwise XST_FAILURE.
+*
+* @note		Does nothing if the target is already initialized.
+*
+*****************************************************************************/
+LONG OranSdnetInitEnv(XilSdnetEnvIf *EnvIfPtr,
+		      OranSdnetSequenceFn SequenceFn)
+{
+	XilSdnetReturnType Result;
+
+	if (OranTargetUp) {
+		return XST_SUCCESS;
+	}
+	if (EnvIfPtr == NULL) {
+		return XST_FAILURE;
+	}
+
+	OranUserEnvIfPtr = EnvIfPtr;
+	OranSeqFn = SequenceFn;
+#if ORAN_SDNET_TRACE
+	OranDriverEnvIfPtr = OranTraceWrap(EnvIfPtr);
+#else
+	OranDriverEnvIfPtr = EnvIfPtr;
+#endif
+	OranDriverEnvIfPtr = OranLockWrap(OranDriverEnvIfPtr);
+#if ORAN_SDNET_ARENA
+	if (OranArenaReserve(OranArenaTargetBytes(
+		&XilSdnetTargetConfig_mb_es_design_sdnet_0_1), "target") !=
+	    XST_SUCCESS) {
+		return XST_FAILURE;
+	}
+#endif
+
+	Result = ORAN_SDNET_CALL(ORAN_CALL_TARGET_INIT,
+		XilSdnetTargetInit(&OranTargetCtx, OranDriverEnvIfPtr,
+			&XilSdnetTargetConfig_mb_es_design_sdnet_0_1));
+	if (Result != XIL_SDNET_SUCCESS) {
+		xil_printf("Error initializing SDNet target: %s\r\n",
+			   XilSdnetReturnTypeToString(Result));
+		return XST_FAILURE;
+	}
+
+	OranTargetUp = 1;
+	return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/**
+*
+* Releases the SDNet target driver. Table contents in hardware are left as
+* they are.
+*
+* @param	None.
+*
+* @return	None.
+*
+* @note		None.
+*
+*****************************************************************************/
+void OranSdnetExit(void)
+{
+	if (OranTargetUp) {
+		(void)XilSdnetTargetExit(&OranTargetCtx);
+		OranTargetUp = 0;
+	}
+}
+
+/****************************************************************************/
+/**
+*
+* Returns the target context set up by OranSdnetInit.
+*
+* @param	None.
+*
+* @return	The target context, or NULL if the target is not initialized.
+*
+* @note		None.
+*
+*****************************************************************************/
+XilSdnetTargetCtx *OranSdnetTarget(void)
+{
+	return OranTargetUp ? &OranTargetCtx : NULL;
+}
+
+/****************************************************************************/
+/**
+*
+* Returns the environment interface handed to the SDNet drivers.
+*
+* @param	None.
+*
+* @return	The environment interface, or NULL if the target is not
+*		initialized.
+*
+* @note		None.
+*
+*****************************************************************************/
+XilSdnetEnvIf *OranSdnetEnvIf(void)
+{
+	return OranTargetUp ? OranDriverEnvIfPtr : NULL;
+}
+
+/****************************************************************************/
+/**
+*
+* Starts a run of table updates that belong together, such as a batch
+* insert. Calls may nest; the run ends with the outermost
+* OranSdnetWriteSequenceEnd.
+*
+* @param	None.
+*
+* @return	None.
+*
+* @note		The run holds the register interface lock, so no other
+*		thread writes sdnet_0 registers inside it. Table locks must
+*		be taken before the run starts.
+*
+*****************************************************************************/
+void OranSdnetWriteSequenceBegin(void)
+{
+	OranLockBus();
+	if (OranSeqDepth++ == 0) {
+		OranSeqErrors = 0;
+		if (OranSeqFn != NULL) {
+			OranSeqFn(OranUserEnvIfPtr, 1);
+		}
+	}
+}
+
+/****************************************************************************/
+/**
+*
+* Ends a run started by OranSdnetWriteSequenceBegin.
+*
+* @param	None.
+*
+* @return	None.
+*
+* @note		Reports how many driver errors the run suppressed.
+*
+*****************************************************************************/
+void OranSdnetWriteSequenceEnd(void)
+{
+	if (OranSeqDepth == 0) {
+		return;
+	}
+	if (--OranSeqDepth == 0) {
+		if (OranSeqFn != NULL) {
+			OranSeqFn(OranUserEnvIfPtr, 0);
+		}
+		if (OranSeqErrors > 1) {
+			xil_printf("sdnet: %d more errors in the same "
+				   "sequence\r\n", (int)(OranSeqErrors - 1));
+		}
+	}
+	OranUnlockBus();
+}
+
+/****************************************************************************/
+/**
+*
+* Returns the number of register reads and writes the SDNet drivers have
+* made through the environment interface.
+*
+* @param	ReadsPtr receives the read count, may be NULL.
+* @param	WritesPtr receives the write count, may be NULL.
+* @param	Clear restarts both counts when non-zero.
+*
+* @return	None.
+*
+* @note		Reads are what cost: each one waits for a round trip through
+*		the AXI interconnect, while writes are posted.
+*
+*****************************************************************************/
+void OranSdnetMmioCounts(u32 *ReadsPtr, u32 *WritesPtr, u8 Clear)
+{
+	OranLockBus();
+	if (ReadsPtr != NULL) {
+		*ReadsPtr = OranMmioReads;
+	}
+	if (WritesPtr != NULL) {
+		*WritesPtr = OranMmioWrites;
+	}
+	if (Clear) {
+		OranMmioReads = 0;
+		OranMmioWrites = 0;
+	}
+	OranUnlockBus();
+}
+
+#endif /* ORAN_SDNET_CTRL */
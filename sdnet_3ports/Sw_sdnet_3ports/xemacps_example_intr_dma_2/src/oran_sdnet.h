@@ -0,0 +1,589 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file oran_sdnet.h
+*
+* Control plane for the SDNet O-RAN classifier (sdnet_0 in mb_es_design).
+*
+* The ingress pipeline in main.json steers frames with a single ternary
+* table, MyProcessing.plane_classify, instead of fixed conditionals. The key
+* is, from most to least significant field:
+*
+*	axis_tid(8) : eth.type(16) : vlan[0].$valid$(1) : vlan[0].pcp(3) :
+*	ecpri.$valid$(1) : ecpri.message_type(8) : roe.$valid$(1) :
+*	roe.RoEsubType(8)
+*
+* and a hit runs set_plane(tdest, prio), which writes metadata.axis_tdest and
+* metadata.prio. A miss runs NoAction, so the frame keeps the tdest it came
+* in with. Entries are written at run time through XilSdnetTableInsert, so
+* plane steering can be changed without rebuilding the bitstream.
+*
+* eCPRI IQ data and real-time control frames also carry PC_ID/RTC_ID and
+* SEQ_ID, which the parser extracts into ecpri_id. Those frames go through a
+* second, exact-match table, MyProcessing.eaxc_steer, keyed on
+*
+*	axis_tid(8) : ecpri_id.pc_id(16)
+*
+* It runs the same set_plane action.
+*
+* Every frame is finally counted in MyProcessing.plane_stats and metered in
+* MyProcessing.port_meter, both indexed by
+*
+*	plane(3) : axis_tid(2)
+*
+* where plane is one of ORAN_STATS_PLANE_* below.
+*
+* The control plane is split by table and extern:
+*
+*	oran_sdnet.c	driver bring-up and register access
+*	oran_policy.c	plane_classify
+*	oran_eaxc.c	eaxc_steer
+*	oran_table.c	make-before-break commits for either table
+*	oran_stats.c	plane_stats
+*	oran_meter.c	port_meter
+*	oran_snapshot.c	saving and restoring both tables
+*	oran_lock.c	table locks for several threads
+*	oran_arena.c	driver heap on the standalone BSP
+*	oran_env_uio.c	register access from Linux
+*	oran_trace.c	register access tracing
+*
+*****************************************************************************/
+#ifndef ORAN_SDNET_H
+#define ORAN_SDNET_H
+
+/***************************** Include Files ********************************/
+
+#include "xil_types.h"
+#include "xparameters.h"
+
+/*
+ * Build the SDNet control plane: the table drivers and everything else
+ * declared below. It needs libsdnetdrv, built from
+ * sdnet_3ports.ip_user_files/mem_init_files with
+ * PLATFORM=a53_standalone.mak and added to the linker libraries as
+ * sdnetdrv, and an sdnet_0 regenerated from main.json, whose
+ * plane_classify and eaxc_steer tables the committed bitstream and
+ * mb_es_design_sdnet_0_1_defs.h do not have yet. Off, the files of the
+ * control plane build empty and main() leaves sdnet_0 as it is.
+ */
+#ifndef ORAN_SDNET_CTRL
+#define ORAN_SDNET_CTRL		0
+#endif
+
+#if ORAN_SDNET_CTRL
+#include "sdnet_target.h"
+#include "mb_es_design_sdnet_0_1_defs.h"
+
+/************************** Constant Definitions ****************************/
+
+/*
+ * AXI-Lite window of sdnet_0, see SEG_sdnet_0_Reg in the address editor.
+ */
+#ifdef XPAR_SDNET_0_BASEADDR
+#define ORAN_SDNET_BASEADDR	XPAR_SDNET_0_BASEADDR
+#else
+#define ORAN_SDNET_BASEADDR	0x80020000
+#endif
+
+#define ORAN_POLICY_TABLE_NAME	"MyProcessing.plane_classify"
+#define ORAN_POLICY_ACTION_SET	"MyProcessing.set_plane"
+#define ORAN_POLICY_ACTION_NOP	"NoAction"
+
+#define ORAN_POLICY_KEY_BITS	46
+#define ORAN_POLICY_KEY_BYTES	((ORAN_POLICY_KEY_BITS + 7) / 8)
+#define ORAN_POLICY_PARAM_BYTES	5	/* tdest(32) : prio(8) */
+
+#define ORAN_EAXC_TABLE_NAME	"MyProcessing.eaxc_steer"
+#define ORAN_EAXC_KEY_BITS	24
+#define ORAN_EAXC_KEY_BYTES	((ORAN_EAXC_KEY_BITS + 7) / 8)
+#define ORAN_EAXC_DEPTH		256	/* max_size of eaxc_steer */
+#define ORAN_EAXC_NONE		0xFFFF
+
+/*
+ * Keep an indexed copy of eaxc_steer for queries, about 6 KB with the
+ * buckets below; 0 sends queries to the table driver instead
+ */
+#ifndef ORAN_EAXC_INDEX
+#define ORAN_EAXC_INDEX		1
+#endif
+#define ORAN_EAXC_HASH_BITS	8
+#define ORAN_EAXC_HASH_SIZE	(1 << ORAN_EAXC_HASH_BITS)
+#define ORAN_POLICY_DEPTH	64	/* max_size of plane_classify */
+
+/*
+ * Largest table OranTableCommit can diff; a power of two
+ */
+#ifndef ORAN_TABLE_TXN_MAX
+#define ORAN_TABLE_TXN_MAX	256
+#endif
+
+/*
+ * Record register accesses of the SDNet drivers (oran_trace.c). Must be the
+ * same in every file, so set it on the compiler command line.
+ */
+#ifndef ORAN_SDNET_TRACE
+#define ORAN_SDNET_TRACE	0
+#endif
+#ifndef ORAN_TRACE_RECORDS
+#define ORAN_TRACE_RECORDS	4096	/* 64 KB */
+#endif
+#define ORAN_TRACE_READ		0
+#define ORAN_TRACE_WRITE	1
+
+/*
+ * Writes the Linux environment (oran_env_uio.c) queues in a write sequence
+ * before issuing them
+ */
+#ifndef ORAN_ENV_UIO_BATCH
+#define ORAN_ENV_UIO_BATCH	64
+#endif
+
+/*
+ * Arena serving the allocations of libsdnetdrv (oran_arena.c). Off for
+ * Linux, where the drivers use the C library heap.
+ */
+#ifndef ORAN_SDNET_ARENA
+#if defined(__linux__)
+#define ORAN_SDNET_ARENA	0
+#else
+#define ORAN_SDNET_ARENA	1
+#endif
+#endif
+#ifndef ORAN_ARENA_SIZE
+#define ORAN_ARENA_SIZE		0x10000	/* 64 KB */
+#endif
+#define ORAN_ARENA_ALIGN	16
+
+/*
+ * Keep a table snapshot in raw sectors of the SD card from
+ * ORAN_SNAPSHOT_SD_SECTOR on. They must be outside every partition; the
+ * default is in the gap in front of the first partition of a card laid
+ * out with 1 MB alignment.
+ */
+#ifndef ORAN_SNAPSHOT_SD
+#define ORAN_SNAPSHOT_SD	0
+#endif
+#ifndef ORAN_SNAPSHOT_SD_SECTOR
+#define ORAN_SNAPSHOT_SD_SECTOR	1024	/* 512 KB into the card */
+#endif
+#define ORAN_SNAPSHOT_VERSION	1
+#define ORAN_SNAPSHOT_MAX_BYTES	8192	/* both tables full, 3.9 KB */
+
+/*
+ * Allow the tables to be changed and queried from several threads
+ * (oran_lock.c). The standalone application is single threaded.
+ */
+#ifndef ORAN_SDNET_THREADS
+#if defined(__linux__)
+#define ORAN_SDNET_THREADS	1
+#else
+#define ORAN_SDNET_THREADS	0
+#endif
+#endif
+#if ORAN_SDNET_THREADS
+#include <pthread.h>
+#endif
+
+/*
+ * Wraps a driver call that may touch sdnet_0 registers, so that the
+ * accesses it makes are put down to it in the trace
+ */
+#if ORAN_SDNET_TRACE
+#define ORAN_SDNET_CALL(Call, Expr)	\
+	(OranTraceEnter(Call), OranTraceLeave(Expr))
+#else
+#define ORAN_SDNET_CALL(Call, Expr)	(Expr)
+#endif
+
+/*
+ * eAxC ID layout inside PC_ID/RTC_ID. The split is configured per RU (O-RAN
+ * WG4 CUS 3.1.3.1.6); these defaults give each subfield 4 bits.
+ */
+#define ORAN_EAXC_BANDSECTOR_BITS	4
+#define ORAN_EAXC_CC_BITS		4
+#define ORAN_EAXC_RUPORT_BITS		4
+
+#define ORAN_EAXC_ID(DuPort, BandSector, Cc, RuPort)			\
+	((u16)(((((((u32)(DuPort) << ORAN_EAXC_BANDSECTOR_BITS) |	\
+		   (BandSector)) << ORAN_EAXC_CC_BITS) | (Cc))		\
+		<< ORAN_EAXC_RUPORT_BITS) | (RuPort)))
+
+/*
+ * Read the plane_stats counters (oran_stats.c). The counter block is not
+ * in the address map of the sdnet_0 in this tree, so leave this off until
+ * ORAN_STATS_OFFSET and the registers below have been checked against the
+ * regenerated sdnet_0.
+ */
+#ifndef ORAN_SDNET_STATS
+#define ORAN_SDNET_STATS	0
+#endif
+
+/*
+ * plane_stats counter block, relative to ORAN_SDNET_BASEADDR. Writing
+ * ORAN_STATS_CTRL_LATCH copies every cell into holding registers in one
+ * go; the cells are then read back as a linear block of
+ * {packets lo, packets hi, bytes lo, bytes hi} words.
+ */
+#define ORAN_STATS_OFFSET	0x8000
+#define ORAN_STATS_CTRL_REG	0x00
+#define ORAN_STATS_STATUS_REG	0x04
+#define ORAN_STATS_DATA_REG	0x100
+#define ORAN_STATS_CTRL_LATCH	0x1
+#define ORAN_STATS_STATUS_BUSY	0x1
+#define ORAN_STATS_LATCH_POLLS	1000
+
+#define ORAN_STATS_NUM_PLANES	8
+#define ORAN_STATS_NUM_TIDS	4
+
+#define ORAN_STATS_PLANE_OTHER		0	/* M-plane and anything else */
+#define ORAN_STATS_PLANE_UPLANE		1	/* eCPRI IQ data */
+#define ORAN_STATS_PLANE_CPLANE		2	/* eCPRI real-time control */
+#define ORAN_STATS_PLANE_ECPRI_OTHER	3	/* e.g. delay measurement */
+#define ORAN_STATS_PLANE_ROE		4
+#define ORAN_STATS_PLANE_SPLANE		5	/* PTP */
+#define ORAN_STATS_PLANE_PARSER_ERROR	6
+
+/*
+ * Program the port_meter cells (oran_meter.c). Like the plane_stats block,
+ * the meter block is not in the address map of the sdnet_0 in this tree;
+ * leave this off until ORAN_METER_OFFSET has been checked. Without it the
+ * cells keep their reset rates.
+ */
+#ifndef ORAN_SDNET_METER
+#define ORAN_SDNET_METER	0
+#endif
+
+/*
+ * port_meter block, relative to ORAN_SDNET_BASEADDR. The rates of one cell
+ * are written to the staging registers and then applied together by
+ * writing the cell index with ORAN_METER_CTRL_APPLY, so the meter never
+ * runs with half of a new configuration.
+ */
+#define ORAN_METER_OFFSET	0x9000
+#define ORAN_METER_CTRL_REG	0x00
+#define ORAN_METER_STATUS_REG	0x04
+#define ORAN_METER_CIR_REG	0x10	/* kbit/s */
+#define ORAN_METER_CBS_REG	0x14	/* bytes */
+#define ORAN_METER_PIR_REG	0x18	/* kbit/s, 0 leaves the cell unmetered */
+#define ORAN_METER_PBS_REG	0x1C	/* bytes */
+#define ORAN_METER_CTRL_APPLY	0x80000000
+#define ORAN_METER_STATUS_BUSY	0x1
+#define ORAN_METER_APPLY_POLLS	1000
+
+/* Smallest burst that still lets a full-size tagged frame through */
+#define ORAN_METER_MIN_BURST	1522
+
+/*
+ * Ingress ports as seen in axis_tid
+ */
+#define ORAN_TID_10G_0		0x00
+#define ORAN_TID_10G_1		0x01
+#define ORAN_TID_GEM3		0x02
+
+/*
+ * Values written to metadata.prio. Larger is more urgent; frames that miss
+ * the table leave the pipeline with ORAN_PRIO_BEST_EFFORT.
+ */
+#define ORAN_PRIO_BEST_EFFORT	0
+#define ORAN_PRIO_MPLANE	1
+#define ORAN_PRIO_UPLANE	2
+#define ORAN_PRIO_CPLANE	3
+#define ORAN_PRIO_SPLANE	4
+
+#define ORAN_ETHTYPE_ECPRI	0xAEFE
+#define ORAN_ETHTYPE_ROE	0xFC3D
+#define ORAN_ETHTYPE_PTP	0x88F7
+
+/**************************** Type Definitions ******************************/
+
+/*
+ * Fields of the plane_classify key. Used both for the key and for its mask
+ * (a mask bit of 1 means the key bit is compared).
+ */
+typedef struct {
+	u8 AxisTid;
+	u16 EthType;
+	u8 VlanValid;
+	u8 VlanPcp;
+	u8 EcpriValid;
+	u8 EcpriMsgType;
+	u8 RoeValid;
+	u8 RoeSubType;
+} OranPolicyKey;
+
+/*
+ * One plane_classify entry. Among several matching entries the one with the
+ * lowest Priority wins. With Keep set the entry runs NoAction and Tdest and
+ * Prio are ignored.
+ */
+typedef struct {
+	OranPolicyKey Key;
+	OranPolicyKey Mask;
+	u32 Priority;
+	u32 Tdest;
+	u8 Prio;
+	u8 Keep;
+} OranPolicyRule;
+
+/*
+ * One eaxc_steer entry: frames from AxisTid whose PC_ID/RTC_ID equals PcId
+ * leave with Tdest and Prio.
+ */
+typedef struct {
+	u8 AxisTid;
+	u16 PcId;
+	u32 Tdest;
+	u8 Prio;
+} OranEaxcRule;
+
+/*
+ * One packed entry for OranTableCommit, in the byte layout of the table
+ * driver. MaskPtr is NULL and Priority ignored for exact-match tables;
+ * deletes use only KeyPtr and MaskPtr.
+ */
+typedef struct {
+	u8 *KeyPtr;
+	u8 *MaskPtr;
+	u32 Priority;
+	u32 ActionId;
+	u8 *ParamsPtr;
+} OranTableEntry;
+
+/*
+ * Driver calls told apart in the trace
+ */
+typedef enum {
+	ORAN_CALL_NONE,		/* accesses outside a marked call */
+	ORAN_CALL_TARGET_INIT,
+	ORAN_CALL_TABLE_INSERT,
+	ORAN_CALL_TABLE_UPDATE,
+	ORAN_CALL_TABLE_DELETE,
+	ORAN_CALL_TABLE_RESET,
+	ORAN_CALL_COUNT
+} OranSdnetCall;
+
+/*
+ * One register access. Ticks count XTime from OranTraceStart and Seq
+ * numbers the driver calls, so that the records of one call can be
+ * grouped.
+ */
+typedef struct {
+	u32 Ticks;
+	u32 Address;		/* offset in the sdnet_0 window */
+	u32 Value;
+	u8 Op;			/* ORAN_TRACE_READ or ORAN_TRACE_WRITE */
+	u8 Call;		/* OranSdnetCall */
+	u16 Seq;
+} OranTraceRecord;
+
+/*
+ * Called by OranSdnetWriteSequenceBegin (Begin 1) and by the outermost
+ * OranSdnetWriteSequenceEnd (Begin 0) with the interface given to
+ * OranSdnetInitEnv
+ */
+typedef void (*OranSdnetSequenceFn)(XilSdnetEnvIf *EnvIfPtr, u8 Begin);
+
+/*
+ * sdnet_0 register window mapped into a Linux process, see oran_env_uio.c
+ */
+typedef struct {
+	volatile u32 *RegPtr;
+	u32 Size;
+	int Fd;
+	u8 Batch;		/* in a write sequence, writes are queued */
+	u32 Pending;
+	u32 PendAddress[ORAN_ENV_UIO_BATCH];
+	u32 PendValue[ORAN_ENV_UIO_BATCH];
+	u32 Reads;
+	u32 Writes;
+	u32 Flushes;		/* batches of queued writes issued */
+} OranEnvUio;
+
+/*
+ * Lock of a table or of the register interface, see oran_lock.c. Seq is
+ * odd while the copy of the table kept here is being changed.
+ */
+typedef struct {
+#if ORAN_SDNET_THREADS
+	pthread_mutex_t Writer;	/* recursive */
+#endif
+	u32 Seq;
+	u8 Ready;
+} OranLock;
+
+/*
+ * Arena use, see OranArenaGetStats
+ */
+typedef struct {
+	u32 Size;
+	u32 Reserved;		/* estimated from the table configurations */
+	u32 Used;
+	u32 HighWater;
+	u32 Live;		/* blocks allocated and not freed */
+	u32 Allocs;
+	u32 Failures;
+	u32 Stranded;		/* bytes freed below the top, back on reset */
+} OranArenaStats;
+
+/*
+ * One pass over plane_stats, taken with a single latch
+ */
+typedef struct {
+	u64 Packets;
+	u64 Bytes;
+} OranStatsCell;
+
+typedef struct {
+	OranStatsCell Cell[ORAN_STATS_NUM_PLANES][ORAN_STATS_NUM_TIDS];
+} OranStatsSnapshot;
+
+/*
+ * Rates of one port_meter cell. Frames within CirKbps/Cbs are green, the
+ * excess up to PirKbps/Pbs yellow and the rest red.
+ */
+typedef struct {
+	u32 CirKbps;
+	u32 Cbs;
+	u32 PirKbps;
+	u32 Pbs;
+} OranMeterConfig;
+
+/************************** Function Prototypes *****************************/
+
+/*
+ * SDNet target bring-up, implemented in oran_sdnet.c
+ */
+LONG OranSdnetInit(UINTPTR BaseAddress);
+LONG OranSdnetInitEnv(XilSdnetEnvIf *EnvIfPtr,
+		      OranSdnetSequenceFn SequenceFn);
+void OranSdnetExit(void);
+XilSdnetTargetCtx *OranSdnetTarget(void);
+XilSdnetEnvIf *OranSdnetEnvIf(void);
+void OranSdnetWriteSequenceBegin(void);
+void OranSdnetWriteSequenceEnd(void);
+void OranSdnetMmioCounts(u32 *ReadsPtr, u32 *WritesPtr, u8 Clear);
+
+/*
+ * Transactional table updates, implemented in oran_table.c
+ */
+LONG OranTableCommit(XilSdnetTableCtx *TablePtr, u32 KeyBytes,
+		     u32 ParamBytes, const OranTableEntry *OldPtr,
+		     u32 OldCount, const OranTableEntry *NewPtr,
+		     u32 NewCount);
+
+/*
+ * Driver register trace, implemented in oran_trace.c
+ */
+XilSdnetEnvIf *OranTraceWrap(XilSdnetEnvIf *InnerPtr);
+void OranTraceStart(void);
+void OranTraceStop(void);
+void OranTraceEnter(OranSdnetCall Call);
+XilSdnetReturnType OranTraceLeave(XilSdnetReturnType Result);
+const OranTraceRecord *OranTraceRecords(u32 *CountPtr);
+void OranTracePrint(void);
+LONG OranTraceReplay(XilSdnetEnvIf *EnvIfPtr, const OranTraceRecord *RecordPtr,
+		     u32 Count, u32 *MismatchPtr);
+
+/*
+ * Driver allocation arena, implemented in oran_arena.c
+ */
+void *OranArenaMalloc(size_t Size);
+void *OranArenaCalloc(size_t Count, size_t Size);
+void *OranArenaRealloc(void *Ptr, size_t Size);
+void OranArenaFree(void *Ptr);
+u32 OranArenaCamBytes(const XilSdnetCamConfig *CamConfigPtr,
+		      XilSdnetTableMode Mode);
+u32 OranArenaTargetBytes(const XilSdnetTargetConfig *ConfigPtr);
+LONG OranArenaReserve(u32 Bytes, const char *WhatPtr);
+void OranArenaGetStats(OranArenaStats *StatsPtr);
+void OranArenaPrint(void);
+
+/*
+ * Table and register interface locks, implemented in oran_lock.c
+ */
+void OranLockInit(OranLock *LockPtr);
+void OranLockWrite(OranLock *LockPtr);
+void OranUnlockWrite(OranLock *LockPtr);
+void OranLockChangeBegin(OranLock *LockPtr);
+void OranLockChangeEnd(OranLock *LockPtr);
+u32 OranLockReadBegin(const OranLock *LockPtr);
+u8 OranLockReadRetry(const OranLock *LockPtr, u32 Seq);
+XilSdnetEnvIf *OranLockWrap(XilSdnetEnvIf *InnerPtr);
+void OranLockBus(void);
+void OranUnlockBus(void);
+
+/*
+ * Linux register access, implemented in oran_env_uio.c
+ */
+LONG OranEnvUioFind(const char *NamePtr, char *PathPtr, u32 PathSize);
+LONG OranEnvUioOpen(OranEnvUio *UioPtr, XilSdnetEnvIf *EnvIfPtr,
+		    const char *PathPtr, u64 Offset, u32 Size);
+void OranEnvUioSequence(XilSdnetEnvIf *EnvIfPtr, u8 Begin);
+void OranEnvUioClose(OranEnvUio *UioPtr);
+
+/*
+ * Plane classification table, implemented in oran_policy.c
+ */
+LONG OranPolicyInit(void);
+LONG OranPolicyInsertRule(const OranPolicyRule *RulePtr);
+LONG OranPolicyDeleteRule(const OranPolicyRule *RulePtr);
+LONG OranPolicyInsertRules(const OranPolicyRule *RulePtr, u32 Count);
+LONG OranPolicyBegin(void);
+void OranPolicyStageClear(void);
+LONG OranPolicyStageInsert(const OranPolicyRule *RulePtr);
+LONG OranPolicyStageDelete(const OranPolicyRule *RulePtr);
+LONG OranPolicyCommit(void);
+void OranPolicyAbort(void);
+LONG OranPolicyLoadRules(const OranPolicyRule *RulePtr, u32 Count);
+LONG OranPolicyLoadDefaults(void);
+u32 OranPolicyGetRules(OranPolicyRule *RulePtr, u32 MaxCount);
+void OranPolicyPackKey(const OranPolicyKey *KeyPtr, u8 *BytePtr);
+
+/*
+ * Per-eAxC steering table, implemented in oran_eaxc.c
+ */
+LONG OranEaxcInit(void);
+LONG OranEaxcInsertRule(const OranEaxcRule *RulePtr);
+LONG OranEaxcUpdateRule(const OranEaxcRule *RulePtr);
+LONG OranEaxcDeleteRule(u8 AxisTid, u16 PcId);
+LONG OranEaxcReset(void);
+void OranEaxcExit(void);
+LONG OranEaxcGetRule(u8 AxisTid, u16 PcId, OranEaxcRule *RulePtr);
+u32 OranEaxcGetByResponse(u32 Tdest, u8 Prio, OranEaxcRule *RulePtr,
+			  u32 MaxCount);
+u32 OranEaxcGetRules(OranEaxcRule *RulePtr, u32 MaxCount);
+LONG OranEaxcAudit(void);
+LONG OranEaxcBench(u32 Count);
+
+/*
+ * Table snapshots, implemented in oran_snapshot.c
+ */
+LONG OranSnapshotSave(u8 *BufPtr, u32 Size, u32 *LengthPtr);
+LONG OranSnapshotCheck(const u8 *BufPtr, u32 Length);
+LONG OranSnapshotRestore(const u8 *BufPtr, u32 Length);
+LONG OranSnapshotStore(void);
+LONG OranSnapshotBoot(void);
+
+/*
+ * Plane counters, implemented in oran_stats.c
+ */
+LONG OranStatsRead(OranStatsSnapshot *SnapshotPtr);
+void OranStatsDelta(const OranStatsSnapshot *PrevPtr,
+		    const OranStatsSnapshot *CurPtr,
+		    OranStatsSnapshot *DeltaPtr);
+void OranStatsPrint(const OranStatsSnapshot *SnapshotPtr);
+
+/*
+ * Ingress meters, implemented in oran_meter.c
+ */
+LONG OranMeterSet(u8 Plane, u8 AxisTid, const OranMeterConfig *ConfigPtr);
+LONG OranMeterClear(u8 Plane, u8 AxisTid);
+LONG OranMeterLoadDefaults(void);
+
+#endif /* ORAN_SDNET_CTRL */
+
+#endif /* ORAN_SDNET_H */
@@ -0,0 +1,672 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file oran_snapshot.c
+*
+* Snapshots of the sdnet_0 tables for a warm restart.
+*
+* After a reset the tables are empty and every entry has to be put back.
+* A snapshot holds what was in them, taken from the copies oran_policy.c
+* and oran_eaxc.c keep, so a restart does not have to rebuild the policy
+* one call at a time. The CAM drivers keep their placement state to
+* themselves and offer no way to load it, so a restore still goes through
+* them, but as one reset and one write sequence per table, with no
+* per-entry lookups on the application side.
+*
+* The format is little-endian and independent of structure layout:
+*
+*	header (ORAN_SNAPSHOT_HEADER_BYTES)
+*		magic, format version, section count, IP version of
+*		sdnet_0, hash of the table configuration, payload length,
+*		payload hash, header hash
+*	one section per table with a CAM, in XilSdnetTargetConfig order
+*		table index, entry size, entry count, entries
+*
+* A snapshot is only restored into the bitstream it was taken from: the IP
+* version (XilSdnetTargetBuildInfoGetIpVersion, 0.0.0 where the design has
+* no build information block) and the hash over name, mode, key format,
+* depth and response width of every table must both match.
+*
+* With ORAN_SNAPSHOT_SD the snapshot lives in raw sectors of the SD card,
+* see OranSnapshotBoot.
+*
+*****************************************************************************/
+
+/***************************** Include Files ********************************/
+
+#include <string.h>
+#include "xil_printf.h"
+#include "xstatus.h"
+#include "xtime_l.h"
+#include "oran_sdnet.h"
+#if ORAN_SNAPSHOT_SD
+#include "xsdps.h"
+#endif
+
+#if ORAN_SDNET_CTRL
+
+/************************** Constant Definitions ****************************/
+
+#define ORAN_SNAPSHOT_MAGIC		0x4E53524F	/* "ORSN" */
+#define ORAN_SNAPSHOT_HEADER_BYTES	32
+#define ORAN_SNAPSHOT_SECTIONS_AT	6	/* header offsets */
+#define ORAN_SNAPSHOT_PAYLOAD_AT	16
+#define ORAN_SNAPSHOT_HEADER_HASH_AT	28
+
+/*
+ * Entries as stored: key and mask fields one by one, then priority,
+ * tdest, prio and keep for plane_classify; axis_tid, pc_id, tdest and prio
+ * for eaxc_steer
+ */
+#define ORAN_SNAPSHOT_KEY_BYTES		9
+#define ORAN_SNAPSHOT_POLICY_BYTES	(2 * ORAN_SNAPSHOT_KEY_BYTES + 10)
+#define ORAN_SNAPSHOT_EAXC_BYTES	8
+
+#define ORAN_SNAPSHOT_SD_BLOCK		512
+
+/**************************** Type Definitions ******************************/
+
+/*
+ * Write or read position in a snapshot buffer. Once a write runs past
+ * Size, or a read past the end, Overrun is set and nothing more moves.
+ */
+typedef struct {
+	u8 *BufPtr;
+	const u8 *DataPtr;
+	u32 Offset;
+	u32 Size;
+	u8 Overrun;
+} OranSnapshotCursor;
+
+/************************** Variable Definitions ****************************/
+
+static OranPolicyRule SnapshotPolicy[ORAN_POLICY_DEPTH];
+static OranEaxcRule SnapshotEaxc[ORAN_EAXC_DEPTH];
+
+#if ORAN_SNAPSHOT_SD
+static XSdPs SnapshotSd;
+static u8 SnapshotSdUp;
+static u8 SnapshotSdBuf[ORAN_SNAPSHOT_MAX_BYTES] __attribute__((aligned(64)));
+#endif
+
+/*****************************************************************************/
+/*
+ * FNV-1a, continued from Hash
+ */
+static u32 OranSnapshotHash(u32 Hash, const void *DataPtr, u32 Bytes)
+{
+	const u8 *BytePtr = DataPtr;
+	u32 Index;
+
+	for (Index = 0; Index < Bytes; Index++) {
+		Hash = (Hash ^ BytePtr[Index]) * 16777619U;
+	}
+
+	return Hash;
+}
+
+static u32 OranSnapshotHashWord(u32 Hash, u32 Value)
+{
+	u8 Bytes[4];
+
+	Bytes[0] = (u8)Value;
+	Bytes[1] = (u8)(Value >> 8);
+	Bytes[2] = (u8)(Value >> 16);
+	Bytes[3] = (u8)(Value >> 24);
+
+	return OranSnapshotHash(Hash, Bytes, sizeof(Bytes));
+}
+
+static void OranSnapshotPut(OranSnapshotCursor *CurPtr, u32 Value, u32 Bytes)
+{
+	u32 Index;
+
+	if (CurPtr->Overrun || (Bytes > CurPtr->Size - CurPtr->Offset)) {
+		CurPtr->Overrun = 1;
+		return;
+	}
+	for (Index = 0; Index < Bytes; Index++) {
+		CurPtr->BufPtr[CurPtr->Offset++] = (u8)(Value >> (8 * Index));
+	}
+}
+
+static u32 OranSnapshotGet(OranSnapshotCursor *CurPtr, u32 Bytes)
+{
+	u32 Value = 0;
+	u32 Index;
+
+	if (CurPtr->Overrun || (Bytes > CurPtr->Size - CurPtr->Offset)) {
+		CurPtr->Overrun = 1;
+		return 0;
+	}
+	for (Index = 0; Index < Bytes; Index++) {
+		Value |= (u32)CurPtr->DataPtr[CurPtr->Offset++] << (8 * Index);
+	}
+
+	return Value;
+}
+
+static void OranSnapshotPutKey(OranSnapshotCursor *CurPtr,
+			       const OranPolicyKey *KeyPtr)
+{
+	OranSnapshotPut(CurPtr, KeyPtr->AxisTid, 1);
+	OranSnapshotPut(CurPtr, KeyPtr->EthType, 2);
+	OranSnapshotPut(CurPtr, KeyPtr->VlanValid, 1);
+	OranSnapshotPut(CurPtr, KeyPtr->VlanPcp, 1);
+	OranSnapshotPut(CurPtr, KeyPtr->EcpriValid, 1);
+	OranSnapshotPut(CurPtr, KeyPtr->EcpriMsgType, 1);
+	OranSnapshotPut(CurPtr, KeyPtr->RoeValid, 1);
+	OranSnapshotPut(CurPtr, KeyPtr->RoeSubType, 1);
+}
+
+static void OranSnapshotGetKey(OranSnapshotCursor *CurPtr,
+			       OranPolicyKey *KeyPtr)
+{
+	KeyPtr->AxisTid = (u8)OranSnapshotGet(CurPtr, 1);
+	KeyPtr->EthType = (u16)OranSnapshotGet(CurPtr, 2);
+	KeyPtr->VlanValid = (u8)OranSnapshotGet(CurPtr, 1);
+	KeyPtr->VlanPcp = (u8)OranSnapshotGet(CurPtr, 1);
+	KeyPtr->EcpriValid = (u8)OranSnapshotGet(CurPtr, 1);
+	KeyPtr->EcpriMsgType = (u8)OranSnapshotGet(CurPtr, 1);
+	KeyPtr->RoeValid = (u8)OranSnapshotGet(CurPtr, 1);
+	KeyPtr->RoeSubType = (u8)OranSnapshotGet(CurPtr, 1);
+}
+
+/*
+ * IP version of sdnet_0, 0.0.0 if the design has no build information
+ * block
+ */
+static LONG OranSnapshotIpVersion(XilSdnetVersion *VersionPtr)
+{
+	XilSdnetTargetBuildInfoCtx *BuildInfoPtr;
+	XilSdnetReturnType Result;
+
+	memset(VersionPtr, 0, sizeof(*VersionPtr));
+	Result = XilSdnetTargetGetBuildInfoDrv(OranSdnetTarget(),
+					       &BuildInfoPtr);
+	if (Result == XIL_SDNET_TARGET_ERR_MGMT_DRV_NOT_AVAILABLE) {
+		return XST_SUCCESS;
+	}
+	if (Result == XIL_SDNET_SUCCESS) {
+		Result = XilSdnetTargetBuildInfoGetIpVersion(BuildInfoPtr,
+							     VersionPtr);
+	}
+	if (Result != XIL_SDNET_SUCCESS) {
+		xil_printf("snapshot: no IP version: %s\r\n",
+			   XilSdnetReturnTypeToString(Result));
+		return XST_FAILURE;
+	}
+
+	return XST_SUCCESS;
+}
+
+/*
+ * Hash of what decides the layout of the tables: their number, and name,
+ * mode, key format, depth and response width of each
+ */
+static u32 OranSnapshotConfigHash(void)
+{
+	const XilSdnetTargetConfig *ConfigPtr =
+		&XilSdnetTargetConfig_mb_es_design_sdnet_0_1;
+	const XilSdnetTargetTableConfig *TablePtr;
+	u32 Hash = 2166136261U;
+	u32 Index;
+
+	Hash = OranSnapshotHashWord(Hash, ConfigPtr->TableListSize);
+	for (Index = 0; Index < ConfigPtr->TableListSize; Index++) {
+		TablePtr = ConfigPtr->TableListPtr[Index];
+		Hash = OranSnapshotHash(Hash, TablePtr->NameStringPtr,
+					strlen(TablePtr->NameStringPtr) + 1);
+		Hash = OranSnapshotHashWord(Hash, TablePtr->Config.Mode);
+		Hash = OranSnapshotHashWord(Hash,
+					    TablePtr->Config.KeySizeBits);
+		Hash = OranSnapshotHash(Hash,
+			TablePtr->Config.CamConfig.FormatStringPtr,
+			strlen(TablePtr->Config.CamConfig.FormatStringPtr) + 1);
+		Hash = OranSnapshotHashWord(Hash,
+			TablePtr->Config.CamConfig.NumEntries);
+		Hash = OranSnapshotHashWord(Hash,
+			TablePtr->Config.CamConfig.ResponseSizeBits);
+		Hash = OranSnapshotHashWord(Hash,
+					    TablePtr->Config.ActionIdWidthBits);
+	}
+
+	return Hash;
+}
+
+/****************************************************************************/
+/**
+*
+* Writes a snapshot of plane_classify and eaxc_steer to a buffer.
+*
+* @param	BufPtr receives the snapshot.
+* @param	Size is the size of BufPtr; ORAN_SNAPSHOT_MAX_BYTES always
+*		suffices.
+* @param	LengthPtr receives the length of the snapshot.
+*
+* @return	XST_SUCCESS to indicate success, otherwise XST_FAILURE.
+*
+* @note		Does not access the CAMs. Fails if the configuration has a
+*		table other than those two.
+*
+*****************************************************************************/
+LONG OranSnapshotSave(u8 *BufPtr, u32 Size, u32 *LengthPtr)
+{
+	const XilSdnetTargetConfig *ConfigPtr =
+		&XilSdnetTargetConfig_mb_es_design_sdnet_0_1;
+	const char *NamePtr;
+	OranSnapshotCursor Cur;
+	XilSdnetVersion Version;
+	u32 Sections = 0;
+	u32 Count;
+	u32 Index;
+	u32 Entry;
+
+	if ((BufPtr == NULL) || (LengthPtr == NULL) ||
+	    (OranSnapshotIpVersion(&Version) != XST_SUCCESS)) {
+		return XST_FAILURE;
+	}
+
+	memset(&Cur, 0, sizeof(Cur));
+	Cur.BufPtr = BufPtr;
+	Cur.Size = Size;
+	Cur.Offset = ORAN_SNAPSHOT_HEADER_BYTES;
+	if (Size < ORAN_SNAPSHOT_HEADER_BYTES) {
+		Cur.Overrun = 1;
+	}
+
+	for (Index = 0; Index < ConfigPtr->TableListSize; Index++) {
+		NamePtr = ConfigPtr->TableListPtr[Index]->NameStringPtr;
+		if (strcmp(NamePtr, ORAN_POLICY_TABLE_NAME) == 0) {
+			Count = OranPolicyGetRules(SnapshotPolicy,
+						   ORAN_POLICY_DEPTH);
+			OranSnapshotPut(&Cur, Index, 2);
+			OranSnapshotPut(&Cur, ORAN_SNAPSHOT_POLICY_BYTES, 2);
+			OranSnapshotPut(&Cur, Count, 4);
+			for (Entry = 0; Entry < Count; Entry++) {
+				OranSnapshotPutKey(&Cur,
+						   &SnapshotPolicy[Entry].Key);
+				OranSnapshotPutKey(&Cur,
+						   &SnapshotPolicy[Entry].Mask);
+				OranSnapshotPut(&Cur,
+					SnapshotPolicy[Entry].Priority, 4);
+				OranSnapshotPut(&Cur,
+					SnapshotPolicy[Entry].Tdest, 4);
+				OranSnapshotPut(&Cur,
+					SnapshotPolicy[Entry].Prio, 1);
+				OranSnapshotPut(&Cur,
+					SnapshotPolicy[Entry].Keep, 1);
+			}
+		} else if (strcmp(NamePtr, ORAN_EAXC_TABLE_NAME) == 0) {
+			Count = OranEaxcGetRules(SnapshotEaxc,
+						 ORAN_EAXC_DEPTH);
+			OranSnapshotPut(&Cur, Index, 2);
+			OranSnapshotPut(&Cur, ORAN_SNAPSHOT_EAXC_BYTES, 2);
+			OranSnapshotPut(&Cur, Count, 4);
+			for (Entry = 0; Entry < Count; Entry++) {
+				OranSnapshotPut(&Cur,
+					SnapshotEaxc[Entry].AxisTid, 1);
+				OranSnapshotPut(&Cur,
+					SnapshotEaxc[Entry].PcId, 2);
+				OranSnapshotPut(&Cur,
+					SnapshotEaxc[Entry].Tdest, 4);
+				OranSnapshotPut(&Cur,
+					SnapshotEaxc[Entry].Prio, 1);
+			}
+		} else {
+			xil_printf("snapshot: no support for table %s\r\n",
+				   NamePtr);
+			return XST_FAILURE;
+		}
+		Sections++;
+	}
+	if (Cur.Overrun) {
+		xil_printf("snapshot: does not fit in %d bytes\r\n", (int)Size);
+		return XST_FAILURE;
+	}
+
+	*LengthPtr = Cur.Offset;
+	Cur.Offset = 0;
+	OranSnapshotPut(&Cur, ORAN_SNAPSHOT_MAGIC, 4);
+	OranSnapshotPut(&Cur, ORAN_SNAPSHOT_VERSION, 2);
+	OranSnapshotPut(&Cur, Sections, 2);
+	OranSnapshotPut(&Cur, Version.Major, 1);
+	OranSnapshotPut(&Cur, Version.Minor, 1);
+	OranSnapshotPut(&Cur, Version.Revision, 1);
+	OranSnapshotPut(&Cur, 0, 1);
+	OranSnapshotPut(&Cur, OranSnapshotConfigHash(), 4);
+	OranSnapshotPut(&Cur, *LengthPtr - ORAN_SNAPSHOT_HEADER_BYTES, 4);
+	OranSnapshotPut(&Cur, OranSnapshotHash(2166136261U,
+				BufPtr + ORAN_SNAPSHOT_HEADER_BYTES,
+				*LengthPtr - ORAN_SNAPSHOT_HEADER_BYTES), 4);
+	OranSnapshotPut(&Cur, 0, 4);
+	OranSnapshotPut(&Cur, OranSnapshotHash(2166136261U, BufPtr,
+					       ORAN_SNAPSHOT_HEADER_HASH_AT),
+			4);
+
+	return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/**
+*
+* Checks that a snapshot is intact and was taken on this bitstream.
+*
+* @param	BufPtr is the snapshot.
+* @param	Length is the number of bytes at BufPtr, which may run past
+*		the end of the snapshot.
+*
+* @return	XST_SUCCESS if it can be restored, otherwise XST_FAILURE.
+*
+* @note		Prints why a snapshot is refused.
+*
+*****************************************************************************/
+LONG OranSnapshotCheck(const u8 *BufPtr, u32 Length)
+{
+	OranSnapshotCursor Cur;
+	XilSdnetVersion Version;
+	u32 Payload;
+	u32 PayloadHash;
+	u32 ConfigHash;
+	u32 HeaderHash;
+	u32 Ip;
+
+	if ((BufPtr == NULL) || (Length < ORAN_SNAPSHOT_HEADER_BYTES)) {
+		return XST_FAILURE;
+	}
+
+	memset(&Cur, 0, sizeof(Cur));
+	Cur.DataPtr = BufPtr;
+	Cur.Size = Length;
+	if (OranSnapshotGet(&Cur, 4) != ORAN_SNAPSHOT_MAGIC) {
+		xil_printf("snapshot: none found\r\n");
+		return XST_FAILURE;
+	}
+	if (OranSnapshotGet(&Cur, 2) != ORAN_SNAPSHOT_VERSION) {
+		xil_printf("snapshot: unknown format\r\n");
+		return XST_FAILURE;
+	}
+	(void)OranSnapshotGet(&Cur, 2);
+	Ip = OranSnapshotGet(&Cur, 4);
+	ConfigHash = OranSnapshotGet(&Cur, 4);
+	Payload = OranSnapshotGet(&Cur, 4);
+	PayloadHash = OranSnapshotGet(&Cur, 4);
+	(void)OranSnapshotGet(&Cur, 4);
+	HeaderHash = OranSnapshotGet(&Cur, 4);
+	if (HeaderHash != OranSnapshotHash(2166136261U, BufPtr,
+					   ORAN_SNAPSHOT_HEADER_HASH_AT)) {
+		xil_printf("snapshot: header corrupted\r\n");
+		return XST_FAILURE;
+	}
+	if ((Payload > Length - ORAN_SNAPSHOT_HEADER_BYTES) ||
+	    (OranSnapshotHash(2166136261U, BufPtr + ORAN_SNAPSHOT_HEADER_BYTES,
+			      Payload) != PayloadHash)) {
+		xil_printf("snapshot: entries corrupted\r\n");
+		return XST_FAILURE;
+	}
+
+	if (OranSnapshotIpVersion(&Version) != XST_SUCCESS) {
+		return XST_FAILURE;
+	}
+	if ((Ip & 0xFFFFFF) != (Version.Major | ((u32)Version.Minor << 8) |
+				((u32)Version.Revision << 16))) {
+		xil_printf("snapshot: taken on IP version %d.%d.%d, this is "
+			   "%d.%d.%d\r\n", (int)(Ip & 0xFF),
+			   (int)((Ip >> 8) & 0xFF), (int)((Ip >> 16) & 0xFF),
+			   Version.Major, Version.Minor, Version.Revision);
+		return XST_FAILURE;
+	}
+	if (ConfigHash != OranSnapshotConfigHash()) {
+		xil_printf("snapshot: taken with other tables\r\n");
+		return XST_FAILURE;
+	}
+
+	return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/**
+*
+* Replaces the contents of plane_classify and eaxc_steer with a snapshot.
+*
+* @param	BufPtr is the snapshot.
+* @param	Length is the number of bytes at BufPtr, which may run past
+*		the end of the snapshot.
+*
+* @return	XST_SUCCESS to indicate success, otherwise XST_FAILURE.
+*
+* @note		OranPolicyInit and OranEaxcInit must have run. Nothing is
+*		written unless the whole snapshot checks out; if a table
+*		then fails to load, it keeps the entries loaded before the
+*		failure.
+*
+*****************************************************************************/
+LONG OranSnapshotRestore(const u8 *BufPtr, u32 Length)
+{
+	const XilSdnetTargetConfig *ConfigPtr =
+		&XilSdnetTargetConfig_mb_es_design_sdnet_0_1;
+	const char *NamePtr;
+	OranSnapshotCursor Cur;
+	u32 PolicyCount = 0;
+	u32 EaxcCount = 0;
+	u32 Sections;
+	u32 Section;
+	u32 Index;
+	u32 EntryBytes;
+	u32 Count;
+	u32 Entry;
+	XTime Start;
+	XTime End;
+
+	if (OranSnapshotCheck(BufPtr, Length) != XST_SUCCESS) {
+		return XST_FAILURE;
+	}
+
+	memset(&Cur, 0, sizeof(Cur));
+	Cur.DataPtr = BufPtr;
+	Cur.Size = Length;
+	Cur.Offset = ORAN_SNAPSHOT_SECTIONS_AT;
+	Sections = OranSnapshotGet(&Cur, 2);
+	Cur.Offset = ORAN_SNAPSHOT_PAYLOAD_AT;
+	Cur.Size = ORAN_SNAPSHOT_HEADER_BYTES + OranSnapshotGet(&Cur, 4);
+	Cur.Offset = ORAN_SNAPSHOT_HEADER_BYTES;
+
+	for (Section = 0; Section < Sections; Section++) {
+		Index = OranSnapshotGet(&Cur, 2);
+		EntryBytes = OranSnapshotGet(&Cur, 2);
+		Count = OranSnapshotGet(&Cur, 4);
+		if (Cur.Overrun || (Index >= ConfigPtr->TableListSize)) {
+			break;
+		}
+		NamePtr = ConfigPtr->TableListPtr[Index]->NameStringPtr;
+		if ((strcmp(NamePtr, ORAN_POLICY_TABLE_NAME) == 0) &&
+		    (EntryBytes == ORAN_SNAPSHOT_POLICY_BYTES) &&
+		    (Count <= ORAN_POLICY_DEPTH)) {
+			for (Entry = 0; Entry < Count; Entry++) {
+				OranSnapshotGetKey(&Cur,
+						   &SnapshotPolicy[Entry].Key);
+				OranSnapshotGetKey(&Cur,
+						   &SnapshotPolicy[Entry].Mask);
+				SnapshotPolicy[Entry].Priority =
+					OranSnapshotGet(&Cur, 4);
+				SnapshotPolicy[Entry].Tdest =
+					OranSnapshotGet(&Cur, 4);
+				SnapshotPolicy[Entry].Prio =
+					(u8)OranSnapshotGet(&Cur, 1);
+				SnapshotPolicy[Entry].Keep =
+					(u8)OranSnapshotGet(&Cur, 1);
+			}
+			PolicyCount = Count;
+		} else if ((strcmp(NamePtr, ORAN_EAXC_TABLE_NAME) == 0) &&
+			   (EntryBytes == ORAN_SNAPSHOT_EAXC_BYTES) &&
+			   (Count <= ORAN_EAXC_DEPTH)) {
+			for (Entry = 0; Entry < Count; Entry++) {
+				SnapshotEaxc[Entry].AxisTid =
+					(u8)OranSnapshotGet(&Cur, 1);
+				SnapshotEaxc[Entry].PcId =
+					(u16)OranSnapshotGet(&Cur, 2);
+				SnapshotEaxc[Entry].Tdest =
+					OranSnapshotGet(&Cur, 4);
+				SnapshotEaxc[Entry].Prio =
+					(u8)OranSnapshotGet(&Cur, 1);
+			}
+			EaxcCount = Count;
+		} else {
+			break;
+		}
+	}
+	if ((Section != Sections) || Cur.Overrun) {
+		xil_printf("snapshot: section %d unusable\r\n", (int)Section);
+		return XST_FAILURE;
+	}
+
+	XTime_GetTime(&Start);
+	if ((OranPolicyLoadRules(SnapshotPolicy, PolicyCount) !=
+	     XST_SUCCESS) ||
+	    (OranEaxcReset() != XST_SUCCESS)) {
+		xil_printf("snapshot: restore failed\r\n");
+		return XST_FAILURE;
+	}
+	for (Entry = 0; Entry < EaxcCount; Entry++) {
+		if (OranEaxcInsertRule(&SnapshotEaxc[Entry]) != XST_SUCCESS) {
+			xil_printf("snapshot: restore failed\r\n");
+			return XST_FAILURE;
+		}
+	}
+	XTime_GetTime(&End);
+
+	xil_printf("snapshot: %d plane_classify and %d eaxc_steer entries "
+		   "restored in %d us\r\n", (int)PolicyCount, (int)EaxcCount,
+		   (int)((End - Start) / (COUNTS_PER_SECOND / 1000000)));
+
+	return XST_SUCCESS;
+}
+
+#if ORAN_SNAPSHOT_SD
+/*****************************************************************************/
+/*
+ * Brings up the SD controller on first use
+ */
+static LONG OranSnapshotSdInit(void)
+{
+	XSdPs_Config *SdConfigPtr;
+
+	if (SnapshotSdUp) {
+		return XST_SUCCESS;
+	}
+
+	SdConfigPtr = XSdPs_LookupConfig(XPAR_XSDPS_0_DEVICE_ID);
+	if ((SdConfigPtr == NULL) ||
+	    (XSdPs_CfgInitialize(&SnapshotSd, SdConfigPtr,
+				 SdConfigPtr->BaseAddress) != XST_SUCCESS) ||
+	    (XSdPs_CardInitialize(&SnapshotSd) != XST_SUCCESS)) {
+		xil_printf("snapshot: SD card not ready\r\n");
+		return XST_FAILURE;
+	}
+	SnapshotSdUp = 1;
+
+	return XST_SUCCESS;
+}
+
+/*
+ * Transfer argument of a sector: its number on high-capacity cards, its
+ * byte address on standard-capacity ones
+ */
+static u32 OranSnapshotSdArg(u32 Sector)
+{
+	return SnapshotSd.HCS ? Sector : Sector * ORAN_SNAPSHOT_SD_BLOCK;
+}
+
+/****************************************************************************/
+/**
+*
+* Saves a snapshot of the tables as they are now to the SD card.
+*
+* @param	None.
+*
+* @return	XST_SUCCESS to indicate success, otherwise XST_FAILURE.
+*
+* @note		Call it after every change that should survive a restart.
+*
+*****************************************************************************/
+LONG OranSnapshotStore(void)
+{
+	u32 Length;
+	u32 Blocks;
+
+	if ((OranSnapshotSdInit() != XST_SUCCESS) ||
+	    (OranSnapshotSave(SnapshotSdBuf, sizeof(SnapshotSdBuf),
+			      &Length) != XST_SUCCESS)) {
+		return XST_FAILURE;
+	}
+
+	Blocks = (Length + ORAN_SNAPSHOT_SD_BLOCK - 1) /
+		 ORAN_SNAPSHOT_SD_BLOCK;
+	memset(SnapshotSdBuf + Length, 0,
+	       Blocks * ORAN_SNAPSHOT_SD_BLOCK - Length);
+	if (XSdPs_WritePolled(&SnapshotSd,
+			      OranSnapshotSdArg(ORAN_SNAPSHOT_SD_SECTOR),
+			      Blocks, SnapshotSdBuf) != XST_SUCCESS) {
+		xil_printf("snapshot: SD write failed\r\n");
+		return XST_FAILURE;
+	}
+
+	return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/**
+*
+* Fills plane_classify and eaxc_steer at start-up: from the snapshot on the
+* SD card if there is a usable one, otherwise with the default policy and
+* an empty eaxc_steer, which are then saved as the new snapshot.
+*
+* @param	None.
+*
+* @return	XST_SUCCESS to indicate success, otherwise XST_FAILURE.
+*
+* @note		OranPolicyInit and OranEaxcInit must have run. A snapshot
+*		that cannot be saved does not fail the start-up.
+*
+*****************************************************************************/
+LONG OranSnapshotBoot(void)
+{
+	if ((OranSnapshotSdInit() == XST_SUCCESS) &&
+	    (XSdPs_ReadPolled(&SnapshotSd,
+			      OranSnapshotSdArg(ORAN_SNAPSHOT_SD_SECTOR),
+			      sizeof(SnapshotSdBuf) / ORAN_SNAPSHOT_SD_BLOCK,
+			      SnapshotSdBuf) == XST_SUCCESS) &&
+	    (OranSnapshotRestore(SnapshotSdBuf, sizeof(SnapshotSdBuf)) ==
+	     XST_SUCCESS)) {
+		return XST_SUCCESS;
+	}
+
+	xil_printf("snapshot: loading the default policy\r\n");
+	if ((OranEaxcReset() != XST_SUCCESS) ||
+	    (OranPolicyLoadDefaults() != XST_SUCCESS)) {
+		return XST_FAILURE;
+	}
+	(void)OranSnapshotStore();
+
+	return XST_SUCCESS;
+}
+#else
+/*
+ * Without a place to keep it, a start-up is always a cold one
+ */
+LONG OranSnapshotStore(void)
+{
+	return XST_FAILURE;
+}
+
+LONG OranSnapshotBoot(void)
+{
+	return OranPolicyLoadDefaults();
+}
+#endif
+
+#endif /* ORAN_SDNET_CTRL */
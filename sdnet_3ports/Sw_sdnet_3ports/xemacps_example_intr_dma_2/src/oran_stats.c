@@ -0,0 +1,185 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file oran_stats.c
+*
+* Reads the plane_stats counter extern of sdnet_0, a packet-and-byte
+* counter per plane and ingress port. The plane of a frame is derived from
+* its parsed headers rather than from the table results, so the counters
+* show what arrived whatever the policy made of it.
+*
+* Reading the cells one at a time means an index write, a command write
+* and a completion poll before each cell's data words, and the cells are
+* not taken at the same instant. OranStatsRead instead latches all cells
+* with one control write and reads the holding registers back as a linear
+* block. That is one write, normally one poll and four reads per cell, and
+* every cell of a snapshot comes from the same point in time.
+*
+* Register accesses go through the SDNet environment interface, the same
+* path the table drivers use. The file is only built with ORAN_SDNET_STATS,
+* see oran_sdnet.h.
+*
+*****************************************************************************/
+
+/***************************** Include Files ********************************/
+
+#include "xil_printf.h"
+#include "xstatus.h"
+#include "oran_sdnet.h"
+
+#if ORAN_SDNET_CTRL && ORAN_SDNET_STATS
+
+/************************** Constant Definitions ****************************/
+
+#define ORAN_STATS_NUM_CELLS	(ORAN_STATS_NUM_PLANES * ORAN_STATS_NUM_TIDS)
+#define ORAN_STATS_CELL_WORDS	4
+
+/************************** Variable Definitions ****************************/
+
+static const char *OranStatsPlaneName[ORAN_STATS_NUM_PLANES] = {
+	"other", "U-plane", "C-plane", "eCPRI", "RoE", "S-plane",
+	"parse-err", "-"
+};
+
+/****************************************************************************/
+/**
+*
+* Takes a snapshot of every plane_stats cell.
+*
+* @param	SnapshotPtr receives the counters, indexed by plane and
+*		axis_tid.
+*
+* @return	XST_SUCCESS to indicate success, otherwise XST_FAILURE.
+*
+* @note		OranSdnetInit must have been called first. The counters in
+*		hardware keep running; use OranStatsDelta for rates.
+*
+*****************************************************************************/
+LONG OranStatsRead(OranStatsSnapshot *SnapshotPtr)
+{
+	XilSdnetEnvIf *EnvIfPtr = OranSdnetEnvIf();
+	XilSdnetReturnType Result;
+	uint32_t Words[ORAN_STATS_CELL_WORDS];
+	uint32_t Status;
+	u32 Poll;
+	u32 Cell;
+	u32 Word;
+
+	if (EnvIfPtr == NULL) {
+		return XST_FAILURE;
+	}
+
+	Result = EnvIfPtr->WordWrite32(EnvIfPtr,
+				       ORAN_STATS_OFFSET + ORAN_STATS_CTRL_REG,
+				       ORAN_STATS_CTRL_LATCH);
+	if (Result != XIL_SDNET_SUCCESS) {
+		return XST_FAILURE;
+	}
+
+	for (Poll = 0; Poll < ORAN_STATS_LATCH_POLLS; Poll++) {
+		Result = EnvIfPtr->WordRead32(EnvIfPtr, ORAN_STATS_OFFSET +
+					      ORAN_STATS_STATUS_REG, &Status);
+		if ((Result != XIL_SDNET_SUCCESS) ||
+		    !(Status & ORAN_STATS_STATUS_BUSY)) {
+			break;
+		}
+	}
+	if ((Result != XIL_SDNET_SUCCESS) || (Poll == ORAN_STATS_LATCH_POLLS)) {
+		xil_printf("plane_stats latch timed out\r\n");
+		return XST_FAILURE;
+	}
+
+	for (Cell = 0; Cell < ORAN_STATS_NUM_CELLS; Cell++) {
+		OranStatsCell *CellPtr =
+			&SnapshotPtr->Cell[Cell / ORAN_STATS_NUM_TIDS]
+					  [Cell % ORAN_STATS_NUM_TIDS];
+
+		for (Word = 0; Word < ORAN_STATS_CELL_WORDS; Word++) {
+			Result = EnvIfPtr->WordRead32(EnvIfPtr,
+				ORAN_STATS_OFFSET + ORAN_STATS_DATA_REG +
+				4 * (Cell * ORAN_STATS_CELL_WORDS + Word),
+				&Words[Word]);
+			if (Result != XIL_SDNET_SUCCESS) {
+				return XST_FAILURE;
+			}
+		}
+		CellPtr->Packets = ((u64)Words[1] << 32) | Words[0];
+		CellPtr->Bytes = ((u64)Words[3] << 32) | Words[2];
+	}
+
+	return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/**
+*
+* Computes the counts between two snapshots.
+*
+* @param	PrevPtr is the earlier snapshot.
+* @param	CurPtr is the later snapshot.
+* @param	DeltaPtr receives CurPtr - PrevPtr. It may be PrevPtr or
+*		CurPtr.
+*
+* @return	None.
+*
+* @note		The cells are 64 bits wide and do not wrap in practice.
+*
+*****************************************************************************/
+void OranStatsDelta(const OranStatsSnapshot *PrevPtr,
+		    const OranStatsSnapshot *CurPtr,
+		    OranStatsSnapshot *DeltaPtr)
+{
+	u32 Plane;
+	u32 Tid;
+
+	for (Plane = 0; Plane < ORAN_STATS_NUM_PLANES; Plane++) {
+		for (Tid = 0; Tid < ORAN_STATS_NUM_TIDS; Tid++) {
+			DeltaPtr->Cell[Plane][Tid].Packets =
+				CurPtr->Cell[Plane][Tid].Packets -
+				PrevPtr->Cell[Plane][Tid].Packets;
+			DeltaPtr->Cell[Plane][Tid].Bytes =
+				CurPtr->Cell[Plane][Tid].Bytes -
+				PrevPtr->Cell[Plane][Tid].Bytes;
+		}
+	}
+}
+
+/****************************************************************************/
+/**
+*
+* Prints the non-zero cells of a snapshot, one line per plane and port.
+*
+* @param	SnapshotPtr is the snapshot to print.
+*
+* @return	None.
+*
+* @note		None.
+*
+*****************************************************************************/
+void OranStatsPrint(const OranStatsSnapshot *SnapshotPtr)
+{
+	u32 Plane;
+	u32 Tid;
+
+	for (Plane = 0; Plane < ORAN_STATS_NUM_PLANES; Plane++) {
+		for (Tid = 0; Tid < ORAN_STATS_NUM_TIDS; Tid++) {
+			const OranStatsCell *CellPtr =
+				&SnapshotPtr->Cell[Plane][Tid];
+
+			if (CellPtr->Packets == 0) {
+				continue;
+			}
+			/* xil_printf has no 64-bit conversions */
+			xil_printf("%s tid %d: %u pkts %u bytes\r\n",
+				   OranStatsPlaneName[Plane], (int)Tid,
+				   (unsigned)CellPtr->Packets,
+				   (unsigned)CellPtr->Bytes);
+		}
+	}
+}
+
+#endif /* ORAN_SDNET_CTRL && ORAN_SDNET_STATS */
@@ -0,0 +1,573 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file oran_table.c
+*
+* Transactional updates for any table of sdnet_0 reached through the
+* table driver.
+*
+* The driver takes one entry per call and its register traffic per entry,
+* status read included, is its own: the cam_arg write-sequence hooks that
+* could bracket several entries belong to the vbcam and are not reachable
+* through XilSdnetTable*. There is therefore no batch insert here; bulk
+* loads call the driver per entry inside a write sequence
+* (OranSdnetWriteSequenceBegin/End), which keeps other threads off the
+* registers, prints only the first driver error and, on Linux, issues the
+* queued stores of oran_env_uio.c behind one barrier.
+*
+* OranTableCommit moves a table from one complete set of entries to
+* another without a window in which lookups miss. It works out the
+* difference first and then applies it make-before-break:
+*
+*	1. new entries are inserted, and entries that only change priority
+*	   get a stand-in at the new priority: the entry split in two on a
+*	   wildcard bit, which matches the same frames under masks the
+*	   driver does not see as duplicates. These inserts go lowest
+*	   priority value first,
+*	2. entries whose key, mask and priority stay get their new action
+*	   in place (XilSdnetTableUpdate rewrites one response word),
+*	3. old entries that are gone, and the old copies of the moved ones,
+*	   are deleted, highest priority value first,
+*	4. moved entries are inserted at their new priority whole and their
+*	   stand-ins deleted.
+*
+* Inserting the winners first means a new entry only takes a lookup once
+* every new entry that beats it is in; deleting the losers first means an
+* old entry only goes once every old entry it beat has gone. At every
+* point the lowest-priority hit of any lookup is therefore the winner
+* under either the old or the new set.
+*
+* An entry with no wildcard bit, or none whose halves are free, cannot be
+* split and is still deleted and reinserted after step 4; for that moment
+* its frames hit the next matching entry or miss. Every driver call is
+* planned before the first is made, and if one fails those already made
+* are undone in reverse order.
+*
+* The old entries are matched to the new ones through a commit-diff index,
+* a hash on the masked key and the mask built over the two sets for the
+* length of one commit, so working out the difference takes time in
+* proportion to the size of the table rather than to its square. It does
+* not index the driver's own shadow of the table: the Tiny CAM lookups
+* behind each driver call (XilSdnetTinyCamPrvShadowTableFindEntry and the
+* like, in libsdnetdrv) still walk its entry list.
+*
+*****************************************************************************/
+
+/***************************** Include Files ********************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "xil_printf.h"
+#include "xstatus.h"
+#include "oran_sdnet.h"
+
+#if ORAN_SDNET_CTRL
+
+/************************** Constant Definitions ****************************/
+
+#define ORAN_TABLE_NONE		0xFFFF
+
+/*
+ * Slots of the indexes over the old and the new entries. Each commit uses
+ * the smallest power of two that keeps them at most half full; the index
+ * over the stand-ins of moved entries, two per move, gets twice as many.
+ */
+#define ORAN_TABLE_HASH_SIZE	(2 * ORAN_TABLE_TXN_MAX)
+
+/* The index is rounded up to a power of two and must still fit */
+#if (ORAN_TABLE_TXN_MAX & (ORAN_TABLE_TXN_MAX - 1)) != 0
+#error ORAN_TABLE_TXN_MAX must be a power of two
+#endif
+
+/*
+ * Longest key a moved entry can be split on; longer ones are deleted and
+ * reinserted
+ */
+#define ORAN_TABLE_SPLIT_BYTES	16
+
+/*
+ * Driver calls of one commit. Every entry is inserted, updated or deleted
+ * once, and a split move takes four calls more.
+ */
+#define ORAN_TABLE_STEPS_MAX	(6 * ORAN_TABLE_TXN_MAX)
+
+#define ORAN_TABLE_INSERT	0
+#define ORAN_TABLE_UPDATE	1
+#define ORAN_TABLE_DELETE	2
+
+/**************************** Type Definitions ******************************/
+
+/*
+ * One driver call of a commit. UndoPtr is the entry an update replaces.
+ */
+typedef struct {
+	const OranTableEntry *EntryPtr;
+	const OranTableEntry *UndoPtr;
+	u8 Op;
+} OranTableStep;
+
+/************************** Variable Definitions ****************************/
+
+/*
+ * Scratch for OranTableCommit. For every new entry, the old entry with the
+ * same key and mask (or ORAN_TABLE_NONE); for every old entry, whether a
+ * new one took its key and mask.
+ */
+static u16 TxnMatch[ORAN_TABLE_TXN_MAX];
+static u8 TxnTaken[ORAN_TABLE_TXN_MAX];
+static u16 TxnUpd[ORAN_TABLE_TXN_MAX];
+static u16 TxnMove[ORAN_TABLE_TXN_MAX];
+static const OranTableEntry *TxnIns[3 * ORAN_TABLE_TXN_MAX];
+static const OranTableEntry *TxnDel[ORAN_TABLE_TXN_MAX];
+static u16 TxnHash[ORAN_TABLE_HASH_SIZE];
+static u16 TxnNewHash[ORAN_TABLE_HASH_SIZE];
+static u16 TxnHalfHash[2 * ORAN_TABLE_HASH_SIZE];
+
+/* Whether each move is split, its halves and their mask and keys */
+static u8 TxnSplit[ORAN_TABLE_TXN_MAX];
+static OranTableEntry TxnHalf[ORAN_TABLE_TXN_MAX][2];
+static u8 TxnHalfBytes[ORAN_TABLE_TXN_MAX][3][ORAN_TABLE_SPLIT_BYTES];
+static OranTableStep TxnStep[ORAN_TABLE_STEPS_MAX];
+
+/*****************************************************************************/
+/*
+ * Entries with NULL masks belong to exact-match tables, where priority is
+ * not stored. Key bits outside the mask do not take part in the match.
+ */
+static u8 OranTableSameMatch(const OranTableEntry *APtr,
+			     const OranTableEntry *BPtr, u32 KeyBytes)
+{
+	u32 Index;
+
+	if ((APtr->MaskPtr == NULL) || (BPtr->MaskPtr == NULL)) {
+		return (APtr->MaskPtr == BPtr->MaskPtr) &&
+		       (memcmp(APtr->KeyPtr, BPtr->KeyPtr, KeyBytes) == 0);
+	}
+	if (memcmp(APtr->MaskPtr, BPtr->MaskPtr, KeyBytes) != 0) {
+		return 0;
+	}
+	for (Index = 0; Index < KeyBytes; Index++) {
+		if ((APtr->KeyPtr[Index] ^ BPtr->KeyPtr[Index]) &
+		    APtr->MaskPtr[Index]) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/*
+ * FNV-1a over the masked key and the mask, so entries that
+ * OranTableSameMatch finds equal hash the same
+ */
+static u32 OranTableHash(const OranTableEntry *EntryPtr, u32 KeyBytes,
+			 u32 HashMask)
+{
+	u32 Hash = 2166136261U;
+	u8 Mask = 0xFF;
+	u32 Index;
+
+	for (Index = 0; Index < KeyBytes; Index++) {
+		if (EntryPtr->MaskPtr != NULL) {
+			Mask = EntryPtr->MaskPtr[Index];
+			Hash = (Hash ^ Mask) * 16777619U;
+		}
+		Hash = (Hash ^ (EntryPtr->KeyPtr[Index] & Mask)) * 16777619U;
+	}
+
+	return Hash & HashMask;
+}
+
+static u8 OranTableSameAction(const OranTableEntry *APtr,
+			      const OranTableEntry *BPtr, u32 ParamBytes)
+{
+	if (APtr->ActionId != BPtr->ActionId) {
+		return 0;
+	}
+	if ((APtr->ParamsPtr == NULL) || (BPtr->ParamsPtr == NULL)) {
+		return (APtr->ParamsPtr == BPtr->ParamsPtr);
+	}
+	return (memcmp(APtr->ParamsPtr, BPtr->ParamsPtr, ParamBytes) == 0);
+}
+
+static XilSdnetReturnType OranTableUpdateEntry(XilSdnetTableCtx *TablePtr,
+					       const OranTableEntry *EntryPtr)
+{
+	return ORAN_SDNET_CALL(ORAN_CALL_TABLE_UPDATE,
+		XilSdnetTableUpdate(TablePtr, EntryPtr->KeyPtr,
+				    EntryPtr->MaskPtr, EntryPtr->ActionId,
+				    EntryPtr->ParamsPtr));
+}
+
+static XilSdnetReturnType OranTableInsertEntry(XilSdnetTableCtx *TablePtr,
+					       const OranTableEntry *EntryPtr)
+{
+	return ORAN_SDNET_CALL(ORAN_CALL_TABLE_INSERT,
+		XilSdnetTableInsert(TablePtr, EntryPtr->KeyPtr,
+				    EntryPtr->MaskPtr, EntryPtr->Priority,
+				    EntryPtr->ActionId, EntryPtr->ParamsPtr));
+}
+
+static XilSdnetReturnType OranTableDeleteEntry(XilSdnetTableCtx *TablePtr,
+					       const OranTableEntry *EntryPtr)
+{
+	return ORAN_SDNET_CALL(ORAN_CALL_TABLE_DELETE,
+		XilSdnetTableDelete(TablePtr, EntryPtr->KeyPtr,
+				    EntryPtr->MaskPtr));
+}
+
+/*
+ * Inserts go lowest priority value first and deletes highest first
+ */
+static int OranTableEarlierFirst(const void *APtr, const void *BPtr)
+{
+	u32 A = (*(const OranTableEntry *const *)APtr)->Priority;
+	u32 B = (*(const OranTableEntry *const *)BPtr)->Priority;
+
+	return (A > B) - (A < B);
+}
+
+static int OranTableLaterFirst(const void *APtr, const void *BPtr)
+{
+	u32 A = (*(const OranTableEntry *const *)APtr)->Priority;
+	u32 B = (*(const OranTableEntry *const *)BPtr)->Priority;
+
+	return (A < B) - (A > B);
+}
+
+/*
+ * Adds entry Index of SetPtr to the index HashPtr
+ */
+static void OranTableIndexAdd(u16 *HashPtr, const OranTableEntry *SetPtr,
+			      u32 Index, u32 KeyBytes, u32 HashMask)
+{
+	u32 Slot = OranTableHash(&SetPtr[Index], KeyBytes, HashMask);
+
+	while (HashPtr[Slot] != ORAN_TABLE_NONE) {
+		Slot = (Slot + 1) & HashMask;
+	}
+	HashPtr[Slot] = (u16)Index;
+}
+
+/*
+ * Indexes Count entries of SetPtr in HashPtr
+ */
+static void OranTableIndex(u16 *HashPtr, const OranTableEntry *SetPtr,
+			   u32 Count, u32 KeyBytes, u32 HashMask)
+{
+	u32 Index;
+
+	memset(HashPtr, 0xFF, (HashMask + 1) * sizeof(HashPtr[0]));
+	for (Index = 0; Index < Count; Index++) {
+		OranTableIndexAdd(HashPtr, SetPtr, Index, KeyBytes, HashMask);
+	}
+}
+
+static u8 OranTableIndexHas(const u16 *HashPtr, const OranTableEntry *SetPtr,
+			    const OranTableEntry *EntryPtr, u32 KeyBytes,
+			    u32 HashMask)
+{
+	u32 Slot = OranTableHash(EntryPtr, KeyBytes, HashMask);
+
+	for (; HashPtr[Slot] != ORAN_TABLE_NONE;
+	     Slot = (Slot + 1) & HashMask) {
+		if (OranTableSameMatch(EntryPtr, &SetPtr[HashPtr[Slot]],
+				       KeyBytes)) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * Splits a ternary entry on wildcard key bit Bit into two entries that
+ * together match the same frames, at the priority and with the action of
+ * EntryPtr. Returns 0 if the bit is not a wildcard.
+ */
+static u8 OranTableSplit(const OranTableEntry *EntryPtr, u32 KeyBytes,
+			 u32 Bit, OranTableEntry *HalfPtr,
+			 u8 BytePtr[][ORAN_TABLE_SPLIT_BYTES])
+{
+	u8 Flag = (u8)(1 << (Bit % 8));
+
+	if (EntryPtr->MaskPtr[Bit / 8] & Flag) {
+		return 0;
+	}
+
+	memcpy(BytePtr[0], EntryPtr->MaskPtr, KeyBytes);
+	memcpy(BytePtr[1], EntryPtr->KeyPtr, KeyBytes);
+	memcpy(BytePtr[2], EntryPtr->KeyPtr, KeyBytes);
+	BytePtr[0][Bit / 8] |= Flag;
+	BytePtr[1][Bit / 8] &= (u8)~Flag;
+	BytePtr[2][Bit / 8] |= Flag;
+
+	HalfPtr[0] = *EntryPtr;
+	HalfPtr[0].MaskPtr = BytePtr[0];
+	HalfPtr[0].KeyPtr = BytePtr[1];
+	HalfPtr[1] = HalfPtr[0];
+	HalfPtr[1].KeyPtr = BytePtr[2];
+
+	return 1;
+}
+
+static void OranTablePlan(u32 *CountPtr, u8 Op,
+			  const OranTableEntry *EntryPtr,
+			  const OranTableEntry *UndoPtr)
+{
+	TxnStep[*CountPtr].Op = Op;
+	TxnStep[*CountPtr].EntryPtr = EntryPtr;
+	TxnStep[*CountPtr].UndoPtr = UndoPtr;
+	(*CountPtr)++;
+}
+
+static XilSdnetReturnType OranTableDo(XilSdnetTableCtx *TablePtr,
+				      const OranTableStep *StepPtr)
+{
+	switch (StepPtr->Op) {
+	case ORAN_TABLE_INSERT:
+		return OranTableInsertEntry(TablePtr, StepPtr->EntryPtr);
+	case ORAN_TABLE_UPDATE:
+		return OranTableUpdateEntry(TablePtr, StepPtr->EntryPtr);
+	default:
+		return OranTableDeleteEntry(TablePtr, StepPtr->EntryPtr);
+	}
+}
+
+static void OranTableUndo(XilSdnetTableCtx *TablePtr,
+			  const OranTableStep *StepPtr)
+{
+	switch (StepPtr->Op) {
+	case ORAN_TABLE_INSERT:
+		(void)OranTableDeleteEntry(TablePtr, StepPtr->EntryPtr);
+		break;
+	case ORAN_TABLE_UPDATE:
+		(void)OranTableUpdateEntry(TablePtr, StepPtr->UndoPtr);
+		break;
+	default:
+		(void)OranTableInsertEntry(TablePtr, StepPtr->EntryPtr);
+		break;
+	}
+}
+
+/****************************************************************************/
+/**
+*
+* Replaces the entries of a table, as described at the top of this file.
+*
+* @param	TablePtr is the table, as returned by
+*		XilSdnetTargetGetTableByName.
+* @param	KeyBytes is the size of each key and mask.
+* @param	ParamBytes is the size of each set of action parameters.
+* @param	OldPtr points to the OldCount entries now in the table.
+* @param	OldCount is the number of entries now in the table.
+* @param	NewPtr points to the NewCount entries the table should hold.
+* @param	NewCount is the number of entries the table should hold.
+*
+* @return	XST_SUCCESS if the table now holds the new entries,
+*		otherwise XST_FAILURE with the table back at the old entries.
+*
+* @note		The table needs room for the old and the new entries at the
+*		same time, and two more for each entry that changes
+*		priority. Neither set may hold two entries with the same
+*		key and mask. Both counts are limited to ORAN_TABLE_TXN_MAX.
+*
+*****************************************************************************/
+LONG OranTableCommit(XilSdnetTableCtx *TablePtr, u32 KeyBytes,
+		     u32 ParamBytes, const OranTableEntry *OldPtr,
+		     u32 OldCount, const OranTableEntry *NewPtr,
+		     u32 NewCount)
+{
+	XilSdnetReturnType Result = XIL_SDNET_SUCCESS;
+	u32 NumAdd = 0;
+	u32 NumIns;
+	u32 NumDel = 0;
+	u32 NumUpd = 0;
+	u32 NumMove = 0;
+	u32 NumSteps = 0;
+	u32 KeyBits = 0;
+	u32 Bit;
+	u32 Half;
+	u32 HalfMask;
+	const OranTableEntry *HalfPtr;
+	u32 Step;
+	u32 Move;
+	u32 New;
+	u32 Old;
+	u32 Slot;
+	u32 HashMask;
+
+	if ((TablePtr == NULL) || (OldCount > ORAN_TABLE_TXN_MAX) ||
+	    (NewCount > ORAN_TABLE_TXN_MAX)) {
+		return XST_FAILURE;
+	}
+
+	HashMask = 1;
+	while ((HashMask < 2 * OldCount) || (HashMask < 2 * NewCount)) {
+		HashMask <<= 1;
+	}
+	HashMask--;
+
+	memset(TxnTaken, 0, OldCount);
+	OranTableIndex(TxnHash, OldPtr, OldCount, KeyBytes, HashMask);
+
+	for (New = 0; New < NewCount; New++) {
+		TxnMatch[New] = ORAN_TABLE_NONE;
+		Slot = OranTableHash(&NewPtr[New], KeyBytes, HashMask);
+		for (; (Old = TxnHash[Slot]) != ORAN_TABLE_NONE;
+		     Slot = (Slot + 1) & HashMask) {
+			if (!TxnTaken[Old] &&
+			    OranTableSameMatch(&NewPtr[New], &OldPtr[Old],
+					       KeyBytes)) {
+				TxnMatch[New] = (u16)Old;
+				TxnTaken[Old] = 1;
+				break;
+			}
+		}
+
+		if (TxnMatch[New] == ORAN_TABLE_NONE) {
+			TxnIns[NumAdd++] = &NewPtr[New];
+			continue;
+		}
+		Old = TxnMatch[New];
+		if ((NewPtr[New].MaskPtr != NULL) &&
+		    (NewPtr[New].Priority != OldPtr[Old].Priority)) {
+			TxnMove[NumMove++] = (u16)New;
+		} else if (!OranTableSameAction(&NewPtr[New], &OldPtr[Old],
+						ParamBytes)) {
+			TxnUpd[NumUpd++] = (u16)New;
+		}
+	}
+	for (Old = 0; Old < OldCount; Old++) {
+		if (!TxnTaken[Old]) {
+			TxnDel[NumDel++] = &OldPtr[Old];
+		}
+	}
+
+	/*
+	 * Each move is split on the lowest wildcard bit whose halves clash
+	 * with no entry of either set and no other half. The old copies of
+	 * split moves go with the deletes; the others are left for the end.
+	 */
+	if (NumMove != 0) {
+		OranTableIndex(TxnNewHash, NewPtr, NewCount, KeyBytes,
+			       HashMask);
+		HalfMask = 1;
+		while (HalfMask < 4 * NumMove) {
+			HalfMask <<= 1;
+		}
+		HalfMask--;
+		memset(TxnHalfHash, 0xFF,
+		       (HalfMask + 1) * sizeof(TxnHalfHash[0]));
+		if ((KeyBytes > ORAN_TABLE_SPLIT_BYTES) ||
+		    (XilSdnetTableGetKeySizeBits(TablePtr, &KeyBits) !=
+		     XIL_SDNET_SUCCESS) || (KeyBits > 8 * KeyBytes)) {
+			KeyBits = 0;
+		}
+	}
+	for (Move = 0; Move < NumMove; Move++) {
+		New = TxnMove[Move];
+		TxnSplit[Move] = 0;
+		for (Bit = 0; (Bit < KeyBits) && !TxnSplit[Move]; Bit++) {
+			if (!OranTableSplit(&NewPtr[New], KeyBytes, Bit,
+					    TxnHalf[Move],
+					    TxnHalfBytes[Move])) {
+				continue;
+			}
+			TxnSplit[Move] = 1;
+			for (Half = 0; Half < 2; Half++) {
+				HalfPtr = &TxnHalf[Move][Half];
+				if (OranTableIndexHas(TxnHash, OldPtr,
+						      HalfPtr, KeyBytes,
+						      HashMask) ||
+				    OranTableIndexHas(TxnNewHash, NewPtr,
+						      HalfPtr, KeyBytes,
+						      HashMask) ||
+				    OranTableIndexHas(TxnHalfHash,
+						      TxnHalf[0], HalfPtr,
+						      KeyBytes, HalfMask)) {
+					TxnSplit[Move] = 0;
+				}
+			}
+		}
+		if (TxnSplit[Move]) {
+			OranTableIndexAdd(TxnHalfHash, TxnHalf[0], 2 * Move,
+					  KeyBytes, HalfMask);
+			OranTableIndexAdd(TxnHalfHash, TxnHalf[0],
+					  2 * Move + 1, KeyBytes, HalfMask);
+			TxnDel[NumDel++] = &OldPtr[TxnMatch[New]];
+		}
+	}
+	NumIns = NumAdd;
+	for (Move = 0; Move < NumMove; Move++) {
+		if (TxnSplit[Move]) {
+			TxnIns[NumIns++] = &TxnHalf[Move][0];
+			TxnIns[NumIns++] = &TxnHalf[Move][1];
+		}
+	}
+	qsort(TxnIns, NumIns, sizeof(TxnIns[0]), OranTableEarlierFirst);
+	qsort(TxnDel, NumDel, sizeof(TxnDel[0]), OranTableLaterFirst);
+
+	for (Step = 0; Step < NumIns; Step++) {
+		OranTablePlan(&NumSteps, ORAN_TABLE_INSERT, TxnIns[Step],
+			      NULL);
+	}
+	for (Step = 0; Step < NumUpd; Step++) {
+		New = TxnUpd[Step];
+		OranTablePlan(&NumSteps, ORAN_TABLE_UPDATE, &NewPtr[New],
+			      &OldPtr[TxnMatch[New]]);
+	}
+	for (Step = 0; Step < NumDel; Step++) {
+		OranTablePlan(&NumSteps, ORAN_TABLE_DELETE, TxnDel[Step],
+			      NULL);
+	}
+	for (Move = 0; Move < NumMove; Move++) {
+		New = TxnMove[Move];
+		if (TxnSplit[Move]) {
+			OranTablePlan(&NumSteps, ORAN_TABLE_INSERT,
+				      &NewPtr[New], NULL);
+			OranTablePlan(&NumSteps, ORAN_TABLE_DELETE,
+				      &TxnHalf[Move][0], NULL);
+			OranTablePlan(&NumSteps, ORAN_TABLE_DELETE,
+				      &TxnHalf[Move][1], NULL);
+		}
+	}
+	for (Move = 0; Move < NumMove; Move++) {
+		New = TxnMove[Move];
+		if (!TxnSplit[Move]) {
+			OranTablePlan(&NumSteps, ORAN_TABLE_DELETE,
+				      &OldPtr[TxnMatch[New]], NULL);
+			OranTablePlan(&NumSteps, ORAN_TABLE_INSERT,
+				      &NewPtr[New], NULL);
+		}
+	}
+
+	OranSdnetWriteSequenceBegin();
+	for (Step = 0; Step < NumSteps; Step++) {
+		Result = OranTableDo(TablePtr, &TxnStep[Step]);
+		if (Result != XIL_SDNET_SUCCESS) {
+			break;
+		}
+	}
+	if (Result != XIL_SDNET_SUCCESS) {
+		/*
+		 * Errors are not checked while undoing: there is nothing
+		 * better to fall back to.
+		 */
+		xil_printf("Table commit failed at call %d of %d (%d added, "
+			   "%d updated, %d moved, %d deleted): %s, rolling "
+			   "back\r\n", (int)Step + 1, (int)NumSteps,
+			   (int)NumAdd, (int)NumUpd, (int)NumMove, (int)NumDel,
+			   XilSdnetReturnTypeToString(Result));
+		while (Step > 0) {
+			OranTableUndo(TablePtr, &TxnStep[--Step]);
+		}
+	}
+	OranSdnetWriteSequenceEnd();
+
+	return (Result == XIL_SDNET_SUCCESS) ? XST_SUCCESS : XST_FAILURE;
+}
+
+#endif /* ORAN_SDNET_CTRL */
@@ -0,0 +1,425 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file oran_trace.c
+*
+* Register access tracing for the SDNet drivers.
+*
+* OranTraceWrap puts a recording environment interface in front of the one
+* built by OranSdnetInit. Every WordRead32/WordWrite32 the drivers make is
+* forwarded unchanged and, between OranTraceStart and OranTraceStop,
+* appended to a buffer of OranTraceRecord with its time and the driver call
+* it belongs to. Driver calls are marked with ORAN_SDNET_CALL, which is an
+* empty wrapper unless ORAN_SDNET_TRACE is set.
+*
+* For each call OranTracePrint shows how often it ran, its register reads,
+* writes and time, with log2 histograms of all three. The record buffer is
+* plain memory: its address and size are printed so that it can be saved
+* with XSCT (mrd -bin -file trace.bin <address> <words>) and fed back
+* through OranTraceReplay, against the hardware or any other environment.
+*
+* The application is single threaded and the drivers never call each
+* other, so one current call is enough; a call marked inside another is
+* counted as part of the outer one. With ORAN_SDNET_THREADS, trace with
+* one thread changing tables: the accesses of other threads would be put
+* down to its call.
+*
+*****************************************************************************/
+
+/***************************** Include Files ********************************/
+
+#include <string.h>
+#include "xil_printf.h"
+#include "xstatus.h"
+#include "xtime_l.h"
+#include "oran_sdnet.h"
+
+#if ORAN_SDNET_CTRL
+
+/************************** Constant Definitions ****************************/
+
+#define ORAN_TRACE_BUCKETS	12	/* 0, 1, 2-3, ... 1024 and more */
+
+/**************************** Type Definitions ******************************/
+
+typedef struct {
+	u32 Calls;
+	u32 Reads;
+	u32 Writes;
+	u64 Ticks;
+	u32 MaxTicks;
+	u32 ReadHist[ORAN_TRACE_BUCKETS];
+	u32 WriteHist[ORAN_TRACE_BUCKETS];
+	u32 UsecHist[ORAN_TRACE_BUCKETS];
+} OranTraceCallStats;
+
+/************************** Variable Definitions ****************************/
+
+static const char *const OranTraceCallNames[ORAN_CALL_COUNT] = {
+	"(none)",
+	"TargetInit",
+	"TableInsert",
+	"TableUpdate",
+	"TableDelete",
+	"TableReset",
+};
+
+static XilSdnetEnvIf *TraceInnerPtr;
+static XilSdnetEnvIf TraceEnvIf;
+static OranTraceRecord TraceBuf[ORAN_TRACE_RECORDS];
+static u32 TraceCount;
+static u32 TraceDropped;
+static u8 TraceOn;
+static XTime TraceStart;
+
+static OranTraceCallStats TraceStats[ORAN_CALL_COUNT];
+static u32 TraceCall;
+static u32 TraceDepth;
+static u16 TraceSeq;
+static u32 TraceCallReads;
+static u32 TraceCallWrites;
+static XTime TraceCallStart;
+
+/*****************************************************************************/
+/*
+ * Bucket of a histogram: 0, then one per power of two
+ */
+static u32 OranTraceBucket(u32 Value)
+{
+	u32 Bucket = 0;
+
+	while ((Value != 0) && (Bucket < ORAN_TRACE_BUCKETS - 1)) {
+		Value >>= 1;
+		Bucket++;
+	}
+
+	return Bucket;
+}
+
+static void OranTraceAppend(u8 Op, u32 Address, u32 Value)
+{
+	OranTraceRecord *RecordPtr;
+	XTime Now;
+
+	if (!TraceOn) {
+		return;
+	}
+	if (TraceCount == ORAN_TRACE_RECORDS) {
+		TraceDropped++;
+		return;
+	}
+
+	XTime_GetTime(&Now);
+	RecordPtr = &TraceBuf[TraceCount++];
+	RecordPtr->Ticks = (u32)(Now - TraceStart);
+	RecordPtr->Address = Address;
+	RecordPtr->Value = Value;
+	RecordPtr->Op = Op;
+	RecordPtr->Call = (u8)TraceCall;
+	RecordPtr->Seq = TraceSeq;
+}
+
+static XilSdnetReturnType OranTraceWrite32(XilSdnetEnvIf *EnvIfPtr,
+					   XilSdnetAddressType Address,
+					   uint32_t WriteValue)
+{
+	(void)EnvIfPtr;
+	TraceCallWrites++;
+	OranTraceAppend(ORAN_TRACE_WRITE, (u32)Address, WriteValue);
+	return TraceInnerPtr->WordWrite32(TraceInnerPtr, Address, WriteValue);
+}
+
+static XilSdnetReturnType OranTraceRead32(XilSdnetEnvIf *EnvIfPtr,
+					  XilSdnetAddressType Address,
+					  uint32_t *ReadValuePtr)
+{
+	XilSdnetReturnType Result;
+
+	(void)EnvIfPtr;
+	Result = TraceInnerPtr->WordRead32(TraceInnerPtr, Address,
+					   ReadValuePtr);
+	TraceCallReads++;
+	OranTraceAppend(ORAN_TRACE_READ, (u32)Address, *ReadValuePtr);
+	return Result;
+}
+
+/****************************************************************************/
+/**
+*
+* Builds a recording environment interface in front of another one.
+*
+* @param	InnerPtr is the interface that performs the accesses. It
+*		must stay valid while the returned one is in use.
+*
+* @return	The recording interface, to be handed to the drivers in
+*		place of InnerPtr.
+*
+* @note		There is one recording interface; wrapping again replaces
+*		the interface it forwards to.
+*
+*****************************************************************************/
+XilSdnetEnvIf *OranTraceWrap(XilSdnetEnvIf *InnerPtr)
+{
+	TraceInnerPtr = InnerPtr;
+	TraceEnvIf = *InnerPtr;
+	TraceEnvIf.WordWrite32 = OranTraceWrite32;
+	TraceEnvIf.WordRead32 = OranTraceRead32;
+
+	return &TraceEnvIf;
+}
+
+/****************************************************************************/
+/**
+*
+* Clears the record buffer and the per-call statistics and starts
+* recording.
+*
+* @param	None.
+*
+* @return	None.
+*
+* @note		Statistics are gathered whether or not recording is on.
+*
+*****************************************************************************/
+void OranTraceStart(void)
+{
+	memset(TraceStats, 0, sizeof(TraceStats));
+	TraceCount = 0;
+	TraceDropped = 0;
+	XTime_GetTime(&TraceStart);
+	TraceOn = 1;
+}
+
+/****************************************************************************/
+/**
+*
+* Stops recording. The records taken so far stay in the buffer.
+*
+* @param	None.
+*
+* @return	None.
+*
+* @note		None.
+*
+*****************************************************************************/
+void OranTraceStop(void)
+{
+	TraceOn = 0;
+}
+
+/****************************************************************************/
+/**
+*
+* Marks the start of a driver call. Used through ORAN_SDNET_CALL.
+*
+* @param	Call is the driver call about to run.
+*
+* @return	None.
+*
+* @note		None.
+*
+*****************************************************************************/
+void OranTraceEnter(OranSdnetCall Call)
+{
+	if (TraceDepth++ != 0) {
+		return;
+	}
+
+	TraceCall = Call;
+	TraceSeq++;
+	TraceCallReads = 0;
+	TraceCallWrites = 0;
+	XTime_GetTime(&TraceCallStart);
+}
+
+/****************************************************************************/
+/**
+*
+* Marks the end of the driver call started by OranTraceEnter and accounts
+* for its accesses and time.
+*
+* @param	Result is what the driver call returned.
+*
+* @return	Result, unchanged.
+*
+* @note		None.
+*
+*****************************************************************************/
+XilSdnetReturnType OranTraceLeave(XilSdnetReturnType Result)
+{
+	OranTraceCallStats *StatsPtr;
+	XTime Now;
+	u32 Ticks;
+
+	if ((TraceDepth == 0) || (--TraceDepth != 0)) {
+		return Result;
+	}
+
+	XTime_GetTime(&Now);
+	Ticks = (u32)(Now - TraceCallStart);
+	StatsPtr = &TraceStats[TraceCall];
+	StatsPtr->Calls++;
+	StatsPtr->Reads += TraceCallReads;
+	StatsPtr->Writes += TraceCallWrites;
+	StatsPtr->Ticks += Ticks;
+	if (Ticks > StatsPtr->MaxTicks) {
+		StatsPtr->MaxTicks = Ticks;
+	}
+	StatsPtr->ReadHist[OranTraceBucket(TraceCallReads)]++;
+	StatsPtr->WriteHist[OranTraceBucket(TraceCallWrites)]++;
+	StatsPtr->UsecHist[OranTraceBucket((u32)((u64)Ticks * 1000000 /
+						  COUNTS_PER_SECOND))]++;
+
+	TraceCall = ORAN_CALL_NONE;
+	return Result;
+}
+
+/****************************************************************************/
+/**
+*
+* Returns the records taken since OranTraceStart.
+*
+* @param	CountPtr receives the number of records.
+*
+* @return	The first record.
+*
+* @note		None.
+*
+*****************************************************************************/
+const OranTraceRecord *OranTraceRecords(u32 *CountPtr)
+{
+	*CountPtr = TraceCount;
+	return TraceBuf;
+}
+
+/*****************************************************************************/
+/*
+ * One histogram on one line, buckets 0, 1, 2-3, ...
+ */
+static void OranTracePrintHist(const char *NamePtr, const u32 *HistPtr)
+{
+	u32 Last = ORAN_TRACE_BUCKETS;
+	u32 Bucket;
+
+	while ((Last > 0) && (HistPtr[Last - 1] == 0)) {
+		Last--;
+	}
+	xil_printf("    %-6s", NamePtr);
+	for (Bucket = 0; Bucket < Last; Bucket++) {
+		xil_printf(" %s%d:%d", (Bucket == ORAN_TRACE_BUCKETS - 1) ?
+			   ">=" : "", Bucket ? 1 << (Bucket - 1) : 0,
+			   (int)HistPtr[Bucket]);
+	}
+	xil_printf("\r\n");
+}
+
+/****************************************************************************/
+/**
+*
+* Prints the per-call statistics and where the record buffer is.
+*
+* @param	None.
+*
+* @return	None.
+*
+* @note		Times are in microseconds.
+*
+*****************************************************************************/
+void OranTracePrint(void)
+{
+	const OranTraceCallStats *StatsPtr;
+	u32 Call;
+
+	xil_printf("%-12s %7s %8s %8s %9s %8s\r\n", "sdnet call", "calls",
+		   "reads", "writes", "total us", "max us");
+	for (Call = 0; Call < ORAN_CALL_COUNT; Call++) {
+		StatsPtr = &TraceStats[Call];
+		if (StatsPtr->Calls == 0) {
+			continue;
+		}
+		xil_printf("%-12s %7d %8d %8d %9d %8d\r\n",
+			   OranTraceCallNames[Call], (int)StatsPtr->Calls,
+			   (int)StatsPtr->Reads, (int)StatsPtr->Writes,
+			   (int)(StatsPtr->Ticks * 1000000 / COUNTS_PER_SECOND),
+			   (int)((u64)StatsPtr->MaxTicks * 1000000 /
+				 COUNTS_PER_SECOND));
+		OranTracePrintHist("reads", StatsPtr->ReadHist);
+		OranTracePrintHist("writes", StatsPtr->WriteHist);
+		OranTracePrintHist("us", StatsPtr->UsecHist);
+	}
+
+	xil_printf("sdnet trace: %d records of %d bytes at 0x%08x, "
+		   "%d dropped\r\n", (int)TraceCount,
+		   (int)sizeof(OranTraceRecord), (unsigned)(UINTPTR)TraceBuf,
+		   (int)TraceDropped);
+}
+
+/****************************************************************************/
+/**
+*
+* Plays a trace back into an environment interface: writes are repeated
+* and reads are made and compared with the recorded value.
+*
+* @param	EnvIfPtr is the interface to play into.
+* @param	RecordPtr points to the records.
+* @param	Count is the number of records.
+* @param	MismatchPtr receives the number of reads that returned
+*		something else than in the trace. May be NULL.
+*
+* @return	XST_SUCCESS if every access succeeded and every read
+*		matched, otherwise XST_FAILURE.
+*
+* @note		Timing is not reproduced; the accesses are made back to
+*		back.
+*
+*****************************************************************************/
+LONG OranTraceReplay(XilSdnetEnvIf *EnvIfPtr, const OranTraceRecord *RecordPtr,
+		     u32 Count, u32 *MismatchPtr)
+{
+	XilSdnetReturnType Result = XIL_SDNET_SUCCESS;
+	u32 Mismatches = 0;
+	u32 Value;
+	u32 Index;
+
+	if ((EnvIfPtr == NULL) || ((RecordPtr == NULL) && (Count != 0))) {
+		return XST_FAILURE;
+	}
+
+	for (Index = 0; (Index < Count) && (Result == XIL_SDNET_SUCCESS);
+	     Index++) {
+		if (RecordPtr[Index].Op == ORAN_TRACE_WRITE) {
+			Result = EnvIfPtr->WordWrite32(EnvIfPtr,
+						       RecordPtr[Index].Address,
+						       RecordPtr[Index].Value);
+			continue;
+		}
+
+		Result = EnvIfPtr->WordRead32(EnvIfPtr,
+					      RecordPtr[Index].Address, &Value);
+		if ((Result == XIL_SDNET_SUCCESS) &&
+		    (Value != RecordPtr[Index].Value)) {
+			if (Mismatches++ == 0) {
+				xil_printf("Replay: record %d read 0x%08x from "
+					   "0x%05x, trace has 0x%08x\r\n",
+					   (int)Index, (unsigned)Value,
+					   (unsigned)RecordPtr[Index].Address,
+					   (unsigned)RecordPtr[Index].Value);
+			}
+		}
+	}
+
+	if (MismatchPtr != NULL) {
+		*MismatchPtr = Mismatches;
+	}
+	if ((Result != XIL_SDNET_SUCCESS) || (Mismatches != 0)) {
+		return XST_FAILURE;
+	}
+
+	return XST_SUCCESS;
+}
+
+#endif /* ORAN_SDNET_CTRL */
@@ -83,15 +83,8 @@
 /**************************** Type Definitions ******************************/
 
 /*
- * Define an aligned data type for an ethernet frame. This declaration is
- * specific to the GNU compiler
+ * Frames are built in buffers of the packet buffer pool, see oran_buf.h
  */
-#ifdef __ICCARM__
-typedef char EthernetFrame[XEMACPS_MAX_VLAN_FRAME_SIZE_JUMBO];
-#else
-typedef char EthernetFrame[XEMACPS_MAX_VLAN_FRAME_SIZE_JUMBO]
-	__attribute__ ((aligned(64)));
-#endif
 
 /************************** Function Prototypes *****************************/
 
@@ -101,12 +94,11 @@ typedef char EthernetFrame[XEMACPS_MAX_VLAN_FRAME_SIZE_JUMBO]
  * Utility functions implemented in xemacps_example_util.c
  */
 void EmacPsUtilSetupUart(void);
-void EmacPsUtilFrameHdrFormatMAC(EthernetFrame * FramePtr, char *DestAddr);
-void EmacPsUtilFrameHdrFormatType(EthernetFrame * FramePtr, u16 FrameType);
-void EmacPsUtilFrameSetPayloadData(EthernetFrame * FramePtr, u32 PayloadSize);
-LONG EmacPsUtilFrameVerify(EthernetFrame * CheckFrame,
-			   EthernetFrame * ActualFrame);
-void EmacPsUtilFrameMemClear(EthernetFrame * FramePtr);
+void EmacPsUtilFrameHdrFormatMAC(u8 * FramePtr, char *DestAddr);
+void EmacPsUtilFrameHdrFormatType(u8 * FramePtr, u16 FrameType);
+void EmacPsUtilFrameSetPayloadData(u8 * FramePtr, u32 PayloadSize);
+LONG EmacPsUtilFrameVerify(u8 * CheckFrame, u8 * ActualFrame);
+void EmacPsUtilFrameMemClear(u8 * FramePtr, u32 Bytes);
 LONG EmacPsUtilEnterLoopback(XEmacPs * XEmacPsInstancePtr, u32 Speed);
 void EmacPsUtilstrncpy(char *Destination, const char *Source, u32 n);
 void EmacPsUtilErrorTrap(const char *Message);
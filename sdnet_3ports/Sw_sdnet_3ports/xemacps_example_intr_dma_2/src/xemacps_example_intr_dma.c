@@ -23,6 +23,10 @@
 * - EmacPsDmaSingleFrameIntrExample demonstrates the simplest way to send and
 *   receive frames in in interrupt driven DMA mode.
 *
+* - EmacPsDmaRingExample runs GEM3 on multi-descriptor rings instead of the
+*   PL FIFO interface (ORAN_GEM_RING), polled after RX interrupts
+*   (ORAN_GEM_NAPI) or all the time.
+*
 * - EmacPsErrorHandler() demonstrates how to manage asynchronous errors.
 *
 * - EmacPsResetDevice() demonstrates how to reset the driver/HW without
@@ -110,6 +114,7 @@
 
 /***************************** Include Files ********************************/
 #include "xemacps_example.h"
+#include "oran_buf.h"
 #include "xil_exception.h"
 
 #ifndef __MICROBLAZE__
@@ -119,6 +124,74 @@
 #if EL1_NONSECURE
 #include "xil_smc.h"
 #endif
+
+/* Defines ORAN_SDNET_CTRL, off until sdnet_0 has the tables */
+#include "oran_sdnet.h"
+
+/*
+ * Time filling eaxc_steer with single and batched inserts at start-up and
+ * print entries/s and register accesses per entry. Needs ORAN_SDNET_CTRL.
+ */
+#ifndef ORAN_TABLE_BENCH
+#define ORAN_TABLE_BENCH	0
+#endif
+
+/*
+ * Classify received frames on the PS with the p4gen output of main.json,
+ * the same decision the SDNet pipeline takes in the PL. Regenerate
+ * oran_classify.h with sdnet_3ports/tools/p4tools when the P4 program or
+ * the default policy changes.
+ */
+#ifndef ORAN_PS_CLASSIFY
+#define ORAN_PS_CLASSIFY	1
+#endif
+
+#if ORAN_PS_CLASSIFY
+#include <string.h>
+#include "oran_classify.h"
+
+/* axis_tid of frames handed to the PS classifier (the GEM3 port) */
+#define ORAN_PS_CLASSIFY_TID	0x02
+#endif
+
+/*
+ * Run GEM3 on the DMA rings of oran_gem_ring.c, terminating its traffic on
+ * the PS, instead of bridging it to the PL over the FIFO interface. With
+ * ORAN_GEM_RING_BENCH set to a number of milliseconds, measure the rings
+ * in PHY loopback for that long per frame size and TX queue rather than
+ * serve them.
+ */
+#ifndef ORAN_GEM_RING
+#define ORAN_GEM_RING		0
+#endif
+#ifndef ORAN_GEM_RING_BENCH
+#define ORAN_GEM_RING_BENCH	0
+#endif
+
+/*
+ * Serve the rings from the GEM3 RX interrupt with oran_gem_napi.c, sleeping
+ * while the port is quiet, rather than polling them all the time
+ */
+#ifndef ORAN_GEM_NAPI
+#define ORAN_GEM_NAPI		1
+#endif
+
+/*
+ * Drop the cache maintenance of GEM3 frames when psu_init has made its AXI
+ * port coherent (IOU_COHERENT_CTRL), whatever the exported hardware says
+ * in XPAR_XEMACPS_0_IS_CACHE_COHERENT. The design must route the port
+ * through the CCI with snooping on; psu_init sets both together.
+ */
+#ifndef ORAN_GEM_COHERENT_AUTO
+#define ORAN_GEM_COHERENT_AUTO	0
+#endif
+
+#if ORAN_GEM_RING
+#include "oran_gem_ring.h"
+#endif
+#if ORAN_GEM_COHERENT_AUTO && defined(__aarch64__)
+#include "xiou_slcr.h"
+#endif
 /*************************** Constant Definitions ***************************/
 
 /*
@@ -200,15 +273,13 @@
 
 /*************************** Variable Definitions ***************************/
 
-#ifdef __ICCARM__
-#pragma data_alignment = 64
-EthernetFrame TxFrame;		/* Transmit buffer */
-#pragma data_alignment = 64
-EthernetFrame RxFrame;		/* Receive buffer */
-#else
-EthernetFrame TxFrame;		/* Transmit buffer */
-EthernetFrame RxFrame;		/* Receive buffer */
-#endif
+/*
+ * Frame buffers of the single frame example, from the packet buffer pool.
+ * The receive buffer holds what the DMA may write into one RX buffer.
+ */
+u8 *TxFramePtr;			/* Transmit buffer */
+u8 *RxFramePtr;			/* Receive buffer */
+u32 RxBufBytes;
 
 /*
  * Buffer descriptors are allocated in uncached memory. The memory is made
@@ -293,6 +364,12 @@ LONG EmacPsDmaIntrExample(INTC *IntcInstancePtr,
 
 LONG EmacPsDmaSingleFrameIntrExample(XEmacPs * EmacPsInstancePtr);
 
+#if ORAN_GEM_RING
+static LONG EmacPsDmaRingExample(INTC *IntcInstancePtr,
+				 XEmacPs *EmacPsInstancePtr,
+				 u16 EmacPsIntrId);
+#endif
+
 /*
  * Interrupt setup and Callbacks for examples
  */
@@ -336,9 +413,51 @@ int main(void)
 
 	xil_printf("Entering into main() \r\n");
 
-
 	configEthSub();
 
+#if ORAN_SDNET_CTRL
+	/*
+	 * Program the plane classification table before any traffic is
+	 * bridged through GEM3. eaxc_steer starts empty, so all U-plane
+	 * streams share their plane's class until entries are added. With
+	 * ORAN_SDNET_METER, M-plane traffic from GEM3 is metered from the
+	 * first frame; a meter that cannot be set up is reported and left
+	 * at its reset rates.
+	 * With ORAN_SDNET_TRACE, the register accesses of this bring-up
+	 * (and of the benchmark below) are recorded and summarized. The
+	 * driver memory it took from the arena is printed after it.
+	 * With ORAN_SNAPSHOT_SD both tables come back from the snapshot on
+	 * the SD card, when there is one for this bitstream.
+	 */
+#if ORAN_SDNET_TRACE
+	OranTraceStart();
+#endif
+	if ((OranSdnetInit(ORAN_SDNET_BASEADDR) != XST_SUCCESS) ||
+	    (OranPolicyInit() != XST_SUCCESS) ||
+	    (OranEaxcInit() != XST_SUCCESS) ||
+	    (OranSnapshotBoot() != XST_SUCCESS)) {
+		EmacPsUtilErrorTrap("SDNet plane policy setup failed\r\n");
+		return XST_FAILURE;
+	}
+#if ORAN_SDNET_METER
+	if (OranMeterLoadDefaults() != XST_SUCCESS) {
+		xil_printf("port_meter defaults not loaded\r\n");
+	}
+#endif
+#if ORAN_TABLE_BENCH
+	if (OranEaxcBench(ORAN_EAXC_DEPTH) != XST_SUCCESS) {
+		xil_printf("eaxc_steer benchmark failed\r\n");
+	}
+#endif
+#if ORAN_SDNET_TRACE
+	OranTraceStop();
+	OranTracePrint();
+#endif
+#if ORAN_SDNET_ARENA
+	OranArenaPrint();
+#endif
+#endif
+
 	/*
 	 * Call the EmacPs DMA interrupt example , specify the parameters
 	 * generated in xparameters.h
@@ -353,6 +472,16 @@ int main(void)
 		return XST_FAILURE;
 	}
 
+#if ORAN_SDNET_CTRL && ORAN_SDNET_STATS
+	{
+		static OranStatsSnapshot Stats;
+
+		if (OranStatsRead(&Stats) == XST_SUCCESS) {
+			OranStatsPrint(&Stats);
+		}
+	}
+#endif
+
 	xil_printf("Successfully ran Emacps intr dma Example\r\n");
 	return XST_SUCCESS;
 }
@@ -429,6 +558,12 @@ LONG EmacPsDmaIntrExample(INTC * IntcInstancePtr,
 #endif
 #endif
 
+	/*
+	 * The frame buffers of both the single frame example and the GEM3
+	 * rings come from the packet buffer pool.
+	 */
+	OranBufInit();
+
 	/*
 	 *  Initialize instance. Should be configured for DMA
 	 *  This example calls _CfgInitialize instead of _Initialize due to
@@ -445,6 +580,15 @@ LONG EmacPsDmaIntrExample(INTC * IntcInstancePtr,
 		return XST_FAILURE;
 	}
 
+#if ORAN_GEM_COHERENT_AUTO && defined(__aarch64__)
+	if ((Xil_In32(XIOU_SLCR_COHERENT_CTRL) &
+	     XIOU_SLCR_COHERENT_CTRL_GEM3_AXI_COH_MASK) != 0) {
+		EmacPsInstancePtr->Config.IsCacheCoherent = 1;
+	}
+	xil_printf("GEM3 DMA is %scache coherent\r\n",
+		   EmacPsInstancePtr->Config.IsCacheCoherent ? "" : "not ");
+#endif
+
 	//Enable full duplex. Write a 1 to the gem.network_config[full_duplex] bit.
 
 //	XEmacPs_WriteReg(XPAR_XEMACPS_0_BASEADDR,
@@ -657,6 +801,11 @@ LONG EmacPsDmaIntrExample(INTC * IntcInstancePtr,
 		}
 	}
 
+#if ORAN_GEM_RING
+	return EmacPsDmaRingExample(IntcInstancePtr, EmacPsInstancePtr,
+				    EmacPsIntrId);
+#endif
+
 	//write 1 in GEM3_FIFO_CLK_SEL
 
 	XEmacPs_WriteReg(0xFF180308,
@@ -754,6 +903,143 @@ LONG EmacPsDmaIntrExample(INTC * IntcInstancePtr,
 }
 
 
+#if ORAN_GEM_RING
+/****************************************************************************/
+/**
+*
+* Runs GEM3 on its own DMA rings. The PL FIFO interface is switched off,
+* the rings are built in bd_space and started, and the frames received are
+* served in a loop or, with ORAN_GEM_RING_BENCH, looped back by the PHY to
+* measure the rings and the wait of PTP frames behind M-plane load on
+* each TX queue. With ORAN_GEM_NAPI the loop polls after an RX
+* interrupt and waits for the next one when the ring is empty.
+*
+* @param	IntcInstancePtr is a pointer to the instance of the Intc
+*		driver.
+* @param	EmacPsInstancePtr is a pointer to the instance of the EmacPs
+*		driver, with its options set and the PHY in loopback.
+* @param	EmacPsIntrId is interrupt ID and is typically
+*		XPAR_<EMACPS_instance>_INTR value from xparameters.h.
+*
+* @return	XST_FAILURE if the rings cannot be set up or a benchmark
+*		fails. The service loop does not return.
+*
+* @note		None.
+*
+*****************************************************************************/
+static LONG EmacPsDmaRingExample(INTC *IntcInstancePtr,
+				 XEmacPs *EmacPsInstancePtr,
+				 u16 EmacPsIntrId)
+{
+	OranGemFrame Frames[ORAN_GEM_BATCH];
+	LONG Status;
+	u32 Count;
+	u32 Index;
+#if ORAN_GEM_RING_BENCH
+	OranGemRingCounters Counters;
+	static const u32 BenchBytes[] = { 60, 512, 1514 };
+#endif
+
+	/* Frames go through the GEM DMA, not the PL FIFO */
+	XEmacPs_WriteReg(XPAR_XEMACPS_0_BASEADDR, 0x0000004C, 0x0);
+	XEmacPs_WriteReg(0xFF180308, 0x00000000,
+			 XEmacPs_ReadReg(0xFF180308, 0x00000000) & ~0x40000);
+
+	Status = OranGemRingInit(EmacPsInstancePtr, (UINTPTR)bd_space,
+				 sizeof(bd_space));
+	if (Status != XST_SUCCESS) {
+		return XST_FAILURE;
+	}
+	OranGemRingStart();
+
+#if ORAN_GEM_RING_BENCH
+	for (Index = 0; Index < sizeof(BenchBytes) / sizeof(BenchBytes[0]);
+	     Index++) {
+		if (OranGemRingBench(ORAN_GEM_RING_BENCH,
+				     BenchBytes[Index]) != XST_SUCCESS) {
+			Status = XST_FAILURE;
+		}
+	}
+	if (OranGemRingQueueBench(ORAN_GEM_RING_BENCH) != XST_SUCCESS) {
+		Status = XST_FAILURE;
+	}
+	OranGemRingGetCounters(&Counters);
+	OranGemRingPrint(&Counters);
+	XEmacPs_Stop(EmacPsInstancePtr);
+	(void)IntcInstancePtr;
+	(void)EmacPsIntrId;
+	(void)Frames;
+	(void)Count;
+
+	return Status;
+#else
+#if ORAN_GEM_NAPI
+	/*
+	 * OranGemNapiIntrHandler takes the place of XEmacPs_IntrHandler and
+	 * passes TX and error status on to these handlers
+	 */
+	Status = XEmacPs_SetHandler(EmacPsInstancePtr,
+				    XEMACPS_HANDLER_DMASEND,
+				    (void *)XEmacPsSendHandler,
+				    EmacPsInstancePtr);
+	Status |= XEmacPs_SetHandler(EmacPsInstancePtr, XEMACPS_HANDLER_ERROR,
+				     (void *)XEmacPsErrorHandler,
+				     EmacPsInstancePtr);
+	Status |= EmacPsSetupIntrSystem(IntcInstancePtr, EmacPsInstancePtr,
+					EmacPsIntrId);
+	if (Status == XST_SUCCESS) {
+#ifdef XPAR_INTC_0_DEVICE_ID
+		XIntc_Disconnect(IntcInstancePtr, EmacPsIntrId);
+		Status = XIntc_Connect(IntcInstancePtr, EmacPsIntrId,
+			(XInterruptHandler)OranGemNapiIntrHandler, NULL);
+		XIntc_Enable(IntcInstancePtr, EmacPsIntrId);
+#else
+		XScuGic_Disconnect(IntcInstancePtr, EmacPsIntrId);
+		Status = XScuGic_Connect(IntcInstancePtr, EmacPsIntrId,
+			(Xil_InterruptHandler)OranGemNapiIntrHandler, NULL);
+		XScuGic_Enable(IntcInstancePtr, EmacPsIntrId);
+#endif
+	}
+	if (Status != XST_SUCCESS) {
+		return XST_FAILURE;
+	}
+	OranGemNapiStart(EmacPsInstancePtr, ORAN_GEM_NAPI_USECS,
+			 ORAN_GEM_NAPI_FRAMES, ORAN_GEM_NAPI_BUDGET);
+#else
+	(void)IntcInstancePtr;
+	(void)EmacPsIntrId;
+#endif
+
+	while (1) {
+#if ORAN_GEM_NAPI
+		Count = OranGemNapiPoll(Frames, ORAN_GEM_BATCH);
+#else
+		Count = OranGemRingRecv(Frames, ORAN_GEM_BATCH);
+#endif
+		for (Index = 0; Index < Count; Index++) {
+			/* The M-plane agent takes the frames here */
+			OranGemBufFree(Frames[Index].BufPtr);
+		}
+		if (Count == 0) {
+			(void)OranGemRingReclaim();
+#if ORAN_GEM_NAPI
+			/*
+			 * Wait for the RX interrupt. It is taken once the
+			 * exceptions are enabled again, and one that came
+			 * in before the wfi still ends it.
+			 */
+			Xil_ExceptionDisable();
+			if (OranGemNapiScheduled() == FALSE) {
+				__asm__ __volatile__ ("wfi");
+			}
+			Xil_ExceptionEnable();
+#endif
+		}
+	}
+#endif
+}
+#endif
+
 /****************************************************************************/
 /**
 *
@@ -794,24 +1080,41 @@ LONG EmacPsDmaSingleFrameIntrExample(XEmacPs *EmacPsInstancePtr)
 	 */
 	TxFrameLength = XEMACPS_HDR_SIZE + PayloadSize;
 
+	/*
+	 * Take the frame buffers from the pool: the receive buffer must
+	 * hold the RX buffer size the DMA was set to by the jumbo option.
+	 */
+	RxBufBytes = ((XEmacPs_ReadReg(EmacPsInstancePtr->Config.BaseAddress,
+				       XEMACPS_DMACR_OFFSET) &
+		       XEMACPS_DMACR_RXBUF_MASK) >> XEMACPS_DMACR_RXBUF_SHIFT) *
+		     XEMACPS_RX_BUF_UNIT;
+	TxFramePtr = OranBufAlloc(TxFrameLength);
+	RxFramePtr = OranBufAlloc(RxBufBytes);
+	if ((TxFramePtr == NULL) || (RxFramePtr == NULL)) {
+		EmacPsUtilErrorTrap("No frame buffer in the pool");
+		OranBufFree(TxFramePtr);
+		OranBufFree(RxFramePtr);
+		return XST_FAILURE;
+	}
+
 	/*
 	 * Setup packet to be transmitted
 	 */
-	EmacPsUtilFrameHdrFormatMAC(&TxFrame, EmacPsMAC);
-	EmacPsUtilFrameHdrFormatType(&TxFrame, PayloadSize);
-	EmacPsUtilFrameSetPayloadData(&TxFrame, PayloadSize);
+	EmacPsUtilFrameHdrFormatMAC(TxFramePtr, EmacPsMAC);
+	EmacPsUtilFrameHdrFormatType(TxFramePtr, PayloadSize);
+	EmacPsUtilFrameSetPayloadData(TxFramePtr, PayloadSize);
 
 	if (EmacPsInstancePtr->Config.IsCacheCoherent == 0) {
-		Xil_DCacheFlushRange((UINTPTR)&TxFrame, sizeof(EthernetFrame));
+		Xil_DCacheFlushRange((UINTPTR)TxFramePtr, TxFrameLength);
 	}
 
 	/*
 	 * Clear out receive packet memory area
 	 */
-	EmacPsUtilFrameMemClear(&RxFrame);
+	EmacPsUtilFrameMemClear(RxFramePtr, RxBufBytes);
 
 	if (EmacPsInstancePtr->Config.IsCacheCoherent == 0) {
-		Xil_DCacheFlushRange((UINTPTR)&RxFrame, sizeof(EthernetFrame));
+		Xil_DCacheFlushRange((UINTPTR)RxFramePtr, RxBufBytes);
 	}
 
 	/*
@@ -832,7 +1135,7 @@ LONG EmacPsDmaSingleFrameIntrExample(XEmacPs *EmacPsInstancePtr)
 	 * BD.
 	 */
 
-	XEmacPs_BdSetAddressRx(BdRxPtr, (UINTPTR)&RxFrame);
+	XEmacPs_BdSetAddressRx(BdRxPtr, (UINTPTR)RxFramePtr);
 
 	/*
 	 * Enqueue to HW
@@ -855,7 +1158,7 @@ LONG EmacPsDmaSingleFrameIntrExample(XEmacPs *EmacPsInstancePtr)
 	}
 	/*
 	 * Allocate, setup, and enqueue 1 TxBDs. The first BD will
-	 * describe the first 32 bytes of TxFrame and the rest of BDs
+	 * describe the first 32 bytes of the frame and the rest of BDs
 	 * will describe the rest of the frame.
 	 *
 	 * The function below will allocate 1 adjacent BDs with Bd1Ptr
@@ -871,7 +1174,7 @@ LONG EmacPsDmaSingleFrameIntrExample(XEmacPs *EmacPsInstancePtr)
 	/*
 	 * Setup first TxBD
 	 */
-	XEmacPs_BdSetAddressTx(Bd1Ptr, (UINTPTR)&TxFrame);
+	XEmacPs_BdSetAddressTx(Bd1Ptr, (UINTPTR)TxFramePtr);
 	XEmacPs_BdSetLength(Bd1Ptr, TxFrameLength);
 	XEmacPs_BdClearTxUsed(Bd1Ptr);
 	XEmacPs_BdSetLast(Bd1Ptr);
@@ -975,11 +1278,33 @@ LONG EmacPsDmaSingleFrameIntrExample(XEmacPs *EmacPsInstancePtr)
 		return XST_FAILURE;
 	}
 
-	if (EmacPsUtilFrameVerify(&TxFrame, &RxFrame) != 0) {
+	/*
+	 * Invalidate only the lines the frame was received into: the
+	 * buffer was cleaned in full before it was posted.
+	 */
+	if (EmacPsInstancePtr->Config.IsCacheCoherent == 0) {
+		Xil_DCacheInvalidateRange((UINTPTR)RxFramePtr, RxFrLen);
+	}
+
+	if (EmacPsUtilFrameVerify(TxFramePtr, RxFramePtr) != 0) {
 		EmacPsUtilErrorTrap("Data mismatch");
 		return XST_FAILURE;
 	}
 
+#if ORAN_PS_CLASSIFY
+	{
+		OranClassifyMeta Meta;
+
+		memset(&Meta, 0, sizeof(Meta));
+		Meta.metadata_axis_tid = ORAN_PS_CLASSIFY_TID;
+		(void)OranClassify((const uint8_t *)RxFramePtr, RxFrLen,
+				   &OranClassifyDefaultTables, &Meta);
+		xil_printf("PS classify: tdest %d prio %d parser_error %d\r\n",
+			   (int)Meta.metadata_axis_tdest,
+			   (int)Meta.metadata_prio, (int)Meta.parser_error);
+	}
+#endif
+
 	/*
 	 * Return the RxBD back to the channel for later allocation. Free
 	 * the exact number we just post processed.
@@ -993,9 +1318,13 @@ LONG EmacPsDmaSingleFrameIntrExample(XEmacPs *EmacPsInstancePtr)
 
 	/*
 	 * Finished this example. If everything worked correctly, all TxBDs
-	 * and RxBDs should be free for allocation. Stop the device.
+	 * and RxBDs should be free for allocation. Stop the device and
+	 * give the frame buffers back; on the error paths above they stay
+	 * out of the pool, as the GEM may still write to them.
 	 */
 	XEmacPs_Stop(EmacPsInstancePtr);
+	OranBufFree(TxFramePtr);
+	OranBufFree(RxFramePtr);
 
 	return XST_SUCCESS;
 }
@@ -1381,14 +1710,11 @@ static void XEmacPsRecvHandler(void *Callback)
 	 * happened.
 	 */
 	FramesRx++;
-	if (EmacPsInstancePtr->Config.IsCacheCoherent == 0) {
-		Xil_DCacheInvalidateRange((UINTPTR)&RxFrame, sizeof(EthernetFrame));
-	}
-	if (GemVersion > 2) {
-		if (EmacPsInstancePtr->Config.IsCacheCoherent == 0) {
-			Xil_DCacheInvalidateRange((UINTPTR)RxBdSpacePtr, 64);
-		}
-	}
+	/*
+	 * The frame is invalidated once its length is known, by
+	 * EmacPsDmaSingleFrameIntrExample. The descriptors are in bd_space,
+	 * which is not cached.
+	 */
 }
 
 
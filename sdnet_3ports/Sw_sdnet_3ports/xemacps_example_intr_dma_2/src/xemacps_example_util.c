@@ -62,7 +62,7 @@ u32 Platform;
 * @note     None.
 *
 *****************************************************************************/
-void EmacPsUtilFrameHdrFormatMAC(EthernetFrame * FramePtr, char *DestAddr)
+void EmacPsUtilFrameHdrFormatMAC(u8 * FramePtr, char *DestAddr)
 {
 	char *Frame = (char *) FramePtr;
 	char *SourceAddress = EmacPsMAC;
@@ -92,7 +92,7 @@ void EmacPsUtilFrameHdrFormatMAC(EthernetFrame * FramePtr, char *DestAddr)
 * @note     None.
 *
 *****************************************************************************/
-void EmacPsUtilFrameHdrFormatType(EthernetFrame * FramePtr, u16 FrameType)
+void EmacPsUtilFrameHdrFormatType(u8 * FramePtr, u16 FrameType)
 {
 	char *Frame = (char *) FramePtr;
 
@@ -128,7 +128,7 @@ void EmacPsUtilFrameHdrFormatType(EthernetFrame * FramePtr, u16 FrameType)
 * @note     None.
 *
 *****************************************************************************/
-void EmacPsUtilFrameSetPayloadData(EthernetFrame * FramePtr, u32 PayloadSize)
+void EmacPsUtilFrameSetPayloadData(u8 * FramePtr, u32 PayloadSize)
 {
 	u32 BytesLeft = PayloadSize;
 	u8 *Frame;
@@ -178,8 +178,7 @@ void EmacPsUtilFrameSetPayloadData(EthernetFrame * FramePtr, u32 PayloadSize)
 *
 * @note     None.
 *****************************************************************************/
-LONG EmacPsUtilFrameVerify(EthernetFrame * CheckFrame,
-			   EthernetFrame * ActualFrame)
+LONG EmacPsUtilFrameVerify(u8 * CheckFrame, u8 * ActualFrame)
 {
 	char *CheckPtr = (char *) CheckFrame;
 	char *ActualPtr = (char *) ActualFrame;
@@ -245,19 +244,20 @@ LONG EmacPsUtilFrameVerify(EthernetFrame * CheckFrame,
 
 /****************************************************************************/
 /**
-* This function sets all bytes of a frame to 0.
+* This function fills a frame buffer with a 0xDEADBEEF pattern.
 *
 * @param    FramePtr is a pointer to the frame itself.
+* @param    Bytes is the size of the buffer, a multiple of 4.
 *
 * @return   None.
 *
 * @note     None.
 *
 *****************************************************************************/
-void EmacPsUtilFrameMemClear(EthernetFrame * FramePtr)
+void EmacPsUtilFrameMemClear(u8 * FramePtr, u32 Bytes)
 {
 	u32 *Data32Ptr = (u32 *) FramePtr;
-	u32 WordsLeft = sizeof(EthernetFrame) / sizeof(u32);
+	u32 WordsLeft = Bytes / sizeof(u32);
 
 	/* frame should be an integral number of words */
 	while (WordsLeft--) {
@@ -0,0 +1,58 @@
+################################################################################
+# SPDX-License-Identifier: MIT
+################################################################################
+# Description : Configuration settings to build the Xilinx SDNet control plane
+# driver library for the standalone (bare-metal) application on the ZCU102
+# A53s. The library's heap calls are renamed to the allocation arena of the
+# application (oran_arena.c), so the drivers never touch the 8 KB BSP heap.
+# Only the static library is built; link it into the application.
+#
+#   make PLATFORM=a53_standalone.mak build_static_lib
+#
+################################################################################
+
+# Targets
+LIBNAME=libsdnetdrv
+
+# Directories
+SRC_ROOT=.
+BUILD_ROOT=./build/a53_standalone
+INSTALL_ROOT?=./install/a53_standalone
+LIB_INSTALL_DIR=$(INSTALL_ROOT)/lib
+LIB_HEADER_INSTALL_DIR=$(INSTALL_ROOT)/include
+
+# Commands
+CROSS_COMPILE?=aarch64-none-elf-
+COMPILE=$(CROSS_COMPILE)gcc
+STATIC_LINK=$(CROSS_COMPILE)ar
+DYNAMIC_LINK=$(CROSS_COMPILE)gcc
+DEPLOY=
+
+# File extensions
+TEMP_DEP_FILE_EXT=Td
+DEP_FILE_EXT=d
+OBJ_FILE_EXT=o
+STATIC_LIB_EXT=a
+DYNAMIC_LIB_EXT=so
+
+# Command options/flags
+EARLY_COMPILE_FLAGS=-Wall -Wextra -std=c99 -mcpu=cortex-a53
+LATE_COMPILE_FLAGS=-MT $$@ -MMD -MP -MF $($1_DEP_DIR)/$$*.$(TEMP_DEP_FILE_EXT) -c $$< -o $$@
+EXTRA_COMPILE_FLAGS=-fno-builtin-malloc -fno-builtin-calloc \
+	-fno-builtin-realloc -fno-builtin-free \
+	-Dmalloc=OranArenaMalloc -Dcalloc=OranArenaCalloc \
+	-Drealloc=OranArenaRealloc -Dfree=OranArenaFree
+INC_SWITCH=-I
+STATIC_LINK_FLAGS=rcs $@ $^
+DYNAMIC_LINK_FLAGS=-shared -o $@ $^
+DEPLOY_FLAGS=
+
+# Build variants
+VARIANT?=release
+ifeq ($(VARIANT),debug)
+EARLY_COMPILE_FLAGS+=-g -O0
+endif
+
+ifeq ($(VARIANT),release)
+EARLY_COMPILE_FLAGS+=-O2
+endif
@@ -0,0 +1,60 @@
+################################################################################
+# SPDX-License-Identifier: MIT
+################################################################################
+# Description : Configuration settings to build the Xilinx SDNet control plane
+# driver library for Linux on the ZCU102 A53s, for a control-plane agent using
+# the mmap environment interface of the application (oran_env_uio.c)
+#
+#   make PLATFORM=aarch64.mak [CROSS_COMPILE=...] [DEPLOY_HOST=root@zcu102]
+#
+################################################################################
+
+# Targets
+LIBNAME=libsdnetdrv
+
+# Directories
+SRC_ROOT=.
+BUILD_ROOT=./build/aarch64
+INSTALL_ROOT?=./install/aarch64
+LIB_INSTALL_DIR=$(INSTALL_ROOT)/lib
+LIB_HEADER_INSTALL_DIR=$(INSTALL_ROOT)/include
+
+# Commands
+CROSS_COMPILE?=aarch64-linux-gnu-
+COMPILE=$(CROSS_COMPILE)gcc
+STATIC_LINK=$(CROSS_COMPILE)ar
+DYNAMIC_LINK=$(CROSS_COMPILE)gcc
+DEPLOY=
+
+# File extensions
+TEMP_DEP_FILE_EXT=Td
+DEP_FILE_EXT=d
+OBJ_FILE_EXT=o
+STATIC_LIB_EXT=a
+DYNAMIC_LIB_EXT=so
+
+# Command options/flags
+EARLY_COMPILE_FLAGS=-fPIC -Wall -Wextra -std=c99 -mcpu=cortex-a53
+LATE_COMPILE_FLAGS=-MT $$@ -MMD -MP -MF $($1_DEP_DIR)/$$*.$(TEMP_DEP_FILE_EXT) -c $$< -o $$@
+EXTRA_COMPILE_FLAGS=
+INC_SWITCH=-I
+STATIC_LINK_FLAGS=rcs $@ $^
+DYNAMIC_LINK_FLAGS=-shared -o $@ $^
+DEPLOY_FLAGS=
+
+# "make install" copies the shared library to the board when DEPLOY_HOST is set
+DEPLOY_HOST?=
+ifneq ($(DEPLOY_HOST),)
+DEPLOY=scp
+DEPLOY_FLAGS=$(DYNAMIC_LIB) $(DEPLOY_HOST):/usr/lib/
+endif
+
+# Build variants
+VARIANT?=release
+ifeq ($(VARIANT),debug)
+EARLY_COMPILE_FLAGS+=-g -O0
+endif
+
+ifeq ($(VARIANT),release)
+EARLY_COMPILE_FLAGS+=-O3
+endif
@@ -0,0 +1,14 @@
+/*
+ * Host stand-in for the standalone BSP header. A failed assertion aborts.
+ */
+#ifndef XIL_ASSERT_H
+#define XIL_ASSERT_H
+
+#include <assert.h>
+
+#define Xil_AssertVoid(Expression)	assert(Expression)
+#define Xil_AssertNonvoid(Expression)	assert(Expression)
+#define Xil_AssertVoidAlways()		assert(0)
+#define Xil_AssertNonvoidAlways()	assert(0)
+
+#endif /* XIL_ASSERT_H */
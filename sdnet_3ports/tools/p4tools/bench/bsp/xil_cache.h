@@ -0,0 +1,22 @@
+/*
+ * Host stand-in for the standalone BSP header. Host DMA models write
+ * through the same coherent memory, so there is nothing to maintain.
+ */
+#ifndef XIL_CACHE_H
+#define XIL_CACHE_H
+
+#include "xil_types.h"
+
+static inline void Xil_DCacheFlushRange(INTPTR Addr, INTPTR Len)
+{
+	(void)Addr;
+	(void)Len;
+}
+
+static inline void Xil_DCacheInvalidateRange(INTPTR Addr, INTPTR Len)
+{
+	(void)Addr;
+	(void)Len;
+}
+
+#endif /* XIL_CACHE_H */
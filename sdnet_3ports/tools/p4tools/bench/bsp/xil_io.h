@@ -0,0 +1,35 @@
+/*
+ * Host stand-in for the standalone BSP header. Addresses are pointers into
+ * host memory. Built with XIL_IO_MODEL, every access goes through the two
+ * functions below instead, which a device model provides to give its
+ * registers their side effects.
+ */
+#ifndef XIL_IO_H
+#define XIL_IO_H
+
+#include "xil_types.h"
+
+#ifdef XIL_IO_MODEL
+void XilIoModelOut32(UINTPTR Addr, u32 Value);
+u32 XilIoModelIn32(UINTPTR Addr);
+#endif
+
+static inline void Xil_Out32(UINTPTR Addr, u32 Value)
+{
+#ifdef XIL_IO_MODEL
+	XilIoModelOut32(Addr, Value);
+#else
+	*(volatile u32 *)Addr = Value;
+#endif
+}
+
+static inline u32 Xil_In32(UINTPTR Addr)
+{
+#ifdef XIL_IO_MODEL
+	return XilIoModelIn32(Addr);
+#else
+	return *(volatile u32 *)Addr;
+#endif
+}
+
+#endif /* XIL_IO_H */
@@ -0,0 +1,11 @@
+/*
+ * Host stand-in for the standalone BSP header
+ */
+#ifndef XIL_PRINTF_H
+#define XIL_PRINTF_H
+
+#include <stdio.h>
+
+#define xil_printf	printf
+
+#endif /* XIL_PRINTF_H */
@@ -0,0 +1,8 @@
+/*
+ * Host stand-in for the generated BSP header. No XPAR_ names are defined,
+ * so oran_sdnet.h falls back to its default addresses.
+ */
+#ifndef XPARAMETERS_H
+#define XPARAMETERS_H
+
+#endif /* XPARAMETERS_H */
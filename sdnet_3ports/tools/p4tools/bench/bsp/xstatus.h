@@ -0,0 +1,20 @@
+/*
+ * Host stand-in for the standalone BSP header
+ */
+#ifndef XSTATUS_H
+#define XSTATUS_H
+
+#define XST_SUCCESS		0L
+#define XST_FAILURE		1L
+#define XST_DEVICE_IS_STARTED	5L
+#define XST_DEVICE_IS_STOPPED	6L
+#define XST_INVALID_PARAM	15L
+#define XST_NO_FEATURE		19L
+#define XST_IS_STARTED		23L
+#define XST_DMA_SG_IS_STARTED	514L
+#define XST_DMA_SG_IS_STOPPED	515L
+#define XST_DMA_SG_NO_LIST	523L
+#define XST_DMA_SG_LIST_ERROR	526L
+#define XST_EMAC_MII_BUSY	1004L
+
+#endif /* XSTATUS_H */
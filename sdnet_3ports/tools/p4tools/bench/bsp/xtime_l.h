@@ -0,0 +1,23 @@
+/*
+ * Host stand-in for the standalone BSP header, counting nanoseconds of the
+ * monotonic clock
+ */
+#ifndef XTIME_L_H
+#define XTIME_L_H
+
+#include <time.h>
+#include "xil_types.h"
+
+typedef u64 XTime;
+
+#define COUNTS_PER_SECOND	1000000000ULL
+
+static inline void XTime_GetTime(XTime *TimePtr)
+{
+	struct timespec Ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &Ts);
+	*TimePtr = (XTime)Ts.tv_sec * COUNTS_PER_SECOND + (XTime)Ts.tv_nsec;
+}
+
+#endif /* XTIME_L_H */
@@ -0,0 +1,332 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file buf_bench.c
+*
+* Times and checks the packet buffer pool of oran_buf.c.
+*
+*	buf_bench [-t milliseconds per run]
+*
+* Each class is first timed from one thread, taking and freeing buffers
+* in bursts of BENCH_BURST, against malloc and free of the same size. Then
+* BENCH_THREADS threads take bursts at once, stamp every buffer with a
+* token of their own and check it before freeing, and pass part of each
+* burst through shared slots for another thread to free, so that buffers
+* go back to a list other than the one they came from. A buffer handed out
+* twice shows as a token overwritten or as a free with no reference left.
+* Last, a buffer shared by three owners must go back to the pool at the
+* third free only, and the pool is compared with the jumbo-sized frame
+* buffers it replaces. Every buffer must be back at the end.
+*
+* On a host the core number is the CPU a thread runs on, so steals only
+* happen with threads on several CPUs.
+*
+*****************************************************************************/
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "oran_buf.h"
+
+#define BENCH_BURST	32
+#define BENCH_THREADS	4
+#define BENCH_SLOTS	64
+#define BENCH_PASSED	8	/* of every burst, freed by another thread */
+#define BENCH_FRAME	10276	/* XEMACPS_MAX_VLAN_FRAME_SIZE_JUMBO */
+
+typedef struct {
+	pthread_t Thread;
+	u32 Id;
+	u32 Bytes;
+	u64 Ops;
+	u64 Empty;
+	u64 Errors;
+} BenchThread;
+
+static const u32 ClassBytes[ORAN_BUF_CLASS_CNT] = {
+	ORAN_BUF_SMALL_SIZE, ORAN_BUF_MEDIUM_SIZE, ORAN_BUF_LARGE_SIZE
+};
+
+static u8 *Slot[BENCH_SLOTS];
+static pthread_barrier_t Barrier;
+static u32 Milliseconds = 500;
+static int Stop;
+
+static double NowSec(void)
+{
+	struct timespec Ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &Ts);
+	return (double)Ts.tv_sec + (double)Ts.tv_nsec * 1e-9;
+}
+
+static void Sleep(u32 Ms)
+{
+	struct timespec Ts = { Ms / 1000, (long)(Ms % 1000) * 1000000L };
+
+	nanosleep(&Ts, NULL);
+}
+
+/*
+ * Nanoseconds per buffer taken and freed from one thread, from the pool
+ * or, with Heap set, from malloc
+ */
+static double RunSingle(u32 Bytes, u32 Burst, int Heap)
+{
+	u8 *Bufs[BENCH_BURST];
+	double Start = NowSec();
+	double Elapsed;
+	u64 Ops = 0;
+	u32 Index;
+
+	do {
+		for (Index = 0; Index < Burst; Index++) {
+			Bufs[Index] = Heap ? malloc(Bytes) :
+					     OranBufAlloc(Bytes);
+			Bufs[Index][0] = (u8)Index;
+		}
+		for (Index = 0; Index < Burst; Index++) {
+			if (Heap) {
+				free(Bufs[Index]);
+			} else {
+				OranBufFree(Bufs[Index]);
+			}
+		}
+		Ops += Burst;
+		Elapsed = NowSec() - Start;
+	} while (Elapsed < Milliseconds / 1000.0);
+
+	return Elapsed * 1e9 / (double)Ops;
+}
+
+static void *SharedThread(void *Arg)
+{
+	BenchThread *ThreadPtr = Arg;
+	u8 *Bufs[BENCH_BURST];
+	u64 Tokens[BENCH_BURST];
+	u64 Seq = 0;
+	u8 *OtherPtr;
+	u32 Got;
+	u32 Index;
+
+	pthread_barrier_wait(&Barrier);
+	while (!__atomic_load_n(&Stop, __ATOMIC_RELAXED)) {
+		for (Got = 0; Got < BENCH_BURST; Got++) {
+			Bufs[Got] = OranBufAlloc(ThreadPtr->Bytes);
+			if (Bufs[Got] == NULL) {
+				/* the slots may hold the whole class */
+				ThreadPtr->Empty++;
+				OranBufFree(__atomic_exchange_n(
+					&Slot[Seq++ % BENCH_SLOTS], NULL,
+					__ATOMIC_ACQ_REL));
+				break;
+			}
+			Tokens[Got] = ((u64)ThreadPtr->Id << 48) | Seq++;
+			memcpy(Bufs[Got], &Tokens[Got], sizeof(u64));
+		}
+		for (Index = 0; Index < Got; Index++) {
+			if (memcmp(Bufs[Index], &Tokens[Index],
+				   sizeof(u64)) != 0) {
+				ThreadPtr->Errors++;
+			}
+			if (Index >= BENCH_PASSED) {
+				OranBufFree(Bufs[Index]);
+				continue;
+			}
+			OtherPtr = __atomic_exchange_n(
+				&Slot[(Seq + Index) % BENCH_SLOTS], Bufs[Index],
+				__ATOMIC_ACQ_REL);
+			if (OtherPtr != NULL) {
+				OranBufFree(OtherPtr);
+			}
+		}
+		ThreadPtr->Ops += Got;
+	}
+
+	return NULL;
+}
+
+/*
+ * Takes and frees buffers of one class from BENCH_THREADS threads at once.
+ * Returns nonzero if a buffer went to two owners.
+ */
+static int RunShared(u32 Class)
+{
+	BenchThread Threads[BENCH_THREADS];
+	OranBufStats Before;
+	OranBufStats After;
+	double Start;
+	double Elapsed;
+	u64 Ops = 0;
+	u64 Empty = 0;
+	u64 Errors = 0;
+	u32 Index;
+
+	memset(Threads, 0, sizeof(Threads));
+	OranBufGetStats(Class, &Before);
+	pthread_barrier_init(&Barrier, NULL, BENCH_THREADS + 1);
+	Stop = 0;
+	for (Index = 0; Index < BENCH_THREADS; Index++) {
+		Threads[Index].Id = Index;
+		Threads[Index].Bytes = ClassBytes[Class];
+		pthread_create(&Threads[Index].Thread, NULL, SharedThread,
+			       &Threads[Index]);
+	}
+	pthread_barrier_wait(&Barrier);
+	Start = NowSec();
+	Sleep(Milliseconds);
+	__atomic_store_n(&Stop, 1, __ATOMIC_RELAXED);
+	for (Index = 0; Index < BENCH_THREADS; Index++) {
+		pthread_join(Threads[Index].Thread, NULL);
+		Ops += Threads[Index].Ops;
+		Empty += Threads[Index].Empty;
+		Errors += Threads[Index].Errors;
+	}
+	Elapsed = NowSec() - Start;
+	pthread_barrier_destroy(&Barrier);
+	for (Index = 0; Index < BENCH_SLOTS; Index++) {
+		if (Slot[Index] != NULL) {
+			OranBufFree(Slot[Index]);
+			Slot[Index] = NULL;
+		}
+	}
+	OranBufGetStats(Class, &After);
+
+	printf("%6u %8d threads %10.0f buffers/s %8llu empty %6u stolen\n",
+	       (unsigned)ClassBytes[Class], BENCH_THREADS,
+	       (double)Ops / Elapsed, (unsigned long long)Empty,
+	       (unsigned)(After.Steals - Before.Steals));
+	if ((Errors != 0) || (After.BadFrees != Before.BadFrees) ||
+	    (After.InUse != 0)) {
+		fprintf(stderr, "%u-byte class: %llu tokens overwritten, "
+			"%u bad frees, %u buffers not back\n",
+			(unsigned)ClassBytes[Class],
+			(unsigned long long)Errors,
+			(unsigned)(After.BadFrees - Before.BadFrees),
+			(unsigned)After.InUse);
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * A buffer with three owners, and frees the pool must ignore. Returns
+ * nonzero on a mistake.
+ */
+static int CheckShared(void)
+{
+	static u8 Outside[ORAN_BUF_SMALL_SIZE];
+	OranBufStats Stats;
+	u8 *BufPtr = OranBufAlloc(60);
+	int Fail = 0;
+
+	if ((BufPtr == NULL) || (OranBufSize(BufPtr) != ORAN_BUF_SMALL_SIZE) ||
+	    (((UINTPTR)BufPtr % ORAN_BUF_LINE) != 0) ||
+	    (OranBufSize(BufPtr + 100) != ORAN_BUF_SMALL_SIZE) ||
+	    (OranBufSize(Outside) != 0) ||
+	    (OranBufAlloc(ORAN_BUF_LARGE_SIZE + 1) != NULL)) {
+		fprintf(stderr, "buffer sizes wrong\n");
+		return 1;
+	}
+
+	OranBufRef(BufPtr);
+	OranBufRef(BufPtr + 10);
+	OranBufFree(BufPtr);
+	OranBufFree(BufPtr + 20);
+	OranBufGetStats(ORAN_BUF_CLASS_SMALL, &Stats);
+	if (Stats.InUse != 1) {
+		fprintf(stderr, "shared buffer freed before its last owner\n");
+		Fail = 1;
+	}
+	OranBufFree(BufPtr);
+	OranBufFree(BufPtr);
+	OranBufFree(Outside);
+	OranBufGetStats(ORAN_BUF_CLASS_SMALL, &Stats);
+	if ((Stats.InUse != 0) || (Stats.BadFrees != 1)) {
+		fprintf(stderr, "shared buffer: %u in use, %u bad frees\n",
+			(unsigned)Stats.InUse, (unsigned)Stats.BadFrees);
+		Fail = 1;
+	}
+
+	return Fail;
+}
+
+int main(int argc, char *argv[])
+{
+	static const u32 Bursts[] = { 1, BENCH_BURST };
+	OranBufStats Stats;
+	u64 PoolBytes = 0;
+	u32 PoolCount = 0;
+	u32 Class;
+	u32 Index;
+	int Fail = 0;
+	int I;
+
+	for (I = 1; I + 1 < argc; I += 2) {
+		if (strcmp(argv[I], "-t") == 0) {
+			Milliseconds = (u32)strtoul(argv[I + 1], NULL, 0);
+		} else {
+			break;
+		}
+	}
+	if ((I != argc) || (Milliseconds == 0)) {
+		fprintf(stderr, "usage: buf_bench [-t milliseconds per run]\n");
+		return 2;
+	}
+
+	OranBufInit();
+	Fail |= CheckShared();
+
+	printf("%6s %8s %12s %12s\n", "bytes", "burst", "pool ns", "malloc ns");
+	for (Class = 0; Class < ORAN_BUF_CLASS_CNT; Class++) {
+		for (Index = 0; Index < sizeof(Bursts) / sizeof(Bursts[0]);
+		     Index++) {
+			OranBufGetStats(Class, &Stats);
+			if (Bursts[Index] > Stats.Count) {
+				continue;
+			}
+			printf("%6u %8u %12.1f %12.1f\n",
+			       (unsigned)ClassBytes[Class],
+			       (unsigned)Bursts[Index],
+			       RunSingle(ClassBytes[Class], Bursts[Index], 0),
+			       RunSingle(ClassBytes[Class], Bursts[Index], 1));
+		}
+	}
+
+	for (Class = 0; Class < ORAN_BUF_CLASS_CNT; Class++) {
+		Fail |= RunShared(Class);
+	}
+
+	OranBufPrint();
+	for (Class = 0; Class < ORAN_BUF_CLASS_CNT; Class++) {
+		OranBufGetStats(Class, &Stats);
+		PoolBytes += (u64)Stats.Size * Stats.Count;
+		PoolCount += Stats.Count;
+		if (Stats.InUse != 0) {
+			fprintf(stderr, "%u-byte buffers not back\n",
+				(unsigned)Stats.Size);
+			Fail = 1;
+		}
+		/* Each class has had a burst, or all of it, out at once */
+		if (Stats.HighWater < ((Stats.Count < BENCH_BURST) ?
+				       Stats.Count : BENCH_BURST)) {
+			fprintf(stderr, "%u-byte buffers: high water %u\n",
+				(unsigned)Stats.Size,
+				(unsigned)Stats.HighWater);
+			Fail = 1;
+		}
+	}
+	printf("pool: %u buffers in %llu KB, as %d-byte frames %llu KB\n",
+	       (unsigned)PoolCount, (unsigned long long)(PoolBytes / 1024),
+	       BENCH_FRAME,
+	       (unsigned long long)(((u64)PoolCount * BENCH_FRAME) / 1024));
+
+	printf("%s\n", Fail ? "FAIL" : "ok");
+	return Fail;
+}
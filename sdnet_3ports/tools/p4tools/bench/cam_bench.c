@@ -0,0 +1,369 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file cam_bench.c
+*
+* Runs the application's table code (oran_sdnet.c, oran_policy.c,
+* oran_eaxc.c, oran_table.c, oran_trace.c) on a host against the software
+* driver and CAM model of sdnet_model.c, with the tables of main.json
+* (sdnet_config.c).
+*
+*	cam_bench [-p main.json] [-n eaxc entries] [-r rounds]
+*
+* The model is checked first: random ternary entries are written to
+* plane_classify and every lookup compared against a brute-force search.
+* Then the application is brought up as on the board, with tracing, and
+* timed: eaxc_steer fills through OranEaxcBench, lookups through the index
+* of oran_eaxc.c, a warm restart of both tables from a snapshot
+* (oran_snapshot.c), and plane_classify changes through OranPolicyCommit.
+* Register accesses are counted by OranSdnetMmioCounts and are those the
+* model charges (see sdnet_model.h), not the IP's; the rates are of the
+* software alone. The model's state comes from the application's arena
+* (oran_arena.c), whose use is printed at the end.
+*
+*****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "xstatus.h"
+#include "oran_sdnet.h"
+#include "sdnet_model.h"
+
+#define BENCH_TABLES		4	/* CAM windows of the register array */
+#define BENCH_CHECK_ENTRIES	ORAN_POLICY_DEPTH
+#define BENCH_CHECK_KEYS	100000
+
+static u32 Regs[BENCH_TABLES * SDNET_MODEL_CAM_WINDOW / 4];
+static uint32_t Seed = 1;
+
+static uint32_t Random(void)
+{
+	Seed = Seed * 1103515245u + 12345u;
+	return Seed >> 8;
+}
+
+static double NowSec(void)
+{
+	struct timespec Ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &Ts);
+	return (double)Ts.tv_sec + (double)Ts.tv_nsec * 1e-9;
+}
+
+/*
+ * Random plane_classify entries, each with its own priority and its index
+ * in the parameters, looked up against a brute-force search. Leaves the
+ * table empty.
+ */
+static int CheckModel(XilSdnetTableCtx *TablePtr, uint32_t ActionId)
+{
+	static uint8_t Key[BENCH_CHECK_ENTRIES][ORAN_POLICY_KEY_BYTES];
+	static uint8_t Mask[BENCH_CHECK_ENTRIES][ORAN_POLICY_KEY_BYTES];
+	static uint32_t Priority[BENCH_CHECK_ENTRIES];
+	uint8_t Probe[ORAN_POLICY_KEY_BYTES];
+	uint8_t Params[ORAN_POLICY_PARAM_BYTES];
+	uint8_t Top = 0xFF >>
+		      (8 * ORAN_POLICY_KEY_BYTES - ORAN_POLICY_KEY_BITS);
+	XilSdnetReturnType Result;
+	uint32_t Got;
+	uint32_t Best;
+	uint32_t Id;
+	uint32_t E;
+	uint32_t I;
+	uint32_t B;
+
+	for (E = 0; E < BENCH_CHECK_ENTRIES; E++) {
+		Priority[E] = E;
+	}
+	for (E = BENCH_CHECK_ENTRIES - 1; E > 0; E--) {
+		I = Random() % (E + 1);
+		Got = Priority[E];
+		Priority[E] = Priority[I];
+		Priority[I] = Got;
+	}
+
+	for (E = 0; E < BENCH_CHECK_ENTRIES; E++) {
+		/* Few care bits, so that entries overlap */
+		for (B = 0; B < ORAN_POLICY_KEY_BYTES; B++) {
+			Mask[E][B] = (uint8_t)(Random() & Random() & Random());
+			Key[E][B] = (uint8_t)Random() & Mask[E][B];
+		}
+		Mask[E][ORAN_POLICY_KEY_BYTES - 1] &= Top;
+		Key[E][ORAN_POLICY_KEY_BYTES - 1] &= Top;
+		memset(Params, 0, sizeof(Params));
+		memcpy(Params, &E, sizeof(E));
+		Result = XilSdnetTableInsert(TablePtr, Key[E], Mask[E],
+					     Priority[E], ActionId, Params);
+		if (Result == XIL_SDNET_CAM_ERR_DUPLICATE_FOUND) {
+			Priority[E] = UINT32_MAX;	/* never inserted */
+		} else if (Result != XIL_SDNET_SUCCESS) {
+			fprintf(stderr, "model insert: %s\n",
+				XilSdnetReturnTypeToString(Result));
+			return -1;
+		}
+	}
+	if (XilSdnetTableInsert(TablePtr, Key[0], Mask[0], 0, ActionId,
+				Params) == XIL_SDNET_SUCCESS) {
+		fprintf(stderr, "model: insert past max_size accepted\n");
+		return -1;
+	}
+
+	for (I = 0; I < BENCH_CHECK_KEYS; I++) {
+		for (B = 0; B < ORAN_POLICY_KEY_BYTES; B++) {
+			Probe[B] = (uint8_t)Random();
+		}
+		Probe[ORAN_POLICY_KEY_BYTES - 1] &= Top;
+		if (I & 1) {
+			/* Near an entry, to hit more than the catch-alls */
+			E = Random() % BENCH_CHECK_ENTRIES;
+			for (B = 0; B < ORAN_POLICY_KEY_BYTES; B++) {
+				Probe[B] = (Probe[B] & ~Mask[E][B]) | Key[E][B];
+			}
+		}
+
+		Best = UINT32_MAX;
+		for (E = 0; E < BENCH_CHECK_ENTRIES; E++) {
+			for (B = 0; B < ORAN_POLICY_KEY_BYTES; B++) {
+				if ((Probe[B] & Mask[E][B]) != Key[E][B]) {
+					break;
+				}
+			}
+			if ((B == ORAN_POLICY_KEY_BYTES) &&
+			    (Priority[E] != UINT32_MAX) &&
+			    ((Best == UINT32_MAX) ||
+			     (Priority[E] < Priority[Best]))) {
+				Best = E;
+			}
+		}
+
+		Result = XilSdnetTableLookup(TablePtr, Probe, &Id, Params);
+		Got = UINT32_MAX;
+		if (Result == XIL_SDNET_SUCCESS) {
+			memcpy(&Got, Params, sizeof(Got));
+		}
+		if ((Got != Best) || ((Result == XIL_SDNET_SUCCESS) &&
+				      (Id != ActionId))) {
+			fprintf(stderr, "model lookup %u: entry %d, expected "
+				"%d\n", (unsigned)I, (int)Got, (int)Best);
+			return -1;
+		}
+	}
+
+	return (XilSdnetTableReset(TablePtr) == XIL_SDNET_SUCCESS) ? 0 : -1;
+}
+
+static void Report(const char *NamePtr, uint32_t Count, double Time)
+{
+	u32 Reads;
+	u32 Writes;
+
+	OranSdnetMmioCounts(&Reads, &Writes, 1);
+	printf("%-24s %8u %12.0f %8.1f %8.1f\n", NamePtr, (unsigned)Count,
+	       Count / Time, (double)Reads / Count, (double)Writes / Count);
+}
+
+int main(int argc, char *argv[])
+{
+	static OranEaxcRule Rules[ORAN_EAXC_DEPTH];
+	static u8 Snapshot[ORAN_SNAPSHOT_MAX_BYTES];
+	const char *P4JsonPath =
+		"../../sdnet_3ports.ip_user_files/mem_init_files/main.json";
+	XilSdnetTableCtx *TablePtr;
+	OranPolicyRule Extra;
+	OranArenaStats Arena;
+	OranEaxcRule Rule;
+	uint32_t ActionId;
+	uint32_t Count = ORAN_EAXC_DEPTH;
+	uint32_t Rounds = 1000;
+	u32 Length;
+	char ErrBuf[256];
+	double Start;
+	uint32_t R;
+	uint32_t I;
+	int Arg;
+
+	for (Arg = 1; Arg + 1 < argc; Arg += 2) {
+		if (strcmp(argv[Arg], "-p") == 0) {
+			P4JsonPath = argv[Arg + 1];
+		} else if (strcmp(argv[Arg], "-n") == 0) {
+			Count = (uint32_t)strtoul(argv[Arg + 1], NULL, 0);
+		} else if (strcmp(argv[Arg], "-r") == 0) {
+			Rounds = (uint32_t)strtoul(argv[Arg + 1], NULL, 0);
+		} else {
+			break;
+		}
+	}
+	if ((Arg != argc) || (Count == 0) || (Count > ORAN_EAXC_DEPTH) ||
+	    (Rounds == 0)) {
+		fprintf(stderr, "usage: cam_bench [-p main.json] "
+			"[-n eaxc entries, 1..%d] [-r rounds]\n",
+			ORAN_EAXC_DEPTH);
+		return 2;
+	}
+
+	if (SdnetModelLoadConfig(P4JsonPath, ErrBuf, sizeof(ErrBuf)) != 0) {
+		fprintf(stderr, "%s: %s\n", P4JsonPath, ErrBuf);
+		return 1;
+	}
+	if (XilSdnetTargetConfig_mb_es_design_sdnet_0_1.TableListSize >
+	    BENCH_TABLES) {
+		fprintf(stderr, "%s: more than %d tables\n", P4JsonPath,
+			BENCH_TABLES);
+		return 1;
+	}
+	if (OranSdnetInit((UINTPTR)Regs) != XST_SUCCESS) {
+		return 1;
+	}
+
+	if ((XilSdnetTargetGetTableByName(OranSdnetTarget(),
+					  ORAN_POLICY_TABLE_NAME,
+					  &TablePtr) != XIL_SDNET_SUCCESS) ||
+	    (XilSdnetTableGetActionId(TablePtr, ORAN_POLICY_ACTION_SET,
+				      &ActionId) != XIL_SDNET_SUCCESS) ||
+	    (CheckModel(TablePtr, ActionId) != 0)) {
+		fprintf(stderr, "model check failed\n");
+		return 1;
+	}
+	printf("model: %d ternary entries, %d lookups checked\n",
+	       BENCH_CHECK_ENTRIES, BENCH_CHECK_KEYS);
+
+	OranTraceStart();
+	if ((OranPolicyInit() != XST_SUCCESS) ||
+	    (OranPolicyLoadDefaults() != XST_SUCCESS) ||
+	    (OranEaxcInit() != XST_SUCCESS) ||
+	    (OranEaxcBench(Count) != XST_SUCCESS)) {
+		fprintf(stderr, "application bring-up failed\n");
+		return 1;
+	}
+
+	for (I = 0; I < Count; I++) {
+		Rules[I].AxisTid = (uint8_t)(I % 3);
+		Rules[I].PcId = (uint16_t)(I * 40503u);	/* distinct, spread */
+		Rules[I].Tdest = I % 3;
+		Rules[I].Prio = ORAN_PRIO_UPLANE;
+	}
+
+	printf("%-24s %8s %12s %8s %8s\n", "", "ops", "ops/s", "rd/op",
+	       "wr/op");
+	OranSdnetMmioCounts(NULL, NULL, 1);
+	Start = NowSec();
+	for (I = 0; I < Count; I++) {
+		if (OranEaxcInsertRule(&Rules[I]) != XST_SUCCESS) {
+			fprintf(stderr, "eaxc_steer insert failed\n");
+			return 1;
+		}
+	}
+	Report("eaxc_steer insert", Count, NowSec() - Start);
+
+	Start = NowSec();
+	for (R = 0; R < Rounds; R++) {
+		for (I = 0; I < Count; I++) {
+			if ((OranEaxcGetRule(Rules[I].AxisTid, Rules[I].PcId,
+					     &Rule) != XST_SUCCESS) ||
+			    (Rule.Tdest != Rules[I].Tdest) ||
+			    (Rule.Prio != Rules[I].Prio)) {
+				fprintf(stderr, "eaxc_steer PC_ID 0x%04x "
+					"lost\n", Rules[I].PcId);
+				return 1;
+			}
+		}
+	}
+	Report("eaxc_steer get", Rounds * Count, NowSec() - Start);
+
+	Start = NowSec();
+	for (I = 0; I < Count; I++) {
+		Rules[I].Tdest = (Rules[I].Tdest + 1) % 3;
+		if (OranEaxcUpdateRule(&Rules[I]) != XST_SUCCESS) {
+			fprintf(stderr, "eaxc_steer update failed\n");
+			return 1;
+		}
+	}
+	Report("eaxc_steer update", Count, NowSec() - Start);
+
+	if (OranEaxcAudit() != XST_SUCCESS) {
+		return 1;
+	}
+
+	/* Both tables emptied and brought back from a snapshot */
+	if ((OranSnapshotSave(Snapshot, sizeof(Snapshot), &Length) !=
+	     XST_SUCCESS) ||
+	    (OranPolicyLoadRules(NULL, 0) != XST_SUCCESS) ||
+	    (OranEaxcReset() != XST_SUCCESS)) {
+		fprintf(stderr, "snapshot save failed\n");
+		return 1;
+	}
+	OranSdnetMmioCounts(NULL, NULL, 1);
+	Start = NowSec();
+	if (OranSnapshotRestore(Snapshot, Length) != XST_SUCCESS) {
+		fprintf(stderr, "snapshot restore failed\n");
+		return 1;
+	}
+	Report("snapshot restore", OranPolicyGetRules(NULL, 0) + Count,
+	       NowSec() - Start);
+	for (I = 0; I < Count; I++) {
+		if ((OranEaxcGetRule(Rules[I].AxisTid, Rules[I].PcId,
+				     &Rule) != XST_SUCCESS) ||
+		    (Rule.Tdest != Rules[I].Tdest)) {
+			fprintf(stderr, "eaxc_steer PC_ID 0x%04x not "
+				"restored\n", Rules[I].PcId);
+			return 1;
+		}
+	}
+	if (OranEaxcAudit() != XST_SUCCESS) {
+		return 1;
+	}
+	Snapshot[Length - 1] ^= 1;
+	if (OranSnapshotCheck(Snapshot, Length) == XST_SUCCESS) {
+		fprintf(stderr, "corrupted snapshot accepted\n");
+		return 1;
+	}
+
+	Start = NowSec();
+	for (I = 0; I < Count; I++) {
+		if (OranEaxcDeleteRule(Rules[I].AxisTid, Rules[I].PcId) !=
+		    XST_SUCCESS) {
+			fprintf(stderr, "eaxc_steer delete failed\n");
+			return 1;
+		}
+	}
+	Report("eaxc_steer delete", Count, NowSec() - Start);
+
+	/* One rule added and taken away again, as two commits */
+	memset(&Extra, 0, sizeof(Extra));
+	Extra.Key.AxisTid = ORAN_TID_GEM3;
+	Extra.Mask.AxisTid = 0xFF;
+	Extra.Priority = 1;
+	Extra.Tdest = ORAN_TID_10G_1;
+	Extra.Prio = ORAN_PRIO_MPLANE;
+	Start = NowSec();
+	for (R = 0; R < Rounds; R++) {
+		if ((OranPolicyBegin() != XST_SUCCESS) ||
+		    (OranPolicyStageInsert(&Extra) != XST_SUCCESS) ||
+		    (OranPolicyCommit() != XST_SUCCESS) ||
+		    (OranPolicyLoadDefaults() != XST_SUCCESS)) {
+			fprintf(stderr, "plane_classify commit failed\n");
+			return 1;
+		}
+	}
+	Report("plane_classify commit", 2 * Rounds, NowSec() - Start);
+
+	OranTraceStop();
+	OranTracePrint();
+	OranArenaPrint();
+
+	/* Every driver allocation is given back */
+	OranEaxcExit();
+	OranSdnetExit();
+	OranArenaGetStats(&Arena);
+	if ((Arena.Used != 0) || (Arena.Failures != 0)) {
+		OranArenaPrint();
+		return 1;
+	}
+	return 0;
+}
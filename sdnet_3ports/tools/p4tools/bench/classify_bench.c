@@ -0,0 +1,302 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file classify_bench.c
+*
+* Micro-benchmark for the p4gen classifier (oran_classify.h), built for
+* the host or, with CROSS_COMPILE set, for the A53 under Linux.
+*
+*	classify_bench [-n iterations] [-p main.json -e plane_policy.txt]
+*
+* A fronthaul-like frame mix (mostly eCPRI U-plane, some C-plane, RoE,
+* PTP, IPv4/UDP M-plane and malformed frames, from all three ingress ports)
+* is classified in a loop on one core. With -p/-e every frame of the mix is
+* first checked against p4sim, so a speed figure is only printed for a
+* classifier that agrees with the interpreter. The cross-check runs the
+* meters too, with the rates from the entries file and frames 100 ns apart.
+*
+*****************************************************************************/
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "oran_classify.h"
+#include "p4prog.h"
+#include "p4sim.h"
+
+#define BENCH_NUM_FRAMES	64
+#define BENCH_FRAME_MAX		128
+#define BENCH_TARGET_MPPS	5.0
+
+typedef struct {
+	uint8_t Data[BENCH_FRAME_MAX];
+	uint32_t Len;
+	uint8_t AxisTid;
+} BenchFrame;
+
+static BenchFrame Frames[BENCH_NUM_FRAMES];
+
+static uint32_t PutEth(uint8_t *P, uint16_t Type)
+{
+	memset(P, 0x11, 6);
+	memset(P + 6, 0x22, 6);
+	P[12] = (uint8_t)(Type >> 8);
+	P[13] = (uint8_t)Type;
+	return 14;
+}
+
+static uint32_t PutVlan(uint8_t *P, uint8_t Pcp, uint16_t Tpid)
+{
+	P[0] = (uint8_t)(Pcp << 5);
+	P[1] = 100;
+	P[2] = (uint8_t)(Tpid >> 8);
+	P[3] = (uint8_t)Tpid;
+	return 4;
+}
+
+static void BuildFrame(BenchFrame *F, uint32_t Kind, uint8_t AxisTid,
+		       uint16_t PcId)
+{
+	uint8_t *P = F->Data;
+	uint32_t Off;
+
+	memset(F, 0, sizeof(*F));
+	F->AxisTid = AxisTid;
+	switch (Kind) {
+	case 0: /* eCPRI IQ data */
+	case 1: /* eCPRI real-time control */
+	case 2: /* eCPRI delay measurement */
+		Off = PutEth(P, 0xAEFE);
+		P[Off] = 0x10;
+		P[Off + 1] = (Kind == 0) ? 0 : (Kind == 1) ? 2 : 5;
+		P[Off + 4] = (uint8_t)(PcId >> 8);
+		P[Off + 5] = (uint8_t)PcId;
+		Off += 4 + 60;
+		break;
+	case 3: /* VLAN tagged eCPRI IQ data */
+		Off = PutEth(P, 0x8100);
+		Off += PutVlan(P + Off, 5, 0xAEFE);
+		P[Off] = 0x10;
+		P[Off + 4] = (uint8_t)(PcId >> 8);
+		P[Off + 5] = (uint8_t)PcId;
+		Off += 4 + 60;
+		break;
+	case 4: /* RoE */
+		Off = PutEth(P, 0xFC3D);
+		P[Off] = 0x81;
+		Off += 8 + 52;
+		break;
+	case 5: /* PTP */
+		Off = PutEth(P, 0x88F7) + 44;
+		break;
+	case 6: /* IPv4/UDP with one option word */
+		Off = PutEth(P, 0x0800);
+		P[Off] = 0x46;
+		P[Off + 9] = 17;
+		Off += 24 + 8 + 18;
+		break;
+	case 7: /* Not IPv4 although the EtherType says so */
+		Off = PutEth(P, 0x0800);
+		P[Off] = 0x65;
+		Off += 46;
+		break;
+	case 8: /* Three VLAN tags, one more than the stack holds */
+		Off = PutEth(P, 0x8100);
+		Off += PutVlan(P + Off, 0, 0x8100);
+		Off += PutVlan(P + Off, 0, 0x8100);
+		Off += PutVlan(P + Off, 0, 0x0800);
+		Off += 40;
+		break;
+	default: /* Runt */
+		Off = 10;
+		break;
+	}
+	F->Len = Off;
+}
+
+static void BuildMix(void)
+{
+	/* Roughly 3/4 U-plane, the rest spread over the other cases */
+	static const uint8_t Kinds[16] = {
+		0, 0, 0, 3, 0, 0, 3, 0, 0, 0, 1, 2, 4, 5, 6, 7
+	};
+	uint32_t I;
+
+	for (I = 0; I < BENCH_NUM_FRAMES; I++) {
+		uint32_t Kind = Kinds[I % 16];
+
+		if (I == 31) {
+			Kind = 8;
+		} else if (I == 63) {
+			Kind = 9;
+		}
+		/* Four eAxC streams, PC_ID 0x0100..0x0103 */
+		BuildFrame(&Frames[I], Kind, (uint8_t)((I / 16) % 3),
+			   (uint16_t)(0x0100 | (I & 3)));
+	}
+}
+
+static double NowSec(void)
+{
+	struct timespec Ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &Ts);
+	return (double)Ts.tv_sec + (double)Ts.tv_nsec * 1e-9;
+}
+
+static int CrossCheck(const char *ProgPath, const char *EntriesPath)
+{
+	uint32_t TidH, TidF, TdestH, TdestF, PrioH, PrioF;
+	OranClassifyCounter Stats[ORAN_CLASSIFY_PLANE_STATS_SIZE];
+	OranClassifyMeter Meters[ORAN_CLASSIFY_PORT_METER_SIZE];
+	OranClassifyTables Tables = OranClassifyDefaultTables;
+	P4Program Prog;
+	P4State St;
+	char Err[256];
+	uint32_t Mismatch = 0;
+	uint32_t StatsMismatch = 0;
+	uint32_t I;
+
+	if (P4ProgramLoad(&Prog, ProgPath, Err, sizeof(Err)) != 0 ||
+	    (EntriesPath != NULL &&
+	     P4LoadEntries(&Prog, EntriesPath, Err, sizeof(Err)) != 0)) {
+		fprintf(stderr, "classify_bench: %s\n", Err);
+		return -1;
+	}
+	if (P4FindMeter(&Prog, "port_meter") == P4_NONE ||
+	    P4FindField(&Prog, "metadata.axis_tid", &TidH, &TidF) != 0 ||
+	    P4FindField(&Prog, "metadata.axis_tdest", &TdestH, &TdestF) != 0 ||
+	    P4FindField(&Prog, "metadata.prio", &PrioH, &PrioF) != 0 ||
+	    P4StateInit(&St, &Prog) != 0) {
+		fprintf(stderr, "classify_bench: unexpected program\n");
+		P4ProgramFree(&Prog);
+		return -1;
+	}
+
+	memset(Stats, 0, sizeof(Stats));
+	memset(Meters, 0, sizeof(Meters));
+	for (I = 0; I < ORAN_CLASSIFY_PORT_METER_SIZE; I++) {
+		const P4MeterRate *R =
+			&Prog.Meters[P4FindMeter(&Prog, "port_meter")].Rates[I];
+
+		Meters[I].Cir = R->Cir;
+		Meters[I].Cbs = R->Cbs;
+		Meters[I].Pir = R->Pir;
+		Meters[I].Pbs = R->Pbs;
+	}
+	Tables.PlaneStats = Stats;
+	Tables.PortMeter = Meters;
+	for (I = 0; I < BENCH_NUM_FRAMES; I++) {
+		P4Preset Tid = { TidH, TidF, Frames[I].AxisTid };
+		OranClassifyMeta Meta;
+
+		memset(&Meta, 0, sizeof(Meta));
+		Meta.metadata_axis_tid = Frames[I].AxisTid;
+		Meta.ingress_timestamp = 100 * (uint64_t)I;
+		St.Now = 100 * (uint64_t)I;
+		OranClassify(Frames[I].Data, Frames[I].Len, &Tables, &Meta);
+		P4Process(&St, Frames[I].Data, Frames[I].Len, &Tid, 1);
+
+		if (Meta.metadata_axis_tdest != P4GetField(&St, TdestH, TdestF) ||
+		    Meta.metadata_prio != P4GetField(&St, PrioH, PrioF) ||
+		    Meta.parser_error != St.ParserError ||
+		    Meta.drop != (uint8_t)P4Dropped(&St)) {
+			fprintf(stderr, "frame %u: generated tdest %u prio %u "
+				"err %u, p4sim tdest %" PRIu64 " prio %" PRIu64
+				" err %u\n", (unsigned)I,
+				(unsigned)Meta.metadata_axis_tdest,
+				(unsigned)Meta.metadata_prio,
+				(unsigned)Meta.parser_error,
+				P4GetField(&St, TdestH, TdestF),
+				P4GetField(&St, PrioH, PrioF),
+				(unsigned)St.ParserError);
+			Mismatch++;
+		}
+	}
+
+	for (I = 0; I < ORAN_CLASSIFY_PLANE_STATS_SIZE; I++) {
+		if (Stats[I].Packets != St.CounterPackets[I] ||
+		    Stats[I].Bytes != St.CounterBytes[I]) {
+			fprintf(stderr, "plane_stats[%u]: generated %" PRIu64
+				"/%" PRIu64 ", p4sim %" PRIu64 "/%" PRIu64 "\n",
+				(unsigned)I, Stats[I].Packets, Stats[I].Bytes,
+				St.CounterPackets[I], St.CounterBytes[I]);
+			StatsMismatch++;
+		}
+	}
+
+	P4StateFree(&St);
+	P4ProgramFree(&Prog);
+	printf("cross-check against p4sim: %u/%u frames agree\n",
+	       (unsigned)(BENCH_NUM_FRAMES - Mismatch),
+	       (unsigned)BENCH_NUM_FRAMES);
+	printf("plane_stats: %s\n", StatsMismatch ? "differ" : "agree");
+	return (Mismatch || StatsMismatch) ? -1 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *ProgPath = NULL;
+	const char *EntriesPath = NULL;
+	static OranClassifyCounter Stats[ORAN_CLASSIFY_PLANE_STATS_SIZE];
+	OranClassifyTables Tables = OranClassifyDefaultTables;
+	uint64_t Iterations = 200000;
+	uint64_t Sink = 0;
+	uint64_t It;
+	double Start;
+	double Elapsed;
+	double Mpps;
+	uint32_t I;
+	int A;
+
+	for (A = 1; A + 1 < argc; A += 2) {
+		if (strcmp(argv[A], "-n") == 0) {
+			Iterations = strtoull(argv[A + 1], NULL, 0);
+		} else if (strcmp(argv[A], "-p") == 0) {
+			ProgPath = argv[A + 1];
+		} else if (strcmp(argv[A], "-e") == 0) {
+			EntriesPath = argv[A + 1];
+		} else {
+			break;
+		}
+	}
+	if (A != argc || Iterations == 0) {
+		fprintf(stderr, "usage: classify_bench [-n iterations]"
+			" [-p main.json -e plane_policy.txt]\n");
+		return 2;
+	}
+
+	BuildMix();
+	if (ProgPath != NULL && CrossCheck(ProgPath, EntriesPath) != 0) {
+		return 1;
+	}
+
+	/* Count as the PS fallback path would */
+	Tables.PlaneStats = Stats;
+	Start = NowSec();
+	for (It = 0; It < Iterations; It++) {
+		for (I = 0; I < BENCH_NUM_FRAMES; I++) {
+			OranClassifyMeta Meta;
+
+			memset(&Meta, 0, sizeof(Meta));
+			Meta.metadata_axis_tid = Frames[I].AxisTid;
+			OranClassify(Frames[I].Data, Frames[I].Len, &Tables,
+				     &Meta);
+			Sink += Meta.metadata_axis_tdest + Meta.metadata_prio;
+		}
+	}
+	Elapsed = NowSec() - Start;
+
+	Mpps = (double)Iterations * BENCH_NUM_FRAMES / Elapsed / 1e6;
+	printf("%" PRIu64 " frames in %.3f s: %.2f Mpps, %.1f ns/frame"
+	       " (target %.0f Mpps per core) [%" PRIu64 "]\n",
+	       Iterations * BENCH_NUM_FRAMES, Elapsed, Mpps,
+	       1e3 / Mpps, BENCH_TARGET_MPPS, Sink);
+	return 0;
+}
@@ -0,0 +1,210 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file env_bench.c
+*
+* Exercises the Linux environment interface of the application
+* (oran_env_uio.c) against a register mock, a file mapped in place of the
+* sdnet_0 window, and times it with and without write sequences.
+*
+*	env_bench [-f register file] [-n entries]
+*
+* Each entry is written the way a CAM driver writes one: a run of data
+* words, a command word, then a read of a status word. The mock is checked
+* through a second mapping of the same file after every pass. Without -f
+* the mock is a temporary file in /dev/shm (or /tmp). Pointed at a UIO
+* device of a design with a scratch window, the same passes run against
+* hardware.
+*
+*****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "xstatus.h"
+#include "oran_sdnet.h"
+
+#define BENCH_WINDOW		0x10000
+#define BENCH_ENTRY_WORDS	8
+#define BENCH_CMD_REG		0x8000
+#define BENCH_STATUS_REG	0x8004
+#define BENCH_PASSES		16
+
+static double NowSec(void)
+{
+	struct timespec Ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &Ts);
+	return (double)Ts.tv_sec + (double)Ts.tv_nsec * 1e-9;
+}
+
+static uint32_t EntryWord(uint32_t Pass, uint32_t Entry, uint32_t Word)
+{
+	return (Pass << 24) ^ (Entry << 8) ^ Word ^ 0x5A5A0000;
+}
+
+/*
+ * One pass of Count entries, in a write sequence or not
+ */
+static int WritePass(XilSdnetEnvIf *EnvIfPtr, uint32_t Pass, uint32_t Count,
+		     int Sequence)
+{
+	uint32_t Entry;
+	uint32_t Word;
+	uint32_t Status;
+
+	if (Sequence) {
+		OranEnvUioSequence(EnvIfPtr, 1);
+	}
+	for (Entry = 0; Entry < Count; Entry++) {
+		for (Word = 0; Word < BENCH_ENTRY_WORDS; Word++) {
+			if (EnvIfPtr->WordWrite32(EnvIfPtr,
+					4 * (Entry * BENCH_ENTRY_WORDS + Word),
+					EntryWord(Pass, Entry, Word)) !=
+			    XIL_SDNET_SUCCESS) {
+				return -1;
+			}
+		}
+		if ((EnvIfPtr->WordWrite32(EnvIfPtr, BENCH_CMD_REG, Entry) !=
+		     XIL_SDNET_SUCCESS) ||
+		    (EnvIfPtr->WordRead32(EnvIfPtr, BENCH_STATUS_REG,
+					  &Status) != XIL_SDNET_SUCCESS)) {
+			return -1;
+		}
+	}
+	if (Sequence) {
+		OranEnvUioSequence(EnvIfPtr, 0);
+	}
+
+	return 0;
+}
+
+static int CheckPass(const volatile uint32_t *MockPtr, uint32_t Pass,
+		     uint32_t Count)
+{
+	uint32_t Entry;
+	uint32_t Word;
+
+	for (Entry = 0; Entry < Count; Entry++) {
+		for (Word = 0; Word < BENCH_ENTRY_WORDS; Word++) {
+			if (MockPtr[Entry * BENCH_ENTRY_WORDS + Word] !=
+			    EntryWord(Pass, Entry, Word)) {
+				fprintf(stderr, "pass %u: entry %u word %u "
+					"not written\n", (unsigned)Pass,
+					(unsigned)Entry, (unsigned)Word);
+				return -1;
+			}
+		}
+	}
+	if (MockPtr[BENCH_CMD_REG / 4] != Count - 1) {
+		fprintf(stderr, "pass %u: last command not written\n",
+			(unsigned)Pass);
+		return -1;
+	}
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	static OranEnvUio Uio;
+	static XilSdnetEnvIf EnvIf;
+	char Temp[] = "/dev/shm/sdnet_regsXXXXXX";
+	char TempTmp[] = "/tmp/sdnet_regsXXXXXX";
+	const char *PathPtr = NULL;
+	volatile uint32_t *MockPtr;
+	uint32_t Count = 1024;
+	uint32_t Pass = 0;
+	uint32_t Flushes;
+	double Time[2] = { 0, 0 };
+	double Start;
+	int Sequence;
+	int Fd;
+	int I;
+	int R;
+
+	for (I = 1; I + 1 < argc; I += 2) {
+		if (strcmp(argv[I], "-f") == 0) {
+			PathPtr = argv[I + 1];
+		} else if (strcmp(argv[I], "-n") == 0) {
+			Count = (uint32_t)strtoul(argv[I + 1], NULL, 0);
+		} else {
+			break;
+		}
+	}
+	if ((I != argc) || (Count == 0) ||
+	    (Count * BENCH_ENTRY_WORDS * 4 > BENCH_CMD_REG)) {
+		fprintf(stderr, "usage: env_bench [-f register file] "
+			"[-n entries, 1..%d]\n",
+			BENCH_CMD_REG / (BENCH_ENTRY_WORDS * 4));
+		return 2;
+	}
+
+	if (PathPtr == NULL) {
+		Fd = mkstemp(Temp);
+		PathPtr = Temp;
+		if (Fd < 0) {
+			Fd = mkstemp(TempTmp);
+			PathPtr = TempTmp;
+		}
+	} else {
+		Fd = open(PathPtr, O_RDWR | O_CREAT, 0600);
+	}
+	if ((Fd < 0) || (ftruncate(Fd, BENCH_WINDOW) != 0)) {
+		perror("register file");
+		return 1;
+	}
+	MockPtr = mmap(NULL, BENCH_WINDOW, PROT_READ | PROT_WRITE, MAP_SHARED,
+		       Fd, 0);
+	if (MockPtr == MAP_FAILED) {
+		perror("register file");
+		return 1;
+	}
+
+	if (OranEnvUioOpen(&Uio, &EnvIf, PathPtr, 0, BENCH_WINDOW) !=
+	    XST_SUCCESS) {
+		return 1;
+	}
+
+	for (R = 0; R < BENCH_PASSES; R++) {
+		for (Sequence = 0; Sequence < 2; Sequence++) {
+			Start = NowSec();
+			if (WritePass(&EnvIf, ++Pass, Count, Sequence) != 0) {
+				fprintf(stderr, "register access failed\n");
+				return 1;
+			}
+			Time[Sequence] += NowSec() - Start;
+			if (CheckPass(MockPtr, Pass, Count) != 0) {
+				return 1;
+			}
+		}
+	}
+
+	Flushes = Uio.Flushes;
+	printf("%u entries of %d words, %s\n", (unsigned)Count,
+	       BENCH_ENTRY_WORDS + 1, PathPtr);
+	printf("%-12s %10s %12s\n", "mode", "ns/write", "barriers/ent");
+	printf("%-12s %10.1f %12.1f\n", "direct",
+	       Time[0] * 1e9 / (BENCH_PASSES * Count * (BENCH_ENTRY_WORDS + 1)),
+	       (double)(BENCH_ENTRY_WORDS + 2));
+	printf("%-12s %10.1f %12.1f\n", "sequence",
+	       Time[1] * 1e9 / (BENCH_PASSES * Count * (BENCH_ENTRY_WORDS + 1)),
+	       (double)Flushes / (BENCH_PASSES * Count) + 1);
+
+	OranEnvUioClose(&Uio);
+	munmap((void *)MockPtr, BENCH_WINDOW);
+	close(Fd);
+	if ((PathPtr == Temp) || (PathPtr == TempTmp)) {
+		unlink(PathPtr);
+	}
+
+	return 0;
+}
@@ -0,0 +1,347 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file gem_bench.c
+*
+* Runs the GEM3 rings of oran_gem_ring.c, on the emacps driver, against the
+* looped-back DMA model of gem_model.c, to check the descriptor handling
+* and measure what the rings cost in software.
+*
+*	gem_bench [-t milliseconds per frame size]
+*
+* OranGemRingBench runs for 60, 512 and 1514-byte frames and prints the
+* rate the software sustains; the model moves frames at memcpy speed, so
+* the share of line rate says how far the CPU is from being the limit, not
+* what the GEM reaches. The cache lines the rings clean or invalidate per
+* frame sent and received follow; the host does no maintenance, but the
+* count is what the A53 would do without a coherent port. A frame longer
+* than a pool buffer and a frame that arrives with the pool empty must then
+* be dropped and counted.
+*
+* The interrupt-driven service of oran_gem_napi.c then receives 60-byte
+* frames the model generates at 10, 100 and 500 thousand a second, first
+* with an interrupt for every frame the poll loop does not catch (no
+* moderation), then with the default moderation. Each run prints the
+* interrupts and GEM register accesses per 1000 frames and the time per
+* frame in the interrupt handler and in the poll loop; every generated
+* frame must be received or counted as dropped by the model, none left on
+* the ring, and every RX error the handler saw must reach the error
+* handler of the instance.
+*
+* With the model's TX paced at 1 Gb/s, OranGemRingQueueBench then keeps TX
+* queue 0 full of 1514-byte M-plane frames and times PTP frames sent in
+* between, first on queue 0 behind the load and then on queue 1; every PTP
+* frame must come back. At the end every buffer but those posted on the RX
+* ring must be back in the pool (oran_buf.c) and every frame the model sent
+* accounted for.
+*
+*****************************************************************************/
+
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "xstatus.h"
+#include "xtime_l.h"
+#include "oran_gem_ring.h"
+#include "gem_model.h"
+
+#define BENCH_LONG_BYTES	3000	/* spans two RX buffers */
+#define BENCH_NAPI_BYTES	60
+#define BENCH_DRAIN_MS		20
+#define BENCH_LINE_MBPS		1000
+#define BENCH_NS(Ticks)		(((Ticks) * 1000000000ULL) / COUNTS_PER_SECOND)
+
+typedef struct {
+	const char *Name;
+	u32 Usecs;
+	u32 Frames;
+} BenchNapiMode;
+
+static const BenchNapiMode NapiModes[] = {
+	{ "per-frame", 0, 0 },
+	{ "moderated", ORAN_GEM_NAPI_USECS, ORAN_GEM_NAPI_FRAMES },
+};
+static const u32 NapiRates[] = { 10000, 100000, 500000 };
+
+static u32 Regs[GEM_MODEL_REGS_BYTES / 4];
+static u8 BdSpace[ORAN_GEM_BD_SPACE_BYTES]
+	__attribute__ ((aligned(XEMACPS_BD_ALIGNMENT)));
+static u8 *Held[ORAN_BUF_MEDIUM_CNT];
+static u8 StaticFrame[BENCH_LONG_BYTES];
+static u64 IntrErrors;		/* RX error interrupts of the NAPI runs */
+static u64 ErrorCalls;		/* of which passed to the error handler */
+
+/*
+ * Handlers of the instance, which OranGemNapiIntrHandler passes the status
+ * it does not handle itself to
+ */
+static void BenchSendHandler(void *CallBackRef)
+{
+	(void)CallBackRef;
+}
+
+static void BenchErrorHandler(void *CallBackRef, u8 Direction,
+			      u32 ErrorWord)
+{
+	(void)CallBackRef;
+	(void)ErrorWord;
+	if (Direction == XEMACPS_RECV) {
+		ErrorCalls++;
+	}
+}
+
+/*
+ * Sends one frame from memory outside the pool and takes it back once the
+ * model has looped it. The model finishes receiving a frame before it
+ * marks it sent, so the frame is on the RX ring when it is reclaimed.
+ * Returns the number of frames OranGemRingRecv handed over.
+ */
+static u32 SendStatic(u32 Length)
+{
+	OranGemFrame Frame = { StaticFrame, Length };
+	OranGemFrame Frames[ORAN_GEM_BATCH];
+	u32 Count;
+	u32 Index;
+
+	memset(StaticFrame, 0xFF, 6);
+	StaticFrame[12] = (u8)(ORAN_GEM_BENCH_ETHTYPE >> 8);
+	StaticFrame[13] = (u8)ORAN_GEM_BENCH_ETHTYPE;
+	if (OranGemRingSend(&Frame, 1) != 1) {
+		return 0;
+	}
+	while (OranGemRingReclaim() == 0) {
+	}
+	Count = OranGemRingRecv(Frames, ORAN_GEM_BATCH);
+	for (Index = 0; Index < Count; Index++) {
+		OranGemBufFree(Frames[Index].BufPtr);
+	}
+
+	return Count;
+}
+
+/*
+ * Receives generated frames through OranGemNapiPoll for Milliseconds,
+ * sleeping while the ring is not scheduled. Returns nonzero if frames went
+ * missing.
+ */
+static int RunNapi(XEmacPs *GemPtr, const BenchNapiMode *ModePtr, u32 Rate,
+		   u32 Milliseconds)
+{
+	OranGemFrame Frames[ORAN_GEM_BATCH];
+	OranGemNapiCounters Napi;
+	GemModelCounters Before;
+	GemModelCounters After;
+	XTime Start;
+	XTime Now;
+	XTime Last;
+	u32 Offered = Rate;
+	u64 Received = 0;
+	u64 Per;
+	u64 Generated;
+	u64 Dropped;
+	u64 Regs;
+	u32 Count;
+	u32 Index;
+
+	memset(StaticFrame, 0xFF, 6);
+	StaticFrame[12] = (u8)(ORAN_GEM_BENCH_ETHTYPE >> 8);
+	StaticFrame[13] = (u8)ORAN_GEM_BENCH_ETHTYPE;
+
+	OranGemNapiStart(GemPtr, ModePtr->Usecs, ModePtr->Frames,
+			 ORAN_GEM_NAPI_BUDGET);
+	GemModelGetCounters(&Before);
+	GemModelGenerate(StaticFrame, BENCH_NAPI_BYTES, Rate);
+	XTime_GetTime(&Start);
+	Last = Start;
+	do {
+		Count = OranGemNapiPoll(Frames, ORAN_GEM_BATCH);
+		for (Index = 0; Index < Count; Index++) {
+			OranGemBufFree(Frames[Index].BufPtr);
+		}
+		Received += Count;
+		XTime_GetTime(&Now);
+		if (Count != 0) {
+			Last = Now;
+		} else if (OranGemNapiScheduled() == FALSE) {
+			/* wfi */
+			sched_yield();
+		}
+		if ((Now - Start > Milliseconds * (COUNTS_PER_SECOND / 1000)) &&
+		    (Rate != 0)) {
+			GemModelGenerate(StaticFrame, BENCH_NAPI_BYTES, 0);
+			Rate = 0;
+		}
+	} while ((Rate != 0) ||
+		 (Now - Last < BENCH_DRAIN_MS * (COUNTS_PER_SECOND / 1000)));
+	OranGemNapiStop();
+	GemModelGetCounters(&After);
+	OranGemNapiGetCounters(&Napi);
+	IntrErrors += Napi.IntrErrors;
+
+	Generated = After.Generated - Before.Generated;
+	Dropped = After.RxDropped - Before.RxDropped;
+	Regs = (After.RegReads + After.RegWrites) -
+	       (Before.RegReads + Before.RegWrites);
+	Per = (Received != 0) ? Received : 1;
+	printf("%-10s %8u %10llu %8llu %8llu %8llu %8llu %8llu\n",
+	       ModePtr->Name, (unsigned)Offered, (unsigned long long)Received,
+	       (unsigned long long)Dropped,
+	       (unsigned long long)((Napi.Interrupts * 1000ULL) / Per),
+	       (unsigned long long)((Regs * 1000) / Per),
+	       (unsigned long long)(BENCH_NS(Napi.IntrTicks) / Per),
+	       (unsigned long long)(BENCH_NS(Napi.PollTicks) / Per));
+
+	if (Received + Dropped != Generated) {
+		fprintf(stderr, "%s: %llu frames generated, %llu received, "
+			"%llu dropped\n", ModePtr->Name,
+			(unsigned long long)Generated,
+			(unsigned long long)Received,
+			(unsigned long long)Dropped);
+		return 1;
+	}
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	static const u32 Bytes[] = { 60, 512, 1514 };
+	XEmacPs_Config Config = { 0 };
+	XEmacPs Gem;
+	OranGemRingCounters Before;
+	OranGemRingCounters Counters;
+	GemModelCounters Model;
+	u32 Milliseconds = 500;
+	u32 HeldCnt;
+	u32 Index;
+	int Fail = 0;
+	int I;
+
+	for (I = 1; I + 1 < argc; I += 2) {
+		if (strcmp(argv[I], "-t") == 0) {
+			Milliseconds = (u32)strtoul(argv[I + 1], NULL, 0);
+		} else {
+			break;
+		}
+	}
+	if ((I != argc) || (Milliseconds == 0)) {
+		fprintf(stderr, "usage: gem_bench [-t milliseconds per frame "
+			"size]\n");
+		return 2;
+	}
+
+	OranBufInit();
+	GemModelInit(Regs);
+	Config.BaseAddress = (UINTPTR)Regs;
+	if ((XEmacPs_CfgInitialize(&Gem, &Config, Config.BaseAddress) !=
+	     XST_SUCCESS) ||
+	    (XEmacPs_SetHandler(&Gem, XEMACPS_HANDLER_DMASEND,
+				(void *)BenchSendHandler, NULL) !=
+	     XST_SUCCESS) ||
+	    (XEmacPs_SetHandler(&Gem, XEMACPS_HANDLER_ERROR,
+				(void *)BenchErrorHandler, NULL) !=
+	     XST_SUCCESS) ||
+	    (OranGemRingInit(&Gem, (UINTPTR)BdSpace, sizeof(BdSpace)) !=
+	     XST_SUCCESS)) {
+		return 1;
+	}
+	if (GemModelStart() != 0) {
+		perror("gem model");
+		return 1;
+	}
+	OranGemRingStart();
+
+	printf("%d RX and %d TX descriptors, %d buffers of %d bytes\n",
+	       ORAN_GEM_RXBD_CNT, ORAN_GEM_TXBD_CNT, (int)ORAN_GEM_BUF_CNT,
+	       ORAN_GEM_BUF_SIZE);
+	for (Index = 0; Index < sizeof(Bytes) / sizeof(Bytes[0]); Index++) {
+		OranGemRingGetCounters(&Before);
+		if (OranGemRingBench(Milliseconds, Bytes[Index]) !=
+		    XST_SUCCESS) {
+			Fail = 1;
+		}
+		OranGemRingGetCounters(&Counters);
+		printf("%u-byte frames: %.1f cache lines per frame looped\n",
+		       (unsigned)Bytes[Index],
+		       (double)(Counters.CacheLines - Before.CacheLines) /
+		       (double)((Counters.RxFrames - Before.RxFrames) + 1));
+	}
+
+	OranGemRingGetCounters(&Before);
+	Index = SendStatic(BENCH_LONG_BYTES);
+	OranGemRingGetCounters(&Counters);
+	if ((Index != 0) || (Counters.RxLong != Before.RxLong + 1)) {
+		fprintf(stderr, "%d-byte frame not dropped as too long\n",
+			BENCH_LONG_BYTES);
+		Fail = 1;
+	}
+
+	for (HeldCnt = 0; (Held[HeldCnt] = OranGemBufAlloc()) != NULL;
+	     HeldCnt++) {
+	}
+	Index = SendStatic(60);
+	OranGemRingGetCounters(&Counters);
+	if ((Index != 0) || (Counters.RxNoBuf != Before.RxNoBuf + 1)) {
+		fprintf(stderr, "frame not dropped with the pool empty\n");
+		Fail = 1;
+	}
+	while (HeldCnt != 0) {
+		OranGemBufFree(Held[--HeldCnt]);
+	}
+
+	GemModelConnect(OranGemNapiIntrHandler, NULL);
+	printf("%-10s %8s %10s %8s %8s %8s %8s %8s\n", "interrupt", "frames/s",
+	       "received", "dropped", "irq/1k", "regs/1k", "irq ns", "poll ns");
+	for (Index = 0; Index < sizeof(NapiModes) / sizeof(NapiModes[0]);
+	     Index++) {
+		for (I = 0; I < (int)(sizeof(NapiRates) / sizeof(NapiRates[0]));
+		     I++) {
+			if (RunNapi(&Gem, &NapiModes[Index], NapiRates[I],
+				    Milliseconds) != 0) {
+				Fail = 1;
+			}
+		}
+	}
+
+	GemModelConnect(NULL, NULL);
+	if (ErrorCalls != IntrErrors) {
+		fprintf(stderr, "%llu RX errors, %llu passed to the handler\n",
+			(unsigned long long)IntrErrors,
+			(unsigned long long)ErrorCalls);
+		Fail = 1;
+	}
+	GemModelLineRate(BENCH_LINE_MBPS);
+	if (OranGemRingQueueBench(Milliseconds) != XST_SUCCESS) {
+		Fail = 1;
+	}
+
+	GemModelStop(&Model);
+	(void)OranGemRingReclaim();
+	XEmacPs_Stop(&Gem);
+	OranGemRingGetCounters(&Counters);
+	OranGemRingPrint(&Counters);
+	printf("model: %llu frames sent, %llu received, %llu dropped\n",
+	       (unsigned long long)Model.TxFrames,
+	       (unsigned long long)Model.RxFrames,
+	       (unsigned long long)Model.RxDropped);
+
+	OranBufPrint();
+	if (Counters.BufFree != ORAN_BUF_MEDIUM_CNT - ORAN_GEM_RXBD_CNT) {
+		fprintf(stderr, "%d buffers lost\n",
+			(int)(ORAN_BUF_MEDIUM_CNT - ORAN_GEM_RXBD_CNT -
+			      Counters.BufFree));
+		Fail = 1;
+	}
+	if ((Counters.TxFrames + Counters.TxErrors != Model.TxFrames) ||
+	    (Counters.TxBytes != Model.TxBytes)) {
+		fprintf(stderr, "sent frames not all reclaimed\n");
+		Fail = 1;
+	}
+
+	printf("%s\n", Fail ? "FAIL" : "ok");
+	return Fail;
+}
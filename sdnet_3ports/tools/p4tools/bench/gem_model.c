@@ -0,0 +1,491 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file gem_model.c
+*
+* Software stand-in for the DMA engine of a ZynqMP GEM with its TX looped
+* back to RX. A thread watches the register file the emacps driver writes
+* and walks the descriptor rings the way the GEM does:
+*
+*	- TX runs on queues 0 and 1, from XEMACPS_TXQBASE_OFFSET and
+*	  XEMACPS_TXQ1BASE_OFFSET, once XEMACPS_NWCTRL_STARTTX_MASK is
+*	  written: each frame is taken from queue 1 if it has one, else from
+*	  queue 0, until both reach a descriptor with the used bit set. The
+*	  used bit is set on the first descriptor of each frame sent. With a
+*	  line rate set by GemModelLineRate, a frame takes its time on the
+*	  wire, preamble and gap included, before the next one is taken
+*	- RX runs on queue 0, from XEMACPS_RXQBASE_OFFSET, into buffers of the
+*	  size in XEMACPS_DMACR_OFFSET: a frame spans as many descriptors as
+*	  it needs, with start of frame on the first and end of frame and the
+*	  length on the last, and the new bit is set on each once its status
+*	  is written. A frame that does not find enough descriptors without
+*	  the new bit is dropped, and XEMACPS_RXSR_BUFFNA_MASK set
+*	- both queues go back to their base address when the base register is
+*	  written or the direction is enabled
+*	- a frame received sets XEMACPS_IXR_FRAMERX_MASK in the interrupt
+*	  status, a frame dropped XEMACPS_IXR_RXUSED_MASK. The status and the
+*	  RX and TX status registers are write-one-to-clear, and the enable
+*	  and disable registers drive the mask, through the register hook of
+*	  the xil_io.h stand-in (XIL_IO_MODEL). An unmasked status bit calls
+*	  the handler given to GemModelConnect, on the model's thread, no
+*	  sooner than the RX interrupt moderation time (bits 7:0 of 0x5C, in
+*	  steps of 800 ns) after the previous call
+*	- GemModelGenerate feeds RX with copies of a frame at a set rate,
+*	  besides what TX loops back
+*
+* TX completion interrupts, statistics registers, the MAC and the PHY are
+* not modelled. Descriptors and buffers are read and written in place, so
+* the driver's addresses must fit the 32-bit descriptor words: build with
+* -no-pie.
+*
+*****************************************************************************/
+
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <time.h>
+#include "xemacps.h"
+#include "gem_model.h"
+
+#define MODEL_FRAME_MAX		0x4000	/* XEMACPS_TXBUF_LEN_MASK + 1 */
+#define MODEL_INTMOD_OFFSET	0x5C
+#define MODEL_INTMOD_STEP_NS	800
+#define MODEL_GEN_BACKLOG	4096	/* frames the generator catches up on */
+#define MODEL_TXQ_CNT		2
+#define MODEL_WIRE_OVERHEAD	24	/* FCS, preamble and gap, bytes */
+#define MODEL_WIRE_SLACK_NS	1000000	/* the line catches up on no more */
+
+static u32 *ModelRegs;
+static pthread_t ModelThread;
+static int ModelStop;
+static GemModelCounters ModelCounters;
+static u8 ModelFrame[MODEL_FRAME_MAX];
+static void (*ModelHandler)(void *CallbackRef);
+static void *ModelHandlerRef;
+static u64 ModelNextIrq;
+static u32 ModelLineMbps;	/* 0: frames take no time */
+static const u32 ModelTxqBase[MODEL_TXQ_CNT] = {
+	XEMACPS_TXQBASE_OFFSET, XEMACPS_TXQ1BASE_OFFSET
+};
+
+static u8 GenFrame[MODEL_FRAME_MAX];
+static u32 GenLength;
+static u64 GenRate;	/* frames per second, 0 when off */
+static u64 GenStart;
+static u64 GenDone;
+static pthread_mutex_t GenLock = PTHREAD_MUTEX_INITIALIZER;
+
+static u64 ModelNowNs(void)
+{
+	struct timespec Ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &Ts);
+	return (u64)Ts.tv_sec * 1000000000ULL + (u64)Ts.tv_nsec;
+}
+
+static u32 ModelRead(u32 *WordPtr)
+{
+	return __atomic_load_n(WordPtr, __ATOMIC_ACQUIRE);
+}
+
+static void ModelWrite(u32 *WordPtr, u32 Value)
+{
+	__atomic_store_n(WordPtr, Value, __ATOMIC_RELEASE);
+}
+
+static u32 *ModelReg(u32 Offset)
+{
+	return &ModelRegs[Offset / 4];
+}
+
+static u32 *ModelBdWord(UINTPTR BdAddr, u32 Offset)
+{
+	return (u32 *)(BdAddr + Offset);
+}
+
+static int ModelIsReg(UINTPTR Addr)
+{
+	return (ModelRegs != NULL) && (Addr >= (UINTPTR)ModelRegs) &&
+	       (Addr < (UINTPTR)ModelRegs + GEM_MODEL_REGS_BYTES);
+}
+
+void XilIoModelOut32(UINTPTR Addr, u32 Value)
+{
+	u32 *RegPtr = (u32 *)Addr;
+
+	if (!ModelIsReg(Addr)) {
+		*(volatile u32 *)Addr = Value;
+		return;
+	}
+
+	__atomic_fetch_add(&ModelCounters.RegWrites, 1, __ATOMIC_RELAXED);
+	switch (Addr - (UINTPTR)ModelRegs) {
+	case XEMACPS_ISR_OFFSET:
+	case XEMACPS_RXSR_OFFSET:
+	case XEMACPS_TXSR_OFFSET:
+	case XEMACPS_INTQ1_STS_OFFSET:
+		__atomic_fetch_and(RegPtr, ~Value, __ATOMIC_ACQ_REL);
+		break;
+	case XEMACPS_IER_OFFSET:
+		__atomic_fetch_and(ModelReg(XEMACPS_IMR_OFFSET), ~Value,
+				   __ATOMIC_ACQ_REL);
+		break;
+	case XEMACPS_IDR_OFFSET:
+		__atomic_fetch_or(ModelReg(XEMACPS_IMR_OFFSET), Value,
+				  __ATOMIC_ACQ_REL);
+		break;
+	case XEMACPS_INTQ1_IER_OFFSET:
+		__atomic_fetch_and(ModelReg(XEMACPS_INTQ1_IMR_OFFSET), ~Value,
+				   __ATOMIC_ACQ_REL);
+		break;
+	case XEMACPS_INTQ1_IDR_OFFSET:
+		__atomic_fetch_or(ModelReg(XEMACPS_INTQ1_IMR_OFFSET), Value,
+				  __ATOMIC_ACQ_REL);
+		break;
+	default:
+		ModelWrite(RegPtr, Value);
+		break;
+	}
+}
+
+u32 XilIoModelIn32(UINTPTR Addr)
+{
+	if (!ModelIsReg(Addr)) {
+		return *(volatile u32 *)Addr;
+	}
+
+	__atomic_fetch_add(&ModelCounters.RegReads, 1, __ATOMIC_RELAXED);
+	return ModelRead((u32 *)Addr);
+}
+
+/*
+ * Calls the handler for unmasked status bits, at most once per moderation
+ * time
+ */
+static void ModelInterrupt(void)
+{
+	u32 Pending;
+	u64 Now;
+
+	Pending = ModelRead(ModelReg(XEMACPS_ISR_OFFSET)) &
+		  ~ModelRead(ModelReg(XEMACPS_IMR_OFFSET));
+	if ((Pending == 0) || (ModelHandler == NULL)) {
+		return;
+	}
+	Now = ModelNowNs();
+	if (Now < ModelNextIrq) {
+		return;
+	}
+
+	ModelCounters.Interrupts++;
+	ModelHandler(ModelHandlerRef);
+	ModelNextIrq = Now + (ModelRead(ModelReg(MODEL_INTMOD_OFFSET)) &
+			      0xFF) * MODEL_INTMOD_STEP_NS;
+}
+
+/*
+ * Places a looped-back frame on the RX ring at *BdPtr
+ */
+static void ModelReceive(UINTPTR *BdPtr, const u8 *FramePtr, u32 Length)
+{
+	u32 BufBytes;
+	u32 Need;
+	u32 Index;
+	u32 Addr;
+	u32 Chunk;
+	u32 Status;
+	UINTPTR Bd = *BdPtr;
+
+	BufBytes = ((ModelRead(ModelReg(XEMACPS_DMACR_OFFSET)) &
+		     XEMACPS_DMACR_RXBUF_MASK) >> XEMACPS_DMACR_RXBUF_SHIFT) *
+		   XEMACPS_RX_BUF_UNIT;
+	if (BufBytes == 0) {
+		BufBytes = XEMACPS_RX_BUF_UNIT;
+	}
+	Need = (Length + BufBytes - 1) / BufBytes;
+
+	for (Index = 0; Index < Need; Index++) {
+		Addr = ModelRead(ModelBdWord(Bd, XEMACPS_BD_ADDR_OFFSET));
+		if ((Addr & XEMACPS_RXBUF_NEW_MASK) != 0) {
+			__atomic_fetch_or(ModelReg(XEMACPS_RXSR_OFFSET),
+					  XEMACPS_RXSR_BUFFNA_MASK,
+					  __ATOMIC_RELAXED);
+			__atomic_fetch_or(ModelReg(XEMACPS_ISR_OFFSET),
+					  XEMACPS_IXR_RXUSED_MASK,
+					  __ATOMIC_RELEASE);
+			ModelCounters.RxDropped++;
+			return;
+		}
+		Bd = ((Addr & XEMACPS_RXBUF_WRAP_MASK) != 0) ?
+		     ModelRead(ModelReg(XEMACPS_RXQBASE_OFFSET)) :
+		     Bd + sizeof(XEmacPs_Bd);
+	}
+
+	Bd = *BdPtr;
+	for (Index = 0; Index < Need; Index++) {
+		Addr = ModelRead(ModelBdWord(Bd, XEMACPS_BD_ADDR_OFFSET));
+		Chunk = (Length - Index * BufBytes < BufBytes) ?
+			Length - Index * BufBytes : BufBytes;
+		memcpy((void *)(UINTPTR)(Addr & XEMACPS_RXBUF_ADD_MASK),
+		       FramePtr + Index * BufBytes, Chunk);
+		Status = 0;
+		if (Index == 0) {
+			Status |= XEMACPS_RXBUF_SOF_MASK;
+		}
+		if (Index == Need - 1) {
+			Status |= XEMACPS_RXBUF_EOF_MASK |
+				  (Length & XEMACPS_RXBUF_LEN_JUMBO_MASK);
+		}
+		ModelWrite(ModelBdWord(Bd, XEMACPS_BD_STAT_OFFSET), Status);
+		ModelWrite(ModelBdWord(Bd, XEMACPS_BD_ADDR_OFFSET),
+			   Addr | XEMACPS_RXBUF_NEW_MASK);
+		Bd = ((Addr & XEMACPS_RXBUF_WRAP_MASK) != 0) ?
+		     ModelRead(ModelReg(XEMACPS_RXQBASE_OFFSET)) :
+		     Bd + sizeof(XEmacPs_Bd);
+	}
+	*BdPtr = Bd;
+	ModelCounters.RxFrames++;
+	__atomic_fetch_or(ModelReg(XEMACPS_ISR_OFFSET),
+			  XEMACPS_IXR_FRAMERX_MASK, __ATOMIC_RELEASE);
+}
+
+/*
+ * Feeds RX with the generator frames due by now
+ */
+static void ModelGenerate(UINTPTR *RxBdPtr, u32 NwCtrl)
+{
+	u64 Due;
+
+	pthread_mutex_lock(&GenLock);
+	if (GenRate != 0) {
+		Due = ((ModelNowNs() - GenStart) * GenRate) / 1000000000ULL;
+		if (Due - GenDone > MODEL_GEN_BACKLOG) {
+			GenDone = Due - MODEL_GEN_BACKLOG;
+		}
+		while (GenDone < Due) {
+			if (((NwCtrl & XEMACPS_NWCTRL_RXEN_MASK) != 0) &&
+			    (*RxBdPtr != 0)) {
+				ModelReceive(RxBdPtr, GenFrame, GenLength);
+				ModelCounters.Generated++;
+			}
+			GenDone++;
+		}
+	}
+	pthread_mutex_unlock(&GenLock);
+}
+
+/*
+ * Sends the frame queued at *TxBdPtr on the TX queue whose base register is
+ * at BaseOffset, looping it back to the RX ring at *RxBdPtr while receive
+ * is enabled. Returns its length, 0 if nothing is queued.
+ */
+static u32 ModelTransmit(UINTPTR *TxBdPtr, u32 BaseOffset, UINTPTR *RxBdPtr,
+			 u32 NwCtrl)
+{
+	UINTPTR First;
+	UINTPTR Bd = *TxBdPtr;
+	u32 Status;
+	u32 Length;
+	u32 Chunk;
+
+	Status = ModelRead(ModelBdWord(Bd, XEMACPS_BD_STAT_OFFSET));
+	if ((Status & XEMACPS_TXBUF_USED_MASK) != 0) {
+		return 0;
+	}
+
+	First = Bd;
+	Length = 0;
+	for (;;) {
+		Chunk = Status & XEMACPS_TXBUF_LEN_MASK;
+		if (Length + Chunk <= MODEL_FRAME_MAX) {
+			memcpy(ModelFrame + Length,
+			       (void *)(UINTPTR)ModelRead(ModelBdWord(
+				       Bd, XEMACPS_BD_ADDR_OFFSET)),
+			       Chunk);
+		}
+		Length += Chunk;
+		Bd = ((Status & XEMACPS_TXBUF_WRAP_MASK) != 0) ?
+		     ModelRead(ModelReg(BaseOffset)) :
+		     Bd + sizeof(XEmacPs_Bd);
+		if ((Status & XEMACPS_TXBUF_LAST_MASK) != 0) {
+			break;
+		}
+		Status = ModelRead(ModelBdWord(Bd, XEMACPS_BD_STAT_OFFSET));
+	}
+
+	ModelCounters.TxFrames++;
+	ModelCounters.TxBytes += Length;
+	if (((NwCtrl & XEMACPS_NWCTRL_RXEN_MASK) != 0) &&
+	    (Length <= MODEL_FRAME_MAX)) {
+		ModelReceive(RxBdPtr, ModelFrame, Length);
+	}
+	__atomic_fetch_or(ModelBdWord(First, XEMACPS_BD_STAT_OFFSET),
+			  XEMACPS_TXBUF_USED_MASK, __ATOMIC_RELEASE);
+	*TxBdPtr = Bd;
+
+	return (Length != 0) ? Length : 1;
+}
+
+static void *ModelMain(void *Arg)
+{
+	u32 RxBase = 0;
+	u32 TxBase[MODEL_TXQ_CNT] = { 0 };
+	u32 Enabled = 0;
+	u32 Active = 0;
+	UINTPTR RxBd = 0;
+	UINTPTR TxBd[MODEL_TXQ_CNT] = { 0 };
+	u64 NextTx = 0;
+	u64 Now;
+	u32 NwCtrl;
+	u32 Reg;
+	u32 Length;
+	int Queue;
+
+	(void)Arg;
+	while (!__atomic_load_n(&ModelStop, __ATOMIC_ACQUIRE)) {
+		NwCtrl = ModelRead(ModelReg(XEMACPS_NWCTRL_OFFSET));
+		Reg = ModelRead(ModelReg(XEMACPS_RXQBASE_OFFSET));
+		if ((Reg != RxBase) ||
+		    ((NwCtrl & ~Enabled & XEMACPS_NWCTRL_RXEN_MASK) != 0)) {
+			RxBase = Reg;
+			RxBd = Reg;
+		}
+		for (Queue = 0; Queue < MODEL_TXQ_CNT; Queue++) {
+			Reg = ModelRead(ModelReg(ModelTxqBase[Queue]));
+			if ((Reg != TxBase[Queue]) ||
+			    ((NwCtrl & ~Enabled &
+			      XEMACPS_NWCTRL_TXEN_MASK) != 0)) {
+				TxBase[Queue] = Reg;
+				TxBd[Queue] = Reg;
+			}
+		}
+		Enabled = NwCtrl;
+
+		ModelGenerate(&RxBd, NwCtrl);
+		ModelInterrupt();
+		if ((NwCtrl & XEMACPS_NWCTRL_TXEN_MASK) == 0) {
+			Active = 0;
+		} else if ((NwCtrl & XEMACPS_NWCTRL_STARTTX_MASK) != 0) {
+			/* The driver may set the bit again: then run again */
+			Reg = NwCtrl;
+			while (!__atomic_compare_exchange_n(
+				       ModelReg(XEMACPS_NWCTRL_OFFSET), &Reg,
+				       Reg & ~XEMACPS_NWCTRL_STARTTX_MASK, 0,
+				       __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+			}
+			Active = 1;
+		}
+		if (RxBd == 0) {
+			NwCtrl &= ~XEMACPS_NWCTRL_RXEN_MASK;
+		}
+
+		while (Active) {
+			if (ModelLineMbps != 0) {
+				Now = ModelNowNs();
+				if (Now < NextTx) {
+					break;
+				}
+				if (Now - NextTx > MODEL_WIRE_SLACK_NS) {
+					NextTx = Now - MODEL_WIRE_SLACK_NS;
+				}
+			}
+			Length = 0;
+			for (Queue = MODEL_TXQ_CNT - 1; Queue >= 0; Queue--) {
+				if ((TxBd[Queue] != 0) &&
+				    ((Length = ModelTransmit(
+					      &TxBd[Queue],
+					      ModelTxqBase[Queue], &RxBd,
+					      NwCtrl)) != 0)) {
+					break;
+				}
+			}
+			if (Length == 0) {
+				Active = 0;
+			} else if (ModelLineMbps != 0) {
+				NextTx += ((u64)(Length + MODEL_WIRE_OVERHEAD) *
+					   8000) / ModelLineMbps;
+			}
+		}
+		ModelInterrupt();
+		sched_yield();
+	}
+
+	return NULL;
+}
+
+/*
+ * Clears the register file and sets the module revision the driver reads
+ * in XEmacPs_Reset
+ */
+void GemModelInit(u32 *Regs)
+{
+	ModelRegs = Regs;
+	memset(Regs, 0, GEM_MODEL_REGS_BYTES);
+	Regs[GEM_MODEL_REVISION_REG / 4] = (u32)GEM_MODEL_VERSION << 16;
+	Regs[XEMACPS_IMR_OFFSET / 4] = XEMACPS_IXR_ALL_MASK;
+	Regs[XEMACPS_INTQ1_IMR_OFFSET / 4] = XEMACPS_INTQ1_IXR_ALL_MASK;
+	memset(&ModelCounters, 0, sizeof(ModelCounters));
+	ModelHandler = NULL;
+	ModelLineMbps = 0;
+	GenRate = 0;
+}
+
+/*
+ * Paces TX at a line rate, or sends at memcpy speed with 0
+ */
+void GemModelLineRate(u32 Mbps)
+{
+	__atomic_store_n(&ModelLineMbps, Mbps, __ATOMIC_RELEASE);
+}
+
+/*
+ * Sets the function the model calls as the GEM interrupt
+ */
+void GemModelConnect(void (*Handler)(void *CallbackRef), void *CallbackRef)
+{
+	ModelHandlerRef = CallbackRef;
+	__atomic_store_n(&ModelHandler, Handler, __ATOMIC_RELEASE);
+}
+
+/*
+ * Starts feeding RX with copies of a frame, FramesPerSec of them a second
+ * from now on, or stops with a rate of 0
+ */
+void GemModelGenerate(const u8 *FramePtr, u32 Length, u32 FramesPerSec)
+{
+	pthread_mutex_lock(&GenLock);
+	GenLength = (Length < MODEL_FRAME_MAX) ? Length : MODEL_FRAME_MAX;
+	memcpy(GenFrame, FramePtr, GenLength);
+	GenRate = FramesPerSec;
+	GenStart = ModelNowNs();
+	GenDone = 0;
+	pthread_mutex_unlock(&GenLock);
+}
+
+/*
+ * Reads what the model has done so far
+ */
+void GemModelGetCounters(GemModelCounters *CountersPtr)
+{
+	*CountersPtr = ModelCounters;
+}
+
+int GemModelStart(void)
+{
+	__atomic_store_n(&ModelStop, 0, __ATOMIC_RELEASE);
+	return pthread_create(&ModelThread, NULL, ModelMain, NULL);
+}
+
+/*
+ * Stops the thread and reads what it sent and received
+ */
+void GemModelStop(GemModelCounters *CountersPtr)
+{
+	__atomic_store_n(&ModelStop, 1, __ATOMIC_RELEASE);
+	(void)pthread_join(ModelThread, NULL);
+	*CountersPtr = ModelCounters;
+}
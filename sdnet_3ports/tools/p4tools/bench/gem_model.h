@@ -0,0 +1,43 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file gem_model.h
+*
+* Software stand-in for the DMA engine and interrupt of a ZynqMP GEM in
+* loopback, so that the emacps driver and the rings of oran_gem_ring.c run
+* on a host. Build with XIL_IO_MODEL. See gem_model.c.
+*
+*****************************************************************************/
+#ifndef GEM_MODEL_H
+#define GEM_MODEL_H
+
+#include "xil_types.h"
+
+#define GEM_MODEL_REGS_BYTES	0x1000	/* register file, from the base */
+#define GEM_MODEL_REVISION_REG	0xFC	/* read by XEmacPs_Reset */
+#define GEM_MODEL_VERSION	7	/* module ID, bits 27:16 of the above */
+
+typedef struct {
+	u64 TxFrames;
+	u64 TxBytes;
+	u64 RxFrames;
+	u64 RxDropped;	/* no descriptor posted */
+	u64 Generated;	/* by GemModelGenerate, received or dropped */
+	u64 Interrupts;
+	u64 RegReads;
+	u64 RegWrites;
+} GemModelCounters;
+
+void GemModelInit(u32 *Regs);
+void GemModelConnect(void (*Handler)(void *CallbackRef), void *CallbackRef);
+void GemModelLineRate(u32 Mbps);
+void GemModelGenerate(const u8 *FramePtr, u32 Length, u32 FramesPerSec);
+int GemModelStart(void);
+void GemModelGetCounters(GemModelCounters *CountersPtr);
+void GemModelStop(GemModelCounters *CountersPtr);
+
+#endif /* GEM_MODEL_H */
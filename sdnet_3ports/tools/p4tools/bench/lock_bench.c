@@ -0,0 +1,323 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file lock_bench.c
+*
+* Runs eaxc_steer queries from several threads while another thread
+* changes the table, against the software driver and CAM model of
+* sdnet_model.c, to show that the lock-free queries of oran_eaxc.c keep
+* scaling while writes are in progress (see oran_lock.c).
+*
+*	lock_bench [-p main.json] [-t milliseconds per run] [-r max readers]
+*
+* eaxc_steer is filled with one entry per stream. The writer moves streams
+* between two tdests with OranEaxcUpdateRule and deletes and re-inserts
+* the last ORAN_EAXC_DEPTH / 8 of them; every reader result is checked
+* against what the writer can have left in the table. Each reader count
+* runs with the writer idle and busy, first with the lock-free queries and
+* then with every call under one global mutex, the way a table-wide lock
+* would serialize them. OranEaxcAudit runs at the end.
+*
+*****************************************************************************/
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "xstatus.h"
+#include "oran_sdnet.h"
+#include "sdnet_model.h"
+
+#define BENCH_TABLES	4	/* CAM windows of the register array */
+#define BENCH_COUNT	ORAN_EAXC_DEPTH
+#define BENCH_CHURN	(ORAN_EAXC_DEPTH / 8)	/* deleted and re-inserted */
+#define BENCH_THREADS	4	/* readers and the writer */
+#define BENCH_NONE	0xFFFF
+
+typedef struct {
+	pthread_t Thread;
+	uint32_t Seed;
+	uint64_t Ops;
+	uint64_t Errors;
+} BenchThread;
+
+static u32 Regs[BENCH_TABLES * SDNET_MODEL_CAM_WINDOW / 4];
+static OranEaxcRule Rules[BENCH_COUNT];
+static uint16_t IndexOf[0x10000];	/* PC_ID to rule */
+static pthread_mutex_t Global = PTHREAD_MUTEX_INITIALIZER;
+static pthread_barrier_t Barrier;
+static int UseGlobal;
+static int Stop;
+
+static uint32_t Random(uint32_t *SeedPtr)
+{
+	*SeedPtr = *SeedPtr * 1103515245u + 12345u;
+	return *SeedPtr >> 8;
+}
+
+static double NowSec(void)
+{
+	struct timespec Ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &Ts);
+	return (double)Ts.tv_sec + (double)Ts.tv_nsec * 1e-9;
+}
+
+static void Enter(void)
+{
+	if (UseGlobal) {
+		pthread_mutex_lock(&Global);
+	}
+}
+
+static void Leave(void)
+{
+	if (UseGlobal) {
+		pthread_mutex_unlock(&Global);
+	}
+}
+
+/*
+ * A stream's tdest is its own or that plus 3, its priority never changes,
+ * and only the churned streams may be missing
+ */
+static int CheckRule(const OranEaxcRule *RulePtr, uint32_t Index)
+{
+	return (RulePtr->AxisTid == Rules[Index].AxisTid) &&
+	       (RulePtr->PcId == Rules[Index].PcId) &&
+	       ((RulePtr->Tdest == Rules[Index].Tdest) ||
+		(RulePtr->Tdest == Rules[Index].Tdest + 3)) &&
+	       (RulePtr->Prio == Rules[Index].Prio);
+}
+
+static void *Reader(void *Arg)
+{
+	BenchThread *SelfPtr = Arg;
+	OranEaxcRule Found[8];
+	OranEaxcRule Rule;
+	uint32_t Index;
+	uint32_t Count;
+	uint32_t I;
+	LONG Status;
+
+	pthread_barrier_wait(&Barrier);
+	while (!__atomic_load_n(&Stop, __ATOMIC_RELAXED)) {
+		Index = Random(&SelfPtr->Seed) % BENCH_COUNT;
+		if ((SelfPtr->Ops & 63) != 63) {
+			Enter();
+			Status = OranEaxcGetRule(Rules[Index].AxisTid,
+						 Rules[Index].PcId, &Rule);
+			Leave();
+			if ((Status == XST_SUCCESS) ? !CheckRule(&Rule, Index) :
+			    (Index < BENCH_COUNT - BENCH_CHURN)) {
+				SelfPtr->Errors++;
+			}
+		} else {
+			Enter();
+			Count = OranEaxcGetByResponse(Rules[Index].Tdest,
+						      Rules[Index].Prio, Found,
+						      8);
+			Leave();
+			for (I = 0; (I < Count) && (I < 8); I++) {
+				if ((IndexOf[Found[I].PcId] == BENCH_NONE) ||
+				    !CheckRule(&Found[I],
+					       IndexOf[Found[I].PcId]) ||
+				    (Found[I].Tdest != Rules[Index].Tdest)) {
+					SelfPtr->Errors++;
+				}
+			}
+		}
+		SelfPtr->Ops++;
+	}
+
+	return NULL;
+}
+
+static void *Writer(void *Arg)
+{
+	BenchThread *SelfPtr = Arg;
+	OranEaxcRule Rule;
+	uint32_t Index;
+	LONG Status;
+
+	pthread_barrier_wait(&Barrier);
+	while (!__atomic_load_n(&Stop, __ATOMIC_RELAXED)) {
+		Index = Random(&SelfPtr->Seed) % BENCH_COUNT;
+		Rule = Rules[Index];
+		Enter();
+		if (Index < BENCH_COUNT - BENCH_CHURN) {
+			Rule.Tdest += (Random(&SelfPtr->Seed) & 1) ? 3 : 0;
+			Status = OranEaxcUpdateRule(&Rule);
+		} else {
+			Status = OranEaxcDeleteRule(Rule.AxisTid, Rule.PcId);
+			if (Status == XST_SUCCESS) {
+				Status = OranEaxcInsertRule(&Rule);
+			}
+		}
+		Leave();
+		if (Status != XST_SUCCESS) {
+			SelfPtr->Errors++;
+		}
+		SelfPtr->Ops++;
+	}
+
+	return NULL;
+}
+
+/*
+ * One run of Readers readers, with or without the writer. Returns the
+ * number of wrong results.
+ */
+static uint64_t Run(uint32_t Readers, int Writing, double Seconds,
+		    double *ReadRatePtr, double *WriteRatePtr)
+{
+	BenchThread Threads[BENCH_THREADS];
+	struct timespec Sleep;
+	uint64_t Reads = 0;
+	uint64_t Errors = 0;
+	double Start;
+	double Time;
+	uint32_t Count = Readers + (Writing ? 1 : 0);
+	uint32_t T;
+
+	memset(Threads, 0, sizeof(Threads));
+	Stop = 0;
+	pthread_barrier_init(&Barrier, NULL, Count + 1);
+	for (T = 0; T < Count; T++) {
+		Threads[T].Seed = T + 1;
+		pthread_create(&Threads[T].Thread, NULL,
+			       (T < Readers) ? Reader : Writer, &Threads[T]);
+	}
+
+	pthread_barrier_wait(&Barrier);
+	Start = NowSec();
+	Sleep.tv_sec = (time_t)Seconds;
+	Sleep.tv_nsec = (long)((Seconds - (double)Sleep.tv_sec) * 1e9);
+	nanosleep(&Sleep, NULL);
+	__atomic_store_n(&Stop, 1, __ATOMIC_RELAXED);
+	for (T = 0; T < Count; T++) {
+		pthread_join(Threads[T].Thread, NULL);
+	}
+	Time = NowSec() - Start;
+	pthread_barrier_destroy(&Barrier);
+
+	for (T = 0; T < Readers; T++) {
+		Reads += Threads[T].Ops;
+		Errors += Threads[T].Errors;
+	}
+	*ReadRatePtr = (double)Reads / Time;
+	*WriteRatePtr = Writing ? (double)Threads[Readers].Ops / Time : 0.0;
+	if (Writing) {
+		Errors += Threads[Readers].Errors;
+	}
+
+	return Errors;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *P4JsonPath =
+		"../../sdnet_3ports.ip_user_files/mem_init_files/main.json";
+	static const char *const ModeNames[2] = { "lock-free", "global mutex" };
+	uint32_t MaxReaders = BENCH_THREADS - 1;
+	uint32_t Milliseconds = 200;
+	uint64_t Errors = 0;
+	double Single[2] = { 0.0, 0.0 };
+	double ReadRate;
+	double WriteRate;
+	char ErrBuf[256];
+	uint32_t Readers;
+	uint32_t I;
+	int Writing;
+	int Mode;
+	int Arg;
+
+	for (Arg = 1; Arg + 1 < argc; Arg += 2) {
+		if (strcmp(argv[Arg], "-p") == 0) {
+			P4JsonPath = argv[Arg + 1];
+		} else if (strcmp(argv[Arg], "-t") == 0) {
+			Milliseconds = (uint32_t)strtoul(argv[Arg + 1], NULL,
+							 0);
+		} else if (strcmp(argv[Arg], "-r") == 0) {
+			MaxReaders = (uint32_t)strtoul(argv[Arg + 1], NULL, 0);
+		} else {
+			break;
+		}
+	}
+	if ((Arg != argc) || (Milliseconds == 0) || (MaxReaders == 0) ||
+	    (MaxReaders > BENCH_THREADS - 1)) {
+		fprintf(stderr, "usage: lock_bench [-p main.json] "
+			"[-t milliseconds per run] [-r max readers, 1..%d]\n",
+			BENCH_THREADS - 1);
+		return 2;
+	}
+
+	if (SdnetModelLoadConfig(P4JsonPath, ErrBuf, sizeof(ErrBuf)) != 0) {
+		fprintf(stderr, "%s: %s\n", P4JsonPath, ErrBuf);
+		return 1;
+	}
+	if (XilSdnetTargetConfig_mb_es_design_sdnet_0_1.TableListSize >
+	    BENCH_TABLES) {
+		fprintf(stderr, "%s: more than %d tables\n", P4JsonPath,
+			BENCH_TABLES);
+		return 1;
+	}
+
+	memset(IndexOf, 0xFF, sizeof(IndexOf));
+	for (I = 0; I < BENCH_COUNT; I++) {
+		Rules[I].AxisTid = (uint8_t)(I % 3);
+		Rules[I].PcId = (uint16_t)(I * 40503u);	/* distinct, spread */
+		Rules[I].Tdest = I % 3;
+		Rules[I].Prio = ORAN_PRIO_UPLANE;
+		IndexOf[Rules[I].PcId] = (uint16_t)I;
+	}
+	if ((OranSdnetInit((UINTPTR)Regs) != XST_SUCCESS) ||
+	    (OranEaxcInit() != XST_SUCCESS)) {
+		fprintf(stderr, "application bring-up failed\n");
+		return 1;
+	}
+	for (I = 0; I < BENCH_COUNT; I++) {
+		if (OranEaxcInsertRule(&Rules[I]) != XST_SUCCESS) {
+			fprintf(stderr, "eaxc_steer insert failed\n");
+			return 1;
+		}
+	}
+
+	printf("%-13s %7s %6s %12s %12s %9s %10s\n", "", "readers", "writer",
+	       "reads/s", "per reader", "scaling", "writes/s");
+	for (Mode = 0; Mode < 2; Mode++) {
+		UseGlobal = Mode;
+		for (Readers = 1; Readers <= MaxReaders; Readers++) {
+			for (Writing = 0; Writing < 2; Writing++) {
+				Errors += Run(Readers, Writing,
+					      Milliseconds / 1000.0,
+					      &ReadRate, &WriteRate);
+				if ((Readers == 1) && !Writing) {
+					Single[Mode] = ReadRate;
+				}
+				printf("%-13s %7u %6s %12.0f %12.0f %8.2fx "
+				       "%10.0f\n", ModeNames[Mode],
+				       (unsigned)Readers,
+				       Writing ? "busy" : "idle", ReadRate,
+				       ReadRate / Readers,
+				       ReadRate / Single[Mode], WriteRate);
+			}
+		}
+	}
+
+	if (OranEaxcAudit() != XST_SUCCESS) {
+		Errors++;
+	}
+	if (Errors != 0) {
+		fprintf(stderr, "lock_bench: %llu wrong results\n",
+			(unsigned long long)Errors);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,177 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file sdnet_config.c
+*
+* XilSdnetTargetConfig_mb_es_design_sdnet_0_1, which the SDNet build
+* generates for the IP, built instead from main.json for sdnet_model.c.
+* Every table with a key becomes a TCAM if any key field is ternary or LPM
+* and a BCAM otherwise, sized by max_size, with the actions and parameter
+* widths of the P4 program. Keyless tables have no CAM and are left out.
+*
+*****************************************************************************/
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "p4prog.h"
+#include "sdnet_model.h"
+
+XilSdnetTargetConfig XilSdnetTargetConfig_mb_es_design_sdnet_0_1;
+
+static char *ConfigStrdup(const char *S)
+{
+	char *Copy = malloc(strlen(S) + 1);
+
+	if (Copy != NULL) {
+		strcpy(Copy, S);
+	}
+	return Copy;
+}
+
+static int ConfigError(char *ErrBuf, size_t ErrLen, const char *Fmt, ...)
+{
+	va_list Args;
+
+	va_start(Args, Fmt);
+	vsnprintf(ErrBuf, ErrLen, Fmt, Args);
+	va_end(Args);
+	return -1;
+}
+
+/****************************************************************************/
+/**
+*
+* Fills XilSdnetTargetConfig_mb_es_design_sdnet_0_1 from a p4c-sdnet JSON
+* program, in place of the configuration the SDNet build generates.
+*
+* @param	P4JsonPath is main.json.
+* @param	ErrBuf receives a message on failure.
+* @param	ErrLen is the size of ErrBuf.
+*
+* @return	0 on success, -1 on failure.
+*
+* @note		Loading again leaks the previous configuration, which
+*		targets may still point to.
+*
+*****************************************************************************/
+int SdnetModelLoadConfig(const char *P4JsonPath, char *ErrBuf, size_t ErrLen)
+{
+	XilSdnetTargetConfig *ConfigPtr =
+		&XilSdnetTargetConfig_mb_es_design_sdnet_0_1;
+	XilSdnetTargetTableConfig **List;
+	XilSdnetTargetTableConfig *Entry;
+	XilSdnetTableConfig *Tbl;
+	const P4Table *P4Tbl;
+	const P4Action *P4Act;
+	XilSdnetAction *Act;
+	P4Program Prog;
+	char Format[P4_MAX_KEY_FIELDS * 8];
+	uint32_t ParamBits;
+	uint32_t MaxParamBits;
+	uint32_t Count = 0;
+	uint32_t I;
+	uint32_t K;
+	uint32_t P;
+	int Ternary;
+
+	if (P4ProgramLoad(&Prog, P4JsonPath, ErrBuf, ErrLen) != 0) {
+		return -1;
+	}
+
+	List = calloc(Prog.NumTables + 1, sizeof(*List));
+	if (List == NULL) {
+		P4ProgramFree(&Prog);
+		return ConfigError(ErrBuf, ErrLen, "out of memory");
+	}
+
+	for (I = 0; I < Prog.NumTables; I++) {
+		P4Tbl = &Prog.Tables[I];
+		if (P4Tbl->NumKeys == 0) {
+			continue;	/* keyless, no CAM behind it */
+		}
+
+		Entry = calloc(1, sizeof(*Entry));
+		if (Entry == NULL) {
+			P4ProgramFree(&Prog);
+			return ConfigError(ErrBuf, ErrLen, "out of memory");
+		}
+		Tbl = &Entry->Config;
+		Entry->NameStringPtr = ConfigStrdup(P4Tbl->Name);
+
+		Format[0] = '\0';
+		Ternary = 0;
+		for (K = 0; K < P4Tbl->NumKeys; K++) {
+			Ternary |= (P4Tbl->Match[K] == P4M_TERNARY) ||
+				   (P4Tbl->Match[K] == P4M_LPM);
+			snprintf(Format + strlen(Format),
+				 sizeof(Format) - strlen(Format), "%s%u%c",
+				 K ? ":" : "", (unsigned)P4Tbl->KeyWidth[K],
+				 (P4Tbl->Match[K] == P4M_TERNARY) ? 't' :
+				 (P4Tbl->Match[K] == P4M_LPM) ? 'p' : 'c');
+			Tbl->KeySizeBits += P4Tbl->KeyWidth[K];
+		}
+
+		Tbl->Endian = XIL_SDNET_LITTLE_ENDIAN;
+		Tbl->Mode = Ternary ? XIL_SDNET_TABLE_MODE_TCAM :
+				      XIL_SDNET_TABLE_MODE_BCAM;
+		Tbl->ActionListSize = P4Tbl->NumActions;
+		Tbl->ActionListPtr = calloc(P4Tbl->NumActions + 1,
+					    sizeof(XilSdnetAction *));
+		if (Tbl->ActionListPtr == NULL) {
+			P4ProgramFree(&Prog);
+			return ConfigError(ErrBuf, ErrLen, "out of memory");
+		}
+		while ((1u << Tbl->ActionIdWidthBits) < P4Tbl->NumActions) {
+			Tbl->ActionIdWidthBits++;
+		}
+		MaxParamBits = 0;
+		for (K = 0; K < P4Tbl->NumActions; K++) {
+			P4Act = &Prog.Actions[P4Tbl->Actions[K]];
+			Act = calloc(1, sizeof(*Act));
+			if (Act != NULL) {
+				Act->ParamListPtr = calloc(P4Act->NumParams + 1,
+					sizeof(XilSdnetAttribute));
+			}
+			if ((Act == NULL) || (Act->ParamListPtr == NULL)) {
+				P4ProgramFree(&Prog);
+				return ConfigError(ErrBuf, ErrLen,
+						  "out of memory");
+			}
+			Act->NameStringPtr = ConfigStrdup(P4Act->Name);
+			Act->ParamListSize = P4Act->NumParams;
+			ParamBits = 0;
+			for (P = 0; P < P4Act->NumParams; P++) {
+				Act->ParamListPtr[P].NameStringPtr = "";
+				Act->ParamListPtr[P].Value =
+					P4Act->ParamWidth[P];
+				ParamBits += P4Act->ParamWidth[P];
+			}
+			if (ParamBits > MaxParamBits) {
+				MaxParamBits = ParamBits;
+			}
+			Tbl->ActionListPtr[K] = Act;
+		}
+
+		Tbl->CamConfig.BaseAddr = Count * SDNET_MODEL_CAM_WINDOW;
+		Tbl->CamConfig.FormatStringPtr = ConfigStrdup(Format);
+		Tbl->CamConfig.NumEntries = P4Tbl->MaxSize;
+		Tbl->CamConfig.ResponseSizeBits =
+			(uint16_t)(Tbl->ActionIdWidthBits + MaxParamBits);
+		Tbl->CamConfig.PrioritySizeBits =
+			XIL_SDNET_CAM_PRIORITY_SIZE_DEFAULT;
+		Tbl->CamConfig.Endian = XIL_SDNET_LITTLE_ENDIAN;
+		List[Count++] = Entry;
+	}
+
+	P4ProgramFree(&Prog);
+	ConfigPtr->Endian = XIL_SDNET_LITTLE_ENDIAN;
+	ConfigPtr->TableListSize = Count;
+	ConfigPtr->TableListPtr = List;
+	return 0;
+}
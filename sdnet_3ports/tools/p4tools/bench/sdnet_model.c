@@ -0,0 +1,1276 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file sdnet_model.c
+*
+* Software stand-in for the SDNet control-plane driver library and the
+* CAMs behind it. It implements the target, table, BCAM, TCAM and build
+* information calls the application makes, with the semantics documented
+* in sdnet_table.h and cam_top.h:
+*
+*	- exact tables (BCAM, DCAM, tiny BCAM) match the whole key; ternary
+*	  tables (TCAM, STCAM, tiny TCAM) match under the entry mask, and
+*	  the lowest priority value wins, the oldest entry among equals
+*	- inserting a key (and mask) already present fails with
+*	  XIL_SDNET_CAM_ERR_DUPLICATE_FOUND, and a ternary key with bits set
+*	  outside its mask with XIL_SDNET_CAM_ERR_MASKED_KEY_BIT_IS_SET
+*	- update and delete of a missing key fail with
+*	  XIL_SDNET_CAM_ERR_KEY_NOT_FOUND, insert into a full CAM with
+*	  XIL_SDNET_CAM_ERR_FULL
+*	- a table response is the action ID in the low ActionIdWidthBits
+*	  bits followed by the action parameters
+*
+* Key width comes from the CAM format string, so a BCAM or TCAM can also
+* be brought up on its own from a table's CamConfig. Exact lookups go
+* through a hash of the key; ternary lookups scan the entries in priority
+* order and stop at the first match.
+*
+* The CAM hardware is not modelled at register level. Each insert, update,
+* delete and reset is charged to the environment interface as the data
+* words (key, mask, response, priority), one command word and one status
+* read, in the layout of sdnet_model.h, so that a tracing or counting
+* interface sees a plausible access pattern and the cost of driver calls
+* relative to each other. Reads from the shadow (GetByKey, GetByResponse,
+* Lookup) cost nothing, as in the driver; GetByResponse walks the entries
+* in slot order, as the driver walks its list.
+*
+* The configuration comes from sdnet_config.c. Heap calls can be renamed
+* at compile time, as a53_standalone.mak does for the driver library.
+*
+*****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sdnet_model.h"
+
+#define MODEL_NONE		UINT32_MAX
+
+#define MODEL_CMD_INSERT	1
+#define MODEL_CMD_UPDATE	2
+#define MODEL_CMD_DELETE	3
+#define MODEL_CMD_RESET		4
+
+/*
+ * Per-slot bookkeeping. The key, mask and response bytes of the slot are in
+ * the CAM's Data pool, Stride bytes apart, so that an entry costs what the
+ * table needs rather than the widest key the model accepts
+ */
+typedef struct {
+	uint32_t Priority;
+	uint32_t Seq;		/* insertion order */
+	uint32_t Next;		/* hash chain, or free list */
+	uint32_t Used;
+} ModelEntry;
+
+struct XilSdnetCamCtx {
+	XilSdnetEnvIf EnvIf;
+	XilSdnetAddressType BaseAddr;
+	int Ternary;
+	uint32_t KeyBits;
+	uint32_t KeyBytes;
+	uint32_t RespBytes;
+	uint32_t Depth;
+	uint32_t Count;
+	uint32_t NextSeq;
+	uint32_t FreeHead;
+	ModelEntry *Entries;
+	uint32_t Stride;
+	uint8_t *Data;		/* key, ternary mask, response per slot */
+	uint8_t ExactMask[SDNET_MODEL_KEY_MAX];
+	uint32_t *Order;	/* ternary: used slots, best first */
+	uint32_t HashMask;
+	uint32_t *HashHead;
+};
+
+#define MODEL_KEY(Cam, Slot)	(&(Cam)->Data[(size_t)(Slot) *		\
+					      (Cam)->Stride])
+#define MODEL_MASK(Cam, Slot)	((Cam)->Ternary ?			\
+				 MODEL_KEY(Cam, Slot) + (Cam)->KeyBytes : \
+				 (Cam)->ExactMask)
+#define MODEL_RESP(Cam, Slot)	(MODEL_KEY(Cam, Slot) + (Cam)->Stride -	\
+				 (Cam)->RespBytes)
+
+struct XilSdnetTablePrivateCtx {
+	const char *NamePtr;
+	XilSdnetTableConfig *ConfigPtr;
+	struct XilSdnetCamCtx Cam;
+	uint32_t ParamBits;
+	XilSdnetTableCtx Handle;
+};
+
+struct XilSdnetTargetPrivateCtx {
+	uint32_t NumTables;
+	XilSdnetTablePrivateCtx *Tables;
+};
+
+/*
+ * Environment
+ */
+static XilSdnetReturnType ModelStubWrite(XilSdnetEnvIf *EnvIfPtr,
+					 XilSdnetAddressType Address,
+					 uint32_t WriteValue)
+{
+	(void)EnvIfPtr; (void)Address; (void)WriteValue;
+	return XIL_SDNET_SUCCESS;
+}
+
+static XilSdnetReturnType ModelStubRead(XilSdnetEnvIf *EnvIfPtr,
+					XilSdnetAddressType Address,
+					uint32_t *ReadValuePtr)
+{
+	(void)EnvIfPtr; (void)Address;
+	*ReadValuePtr = 0;
+	return XIL_SDNET_SUCCESS;
+}
+
+static XilSdnetReturnType ModelStubLog(XilSdnetEnvIf *EnvIfPtr,
+				       const char *MessagePtr)
+{
+	(void)EnvIfPtr; (void)MessagePtr;
+	return XIL_SDNET_SUCCESS;
+}
+
+XilSdnetReturnType XilSdnetStubEnvIf(XilSdnetEnvIf *EnvIfPtr)
+{
+	if (EnvIfPtr == NULL) {
+		return XIL_SDNET_GENERAL_ERR_NULL_PARAM;
+	}
+	EnvIfPtr->UserCtx = NULL;
+	EnvIfPtr->WordWrite32 = ModelStubWrite;
+	EnvIfPtr->WordRead32 = ModelStubRead;
+	EnvIfPtr->LogError = ModelStubLog;
+	EnvIfPtr->LogInfo = ModelStubLog;
+	return XIL_SDNET_SUCCESS;
+}
+
+const char *XilSdnetReturnTypeToString(XilSdnetReturnType Value)
+{
+	static char Unknown[40];
+
+	switch (Value) {
+	case XIL_SDNET_SUCCESS:
+		return "XIL_SDNET_SUCCESS";
+	case XIL_SDNET_GENERAL_ERR_NULL_PARAM:
+		return "XIL_SDNET_GENERAL_ERR_NULL_PARAM";
+	case XIL_SDNET_GENERAL_ERR_INVALID_CONTEXT:
+		return "XIL_SDNET_GENERAL_ERR_INVALID_CONTEXT";
+	case XIL_SDNET_CAM_ERR_FULL:
+		return "XIL_SDNET_CAM_ERR_FULL";
+	case XIL_SDNET_CAM_ERR_DUPLICATE_FOUND:
+		return "XIL_SDNET_CAM_ERR_DUPLICATE_FOUND";
+	case XIL_SDNET_CAM_ERR_KEY_NOT_FOUND:
+		return "XIL_SDNET_CAM_ERR_KEY_NOT_FOUND";
+	case XIL_SDNET_CAM_ERR_MASKED_KEY_BIT_IS_SET:
+		return "XIL_SDNET_CAM_ERR_MASKED_KEY_BIT_IS_SET";
+	case XIL_SDNET_CAM_ERR_FORMAT_SYNTAX:
+		return "XIL_SDNET_CAM_ERR_FORMAT_SYNTAX";
+	case XIL_SDNET_CAM_ERR_ENVIRONMENT:
+		return "XIL_SDNET_CAM_ERR_ENVIRONMENT";
+	case XIL_SDNET_TABLE_ERR_INVALID_ACTION_ID:
+		return "XIL_SDNET_TABLE_ERR_INVALID_ACTION_ID";
+	case XIL_SDNET_TABLE_ERR_ACTION_NOT_FOUND:
+		return "XIL_SDNET_TABLE_ERR_ACTION_NOT_FOUND";
+	case XIL_SDNET_TABLE_ERR_INVALID_TABLE_MODE:
+		return "XIL_SDNET_TABLE_ERR_INVALID_TABLE_MODE";
+	default:
+		snprintf(Unknown, sizeof(Unknown), "XilSdnetReturnType %d",
+			 (int)Value);
+		return Unknown;
+	}
+}
+
+/*
+ * CAM
+ */
+XilSdnetReturnType XilSdnetCamGetKeyLengthInBits(char *FormatStringPtr,
+						 uint32_t *KeyLengthPtr)
+{
+	const char *P = FormatStringPtr;
+	uint32_t Bits = 0;
+	char *End;
+	unsigned long Len;
+
+	if ((P == NULL) || (KeyLengthPtr == NULL)) {
+		return XIL_SDNET_GENERAL_ERR_NULL_PARAM;
+	}
+	while (*P != '\0') {
+		Len = strtoul(P, &End, 10);
+		if ((End == P) || (Len == 0)) {
+			return XIL_SDNET_CAM_ERR_FORMAT_SYNTAX;
+		}
+		P = End;
+		if ((*P != '\0') && (strchr("bcuptr", *P) != NULL)) {
+			P++;
+		}
+		if (*P == ':') {
+			P++;
+		} else if (*P != '\0') {
+			return XIL_SDNET_CAM_ERR_FORMAT_SYNTAX;
+		}
+		Bits += (uint32_t)Len;
+	}
+	*KeyLengthPtr = Bits;
+	return (Bits != 0) ? XIL_SDNET_SUCCESS :
+			     XIL_SDNET_CAM_ERR_FORMAT_SYNTAX;
+}
+
+static void ModelCamFree(struct XilSdnetCamCtx *Cam)
+{
+	free(Cam->Entries);
+	free(Cam->Data);
+	free(Cam->Order);
+	free(Cam->HashHead);
+	memset(Cam, 0, sizeof(*Cam));
+}
+
+static void ModelCamClear(struct XilSdnetCamCtx *Cam)
+{
+	uint32_t I;
+
+	for (I = 0; I < Cam->Depth; I++) {
+		Cam->Entries[I].Used = 0;
+		Cam->Entries[I].Next = I + 1;
+	}
+	if (Cam->Depth != 0) {
+		Cam->Entries[Cam->Depth - 1].Next = MODEL_NONE;
+	}
+	for (I = 0; I <= Cam->HashMask; I++) {
+		Cam->HashHead[I] = MODEL_NONE;
+	}
+	Cam->FreeHead = 0;
+	Cam->Count = 0;
+	Cam->NextSeq = 0;
+}
+
+static XilSdnetReturnType ModelCamInit(struct XilSdnetCamCtx *Cam,
+				       XilSdnetEnvIf *EnvIfPtr,
+				       XilSdnetCamConfig *ConfigPtr,
+				       int Ternary)
+{
+	XilSdnetReturnType Result;
+	uint32_t HashSize = 1;
+
+	if ((Cam == NULL) || (EnvIfPtr == NULL) || (ConfigPtr == NULL)) {
+		return XIL_SDNET_GENERAL_ERR_NULL_PARAM;
+	}
+	memset(Cam, 0, sizeof(*Cam));
+	Result = XilSdnetCamGetKeyLengthInBits(ConfigPtr->FormatStringPtr,
+					       &Cam->KeyBits);
+	if (Result != XIL_SDNET_SUCCESS) {
+		return Result;
+	}
+	Cam->KeyBytes = (Cam->KeyBits + 7) / 8;
+	Cam->RespBytes = (ConfigPtr->ResponseSizeBits + 7) / 8u;
+	if ((Cam->KeyBytes > SDNET_MODEL_KEY_MAX) ||
+	    (Cam->RespBytes > SDNET_MODEL_RESP_MAX)) {
+		return XIL_SDNET_CAM_ERR_MAX_KEY_LEN_EXCEED;
+	}
+	if (ConfigPtr->NumEntries == 0) {
+		return XIL_SDNET_CAM_ERR_INVALID_NUM_ENTRIES;
+	}
+
+	while (HashSize < 2 * ConfigPtr->NumEntries) {
+		HashSize <<= 1;
+	}
+	Cam->EnvIf = *EnvIfPtr;
+	Cam->BaseAddr = ConfigPtr->BaseAddr;
+	Cam->Ternary = Ternary;
+	Cam->Depth = ConfigPtr->NumEntries;
+	Cam->HashMask = HashSize - 1;
+	Cam->Stride = Cam->KeyBytes * (Ternary ? 2 : 1) + Cam->RespBytes;
+	memset(Cam->ExactMask, 0xFF, Cam->KeyBytes);
+	Cam->ExactMask[Cam->KeyBytes - 1] =
+		(uint8_t)(0xFF >> ((8 - Cam->KeyBits % 8) % 8));
+	Cam->Entries = calloc(Cam->Depth, sizeof(ModelEntry));
+	Cam->Data = calloc(Cam->Depth, Cam->Stride);
+	if (Ternary) {
+		Cam->Order = calloc(Cam->Depth, sizeof(uint32_t));
+	}
+	Cam->HashHead = calloc(HashSize, sizeof(uint32_t));
+	if ((Cam->Entries == NULL) || (Cam->Data == NULL) ||
+	    (Ternary && (Cam->Order == NULL)) || (Cam->HashHead == NULL)) {
+		ModelCamFree(Cam);
+		return XIL_SDNET_CAM_ERR_MALLOC_FAILED;
+	}
+	ModelCamClear(Cam);
+
+	return XIL_SDNET_SUCCESS;
+}
+
+/*
+ * Key bytes with the padding above KeyBits cleared, and for a ternary CAM
+ * the bits outside the mask checked
+ */
+static XilSdnetReturnType ModelCamKey(const struct XilSdnetCamCtx *Cam,
+				      const uint8_t *KeyPtr,
+				      const uint8_t *MaskPtr, uint8_t *Key,
+				      uint8_t *Mask)
+{
+	uint8_t Top = (uint8_t)(0xFF >> ((8 - Cam->KeyBits % 8) % 8));
+	uint32_t I;
+
+	if (KeyPtr == NULL) {
+		return XIL_SDNET_GENERAL_ERR_NULL_PARAM;
+	}
+	memcpy(Key, KeyPtr, Cam->KeyBytes);
+	Key[Cam->KeyBytes - 1] &= Top;
+	if (!Cam->Ternary) {
+		memset(Mask, 0xFF, Cam->KeyBytes);
+		Mask[Cam->KeyBytes - 1] = Top;
+		return XIL_SDNET_SUCCESS;
+	}
+
+	if (MaskPtr == NULL) {
+		return XIL_SDNET_GENERAL_ERR_NULL_PARAM;
+	}
+	memcpy(Mask, MaskPtr, Cam->KeyBytes);
+	Mask[Cam->KeyBytes - 1] &= Top;
+	for (I = 0; I < Cam->KeyBytes; I++) {
+		if (Key[I] & ~Mask[I]) {
+			return XIL_SDNET_CAM_ERR_MASKED_KEY_BIT_IS_SET;
+		}
+	}
+	return XIL_SDNET_SUCCESS;
+}
+
+static uint32_t ModelCamHash(const struct XilSdnetCamCtx *Cam,
+			     const uint8_t *Key, const uint8_t *Mask)
+{
+	uint32_t Hash = 2166136261u;
+	uint32_t I;
+
+	for (I = 0; I < Cam->KeyBytes; I++) {
+		Hash = (Hash ^ Key[I]) * 16777619u;
+		Hash = (Hash ^ Mask[I]) * 16777619u;
+	}
+	return Hash & Cam->HashMask;
+}
+
+static uint32_t ModelCamFind(const struct XilSdnetCamCtx *Cam,
+			     const uint8_t *Key, const uint8_t *Mask)
+{
+	uint32_t Slot = Cam->HashHead[ModelCamHash(Cam, Key, Mask)];
+
+	while (Slot != MODEL_NONE) {
+		if ((memcmp(MODEL_KEY(Cam, Slot), Key, Cam->KeyBytes) == 0) &&
+		    (memcmp(MODEL_MASK(Cam, Slot), Mask,
+			    Cam->KeyBytes) == 0)) {
+			return Slot;
+		}
+		Slot = Cam->Entries[Slot].Next;
+	}
+	return MODEL_NONE;
+}
+
+/*
+ * Register traffic of one command: data words, the command, a status read
+ */
+static XilSdnetReturnType ModelCamWords(struct XilSdnetCamCtx *Cam,
+					uint32_t Reg, const uint8_t *BytePtr,
+					uint32_t Bytes)
+{
+	uint32_t Word;
+	uint32_t I;
+
+	for (I = 0; I < Bytes; I += 4) {
+		Word = 0;
+		memcpy(&Word, BytePtr + I, (Bytes - I < 4) ? Bytes - I : 4);
+		if (Cam->EnvIf.WordWrite32(&Cam->EnvIf,
+					   Cam->BaseAddr + Reg + I, Word) !=
+		    XIL_SDNET_SUCCESS) {
+			return XIL_SDNET_CAM_ERR_ENVIRONMENT;
+		}
+	}
+	return XIL_SDNET_SUCCESS;
+}
+
+static XilSdnetReturnType ModelCamCommand(struct XilSdnetCamCtx *Cam,
+					  uint32_t Command,
+					  const uint8_t *Key,
+					  const uint8_t *Mask,
+					  const uint8_t *Resp,
+					  uint32_t Priority)
+{
+	XilSdnetReturnType Result = XIL_SDNET_SUCCESS;
+	uint32_t Status;
+
+	if (Key != NULL) {
+		Result = ModelCamWords(Cam, SDNET_MODEL_KEY_REG, Key,
+				       Cam->KeyBytes);
+		if ((Result == XIL_SDNET_SUCCESS) && Cam->Ternary) {
+			Result = ModelCamWords(Cam, SDNET_MODEL_MASK_REG,
+					       Mask, Cam->KeyBytes);
+		}
+		if ((Result == XIL_SDNET_SUCCESS) &&
+		    (Command != MODEL_CMD_DELETE)) {
+			Result = ModelCamWords(Cam, SDNET_MODEL_RESP_REG,
+					       Resp, Cam->RespBytes);
+		}
+		if ((Result == XIL_SDNET_SUCCESS) && Cam->Ternary &&
+		    (Command == MODEL_CMD_INSERT)) {
+			Result = ModelCamWords(Cam, SDNET_MODEL_PRIO_REG,
+					       (const uint8_t *)&Priority, 4);
+		}
+	}
+	if ((Result != XIL_SDNET_SUCCESS) ||
+	    (Cam->EnvIf.WordWrite32(&Cam->EnvIf,
+				    Cam->BaseAddr + SDNET_MODEL_CMD_REG,
+				    Command) != XIL_SDNET_SUCCESS) ||
+	    (Cam->EnvIf.WordRead32(&Cam->EnvIf,
+				   Cam->BaseAddr + SDNET_MODEL_STATUS_REG,
+				   &Status) != XIL_SDNET_SUCCESS)) {
+		return XIL_SDNET_CAM_ERR_ENVIRONMENT;
+	}
+	return XIL_SDNET_SUCCESS;
+}
+
+static int ModelCamBefore(const ModelEntry *APtr, const ModelEntry *BPtr)
+{
+	return (APtr->Priority < BPtr->Priority) ||
+	       ((APtr->Priority == BPtr->Priority) && (APtr->Seq < BPtr->Seq));
+}
+
+static XilSdnetReturnType ModelCamInsert(struct XilSdnetCamCtx *Cam,
+					 const uint8_t *KeyPtr,
+					 const uint8_t *MaskPtr,
+					 uint32_t Priority,
+					 const uint8_t *RespPtr)
+{
+	uint8_t Key[SDNET_MODEL_KEY_MAX];
+	uint8_t Mask[SDNET_MODEL_KEY_MAX];
+	XilSdnetReturnType Result;
+	ModelEntry *EntryPtr;
+	uint32_t Hash;
+	uint32_t Slot;
+	uint32_t Pos;
+
+	if ((Cam == NULL) || (Cam->Entries == NULL)) {
+		return XIL_SDNET_GENERAL_ERR_INVALID_CONTEXT;
+	}
+	if (RespPtr == NULL) {
+		return XIL_SDNET_GENERAL_ERR_NULL_PARAM;
+	}
+	Slot = Cam->FreeHead;
+	if (Slot == MODEL_NONE) {
+		return XIL_SDNET_CAM_ERR_FULL;
+	}
+	Result = ModelCamKey(Cam, KeyPtr, MaskPtr, Key, Mask);
+	if (Result != XIL_SDNET_SUCCESS) {
+		return Result;
+	}
+	if (ModelCamFind(Cam, Key, Mask) != MODEL_NONE) {
+		return XIL_SDNET_CAM_ERR_DUPLICATE_FOUND;
+	}
+	Priority = Cam->Ternary ? Priority : 0;
+	Result = ModelCamCommand(Cam, MODEL_CMD_INSERT, Key, Mask, RespPtr,
+				 Priority);
+	if (Result != XIL_SDNET_SUCCESS) {
+		return Result;
+	}
+
+	EntryPtr = &Cam->Entries[Slot];
+	memcpy(MODEL_KEY(Cam, Slot), Key, Cam->KeyBytes);
+	if (Cam->Ternary) {
+		memcpy(MODEL_MASK(Cam, Slot), Mask, Cam->KeyBytes);
+	}
+	memcpy(MODEL_RESP(Cam, Slot), RespPtr, Cam->RespBytes);
+	EntryPtr->Priority = Priority;
+	EntryPtr->Seq = Cam->NextSeq++;
+	Cam->FreeHead = EntryPtr->Next;
+	Hash = ModelCamHash(Cam, Key, Mask);
+	EntryPtr->Next = Cam->HashHead[Hash];
+	Cam->HashHead[Hash] = Slot;
+	EntryPtr->Used = 1;
+
+	if (Cam->Ternary) {
+		Pos = Cam->Count;
+		while ((Pos > 0) &&
+		       ModelCamBefore(EntryPtr,
+				      &Cam->Entries[Cam->Order[Pos - 1]])) {
+			Cam->Order[Pos] = Cam->Order[Pos - 1];
+			Pos--;
+		}
+		Cam->Order[Pos] = Slot;
+	}
+	Cam->Count++;
+
+	return XIL_SDNET_SUCCESS;
+}
+
+static XilSdnetReturnType ModelCamFindKey(struct XilSdnetCamCtx *Cam,
+					  const uint8_t *KeyPtr,
+					  const uint8_t *MaskPtr,
+					  uint32_t *SlotPtr)
+{
+	uint8_t Key[SDNET_MODEL_KEY_MAX];
+	uint8_t Mask[SDNET_MODEL_KEY_MAX];
+	XilSdnetReturnType Result;
+
+	if ((Cam == NULL) || (Cam->Entries == NULL)) {
+		return XIL_SDNET_GENERAL_ERR_INVALID_CONTEXT;
+	}
+	Result = ModelCamKey(Cam, KeyPtr, MaskPtr, Key, Mask);
+	if (Result != XIL_SDNET_SUCCESS) {
+		return Result;
+	}
+	*SlotPtr = ModelCamFind(Cam, Key, Mask);
+	return (*SlotPtr == MODEL_NONE) ? XIL_SDNET_CAM_ERR_KEY_NOT_FOUND :
+					  XIL_SDNET_SUCCESS;
+}
+
+static XilSdnetReturnType ModelCamUpdate(struct XilSdnetCamCtx *Cam,
+					 const uint8_t *KeyPtr,
+					 const uint8_t *MaskPtr,
+					 const uint8_t *RespPtr)
+{
+	XilSdnetReturnType Result;
+	uint32_t Slot;
+
+	if (RespPtr == NULL) {
+		return XIL_SDNET_GENERAL_ERR_NULL_PARAM;
+	}
+	Result = ModelCamFindKey(Cam, KeyPtr, MaskPtr, &Slot);
+	if (Result != XIL_SDNET_SUCCESS) {
+		return Result;
+	}
+	Result = ModelCamCommand(Cam, MODEL_CMD_UPDATE, MODEL_KEY(Cam, Slot),
+				 MODEL_MASK(Cam, Slot), RespPtr,
+				 Cam->Entries[Slot].Priority);
+	if (Result == XIL_SDNET_SUCCESS) {
+		memcpy(MODEL_RESP(Cam, Slot), RespPtr, Cam->RespBytes);
+	}
+	return Result;
+}
+
+static XilSdnetReturnType ModelCamDelete(struct XilSdnetCamCtx *Cam,
+					 const uint8_t *KeyPtr,
+					 const uint8_t *MaskPtr)
+{
+	XilSdnetReturnType Result;
+	ModelEntry *EntryPtr;
+	uint32_t *LinkPtr;
+	uint32_t Slot;
+	uint32_t Pos;
+
+	Result = ModelCamFindKey(Cam, KeyPtr, MaskPtr, &Slot);
+	if (Result != XIL_SDNET_SUCCESS) {
+		return Result;
+	}
+	EntryPtr = &Cam->Entries[Slot];
+	Result = ModelCamCommand(Cam, MODEL_CMD_DELETE, MODEL_KEY(Cam, Slot),
+				 MODEL_MASK(Cam, Slot), NULL, 0);
+	if (Result != XIL_SDNET_SUCCESS) {
+		return Result;
+	}
+
+	LinkPtr = &Cam->HashHead[ModelCamHash(Cam, MODEL_KEY(Cam, Slot),
+					      MODEL_MASK(Cam, Slot))];
+	while (*LinkPtr != Slot) {
+		LinkPtr = &Cam->Entries[*LinkPtr].Next;
+	}
+	*LinkPtr = EntryPtr->Next;
+	EntryPtr->Used = 0;
+	EntryPtr->Next = Cam->FreeHead;
+	Cam->FreeHead = Slot;
+
+	if (Cam->Ternary) {
+		for (Pos = 0; Cam->Order[Pos] != Slot; Pos++) {
+		}
+		memmove(&Cam->Order[Pos], &Cam->Order[Pos + 1],
+			(Cam->Count - Pos - 1) * sizeof(uint32_t));
+	}
+	Cam->Count--;
+
+	return XIL_SDNET_SUCCESS;
+}
+
+static XilSdnetReturnType ModelCamReset(struct XilSdnetCamCtx *Cam)
+{
+	XilSdnetReturnType Result;
+
+	if ((Cam == NULL) || (Cam->Entries == NULL)) {
+		return XIL_SDNET_GENERAL_ERR_INVALID_CONTEXT;
+	}
+	Result = ModelCamCommand(Cam, MODEL_CMD_RESET, NULL, NULL, NULL, 0);
+	if (Result == XIL_SDNET_SUCCESS) {
+		ModelCamClear(Cam);
+	}
+	return Result;
+}
+
+/*
+ * What the data path would return for a key: the exact entry, or the
+ * first ternary entry in priority order that matches under its mask
+ */
+static uint32_t ModelCamLookup(const struct XilSdnetCamCtx *Cam,
+			       const uint8_t *KeyPtr)
+{
+	uint8_t Key[SDNET_MODEL_KEY_MAX];
+	uint8_t Mask[SDNET_MODEL_KEY_MAX];
+	const uint8_t *SlotKey;
+	const uint8_t *SlotMask;
+	uint32_t Pos;
+	uint32_t I;
+
+	if (!Cam->Ternary) {
+		if (ModelCamKey(Cam, KeyPtr, NULL, Key, Mask) !=
+		    XIL_SDNET_SUCCESS) {
+			return MODEL_NONE;
+		}
+		return ModelCamFind(Cam, Key, Mask);
+	}
+
+	for (Pos = 0; Pos < Cam->Count; Pos++) {
+		SlotKey = MODEL_KEY(Cam, Cam->Order[Pos]);
+		SlotMask = MODEL_MASK(Cam, Cam->Order[Pos]);
+		for (I = 0; I < Cam->KeyBytes; I++) {
+			if ((KeyPtr[I] & SlotMask[I]) != SlotKey[I]) {
+				break;
+			}
+		}
+		if (I == Cam->KeyBytes) {
+			return Cam->Order[Pos];
+		}
+	}
+	return MODEL_NONE;
+}
+
+/*
+ * Linear, like the driver's
+ */
+static XilSdnetReturnType ModelCamGetByResponse(struct XilSdnetCamCtx *Cam,
+						const uint8_t *ResponsePtr,
+						const uint8_t *ResponseMaskPtr,
+						uint32_t *PositionPtr,
+						uint8_t *KeyPtr)
+{
+	const uint8_t *Resp;
+	uint32_t Slot;
+	uint32_t I;
+
+	if ((ResponsePtr == NULL) || (ResponseMaskPtr == NULL) ||
+	    (PositionPtr == NULL) || (KeyPtr == NULL)) {
+		return XIL_SDNET_GENERAL_ERR_NULL_PARAM;
+	}
+	for (Slot = *PositionPtr; Slot < Cam->Depth; Slot++) {
+		if (!Cam->Entries[Slot].Used) {
+			continue;
+		}
+		Resp = MODEL_RESP(Cam, Slot);
+		for (I = 0; I < Cam->RespBytes; I++) {
+			if ((Resp[I] ^ ResponsePtr[I]) &
+			    ResponseMaskPtr[I]) {
+				break;
+			}
+		}
+		if (I == Cam->RespBytes) {
+			memcpy(KeyPtr, MODEL_KEY(Cam, Slot), Cam->KeyBytes);
+			*PositionPtr = Slot + 1;
+			return XIL_SDNET_SUCCESS;
+		}
+	}
+	*PositionPtr = Cam->Depth;
+	return XIL_SDNET_CAM_ERR_KEY_NOT_FOUND;
+}
+
+/*
+ * BCAM and TCAM drivers
+ */
+XilSdnetReturnType XilSdnetBcamInit(XilSdnetBcamCtx *CtxPtr,
+				    XilSdnetEnvIf *EnvIfPtr,
+				    XilSdnetCamConfig *ConfigPtr)
+{
+	XilSdnetReturnType Result;
+
+	if (CtxPtr == NULL) {
+		return XIL_SDNET_GENERAL_ERR_NULL_PARAM;
+	}
+	CtxPtr->PrivateCtxPtr = malloc(sizeof(struct XilSdnetCamCtx));
+	if (CtxPtr->PrivateCtxPtr == NULL) {
+		return XIL_SDNET_CAM_ERR_MALLOC_FAILED;
+	}
+	Result = ModelCamInit(CtxPtr->PrivateCtxPtr, EnvIfPtr, ConfigPtr, 0);
+	if (Result != XIL_SDNET_SUCCESS) {
+		free(CtxPtr->PrivateCtxPtr);
+		CtxPtr->PrivateCtxPtr = NULL;
+	}
+	return Result;
+}
+
+XilSdnetReturnType XilSdnetBcamReset(XilSdnetBcamCtx *CtxPtr)
+{
+	return ModelCamReset(CtxPtr->PrivateCtxPtr);
+}
+
+XilSdnetReturnType XilSdnetBcamInsert(XilSdnetBcamCtx *CtxPtr,
+				      uint8_t *KeyPtr, uint8_t *ResponsePtr)
+{
+	return ModelCamInsert(CtxPtr->PrivateCtxPtr, KeyPtr, NULL, 0,
+			      ResponsePtr);
+}
+
+XilSdnetReturnType XilSdnetBcamUpdate(XilSdnetBcamCtx *CtxPtr,
+				      uint8_t *KeyPtr, uint8_t *ResponsePtr)
+{
+	return ModelCamUpdate(CtxPtr->PrivateCtxPtr, KeyPtr, NULL,
+			      ResponsePtr);
+}
+
+XilSdnetReturnType XilSdnetBcamDelete(XilSdnetBcamCtx *CtxPtr,
+				      uint8_t *KeyPtr)
+{
+	return ModelCamDelete(CtxPtr->PrivateCtxPtr, KeyPtr, NULL);
+}
+
+XilSdnetReturnType XilSdnetBcamGetByKey(XilSdnetBcamCtx *CtxPtr,
+					uint8_t *KeyPtr, uint8_t *ResponsePtr)
+{
+	struct XilSdnetCamCtx *Cam = CtxPtr->PrivateCtxPtr;
+	XilSdnetReturnType Result;
+	uint32_t Slot;
+
+	if (ResponsePtr == NULL) {
+		return XIL_SDNET_GENERAL_ERR_NULL_PARAM;
+	}
+	Result = ModelCamFindKey(Cam, KeyPtr, NULL, &Slot);
+	if (Result == XIL_SDNET_SUCCESS) {
+		memcpy(ResponsePtr, MODEL_RESP(Cam, Slot), Cam->RespBytes);
+	}
+	return Result;
+}
+
+XilSdnetReturnType XilSdnetBcamGetByResponse(XilSdnetBcamCtx *CtxPtr,
+					     uint8_t *ResponsePtr,
+					     uint8_t *ResponseMaskPtr,
+					     uint32_t *PositionPtr,
+					     uint8_t *KeyPtr)
+{
+	return ModelCamGetByResponse(CtxPtr->PrivateCtxPtr, ResponsePtr,
+				     ResponseMaskPtr, PositionPtr, KeyPtr);
+}
+
+XilSdnetReturnType XilSdnetBcamExit(XilSdnetBcamCtx *CtxPtr)
+{
+	if ((CtxPtr == NULL) || (CtxPtr->PrivateCtxPtr == NULL)) {
+		return XIL_SDNET_GENERAL_ERR_INVALID_CONTEXT;
+	}
+	ModelCamFree(CtxPtr->PrivateCtxPtr);
+	free(CtxPtr->PrivateCtxPtr);
+	CtxPtr->PrivateCtxPtr = NULL;
+	return XIL_SDNET_SUCCESS;
+}
+
+XilSdnetReturnType XilSdnetTcamInit(XilSdnetTcamCtx *CtxPtr,
+				    XilSdnetEnvIf *EnvIfPtr,
+				    XilSdnetCamConfig *ConfigPtr)
+{
+	XilSdnetReturnType Result;
+
+	if (CtxPtr == NULL) {
+		return XIL_SDNET_GENERAL_ERR_NULL_PARAM;
+	}
+	CtxPtr->PrivateCtxPtr = malloc(sizeof(struct XilSdnetCamCtx));
+	if (CtxPtr->PrivateCtxPtr == NULL) {
+		return XIL_SDNET_CAM_ERR_MALLOC_FAILED;
+	}
+	Result = ModelCamInit(CtxPtr->PrivateCtxPtr, EnvIfPtr, ConfigPtr, 1);
+	if (Result != XIL_SDNET_SUCCESS) {
+		free(CtxPtr->PrivateCtxPtr);
+		CtxPtr->PrivateCtxPtr = NULL;
+	}
+	return Result;
+}
+
+XilSdnetReturnType XilSdnetTcamReset(XilSdnetTcamCtx *CtxPtr)
+{
+	return ModelCamReset(CtxPtr->PrivateCtxPtr);
+}
+
+XilSdnetReturnType XilSdnetTcamInsert(XilSdnetTcamCtx *CtxPtr,
+				      uint8_t *KeyPtr, uint8_t *MaskPtr,
+				      uint32_t Priority, uint8_t *ResponsePtr)
+{
+	return ModelCamInsert(CtxPtr->PrivateCtxPtr, KeyPtr, MaskPtr, Priority,
+			      ResponsePtr);
+}
+
+XilSdnetReturnType XilSdnetTcamUpdate(XilSdnetTcamCtx *CtxPtr,
+				      uint8_t *KeyPtr, uint8_t *MaskPtr,
+				      uint8_t *ResponsePtr)
+{
+	return ModelCamUpdate(CtxPtr->PrivateCtxPtr, KeyPtr, MaskPtr,
+			      ResponsePtr);
+}
+
+XilSdnetReturnType XilSdnetTcamDelete(XilSdnetTcamCtx *CtxPtr,
+				      uint8_t *KeyPtr, uint8_t *MaskPtr)
+{
+	return ModelCamDelete(CtxPtr->PrivateCtxPtr, KeyPtr, MaskPtr);
+}
+
+XilSdnetReturnType XilSdnetTcamLookup(XilSdnetTcamCtx *CtxPtr,
+				      uint8_t *KeyPtr, uint8_t *ResponsePtr)
+{
+	struct XilSdnetCamCtx *Cam = CtxPtr->PrivateCtxPtr;
+	uint32_t Slot;
+
+	if ((KeyPtr == NULL) || (ResponsePtr == NULL)) {
+		return XIL_SDNET_GENERAL_ERR_NULL_PARAM;
+	}
+	Slot = ModelCamLookup(Cam, KeyPtr);
+	if (Slot == MODEL_NONE) {
+		return XIL_SDNET_CAM_ERR_KEY_NOT_FOUND;
+	}
+	memcpy(ResponsePtr, MODEL_RESP(Cam, Slot), Cam->RespBytes);
+	return XIL_SDNET_SUCCESS;
+}
+
+XilSdnetReturnType XilSdnetTcamExit(XilSdnetTcamCtx *CtxPtr)
+{
+	return XilSdnetBcamExit((XilSdnetBcamCtx *)CtxPtr);
+}
+
+/*
+ * Table driver. The response is the action ID in the low ActionIdWidthBits
+ * bits, then the action parameters.
+ */
+static XilSdnetTablePrivateCtx *ModelTable(XilSdnetTableCtx *CtxPtr)
+{
+	return (CtxPtr == NULL) ? NULL : CtxPtr->PrivateCtxPtr;
+}
+
+static XilSdnetReturnType ModelTablePack(const XilSdnetTablePrivateCtx *Tbl,
+					 uint32_t ActionId,
+					 const uint8_t *ParamsPtr,
+					 uint8_t *RespPtr)
+{
+	uint32_t IdBits = Tbl->ConfigPtr->ActionIdWidthBits;
+	uint32_t Bit;
+	uint32_t Out;
+
+	if (ActionId >= Tbl->ConfigPtr->ActionListSize) {
+		return XIL_SDNET_TABLE_ERR_INVALID_ACTION_ID;
+	}
+	if ((ParamsPtr == NULL) && (Tbl->ParamBits != 0)) {
+		return XIL_SDNET_GENERAL_ERR_NULL_PARAM;
+	}
+	memset(RespPtr, 0, SDNET_MODEL_RESP_MAX);
+	for (Bit = 0; Bit < IdBits; Bit++) {
+		if (ActionId & (1u << Bit)) {
+			RespPtr[Bit / 8] |= (uint8_t)(1 << (Bit % 8));
+		}
+	}
+	for (Bit = 0; Bit < Tbl->ParamBits; Bit++) {
+		Out = IdBits + Bit;
+		if (ParamsPtr[Bit / 8] & (1 << (Bit % 8))) {
+			RespPtr[Out / 8] |= (uint8_t)(1 << (Out % 8));
+		}
+	}
+	return XIL_SDNET_SUCCESS;
+}
+
+static void ModelTableUnpack(const XilSdnetTablePrivateCtx *Tbl,
+			     const uint8_t *RespPtr, uint32_t *ActionIdPtr,
+			     uint8_t *ParamsPtr)
+{
+	uint32_t IdBits = Tbl->ConfigPtr->ActionIdWidthBits;
+	uint32_t Bit;
+	uint32_t In;
+
+	if (ActionIdPtr != NULL) {
+		*ActionIdPtr = 0;
+		for (Bit = 0; Bit < IdBits; Bit++) {
+			if (RespPtr[Bit / 8] & (1 << (Bit % 8))) {
+				*ActionIdPtr |= 1u << Bit;
+			}
+		}
+	}
+	if (ParamsPtr != NULL) {
+		memset(ParamsPtr, 0, (Tbl->ParamBits + 7) / 8);
+		for (Bit = 0; Bit < Tbl->ParamBits; Bit++) {
+			In = IdBits + Bit;
+			if (RespPtr[In / 8] & (1 << (In % 8))) {
+				ParamsPtr[Bit / 8] |= (uint8_t)(1 << (Bit % 8));
+			}
+		}
+	}
+}
+
+XilSdnetReturnType XilSdnetTableGetMode(XilSdnetTableCtx *CtxPtr,
+					XilSdnetTableMode *ModePtr)
+{
+	XilSdnetTablePrivateCtx *Tbl = ModelTable(CtxPtr);
+
+	if ((Tbl == NULL) || (ModePtr == NULL)) {
+		return XIL_SDNET_GENERAL_ERR_NULL_PARAM;
+	}
+	*ModePtr = Tbl->ConfigPtr->Mode;
+	return XIL_SDNET_SUCCESS;
+}
+
+XilSdnetReturnType XilSdnetTableGetKeySizeBits(XilSdnetTableCtx *CtxPtr,
+					       uint32_t *KeySizeBitsPtr)
+{
+	XilSdnetTablePrivateCtx *Tbl = ModelTable(CtxPtr);
+
+	if ((Tbl == NULL) || (KeySizeBitsPtr == NULL)) {
+		return XIL_SDNET_GENERAL_ERR_NULL_PARAM;
+	}
+	*KeySizeBitsPtr = Tbl->ConfigPtr->KeySizeBits;
+	return XIL_SDNET_SUCCESS;
+}
+
+XilSdnetReturnType XilSdnetTableGetActionIdWidthBits(XilSdnetTableCtx *CtxPtr,
+						     uint32_t *WidthPtr)
+{
+	XilSdnetTablePrivateCtx *Tbl = ModelTable(CtxPtr);
+
+	if ((Tbl == NULL) || (WidthPtr == NULL)) {
+		return XIL_SDNET_GENERAL_ERR_NULL_PARAM;
+	}
+	*WidthPtr = Tbl->ConfigPtr->ActionIdWidthBits;
+	return XIL_SDNET_SUCCESS;
+}
+
+XilSdnetReturnType XilSdnetTableGetActionId(XilSdnetTableCtx *CtxPtr,
+					    char *ActionNamePtr,
+					    uint32_t *ActionIdPtr)
+{
+	XilSdnetTablePrivateCtx *Tbl = ModelTable(CtxPtr);
+	uint32_t I;
+
+	if ((Tbl == NULL) || (ActionNamePtr == NULL) || (ActionIdPtr == NULL)) {
+		return XIL_SDNET_GENERAL_ERR_NULL_PARAM;
+	}
+	for (I = 0; I < Tbl->ConfigPtr->ActionListSize; I++) {
+		if (strcmp(Tbl->ConfigPtr->ActionListPtr[I]->NameStringPtr,
+			   ActionNamePtr) == 0) {
+			*ActionIdPtr = I;
+			return XIL_SDNET_SUCCESS;
+		}
+	}
+	return XIL_SDNET_TABLE_ERR_ACTION_NOT_FOUND;
+}
+
+XilSdnetReturnType XilSdnetTableInsert(XilSdnetTableCtx *CtxPtr,
+				       uint8_t *KeyPtr, uint8_t *MaskPtr,
+				       uint32_t Priority, uint32_t ActionId,
+				       uint8_t *ActionParamsPtr)
+{
+	XilSdnetTablePrivateCtx *Tbl = ModelTable(CtxPtr);
+	uint8_t Resp[SDNET_MODEL_RESP_MAX];
+	XilSdnetReturnType Result;
+
+	if (Tbl == NULL) {
+		return XIL_SDNET_GENERAL_ERR_INVALID_CONTEXT;
+	}
+	Result = ModelTablePack(Tbl, ActionId, ActionParamsPtr, Resp);
+	if (Result != XIL_SDNET_SUCCESS) {
+		return Result;
+	}
+	return ModelCamInsert(&Tbl->Cam, KeyPtr, MaskPtr, Priority, Resp);
+}
+
+XilSdnetReturnType XilSdnetTableUpdate(XilSdnetTableCtx *CtxPtr,
+				       uint8_t *KeyPtr, uint8_t *MaskPtr,
+				       uint32_t ActionId,
+				       uint8_t *ActionParamsPtr)
+{
+	XilSdnetTablePrivateCtx *Tbl = ModelTable(CtxPtr);
+	uint8_t Resp[SDNET_MODEL_RESP_MAX];
+	XilSdnetReturnType Result;
+
+	if (Tbl == NULL) {
+		return XIL_SDNET_GENERAL_ERR_INVALID_CONTEXT;
+	}
+	Result = ModelTablePack(Tbl, ActionId, ActionParamsPtr, Resp);
+	if (Result != XIL_SDNET_SUCCESS) {
+		return Result;
+	}
+	return ModelCamUpdate(&Tbl->Cam, KeyPtr, MaskPtr, Resp);
+}
+
+XilSdnetReturnType XilSdnetTableDelete(XilSdnetTableCtx *CtxPtr,
+				       uint8_t *KeyPtr, uint8_t *MaskPtr)
+{
+	XilSdnetTablePrivateCtx *Tbl = ModelTable(CtxPtr);
+
+	if (Tbl == NULL) {
+		return XIL_SDNET_GENERAL_ERR_INVALID_CONTEXT;
+	}
+	return ModelCamDelete(&Tbl->Cam, KeyPtr, MaskPtr);
+}
+
+XilSdnetReturnType XilSdnetTableGetByKey(XilSdnetTableCtx *CtxPtr,
+					 uint8_t *KeyPtr, uint8_t *MaskPtr,
+					 uint32_t *PriorityPtr,
+					 uint32_t *ActionIdPtr,
+					 uint8_t *ActionParamsPtr)
+{
+	XilSdnetTablePrivateCtx *Tbl = ModelTable(CtxPtr);
+	XilSdnetReturnType Result;
+	uint32_t Slot;
+
+	if (Tbl == NULL) {
+		return XIL_SDNET_GENERAL_ERR_INVALID_CONTEXT;
+	}
+	Result = ModelCamFindKey(&Tbl->Cam, KeyPtr, MaskPtr, &Slot);
+	if (Result != XIL_SDNET_SUCCESS) {
+		return Result;
+	}
+	if (PriorityPtr != NULL) {
+		*PriorityPtr = Tbl->Cam.Entries[Slot].Priority;
+	}
+	ModelTableUnpack(Tbl, MODEL_RESP(&Tbl->Cam, Slot), ActionIdPtr,
+			 ActionParamsPtr);
+	return XIL_SDNET_SUCCESS;
+}
+
+/*
+ * The action ID must match; the parameters match under their mask
+ */
+XilSdnetReturnType XilSdnetTableGetByResponse(XilSdnetTableCtx *CtxPtr,
+					      uint32_t ActionId,
+					      uint8_t *ActionParamsPtr,
+					      uint8_t *ActionParamsMaskPtr,
+					      uint32_t *PositionPtr,
+					      uint8_t *KeyPtr,
+					      uint8_t *MaskPtr)
+{
+	XilSdnetTablePrivateCtx *Tbl = ModelTable(CtxPtr);
+	uint8_t Resp[SDNET_MODEL_RESP_MAX];
+	uint8_t RespMask[SDNET_MODEL_RESP_MAX];
+	XilSdnetReturnType Result;
+	uint32_t Position;
+	uint32_t Bit;
+
+	if (Tbl == NULL) {
+		return XIL_SDNET_GENERAL_ERR_INVALID_CONTEXT;
+	}
+	if (ActionParamsMaskPtr == NULL) {
+		return XIL_SDNET_GENERAL_ERR_NULL_PARAM;
+	}
+	Result = ModelTablePack(Tbl, ActionId, ActionParamsPtr, Resp);
+	if (Result != XIL_SDNET_SUCCESS) {
+		return Result;
+	}
+	(void)ModelTablePack(Tbl, 0, ActionParamsMaskPtr, RespMask);
+	for (Bit = 0; Bit < Tbl->ConfigPtr->ActionIdWidthBits; Bit++) {
+		RespMask[Bit / 8] |= (uint8_t)(1 << (Bit % 8));
+	}
+
+	Result = ModelCamGetByResponse(&Tbl->Cam, Resp, RespMask, PositionPtr,
+				       KeyPtr);
+	if ((Result == XIL_SDNET_SUCCESS) && Tbl->Cam.Ternary &&
+	    (MaskPtr != NULL)) {
+		Position = *PositionPtr - 1;
+		memcpy(MaskPtr, MODEL_MASK(&Tbl->Cam, Position),
+		       Tbl->Cam.KeyBytes);
+	}
+	return Result;
+}
+
+XilSdnetReturnType XilSdnetTableLookup(XilSdnetTableCtx *CtxPtr,
+				       uint8_t *KeyPtr, uint32_t *ActionIdPtr,
+				       uint8_t *ActionParamsPtr)
+{
+	XilSdnetTablePrivateCtx *Tbl = ModelTable(CtxPtr);
+	uint32_t Slot;
+
+	if ((Tbl == NULL) || (KeyPtr == NULL)) {
+		return XIL_SDNET_GENERAL_ERR_NULL_PARAM;
+	}
+	Slot = ModelCamLookup(&Tbl->Cam, KeyPtr);
+	if (Slot == MODEL_NONE) {
+		return XIL_SDNET_CAM_ERR_KEY_NOT_FOUND;
+	}
+	ModelTableUnpack(Tbl, MODEL_RESP(&Tbl->Cam, Slot), ActionIdPtr,
+			 ActionParamsPtr);
+	return XIL_SDNET_SUCCESS;
+}
+
+XilSdnetReturnType XilSdnetTableReset(XilSdnetTableCtx *CtxPtr)
+{
+	XilSdnetTablePrivateCtx *Tbl = ModelTable(CtxPtr);
+
+	if (Tbl == NULL) {
+		return XIL_SDNET_GENERAL_ERR_INVALID_CONTEXT;
+	}
+	return ModelCamReset(&Tbl->Cam);
+}
+
+/*
+ * Tables belong to the target and go with XilSdnetTargetExit
+ */
+XilSdnetReturnType XilSdnetTableExit(XilSdnetTableCtx *CtxPtr)
+{
+	return (ModelTable(CtxPtr) == NULL) ?
+	       XIL_SDNET_GENERAL_ERR_INVALID_CONTEXT : XIL_SDNET_SUCCESS;
+}
+
+/*
+ * Target driver
+ */
+XilSdnetReturnType XilSdnetTargetInit(XilSdnetTargetCtx *CtxPtr,
+				      XilSdnetEnvIf *EnvIfPtr,
+				      XilSdnetTargetConfig *ConfigPtr)
+{
+	XilSdnetTargetPrivateCtx *Target;
+	XilSdnetTablePrivateCtx *Tbl;
+	XilSdnetTableConfig *TblConfig;
+	XilSdnetReturnType Result;
+	uint32_t Bits;
+	uint32_t I;
+	uint32_t A;
+	uint32_t P;
+
+	if ((CtxPtr == NULL) || (EnvIfPtr == NULL) || (ConfigPtr == NULL)) {
+		return XIL_SDNET_GENERAL_ERR_NULL_PARAM;
+	}
+	Target = calloc(1, sizeof(*Target));
+	if (Target != NULL) {
+		Target->Tables = calloc(ConfigPtr->TableListSize + 1,
+					sizeof(*Target->Tables));
+	}
+	if ((Target == NULL) || (Target->Tables == NULL)) {
+		free(Target);
+		return XIL_SDNET_TABLE_ERR_MALLOC_FAILED;
+	}
+	CtxPtr->PrivateCtxPtr = Target;
+
+	for (I = 0; I < ConfigPtr->TableListSize; I++) {
+		Tbl = &Target->Tables[I];
+		TblConfig = &ConfigPtr->TableListPtr[I]->Config;
+		Tbl->NamePtr = ConfigPtr->TableListPtr[I]->NameStringPtr;
+		Tbl->ConfigPtr = TblConfig;
+		Tbl->Handle.PrivateCtxPtr = Tbl;
+		for (A = 0; A < TblConfig->ActionListSize; A++) {
+			Bits = 0;
+			for (P = 0;
+			     P < TblConfig->ActionListPtr[A]->ParamListSize;
+			     P++) {
+				Bits += TblConfig->ActionListPtr[A]->
+					ParamListPtr[P].Value;
+			}
+			if (Bits > Tbl->ParamBits) {
+				Tbl->ParamBits = Bits;
+			}
+		}
+		Result = ModelCamInit(&Tbl->Cam, EnvIfPtr,
+			&TblConfig->CamConfig,
+			(TblConfig->Mode == XIL_SDNET_TABLE_MODE_TCAM) ||
+			(TblConfig->Mode == XIL_SDNET_TABLE_MODE_STCAM) ||
+			(TblConfig->Mode == XIL_SDNET_TABLE_MODE_TINY_TCAM));
+		if (Result == XIL_SDNET_SUCCESS) {
+			Result = ModelCamReset(&Tbl->Cam);
+		}
+		if (Result != XIL_SDNET_SUCCESS) {
+			Target->NumTables = I + 1;
+			(void)XilSdnetTargetExit(CtxPtr);
+			return Result;
+		}
+	}
+	Target->NumTables = ConfigPtr->TableListSize;
+
+	return XIL_SDNET_SUCCESS;
+}
+
+XilSdnetReturnType XilSdnetTargetExit(XilSdnetTargetCtx *CtxPtr)
+{
+	XilSdnetTargetPrivateCtx *Target;
+	uint32_t I;
+
+	if ((CtxPtr == NULL) || (CtxPtr->PrivateCtxPtr == NULL)) {
+		return XIL_SDNET_GENERAL_ERR_INVALID_CONTEXT;
+	}
+	Target = CtxPtr->PrivateCtxPtr;
+	for (I = 0; I < Target->NumTables; I++) {
+		ModelCamFree(&Target->Tables[I].Cam);
+	}
+	free(Target->Tables);
+	free(Target);
+	CtxPtr->PrivateCtxPtr = NULL;
+	return XIL_SDNET_SUCCESS;
+}
+
+XilSdnetReturnType XilSdnetTargetGetTableByName(XilSdnetTargetCtx *CtxPtr,
+	char *TableNamePtr, XilSdnetTableCtx **TableCtxPtrPtr)
+{
+	XilSdnetTargetPrivateCtx *Target;
+	uint32_t I;
+
+	if ((CtxPtr == NULL) || (CtxPtr->PrivateCtxPtr == NULL) ||
+	    (TableNamePtr == NULL) || (TableCtxPtrPtr == NULL)) {
+		return XIL_SDNET_GENERAL_ERR_NULL_PARAM;
+	}
+	Target = CtxPtr->PrivateCtxPtr;
+	for (I = 0; I < Target->NumTables; I++) {
+		if (strcmp(Target->Tables[I].NamePtr, TableNamePtr) == 0) {
+			*TableCtxPtrPtr = &Target->Tables[I].Handle;
+			return XIL_SDNET_SUCCESS;
+		}
+	}
+	return XIL_SDNET_TABLE_ERR_INVALID_TABLE_HANDLE_DRV;
+}
+
+XilSdnetReturnType XilSdnetTargetGetTableByIndex(XilSdnetTargetCtx *CtxPtr,
+	uint32_t Index, XilSdnetTableCtx **TableCtxPtrPtr)
+{
+	XilSdnetTargetPrivateCtx *Target;
+
+	if ((CtxPtr == NULL) || (CtxPtr->PrivateCtxPtr == NULL) ||
+	    (TableCtxPtrPtr == NULL)) {
+		return XIL_SDNET_GENERAL_ERR_NULL_PARAM;
+	}
+	Target = CtxPtr->PrivateCtxPtr;
+	if (Index >= Target->NumTables) {
+		return XIL_SDNET_TABLE_ERR_INVALID_TABLE_HANDLE_DRV;
+	}
+	*TableCtxPtrPtr = &Target->Tables[Index].Handle;
+	return XIL_SDNET_SUCCESS;
+}
+
+/*
+ * Build information driver: an IP version and nothing else
+ */
+XilSdnetReturnType XilSdnetTargetGetBuildInfoDrv(XilSdnetTargetCtx *CtxPtr,
+	XilSdnetTargetBuildInfoCtx **BuildInfoCtxPtrPtr)
+{
+	static XilSdnetTargetBuildInfoCtx BuildInfo;
+
+	if ((CtxPtr == NULL) || (CtxPtr->PrivateCtxPtr == NULL) ||
+	    (BuildInfoCtxPtrPtr == NULL)) {
+		return XIL_SDNET_GENERAL_ERR_NULL_PARAM;
+	}
+	*BuildInfoCtxPtrPtr = &BuildInfo;
+	return XIL_SDNET_SUCCESS;
+}
+
+XilSdnetReturnType XilSdnetTargetBuildInfoGetIpVersion(
+	XilSdnetTargetBuildInfoCtx *CtxPtr, XilSdnetVersion *IpVersionPtr)
+{
+	if ((CtxPtr == NULL) || (IpVersionPtr == NULL)) {
+		return XIL_SDNET_GENERAL_ERR_NULL_PARAM;
+	}
+	IpVersionPtr->Major = SDNET_MODEL_IP_MAJOR;
+	IpVersionPtr->Minor = SDNET_MODEL_IP_MINOR;
+	IpVersionPtr->Revision = SDNET_MODEL_IP_REVISION;
+	return XIL_SDNET_SUCCESS;
+}
+
+XilSdnetReturnType XilSdnetTargetGetTableCount(XilSdnetTargetCtx *CtxPtr,
+					       uint32_t *NumTablesPtr)
+{
+	if ((CtxPtr == NULL) || (CtxPtr->PrivateCtxPtr == NULL) ||
+	    (NumTablesPtr == NULL)) {
+		return XIL_SDNET_GENERAL_ERR_NULL_PARAM;
+	}
+	*NumTablesPtr =
+		((XilSdnetTargetPrivateCtx *)CtxPtr->PrivateCtxPtr)->NumTables;
+	return XIL_SDNET_SUCCESS;
+}
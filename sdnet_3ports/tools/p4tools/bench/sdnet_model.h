@@ -0,0 +1,45 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file sdnet_model.h
+*
+* Software stand-in for the SDNet control-plane driver library
+* (libsdnetdrv) and the CAMs behind it, so that the application's table
+* code runs on a host. See sdnet_model.c.
+*
+*****************************************************************************/
+#ifndef SDNET_MODEL_H
+#define SDNET_MODEL_H
+
+#include <stddef.h>
+#include "sdnet_target.h"
+
+/*
+ * Register layout the model charges its operations to, relative to the
+ * CamConfig.BaseAddr of each table. It is the model's own, not the IP's.
+ */
+#define SDNET_MODEL_KEY_REG	0x000
+#define SDNET_MODEL_MASK_REG	0x040
+#define SDNET_MODEL_RESP_REG	0x080
+#define SDNET_MODEL_PRIO_REG	0x0C0
+#define SDNET_MODEL_CMD_REG	0x0C4
+#define SDNET_MODEL_STATUS_REG	0x0C8
+#define SDNET_MODEL_CAM_WINDOW	0x1000	/* between tables */
+
+#define SDNET_MODEL_KEY_MAX	64	/* bytes */
+#define SDNET_MODEL_RESP_MAX	32	/* bytes */
+
+/*
+ * What the model's build information driver reports as the IP version
+ */
+#define SDNET_MODEL_IP_MAJOR	2
+#define SDNET_MODEL_IP_MINOR	1
+#define SDNET_MODEL_IP_REVISION	0
+
+int SdnetModelLoadConfig(const char *P4JsonPath, char *ErrBuf, size_t ErrLen);
+
+#endif /* SDNET_MODEL_H */
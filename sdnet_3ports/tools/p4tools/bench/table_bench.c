@@ -0,0 +1,280 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file table_bench.c
+*
+* Cost of OranTableCommit (oran_table.c in the application) as tables grow,
+* built for the host or, with CROSS_COMPILE set, for the A53 under Linux.
+*
+*	table_bench [-n max entries]
+*
+* For table sizes from 16 up to the maximum (4096 by default) a ternary
+* table is replaced by a new generation that updates, reprioritises, drops
+* and adds about a tenth of the entries each. The table driver is stubbed
+* out, so the figures are the work done in software per entry: the diff
+* through the commit-diff index, the stand-ins of moved entries and the
+* ordering of the driver calls. The same diff done with the nested scan
+* OranTableCommit used before is timed next to it. The time the driver
+* spends in its own shadow table per call is not part of the figures.
+*
+*****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "xstatus.h"
+#include "oran_sdnet.h"
+
+#define BENCH_KEY_BYTES		ORAN_POLICY_KEY_BYTES
+#define BENCH_PARAM_BYTES	ORAN_POLICY_PARAM_BYTES
+#define BENCH_ENTRY_BYTES	(2 * BENCH_KEY_BYTES + BENCH_PARAM_BYTES)
+#define BENCH_MIN_ENTRIES	16
+#define BENCH_WORK		(1 << 17)
+
+static uint8_t OldBytes[ORAN_TABLE_TXN_MAX][BENCH_ENTRY_BYTES];
+static uint8_t NewBytes[ORAN_TABLE_TXN_MAX][BENCH_ENTRY_BYTES];
+static OranTableEntry OldSet[ORAN_TABLE_TXN_MAX];
+static OranTableEntry NewSet[ORAN_TABLE_TXN_MAX];
+static uint8_t Taken[ORAN_TABLE_TXN_MAX];
+static uint64_t DriverCalls;
+static uint32_t Seed = 1;
+
+/*
+ * Driver and environment stand-ins
+ */
+XilSdnetReturnType XilSdnetTableInsert(XilSdnetTableCtx *CtxPtr,
+				       uint8_t *KeyPtr, uint8_t *MaskPtr,
+				       uint32_t Priority, uint32_t ActionId,
+				       uint8_t *ActionParamsPtr)
+{
+	(void)CtxPtr; (void)KeyPtr; (void)MaskPtr; (void)Priority;
+	(void)ActionId; (void)ActionParamsPtr;
+	DriverCalls++;
+	return XIL_SDNET_SUCCESS;
+}
+
+XilSdnetReturnType XilSdnetTableUpdate(XilSdnetTableCtx *CtxPtr,
+				       uint8_t *KeyPtr, uint8_t *MaskPtr,
+				       uint32_t ActionId,
+				       uint8_t *ActionParamsPtr)
+{
+	(void)CtxPtr; (void)KeyPtr; (void)MaskPtr; (void)ActionId;
+	(void)ActionParamsPtr;
+	DriverCalls++;
+	return XIL_SDNET_SUCCESS;
+}
+
+XilSdnetReturnType XilSdnetTableDelete(XilSdnetTableCtx *CtxPtr,
+				       uint8_t *KeyPtr, uint8_t *MaskPtr)
+{
+	(void)CtxPtr; (void)KeyPtr; (void)MaskPtr;
+	DriverCalls++;
+	return XIL_SDNET_SUCCESS;
+}
+
+XilSdnetReturnType XilSdnetTableGetKeySizeBits(XilSdnetTableCtx *CtxPtr,
+					       uint32_t *KeySizeBitsPtr)
+{
+	(void)CtxPtr;
+	*KeySizeBitsPtr = 8 * BENCH_KEY_BYTES;
+	return XIL_SDNET_SUCCESS;
+}
+
+const char *XilSdnetReturnTypeToString(XilSdnetReturnType Return)
+{
+	(void)Return;
+	return "error";
+}
+
+void OranSdnetWriteSequenceBegin(void)
+{
+}
+
+void OranSdnetWriteSequenceEnd(void)
+{
+}
+
+static uint32_t Random(void)
+{
+	Seed ^= Seed << 13;
+	Seed ^= Seed >> 17;
+	Seed ^= Seed << 5;
+	return Seed;
+}
+
+static double NowSec(void)
+{
+	struct timespec Ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &Ts);
+	return (double)Ts.tv_sec + (double)Ts.tv_nsec * 1e-9;
+}
+
+static void PointEntry(OranTableEntry *EntryPtr, uint8_t *BytePtr)
+{
+	EntryPtr->KeyPtr = BytePtr;
+	EntryPtr->MaskPtr = BytePtr + BENCH_KEY_BYTES;
+	EntryPtr->ParamsPtr = BytePtr + 2 * BENCH_KEY_BYTES;
+}
+
+static void RandomEntry(OranTableEntry *EntryPtr, uint8_t *BytePtr)
+{
+	uint32_t I;
+
+	PointEntry(EntryPtr, BytePtr);
+	for (I = 0; I < BENCH_ENTRY_BYTES; I++) {
+		BytePtr[I] = (uint8_t)Random();
+	}
+	/* Keys are distinct under their masks: the first bytes are exact */
+	BytePtr[BENCH_KEY_BYTES] = 0xFF;
+	BytePtr[BENCH_KEY_BYTES + 1] = 0xFF;
+	BytePtr[BENCH_KEY_BYTES + 2] = 0xFF;
+	EntryPtr->Priority = Random() % 64;
+	EntryPtr->ActionId = Random() % 2;
+}
+
+/*
+ * Old generation of Count entries, and a new one built from it
+ */
+static uint32_t BuildSets(uint32_t Count)
+{
+	uint32_t NewCount = 0;
+	uint32_t I;
+	uint32_t J;
+
+	for (I = 0; I < Count; I++) {
+		RandomEntry(&OldSet[I], OldBytes[I]);
+		OldBytes[I][0] = (uint8_t)I;
+		OldBytes[I][1] = (uint8_t)(I >> 8);
+	}
+
+	for (I = 0; I < Count; I++) {
+		uint32_t Pick = Random() % 10;
+
+		if (Pick == 0) {
+			continue;	/* dropped */
+		}
+		memcpy(NewBytes[NewCount], OldBytes[I], BENCH_ENTRY_BYTES);
+		PointEntry(&NewSet[NewCount], NewBytes[NewCount]);
+		NewSet[NewCount].Priority = OldSet[I].Priority;
+		NewSet[NewCount].ActionId = OldSet[I].ActionId;
+		if (Pick == 1) {
+			NewBytes[NewCount][2 * BENCH_KEY_BYTES] ^= 0x5A;
+		} else if (Pick == 2) {
+			NewSet[NewCount].Priority++;
+		}
+		NewCount++;
+	}
+	for (I = 0; (I < Count / 10) && (NewCount < Count); I++) {
+		RandomEntry(&NewSet[NewCount], NewBytes[NewCount]);
+		NewBytes[NewCount][0] = (uint8_t)(Count + I);
+		NewBytes[NewCount][1] = (uint8_t)((Count + I) >> 8);
+		NewBytes[NewCount][2] = 0xA5;
+		NewCount++;
+	}
+
+	/* Present the new generation in a different order */
+	for (I = NewCount; I > 1; I--) {
+		OranTableEntry Swap;
+
+		J = Random() % I;
+		Swap = NewSet[I - 1];
+		NewSet[I - 1] = NewSet[J];
+		NewSet[J] = Swap;
+	}
+
+	return NewCount;
+}
+
+/*
+ * The matching OranTableCommit did with a nested scan, kept for comparison
+ */
+static uint32_t LinearDiff(uint32_t OldCount, uint32_t NewCount)
+{
+	uint32_t Matched = 0;
+	uint32_t New;
+	uint32_t Old;
+
+	memset(Taken, 0, OldCount);
+	for (New = 0; New < NewCount; New++) {
+		for (Old = 0; Old < OldCount; Old++) {
+			if (!Taken[Old] &&
+			    (memcmp(NewSet[New].KeyPtr, OldSet[Old].KeyPtr,
+				    BENCH_KEY_BYTES) == 0) &&
+			    (memcmp(NewSet[New].MaskPtr, OldSet[Old].MaskPtr,
+				    BENCH_KEY_BYTES) == 0)) {
+				Taken[Old] = 1;
+				Matched++;
+				break;
+			}
+		}
+	}
+
+	return Matched;
+}
+
+int main(int argc, char *argv[])
+{
+	static XilSdnetTableCtx Table;
+	uint32_t MaxEntries = ORAN_TABLE_TXN_MAX;
+	uint32_t Count;
+	uint32_t NewCount;
+	uint32_t Reps;
+	uint32_t R;
+	uint64_t Sink = 0;
+	double Start;
+	double Commit;
+	double Linear;
+
+	if ((argc == 3) && (strcmp(argv[1], "-n") == 0)) {
+		MaxEntries = (uint32_t)strtoul(argv[2], NULL, 0);
+	} else if (argc != 1) {
+		MaxEntries = 0;
+	}
+	if ((MaxEntries < BENCH_MIN_ENTRIES) ||
+	    (MaxEntries > ORAN_TABLE_TXN_MAX)) {
+		fprintf(stderr, "usage: table_bench [-n max entries, %d..%d]\n",
+			BENCH_MIN_ENTRIES, ORAN_TABLE_TXN_MAX);
+		return 2;
+	}
+
+	printf("%8s %8s %14s %14s %12s\n", "entries", "calls",
+	       "commit ns/ent", "scan ns/ent", "scan/commit");
+	for (Count = BENCH_MIN_ENTRIES; Count <= MaxEntries; Count *= 2) {
+		NewCount = BuildSets(Count);
+		Reps = BENCH_WORK / Count;
+		if (Reps == 0) {
+			Reps = 1;
+		}
+
+		DriverCalls = 0;
+		Start = NowSec();
+		for (R = 0; R < Reps; R++) {
+			if (OranTableCommit(&Table, BENCH_KEY_BYTES,
+					    BENCH_PARAM_BYTES, OldSet, Count,
+					    NewSet, NewCount) != XST_SUCCESS) {
+				fprintf(stderr, "commit of %u entries failed\n",
+					(unsigned)Count);
+				return 1;
+			}
+		}
+		Commit = (NowSec() - Start) / Reps;
+
+		Start = NowSec();
+		for (R = 0; R < Reps; R++) {
+			Sink += LinearDiff(Count, NewCount);
+		}
+		Linear = (NowSec() - Start) / Reps;
+
+		printf("%8u %8u %14.1f %14.1f %12.1f\n", (unsigned)Count,
+		       (unsigned)(DriverCalls / Reps), Commit * 1e9 / Count,
+		       Linear * 1e9 / Count, Linear / Commit);
+	}
+
+	return (Sink == 0);
+}
@@ -0,0 +1,373 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file json.c
+*
+* Recursive descent JSON parser used by the p4tools.
+*
+*****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "json.h"
+
+typedef struct {
+	const char *Pos;
+	const char *Err;
+	int Line;
+} JsonParser;
+
+static JsonValue *JsonParseValue(JsonParser *P);
+
+static void JsonSkipWs(JsonParser *P)
+{
+	while (*P->Pos == ' ' || *P->Pos == '\t' || *P->Pos == '\r' ||
+	       *P->Pos == '\n') {
+		if (*P->Pos == '\n') {
+			P->Line++;
+		}
+		P->Pos++;
+	}
+}
+
+static JsonValue *JsonNew(JsonParser *P, JsonType Type)
+{
+	JsonValue *V = calloc(1, sizeof(*V));
+
+	if (V == NULL) {
+		P->Err = "out of memory";
+		return NULL;
+	}
+	V->Type = Type;
+	return V;
+}
+
+static int JsonAppend(JsonParser *P, JsonValue *Parent, char *Key,
+		      JsonValue *Child)
+{
+	size_t N = Parent->Count + 1;
+	JsonValue **Items = realloc(Parent->Items, N * sizeof(*Items));
+
+	if (Items == NULL) {
+		P->Err = "out of memory";
+		return -1;
+	}
+	Parent->Items = Items;
+	if (Parent->Type == JSON_OBJECT) {
+		char **Keys = realloc(Parent->Keys, N * sizeof(*Keys));
+
+		if (Keys == NULL) {
+			P->Err = "out of memory";
+			return -1;
+		}
+		Parent->Keys = Keys;
+		Keys[N - 1] = Key;
+	}
+	Items[N - 1] = Child;
+	Parent->Count = N;
+	return 0;
+}
+
+static char *JsonParseString(JsonParser *P)
+{
+	const char *S = P->Pos + 1;
+	size_t Len = 0;
+	char *Out;
+	char *D;
+
+	/* Upper bound on the unescaped length */
+	while (S[Len] != '"') {
+		if (S[Len] == '\0') {
+			P->Err = "unterminated string";
+			return NULL;
+		}
+		if (S[Len] == '\\' && S[Len + 1] != '\0') {
+			Len++;
+		}
+		Len++;
+	}
+
+	Out = malloc(Len + 1);
+	if (Out == NULL) {
+		P->Err = "out of memory";
+		return NULL;
+	}
+
+	D = Out;
+	while (*S != '"') {
+		if (*S == '\\') {
+			S++;
+			switch (*S) {
+			case 'n': *D++ = '\n'; break;
+			case 't': *D++ = '\t'; break;
+			case 'r': *D++ = '\r'; break;
+			case 'b': *D++ = '\b'; break;
+			case 'f': *D++ = '\f'; break;
+			case 'u':
+				/* Only ASCII escapes appear in p4c output */
+				if (strlen(S) >= 5) {
+					char Hex[5] = { S[1], S[2], S[3], S[4], 0 };
+
+					*D++ = (char)strtol(Hex, NULL, 16);
+					S += 4;
+				}
+				break;
+			default: *D++ = *S; break;
+			}
+			S++;
+		} else {
+			*D++ = *S++;
+		}
+	}
+	*D = '\0';
+	P->Pos = S + 1;
+	return Out;
+}
+
+static JsonValue *JsonParseContainer(JsonParser *P, char Close)
+{
+	JsonValue *V = JsonNew(P, Close == '}' ? JSON_OBJECT : JSON_ARRAY);
+
+	if (V == NULL) {
+		return NULL;
+	}
+
+	P->Pos++;
+	JsonSkipWs(P);
+	if (*P->Pos == Close) {
+		P->Pos++;
+		return V;
+	}
+
+	for (;;) {
+		char *Key = NULL;
+		JsonValue *Child;
+
+		JsonSkipWs(P);
+		if (Close == '}') {
+			if (*P->Pos != '"') {
+				P->Err = "expected object key";
+				goto Fail;
+			}
+			Key = JsonParseString(P);
+			if (Key == NULL) {
+				goto Fail;
+			}
+			JsonSkipWs(P);
+			if (*P->Pos != ':') {
+				free(Key);
+				P->Err = "expected ':'";
+				goto Fail;
+			}
+			P->Pos++;
+		}
+
+		Child = JsonParseValue(P);
+		if (Child == NULL || JsonAppend(P, V, Key, Child) != 0) {
+			free(Key);
+			JsonFree(Child);
+			goto Fail;
+		}
+
+		JsonSkipWs(P);
+		if (*P->Pos == ',') {
+			P->Pos++;
+			continue;
+		}
+		if (*P->Pos == Close) {
+			P->Pos++;
+			return V;
+		}
+		P->Err = "expected ',' or closing bracket";
+		goto Fail;
+	}
+
+Fail:
+	JsonFree(V);
+	return NULL;
+}
+
+static JsonValue *JsonParseValue(JsonParser *P)
+{
+	JsonValue *V;
+
+	JsonSkipWs(P);
+	switch (*P->Pos) {
+	case '{':
+		return JsonParseContainer(P, '}');
+	case '[':
+		return JsonParseContainer(P, ']');
+	case '"':
+		V = JsonNew(P, JSON_STRING);
+		if (V != NULL) {
+			V->Str = JsonParseString(P);
+			if (V->Str == NULL) {
+				free(V);
+				V = NULL;
+			}
+		}
+		return V;
+	case 't':
+	case 'f':
+		V = JsonNew(P, JSON_BOOL);
+		if (V == NULL) {
+			return NULL;
+		}
+		if (strncmp(P->Pos, "true", 4) == 0) {
+			V->Bool = 1;
+			P->Pos += 4;
+		} else if (strncmp(P->Pos, "false", 5) == 0) {
+			P->Pos += 5;
+		} else {
+			free(V);
+			P->Err = "bad literal";
+			return NULL;
+		}
+		V->Int = V->Bool;
+		return V;
+	case 'n':
+		if (strncmp(P->Pos, "null", 4) != 0) {
+			P->Err = "bad literal";
+			return NULL;
+		}
+		P->Pos += 4;
+		return JsonNew(P, JSON_NULL);
+	default:
+		if (*P->Pos == '-' || (*P->Pos >= '0' && *P->Pos <= '9')) {
+			char *End;
+
+			V = JsonNew(P, JSON_NUMBER);
+			if (V == NULL) {
+				return NULL;
+			}
+			V->Int = strtoll(P->Pos, &End, 10);
+			if (*End == '.' || *End == 'e' || *End == 'E') {
+				V->Int = (int64_t)strtod(P->Pos, &End);
+			}
+			P->Pos = End;
+			return V;
+		}
+		P->Err = "unexpected character";
+		return NULL;
+	}
+}
+
+/****************************************************************************/
+/**
+*
+* Parses a NUL terminated JSON document.
+*
+* @param	Text is the document.
+* @param	ErrBuf receives a message on failure, may be NULL.
+* @param	ErrLen is the size of ErrBuf.
+*
+* @return	The root value, or NULL on error. Release with JsonFree.
+*
+*****************************************************************************/
+JsonValue *JsonParse(const char *Text, char *ErrBuf, size_t ErrLen)
+{
+	JsonParser P = { Text, NULL, 1 };
+	JsonValue *Root = JsonParseValue(&P);
+
+	if (Root != NULL) {
+		JsonSkipWs(&P);
+		if (*P.Pos != '\0') {
+			P.Err = "trailing data";
+			JsonFree(Root);
+			Root = NULL;
+		}
+	}
+	if (Root == NULL && ErrBuf != NULL) {
+		snprintf(ErrBuf, ErrLen, "line %d: %s", P.Line,
+			 P.Err ? P.Err : "parse error");
+	}
+	return Root;
+}
+
+JsonValue *JsonLoadFile(const char *Path, char *ErrBuf, size_t ErrLen)
+{
+	FILE *F = fopen(Path, "rb");
+	JsonValue *Root;
+	char *Text;
+	long Size;
+
+	if (F == NULL) {
+		snprintf(ErrBuf, ErrLen, "cannot open %s", Path);
+		return NULL;
+	}
+	fseek(F, 0, SEEK_END);
+	Size = ftell(F);
+	fseek(F, 0, SEEK_SET);
+
+	Text = malloc((size_t)Size + 1);
+	if (Text == NULL || fread(Text, 1, (size_t)Size, F) != (size_t)Size) {
+		snprintf(ErrBuf, ErrLen, "cannot read %s", Path);
+		free(Text);
+		fclose(F);
+		return NULL;
+	}
+	Text[Size] = '\0';
+	fclose(F);
+
+	Root = JsonParse(Text, ErrBuf, ErrLen);
+	free(Text);
+	return Root;
+}
+
+void JsonFree(JsonValue *Value)
+{
+	size_t I;
+
+	if (Value == NULL) {
+		return;
+	}
+	for (I = 0; I < Value->Count; I++) {
+		JsonFree(Value->Items[I]);
+		if (Value->Keys != NULL) {
+			free(Value->Keys[I]);
+		}
+	}
+	free(Value->Items);
+	free(Value->Keys);
+	free(Value->Str);
+	free(Value);
+}
+
+JsonValue *JsonGet(const JsonValue *Object, const char *Key)
+{
+	size_t I;
+
+	if (Object == NULL || Object->Type != JSON_OBJECT) {
+		return NULL;
+	}
+	for (I = 0; I < Object->Count; I++) {
+		if (strcmp(Object->Keys[I], Key) == 0) {
+			return Object->Items[I];
+		}
+	}
+	return NULL;
+}
+
+JsonValue *JsonAt(const JsonValue *Array, size_t Index)
+{
+	if (Array == NULL || Array->Type != JSON_ARRAY ||
+	    Index >= Array->Count) {
+		return NULL;
+	}
+	return Array->Items[Index];
+}
+
+const char *JsonStr(const JsonValue *Value)
+{
+	return (Value != NULL && Value->Type == JSON_STRING) ? Value->Str : NULL;
+}
+
+int64_t JsonInt(const JsonValue *Value)
+{
+	return (Value != NULL) ? Value->Int : 0;
+}
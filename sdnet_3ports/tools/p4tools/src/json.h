@@ -0,0 +1,51 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file json.h
+*
+* Minimal read-only JSON DOM, just enough to load the p4c-sdnet output
+* (main.json). Numbers are kept as doubles and as 64-bit integers; strings
+* are NUL terminated and unescaped.
+*
+*****************************************************************************/
+#ifndef P4_JSON_H
+#define P4_JSON_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+	JSON_NULL,
+	JSON_BOOL,
+	JSON_NUMBER,
+	JSON_STRING,
+	JSON_ARRAY,
+	JSON_OBJECT
+} JsonType;
+
+typedef struct JsonValue JsonValue;
+
+struct JsonValue {
+	JsonType Type;
+	int Bool;
+	int64_t Int;
+	char *Str;		/* JSON_STRING */
+	size_t Count;		/* JSON_ARRAY / JSON_OBJECT */
+	char **Keys;		/* JSON_OBJECT */
+	JsonValue **Items;	/* JSON_ARRAY / JSON_OBJECT */
+};
+
+JsonValue *JsonParse(const char *Text, char *ErrBuf, size_t ErrLen);
+JsonValue *JsonLoadFile(const char *Path, char *ErrBuf, size_t ErrLen);
+void JsonFree(JsonValue *Value);
+
+JsonValue *JsonGet(const JsonValue *Object, const char *Key);
+JsonValue *JsonAt(const JsonValue *Array, size_t Index);
+const char *JsonStr(const JsonValue *Value);
+int64_t JsonInt(const JsonValue *Value);
+
+#endif /* P4_JSON_H */
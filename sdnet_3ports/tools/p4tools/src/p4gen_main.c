@@ -0,0 +1,1391 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file p4gen_main.c
+*
+* p4gen: compiles the SDNet program (main.json) into a C header with one
+* static inline classify function, for the PS path that sees frames the PL
+* pipeline did not classify.
+*
+*	p4gen -p main.json -e plane_policy.txt -n OranClassify -o oran_classify.h
+*
+* The parser becomes straight-line code per state: each header is read at
+* fixed byte offsets from the state's cursor and each select is a switch
+* on the packed key. Tables are a first-match scan over value/mask words
+* in priority order, followed by a switch on the action id. The semantics
+* are those of p4sim, including the parser error codes, so the generated
+* code can be checked against the interpreter frame by frame.
+*
+* Entries given with -e are emitted as the default tables; the caller can
+* pass its own tables instead.
+*
+*****************************************************************************/
+
+#include <ctype.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "p4prog.h"
+#include "p4sim.h"
+
+#define P4GEN_NAME_MAX		128
+#define P4GEN_MAX_WORDS		P4_MAX_KEY_FIELDS
+
+/**************************** Type Definitions ******************************/
+
+typedef struct {
+	FILE *F;
+	const P4Program *Prog;
+	const char *Prefix;		/* CamelCase, e.g. OranClassify */
+	char Macro[P4GEN_NAME_MAX];	/* UPPER_SNAKE of Prefix */
+	uint8_t *UsedField;		/* per value slot */
+	uint8_t *UsedValid;		/* per header */
+	int UsesVarbit;
+	int Failed;
+} P4Gen;
+
+/* Placement of the table key fields in 64-bit match words */
+typedef struct {
+	uint32_t NumWords;
+	uint32_t Word[P4_MAX_KEY_FIELDS];
+	uint32_t Shift[P4_MAX_KEY_FIELDS];
+} P4GenKeyLayout;
+
+/****************************************************************************/
+
+static void Usage(void)
+{
+	fprintf(stderr,
+		"usage: p4gen -p main.json [-e entries]... [-n Prefix]"
+		" [-o out.h]\n");
+	exit(2);
+}
+
+static void GenFail(P4Gen *G, const char *Msg, const char *Name)
+{
+	if (!G->Failed) {
+		fprintf(stderr, "p4gen: %s%s%s\n", Msg, Name ? ": " : "",
+			Name ? Name : "");
+	}
+	G->Failed = 1;
+}
+
+static uint64_t WidthMask(uint32_t Width)
+{
+	return (Width >= 64) ? UINT64_MAX : ((1ULL << Width) - 1);
+}
+
+/* "vlan[0]" -> "vlan_0", "MyProcessing.set_plane" -> "MyProcessing_set_plane" */
+static void CName(char *Out, const char *In)
+{
+	size_t N = 0;
+
+	for (; *In != '\0' && N < P4GEN_NAME_MAX - 1; In++) {
+		char C = isalnum((unsigned char)*In) ? *In : '_';
+
+		if (C == '_' && (N == 0 || Out[N - 1] == '_')) {
+			continue;
+		}
+		Out[N++] = C;
+	}
+	while (N > 0 && Out[N - 1] == '_') {
+		N--;
+	}
+	Out[N] = '\0';
+}
+
+/* Drops the control prefix: "MyProcessing.plane_classify" -> "plane_classify" */
+static const char *ShortName(const char *Name)
+{
+	const char *Dot = strrchr(Name, '.');
+
+	return (Dot != NULL) ? Dot + 1 : Name;
+}
+
+/* "plane_classify" -> "PlaneClassify" */
+static void CamelName(char *Out, const char *In)
+{
+	size_t N = 0;
+	int Up = 1;
+
+	for (; *In != '\0' && N < P4GEN_NAME_MAX - 1; In++) {
+		if (!isalnum((unsigned char)*In)) {
+			Up = 1;
+			continue;
+		}
+		Out[N++] = Up ? (char)toupper((unsigned char)*In) : *In;
+		Up = 0;
+	}
+	Out[N] = '\0';
+}
+
+/* "OranClassify" -> "ORAN_CLASSIFY", "set_plane" -> "SET_PLANE" */
+static void MacroName(char *Out, const char *In)
+{
+	size_t N = 0;
+	const char *P;
+
+	for (P = In; *P != '\0' && N < P4GEN_NAME_MAX - 2; P++) {
+		if (!isalnum((unsigned char)*P)) {
+			if (N > 0 && Out[N - 1] != '_') {
+				Out[N++] = '_';
+			}
+			continue;
+		}
+		if (isupper((unsigned char)*P) && P > In &&
+		    islower((unsigned char)P[-1]) && Out[N - 1] != '_') {
+			Out[N++] = '_';
+		}
+		Out[N++] = (char)toupper((unsigned char)*P);
+	}
+	Out[N] = '\0';
+}
+
+static const char *CType(uint32_t Width)
+{
+	return (Width <= 8) ? "uint8_t" : (Width <= 16) ? "uint16_t" :
+	       (Width <= 32) ? "uint32_t" : "uint64_t";
+}
+
+static const P4HeaderType *HType(const P4Gen *G, uint32_t H)
+{
+	return &G->Prog->HeaderTypes[G->Prog->Headers[H].Type];
+}
+
+static int IsPadding(const char *Field)
+{
+	return strncmp(Field, "_padding", 8) == 0;
+}
+
+/* Metadata fields exposed in the Meta struct */
+static int IsMetaField(const P4Gen *G, uint32_t H, uint32_t F)
+{
+	return G->Prog->Headers[H].Metadata &&
+	       HType(G, H)->Fields[F].Width != 0 &&
+	       !IsPadding(HType(G, H)->Fields[F].Name);
+}
+
+static void MetaMember(char *Out, const P4Gen *G, uint32_t H, uint32_t F)
+{
+	char Hdr[P4GEN_NAME_MAX];
+	char Fld[P4GEN_NAME_MAX];
+
+	CName(Fld, HType(G, H)->Fields[F].Name);
+	if (H == G->Prog->StdMetaHeader) {
+		snprintf(Out, P4GEN_NAME_MAX, "%s", Fld);
+	} else {
+		CName(Hdr, G->Prog->Headers[H].Name);
+		snprintf(Out, P4GEN_NAME_MAX, "%.60s_%.60s", Hdr, Fld);
+	}
+}
+
+static void FieldVar(char *Out, const P4Gen *G, uint32_t H, uint32_t F)
+{
+	char Hdr[P4GEN_NAME_MAX];
+	char Fld[P4GEN_NAME_MAX];
+
+	CName(Hdr, G->Prog->Headers[H].Name);
+	CName(Fld, HType(G, H)->Fields[F].Name);
+	snprintf(Out, P4GEN_NAME_MAX, "h_%.60s_%.60s", Hdr, Fld);
+}
+
+/*****************************************************************************/
+/*
+ * Usage analysis: only fields that are read somewhere get a local, so the
+ * generated function compiles warning-free with -Wall -Wextra.
+ */
+static void MarkField(P4Gen *G, uint32_t H, uint32_t F)
+{
+	G->UsedField[G->Prog->Headers[H].ValueBase + F] = 1;
+}
+
+static void MarkExpr(P4Gen *G, const P4Expr *E)
+{
+	const P4Program *Prog = G->Prog;
+	uint32_t I;
+
+	if (E == NULL) {
+		return;
+	}
+	switch (E->Kind) {
+	case P4E_FIELD:
+		MarkField(G, E->Header, E->Field);
+		break;
+	case P4E_VALID:
+		G->UsedValid[E->Header] = 1;
+		break;
+	case P4E_STACK_FIELD:
+		for (I = 0; I < Prog->Stacks[E->Header].Size; I++) {
+			MarkField(G, Prog->Stacks[E->Header].Headers[I], E->Field);
+		}
+		break;
+	default:
+		break;
+	}
+	MarkExpr(G, E->Left);
+	MarkExpr(G, E->Right);
+	MarkExpr(G, E->Cond);
+}
+
+static void MarkUsed(P4Gen *G)
+{
+	const P4Program *Prog = G->Prog;
+	uint32_t I;
+	uint32_t J;
+
+	for (I = 0; I < Prog->NumStates; I++) {
+		const P4ParseState *S = &Prog->States[I];
+
+		for (J = 0; J < S->NumOps; J++) {
+			MarkExpr(G, S->Ops[J].Expr);
+			MarkExpr(G, S->Ops[J].Error);
+			if (S->Ops[J].Kind == P4P_EXTRACT_VL) {
+				G->UsesVarbit = 1;
+			}
+		}
+		for (J = 0; J < S->NumKeys; J++) {
+			MarkExpr(G, S->Keys[J]);
+		}
+	}
+	for (I = 0; I < Prog->NumActions; I++) {
+		for (J = 0; J < Prog->Actions[I].NumPrims; J++) {
+			MarkExpr(G, Prog->Actions[I].Prims[J].Src);
+		}
+	}
+	for (I = 0; I < Prog->NumTables; I++) {
+		for (J = 0; J < Prog->Tables[I].NumKeys; J++) {
+			MarkExpr(G, Prog->Tables[I].Keys[J]);
+		}
+	}
+	for (I = 0; I < Prog->NumConds; I++) {
+		MarkExpr(G, Prog->Conds[I].Expr);
+	}
+	/* Metadata is read back into the caller's struct */
+	for (I = 0; I < Prog->NumHeaders; I++) {
+		for (J = 0; J < HType(G, I)->NumFields; J++) {
+			if (IsMetaField(G, I, J)) {
+				MarkField(G, I, J);
+			}
+		}
+	}
+}
+
+/*****************************************************************************/
+/*
+ * Expressions
+ */
+static void EmitExpr(P4Gen *G, const P4Expr *E)
+{
+	static const char *BinOps[] = {
+		[P4OP_ADD] = "+", [P4OP_SUB] = "-", [P4OP_MUL] = "*",
+		[P4OP_AND] = "&", [P4OP_OR] = "|", [P4OP_XOR] = "^",
+		[P4OP_EQ] = "==", [P4OP_NE] = "!=", [P4OP_LT] = "<",
+		[P4OP_LE] = "<=", [P4OP_GT] = ">", [P4OP_GE] = ">=",
+		[P4OP_LAND] = "&&", [P4OP_LOR] = "||",
+	};
+	const P4Program *Prog = G->Prog;
+	char Var[P4GEN_NAME_MAX];
+	char Stack[P4GEN_NAME_MAX];
+	uint32_t I;
+
+	switch (E->Kind) {
+	case P4E_CONST:
+		fprintf(G->F, "UINT64_C(0x%" PRIx64 ")", E->Const);
+		return;
+	case P4E_FIELD:
+		FieldVar(Var, G, E->Header, E->Field);
+		fprintf(G->F, "%s", Var);
+		return;
+	case P4E_VALID:
+		CName(Var, Prog->Headers[E->Header].Name);
+		fprintf(G->F, "(uint64_t)v_%s", Var);
+		return;
+	case P4E_STACK_FIELD:
+		/* Field of the last extracted element */
+		CName(Stack, Prog->Stacks[E->Header].Name);
+		for (I = 0; I + 1 < Prog->Stacks[E->Header].Size; I++) {
+			FieldVar(Var, G, Prog->Stacks[E->Header].Headers[I],
+				 E->Field);
+			fprintf(G->F, "(n_%s <= %u ? %s : ", Stack, I + 1, Var);
+		}
+		FieldVar(Var, G, Prog->Stacks[E->Header].Headers[I], E->Field);
+		fprintf(G->F, "%s", Var);
+		for (I = 0; I + 1 < Prog->Stacks[E->Header].Size; I++) {
+			fprintf(G->F, ")");
+		}
+		return;
+	case P4E_RUNTIME:
+		fprintf(G->F, "Prm[%u]", (unsigned)E->Field);
+		return;
+	case P4E_OP:
+		break;
+	}
+
+	switch (E->Op) {
+	case P4OP_SHL:
+	case P4OP_SHR:
+		fprintf(G->F, "%s%s(", G->Prefix,
+			E->Op == P4OP_SHL ? "Shl" : "Shr");
+		EmitExpr(G, E->Left);
+		fprintf(G->F, ", ");
+		EmitExpr(G, E->Right);
+		fprintf(G->F, ")");
+		return;
+	case P4OP_NOT:
+		fprintf(G->F, "(~");
+		EmitExpr(G, E->Right);
+		fprintf(G->F, ")");
+		return;
+	case P4OP_LNOT:
+		fprintf(G->F, "(uint64_t)!");
+		EmitExpr(G, E->Right);
+		return;
+	case P4OP_B2D:
+	case P4OP_D2B:
+		fprintf(G->F, "(uint64_t)(");
+		EmitExpr(G, E->Right);
+		fprintf(G->F, " != 0)");
+		return;
+	case P4OP_COND:
+		fprintf(G->F, "(");
+		EmitExpr(G, E->Cond);
+		fprintf(G->F, " ? ");
+		EmitExpr(G, E->Left);
+		fprintf(G->F, " : ");
+		EmitExpr(G, E->Right);
+		fprintf(G->F, ")");
+		return;
+	default:
+		break;
+	}
+
+	/* Comparisons and logic yield int in C; keep everything uint64_t */
+	fprintf(G->F, "%s(", (E->Op >= P4OP_EQ) ? "(uint64_t)" : "");
+	EmitExpr(G, E->Left);
+	fprintf(G->F, " %s ", BinOps[E->Op]);
+	EmitExpr(G, E->Right);
+	fprintf(G->F, ")");
+}
+
+/*****************************************************************************/
+/*
+ * Parser
+ */
+static void EmitError(P4Gen *G, const char *Indent, const char *Name)
+{
+	char Macro[P4GEN_NAME_MAX];
+
+	MacroName(Macro, Name);
+	fprintf(G->F, "%s\tErr = %s_ERR_%s;\n%s\tgoto Parsed;\n", Indent,
+		G->Macro, Macro, Indent);
+}
+
+static void EmitHeaderFields(P4Gen *G, uint32_t H, const char *Indent)
+{
+	const P4HeaderType *T = HType(G, H);
+	char Var[P4GEN_NAME_MAX];
+	uint32_t Bit = 0;
+	uint32_t F;
+
+	for (F = 0; F < T->NumFields; F++) {
+		uint32_t W = T->Fields[F].Width;
+		uint32_t NBytes = ((Bit & 7) + W + 7) >> 3;
+		uint32_t Shift = NBytes * 8 - (Bit & 7) - W;
+
+		if (F == T->VarField) {
+			continue;
+		}
+		if (G->UsedField[G->Prog->Headers[H].ValueBase + F]) {
+			if (NBytes > 8) {
+				GenFail(G, "field straddles 9 bytes",
+					T->Fields[F].Name);
+				return;
+			}
+			FieldVar(Var, G, H, F);
+			fprintf(G->F, "%s%s = %sLoad(Pkt + Off + %u, %u)", Indent,
+				Var, G->Prefix, (unsigned)(Bit >> 3),
+				(unsigned)NBytes);
+			if (Shift != 0) {
+				fprintf(G->F, " >> %u", (unsigned)Shift);
+			}
+			if (W != NBytes * 8) {
+				fprintf(G->F, " & UINT64_C(0x%" PRIx64 ")",
+					WidthMask(W));
+			}
+			fprintf(G->F, ";\n");
+		}
+		Bit += W;
+	}
+	if (G->UsedValid[H]) {
+		CName(Var, G->Prog->Headers[H].Name);
+		fprintf(G->F, "%sv_%s = 1;\n", Indent, Var);
+	}
+}
+
+static void EmitParserOp(P4Gen *G, const P4ParserOp *Op)
+{
+	const P4Program *Prog = G->Prog;
+	char Var[P4GEN_NAME_MAX];
+	const P4HeaderType *T;
+	const P4Stack *S;
+	uint32_t Bytes;
+	uint32_t I;
+
+	switch (Op->Kind) {
+	case P4P_EXTRACT:
+		T = HType(G, Op->Header);
+		if (T->VarField != P4_NONE || T->FixedBits % 8 != 0) {
+			GenFail(G, "header is not a whole number of bytes",
+				Prog->Headers[Op->Header].Name);
+			return;
+		}
+		Bytes = T->FixedBits / 8;
+		fprintf(G->F, "\tif (Len - Off < %u) {\n", (unsigned)Bytes);
+		EmitError(G, "\t", "PacketTooShort");
+		fprintf(G->F, "\t}\n");
+		EmitHeaderFields(G, Op->Header, "\t");
+		fprintf(G->F, "\tOff += %u;\n", (unsigned)Bytes);
+		break;
+
+	case P4P_EXTRACT_STACK:
+		S = &Prog->Stacks[Op->Header];
+		T = HType(G, S->Headers[0]);
+		if (T->VarField != P4_NONE || T->FixedBits % 8 != 0) {
+			GenFail(G, "stack element is not a whole number of bytes",
+				S->Name);
+			return;
+		}
+		Bytes = T->FixedBits / 8;
+		CName(Var, S->Name);
+		fprintf(G->F, "\tif (n_%s >= %u) {\n", Var, (unsigned)S->Size);
+		EmitError(G, "\t", "StackOutOfBounds");
+		fprintf(G->F, "\t}\n\tif (Len - Off < %u) {\n",
+			(unsigned)Bytes);
+		EmitError(G, "\t", "PacketTooShort");
+		fprintf(G->F, "\t}\n\tswitch (n_%s) {\n", Var);
+		for (I = 0; I < S->Size; I++) {
+			fprintf(G->F, "\tcase %u:\n", (unsigned)I);
+			EmitHeaderFields(G, S->Headers[I], "\t\t");
+			fprintf(G->F, "\t\tbreak;\n");
+		}
+		fprintf(G->F, "\t}\n\tn_%s++;\n\tOff += %u;\n", Var,
+			(unsigned)Bytes);
+		break;
+
+	case P4P_EXTRACT_VL:
+		T = HType(G, Op->Header);
+		if (T->VarField != T->NumFields - 1 || T->FixedBits % 8 != 0) {
+			GenFail(G, "varbit field must be the last field",
+				Prog->Headers[Op->Header].Name);
+			return;
+		}
+		Bytes = T->FixedBits / 8;
+		fprintf(G->F, "\tVlBits = (uint32_t)");
+		EmitExpr(G, Op->Expr);
+		fprintf(G->F, ";\n\tif ((VlBits & 7) != 0 || VlBits > %u) {\n",
+			(unsigned)(T->Fields[T->VarField].MaxBytes * 8));
+		EmitError(G, "\t", "HeaderTooShort");
+		fprintf(G->F, "\t}\n\tif (Len - Off < ");
+		if (Bytes != 0) {
+			fprintf(G->F, "%u + ", (unsigned)Bytes);
+		}
+		fprintf(G->F, "(VlBits >> 3)) {\n");
+		EmitError(G, "\t", "PacketTooShort");
+		fprintf(G->F, "\t}\n");
+		EmitHeaderFields(G, Op->Header, "\t");
+		fprintf(G->F, "\tOff += ");
+		if (Bytes != 0) {
+			fprintf(G->F, "%u + ", (unsigned)Bytes);
+		}
+		fprintf(G->F, "VlBits >> 3;\n");
+		break;
+
+	case P4P_SET:
+		FieldVar(Var, G, Op->Header, Op->Field);
+		if (!G->UsedField[Prog->Headers[Op->Header].ValueBase +
+				  Op->Field]) {
+			break;
+		}
+		fprintf(G->F, "\t%s = ", Var);
+		EmitExpr(G, Op->Expr);
+		fprintf(G->F, " & UINT64_C(0x%" PRIx64 ");\n",
+			WidthMask(HType(G, Op->Header)->Fields[Op->Field].Width));
+		break;
+
+	case P4P_VERIFY:
+		fprintf(G->F, "\tif (!(");
+		EmitExpr(G, Op->Expr);
+		fprintf(G->F, ")) {\n\t\tErr = (uint32_t)");
+		EmitExpr(G, Op->Error);
+		fprintf(G->F, ";\n\t\tgoto Parsed;\n\t}\n");
+		break;
+	}
+}
+
+static void EmitGotoState(P4Gen *G, const char *Indent, uint32_t State)
+{
+	char Name[P4GEN_NAME_MAX];
+
+	if (State == P4_NONE) {
+		fprintf(G->F, "%sgoto Parsed;\n", Indent);
+		return;
+	}
+	CName(Name, G->Prog->States[State].Name);
+	fprintf(G->F, "%sgoto S_%s;\n", Indent, Name);
+}
+
+static void EmitTransitions(P4Gen *G, const P4ParseState *S)
+{
+	uint64_t Full = WidthMask(S->KeyBits);
+	uint32_t Bits = 0;
+	uint32_t I;
+	uint32_t J;
+	int Masked = 0;
+
+	if (S->NumTransitions > 0 && S->Transitions[0].IsDefault) {
+		EmitGotoState(G, "\t", S->Transitions[0].Next);
+		return;
+	}
+
+	fprintf(G->F, "\tKey = ");
+	for (I = 0; I < S->NumKeys; I++) {
+		Bits += S->Keys[I]->Width;
+		fprintf(G->F, "%s((", I ? " |\n\t      " : "");
+		EmitExpr(G, S->Keys[I]);
+		fprintf(G->F, " & UINT64_C(0x%" PRIx64 ")) << %u)",
+			WidthMask(S->Keys[I]->Width),
+			(unsigned)(S->KeyBits - Bits));
+	}
+	fprintf(G->F, "%s;\n", S->NumKeys ? "" : "0");
+
+	for (I = 0; I < S->NumTransitions && !S->Transitions[I].IsDefault;
+	     I++) {
+		Masked |= (S->Transitions[I].Mask != Full);
+	}
+
+	if (!Masked) {
+		fprintf(G->F, "\tswitch (Key) {\n");
+		for (I = 0; I < S->NumTransitions; I++) {
+			const P4Transition *T = &S->Transitions[I];
+			int Dup = 0;
+
+			if (T->IsDefault) {
+				break;
+			}
+			for (J = 0; J < I; J++) {
+				Dup |= (S->Transitions[J].Value == T->Value);
+			}
+			if (Dup) {
+				continue;
+			}
+			fprintf(G->F, "\tcase UINT64_C(0x%" PRIx64 "):\n",
+				T->Value);
+			EmitGotoState(G, "\t\t", T->Next);
+		}
+		fprintf(G->F, "\tdefault:\n");
+		if (I < S->NumTransitions) {
+			EmitGotoState(G, "\t\t", S->Transitions[I].Next);
+		} else {
+			EmitError(G, "\t", "NoMatch");
+		}
+		fprintf(G->F, "\t}\n");
+		return;
+	}
+
+	for (I = 0; I < S->NumTransitions; I++) {
+		const P4Transition *T = &S->Transitions[I];
+
+		if (T->IsDefault) {
+			EmitGotoState(G, "\t", T->Next);
+			return;
+		}
+		fprintf(G->F, "\tif ((Key & UINT64_C(0x%" PRIx64 ")) == "
+			"UINT64_C(0x%" PRIx64 ")) {\n", T->Mask, T->Value);
+		EmitGotoState(G, "\t\t", T->Next);
+		fprintf(G->F, "\t}\n");
+	}
+	fprintf(G->F, "\t{\n");
+	EmitError(G, "\t", "NoMatch");
+	fprintf(G->F, "\t}\n");
+}
+
+static void EmitParser(P4Gen *G)
+{
+	const P4Program *Prog = G->Prog;
+	uint8_t *Referenced = calloc(Prog->NumStates + 1, 1);
+	char Name[P4GEN_NAME_MAX];
+	uint32_t I;
+	uint32_t J;
+
+	Referenced[Prog->InitState] = 1;
+	for (I = 0; I < Prog->NumStates; I++) {
+		for (J = 0; J < Prog->States[I].NumTransitions; J++) {
+			uint32_t Next = Prog->States[I].Transitions[J].Next;
+
+			if (Next != P4_NONE) {
+				Referenced[Next] = 1;
+			}
+		}
+	}
+
+	fprintf(G->F, "\t/* Parser */\n");
+	EmitGotoState(G, "\t", Prog->InitState);
+	for (I = 0; I < Prog->NumStates && !G->Failed; I++) {
+		const P4ParseState *S = &Prog->States[I];
+
+		if (!Referenced[I]) {
+			continue;
+		}
+		CName(Name, S->Name);
+		fprintf(G->F, "\nS_%s:\n\tif (++Steps > %u) {\n", Name,
+			P4_MAX_PARSE_STEPS);
+		EmitError(G, "\t", "ParserTimeout");
+		fprintf(G->F, "\t}\n");
+		for (J = 0; J < S->NumOps; J++) {
+			EmitParserOp(G, &S->Ops[J]);
+		}
+		EmitTransitions(G, S);
+	}
+	free(Referenced);
+}
+
+/*****************************************************************************/
+/*
+ * Pipeline
+ */
+static void EmitGotoNode(P4Gen *G, const char *Indent, uint32_t Node)
+{
+	const P4Program *Prog = G->Prog;
+	char Name[P4GEN_NAME_MAX];
+
+	if (Node == P4_NONE) {
+		fprintf(G->F, "%sgoto Done;\n", Indent);
+		return;
+	}
+	if (P4_NODE_IS_COND(Node)) {
+		CName(Name, Prog->Conds[P4_NODE_INDEX(Node)].Name);
+		fprintf(G->F, "%sgoto C_%s;\n", Indent, Name);
+	} else {
+		CName(Name, Prog->Tables[P4_NODE_INDEX(Node)].Name);
+		fprintf(G->F, "%sgoto T_%s;\n", Indent, Name);
+	}
+}
+
+static void KeyLayout(const P4Table *Tbl, P4GenKeyLayout *L)
+{
+	uint32_t Used = 0;
+	uint32_t Start = 0;
+	uint32_t K;
+	uint32_t J;
+
+	L->NumWords = 0;
+	for (K = 0; K <= Tbl->NumKeys; K++) {
+		/* Close the current word before K if K does not fit */
+		if (K == Tbl->NumKeys || (K > Start &&
+					  Used + Tbl->KeyWidth[K] > 64)) {
+			uint32_t Shift = 0;
+
+			for (J = K; J-- > Start;) {
+				L->Word[J] = L->NumWords;
+				L->Shift[J] = Shift;
+				Shift += Tbl->KeyWidth[J];
+			}
+			L->NumWords++;
+			Start = K;
+			Used = 0;
+		}
+		if (K < Tbl->NumKeys) {
+			Used += Tbl->KeyWidth[K];
+		}
+	}
+	if (Tbl->NumKeys == 0) {
+		L->NumWords = 1;
+	}
+}
+
+static uint32_t TableParams(const P4Program *Prog, const P4Table *Tbl)
+{
+	uint32_t Max = 1;
+	uint32_t I;
+
+	for (I = 0; I < Tbl->NumActions; I++) {
+		if (Prog->Actions[Tbl->Actions[I]].NumParams > Max) {
+			Max = Prog->Actions[Tbl->Actions[I]].NumParams;
+		}
+	}
+	return Max;
+}
+
+/*
+ * The bucket update runs whether or not the color is used, as it would in
+ * the pipeline. An absent meter array colors everything green.
+ */
+static void EmitMeter(P4Gen *G, const P4Primitive *P, const char *Indent)
+{
+	const P4Program *Prog = G->Prog;
+	const P4MeterArray *M = &Prog->Meters[P->Extern];
+	char Arr[P4GEN_NAME_MAX];
+	char Dst[P4GEN_NAME_MAX];
+	char Now[P4GEN_NAME_MAX] = "0";
+	int UseDst = G->UsedField[Prog->Headers[P->Header].ValueBase +
+				  P->Field];
+
+	CamelName(Arr, ShortName(M->Name));
+	FieldVar(Dst, G, P->Header, P->Field);
+	if (Prog->TimestampField != P4_NONE) {
+		FieldVar(Now, G, Prog->StdMetaHeader, Prog->TimestampField);
+	}
+
+	if (UseDst) {
+		fprintf(G->F, "%s%s = %s_COLOR_GREEN;\n", Indent, Dst,
+			G->Macro);
+	}
+	fprintf(G->F, "%sif (Tables->%s != 0) {\n%s\tuint64_t Idx = ",
+		Indent, Arr, Indent);
+	EmitExpr(G, P->Src);
+	fprintf(G->F, ";\n\n%s\tif (Idx < %u) {\n%s\t\t", Indent,
+		(unsigned)M->Size, Indent);
+	if (UseDst) {
+		fprintf(G->F, "%s = ", Dst);
+	} else {
+		fprintf(G->F, "(void)");
+	}
+	fprintf(G->F, "%sMeterColor(&Tables->%s[Idx],\n%s\t\t\t%s, %u, %s);\n"
+		"%s\t}\n%s}\n", G->Prefix, Arr, Indent,
+		M->Packets ? "1" : "8 * (uint64_t)Len", M->Packets ? 1 : 8,
+		Now, Indent, Indent);
+}
+
+static void EmitAction(P4Gen *G, uint32_t ActionId, const char *Indent)
+{
+	const P4Program *Prog = G->Prog;
+	const P4Action *A = &Prog->Actions[ActionId];
+	char Var[P4GEN_NAME_MAX];
+	uint32_t I;
+
+	for (I = 0; I < A->NumPrims; I++) {
+		const P4Primitive *P = &A->Prims[I];
+
+		switch (P->Kind) {
+		case P4A_ASSIGN:
+			if (!G->UsedField[Prog->Headers[P->Header].ValueBase +
+					  P->Field]) {
+				break;
+			}
+			FieldVar(Var, G, P->Header, P->Field);
+			fprintf(G->F, "%s%s = ", Indent, Var);
+			EmitExpr(G, P->Src);
+			fprintf(G->F, " & UINT64_C(0x%" PRIx64 ");\n", WidthMask(
+				HType(G, P->Header)->Fields[P->Field].Width));
+			break;
+		case P4A_DROP:
+			if (Prog->DropField != P4_NONE) {
+				FieldVar(Var, G, Prog->StdMetaHeader,
+					 Prog->DropField);
+				fprintf(G->F, "%s%s = 1;\n", Indent, Var);
+			}
+			break;
+		case P4A_ADD_HEADER:
+		case P4A_REMOVE_HEADER:
+			/* Only validity is visible to the classifier */
+			if (G->UsedValid[P->Header]) {
+				CName(Var, Prog->Headers[P->Header].Name);
+				fprintf(G->F, "%sv_%s = %d;\n", Indent, Var,
+					P->Kind == P4A_ADD_HEADER);
+			}
+			break;
+		case P4A_COUNT:
+			CamelName(Var, ShortName(Prog->Counters[P->Extern].Name));
+			fprintf(G->F, "%sif (Tables->%s != 0) {\n%s\tuint64_t Idx = ",
+				Indent, Var, Indent);
+			EmitExpr(G, P->Src);
+			fprintf(G->F, ";\n\n%s\tif (Idx < %u) {\n"
+				"%s\t\tTables->%s[Idx].Packets++;\n"
+				"%s\t\tTables->%s[Idx].Bytes += Len;\n%s\t}\n%s}\n",
+				Indent, (unsigned)Prog->Counters[P->Extern].Size,
+				Indent, Var, Indent, Var, Indent, Indent);
+			break;
+		case P4A_METER:
+			EmitMeter(G, P, Indent);
+			break;
+		}
+	}
+}
+
+static void EmitTable(P4Gen *G, uint32_t Index)
+{
+	const P4Program *Prog = G->Prog;
+	const P4Table *Tbl = &Prog->Tables[Index];
+	char Label[P4GEN_NAME_MAX];
+	char Camel[P4GEN_NAME_MAX];
+	char Macro[P4GEN_NAME_MAX];
+	P4GenKeyLayout L;
+	uint32_t W;
+	uint32_t K;
+	uint32_t I;
+
+	CName(Label, Tbl->Name);
+	CamelName(Camel, ShortName(Tbl->Name));
+	KeyLayout(Tbl, &L);
+
+	fprintf(G->F, "\nT_%s: {\n", Label);
+	fprintf(G->F, "\tconst %s%sEntry *E = Tables->%s.Entries;\n",
+		G->Prefix, Camel, Camel);
+	fprintf(G->F, "\tconst %s%sEntry *End = E + Tables->%s.NumEntries;\n",
+		G->Prefix, Camel, Camel);
+	fprintf(G->F, "\tconst uint64_t *Prm = %s%sDefaultParams;\n",
+		G->Prefix, Camel);
+	fprintf(G->F, "\tuint32_t Act = %u;\n",
+		(unsigned)(Tbl->DefaultAction == P4_NONE ? UINT32_MAX :
+			   Tbl->DefaultAction));
+	fprintf(G->F, "\tuint64_t K[%u];\n\n", (unsigned)L.NumWords);
+
+	for (W = 0; W < L.NumWords; W++) {
+		int First = 1;
+
+		fprintf(G->F, "\tK[%u] = ", (unsigned)W);
+		for (K = 0; K < Tbl->NumKeys; K++) {
+			if (L.Word[K] != W) {
+				continue;
+			}
+			fprintf(G->F, "%s((", First ? "" : " |\n\t       ");
+			EmitExpr(G, Tbl->Keys[K]);
+			fprintf(G->F, " & UINT64_C(0x%" PRIx64 ")) << %u)",
+				WidthMask(Tbl->KeyWidth[K]),
+				(unsigned)L.Shift[K]);
+			First = 0;
+		}
+		fprintf(G->F, "%s;\n", First ? "0" : "");
+	}
+
+	fprintf(G->F, "\tfor (; E < End; E++) {\n\t\tif (");
+	for (W = 0; W < L.NumWords; W++) {
+		fprintf(G->F, "%s(K[%u] & E->Mask[%u]) == E->Value[%u]",
+			W ? " &&\n\t\t    " : "", (unsigned)W, (unsigned)W,
+			(unsigned)W);
+	}
+	fprintf(G->F, ") {\n\t\t\tAct = E->Action;\n\t\t\tPrm = E->Params;"
+		"\n\t\t\tbreak;\n\t\t}\n\t}\n");
+	fprintf(G->F, "\t(void)Prm;\n\tswitch (Act) {\n");
+
+	for (I = 0; I < Tbl->NumActions; I++) {
+		MacroName(Macro, ShortName(Prog->Actions[Tbl->Actions[I]].Name));
+		fprintf(G->F, "\tcase %s_ACTION_%s:\n", G->Macro, Macro);
+		EmitAction(G, Tbl->Actions[I], "\t\t");
+		EmitGotoNode(G, "\t\t", Tbl->ActionNext[I]);
+	}
+	fprintf(G->F, "\tdefault:\n");
+	EmitGotoNode(G, "\t\t", Tbl->BaseDefaultNext);
+	fprintf(G->F, "\t}\n}\n");
+}
+
+static void MarkNode(uint8_t *Referenced, uint32_t Node)
+{
+	if (Node != P4_NONE) {
+		Referenced[Node] = 1;
+	}
+}
+
+static void EmitPipeline(P4Gen *G)
+{
+	const P4Program *Prog = G->Prog;
+	uint32_t NumNodes = 2 * (Prog->NumTables + Prog->NumConds) + 2;
+	uint8_t *Referenced = calloc(NumNodes, 1);
+	char Name[P4GEN_NAME_MAX];
+	uint32_t I;
+	uint32_t J;
+
+	/* Labels nobody jumps to would trip -Wunused-label */
+	MarkNode(Referenced, Prog->InitNode);
+	for (I = 0; I < Prog->NumTables; I++) {
+		for (J = 0; J < Prog->Tables[I].NumActions; J++) {
+			MarkNode(Referenced, Prog->Tables[I].ActionNext[J]);
+		}
+		MarkNode(Referenced, Prog->Tables[I].BaseDefaultNext);
+	}
+	for (I = 0; I < Prog->NumConds; I++) {
+		MarkNode(Referenced, Prog->Conds[I].TrueNext);
+		MarkNode(Referenced, Prog->Conds[I].FalseNext);
+	}
+
+	fprintf(G->F, "\n\t/* Ingress pipeline */\n");
+	EmitGotoNode(G, "\t", Prog->InitNode);
+	for (I = 0; I < Prog->NumTables && !G->Failed; I++) {
+		if (Referenced[P4_NODE_TABLE(I)]) {
+			EmitTable(G, I);
+		}
+	}
+	for (I = 0; I < Prog->NumConds && !G->Failed; I++) {
+		const P4Cond *C = &Prog->Conds[I];
+
+		if (!Referenced[P4_NODE_COND(I)]) {
+			continue;
+		}
+
+		CName(Name, C->Name);
+		fprintf(G->F, "\nC_%s:\n\tif (", Name);
+		EmitExpr(G, C->Expr);
+		fprintf(G->F, ") {\n");
+		EmitGotoNode(G, "\t\t", C->TrueNext);
+		fprintf(G->F, "\t}\n");
+		EmitGotoNode(G, "\t", C->FalseNext);
+	}
+	free(Referenced);
+}
+
+/*****************************************************************************/
+/*
+ * Declarations
+ */
+static void EmitTypes(P4Gen *G)
+{
+	static const struct {
+		const char *Name;
+		uint32_t Code;
+	} CoreErrors[] = {
+		{ "PacketTooShort", 1 }, { "NoMatch", 2 },
+		{ "StackOutOfBounds", 3 }, { "HeaderTooShort", 4 },
+		{ "ParserTimeout", 5 },
+	};
+	const P4Program *Prog = G->Prog;
+	char Name[P4GEN_NAME_MAX];
+	char Camel[P4GEN_NAME_MAX];
+	uint32_t I;
+	uint32_t J;
+
+	fprintf(G->F, "/* Parser error codes (standard_metadata.parser_error) */\n");
+	for (I = 0; I < Prog->NumErrors; I++) {
+		MacroName(Name, Prog->ErrorNames[I]);
+		fprintf(G->F, "#define %s_ERR_%s\t%u\n", G->Macro, Name,
+			(unsigned)Prog->ErrorCodes[I]);
+	}
+	/* Core errors the generated parser raises, as p4sim numbers them */
+	for (I = 0; I < sizeof(CoreErrors) / sizeof(CoreErrors[0]); I++) {
+		if (P4ErrorCode(Prog, CoreErrors[I].Name) == P4_NONE) {
+			MacroName(Name, CoreErrors[I].Name);
+			fprintf(G->F, "#define %s_ERR_%s\t%u\n", G->Macro, Name,
+				(unsigned)CoreErrors[I].Code);
+		}
+	}
+	fprintf(G->F, "\n/* Action ids, as used by the SDNet table driver */\n");
+	for (I = 0; I < Prog->NumActions; I++) {
+		MacroName(Name, ShortName(Prog->Actions[I].Name));
+		fprintf(G->F, "#define %s_ACTION_%s\t%u\n", G->Macro, Name,
+			(unsigned)I);
+	}
+
+	fprintf(G->F,
+		"\n/*\n * Metadata in and out of the pipeline. Zero it and set"
+		" the sideband\n * inputs (e.g. the ingress port) before"
+		" calling %s.\n */\ntypedef struct {\n", G->Prefix);
+	for (I = 0; I < Prog->NumHeaders; I++) {
+		for (J = 0; J < HType(G, I)->NumFields; J++) {
+			if (IsMetaField(G, I, J)) {
+				MetaMember(Name, G, I, J);
+				fprintf(G->F, "\t%s %s;\n",
+					CType(HType(G, I)->Fields[J].Width), Name);
+			}
+		}
+	}
+	fprintf(G->F, "} %sMeta;\n", G->Prefix);
+
+	for (I = 0; I < Prog->NumTables; I++) {
+		const P4Table *Tbl = &Prog->Tables[I];
+		P4GenKeyLayout L;
+
+		KeyLayout(Tbl, &L);
+		CamelName(Camel, ShortName(Tbl->Name));
+		fprintf(G->F,
+			"\n/*\n * %s entries, in priority order (first match"
+			" wins).\n * The key fields are packed MSB first into"
+			" 64-bit words:", Tbl->Name);
+		for (J = 0; J < Tbl->NumKeys; J++) {
+			fprintf(G->F, "\n *   word %u bits %u..%u: ",
+				(unsigned)L.Word[J],
+				(unsigned)(L.Shift[J] + Tbl->KeyWidth[J] - 1),
+				(unsigned)L.Shift[J]);
+			if (Tbl->Keys[J]->Kind == P4E_OP) {
+				fprintf(G->F, "masked ");
+			}
+			if (Tbl->Keys[J]->Kind == P4E_VALID) {
+				fprintf(G->F, "%s.$valid$",
+					Prog->Headers[Tbl->Keys[J]->Header].Name);
+			} else if (Tbl->Keys[J]->Kind == P4E_FIELD) {
+				fprintf(G->F, "%s.%s",
+					Prog->Headers[Tbl->Keys[J]->Header].Name,
+					HType(G, Tbl->Keys[J]->Header)->Fields[
+						Tbl->Keys[J]->Field].Name);
+			} else {
+				fprintf(G->F, "key %u", (unsigned)J);
+			}
+		}
+		fprintf(G->F,
+			"\n * Value must already be masked.\n */\n"
+			"typedef struct {\n\tuint64_t Value[%u];\n"
+			"\tuint64_t Mask[%u];\n\tuint32_t Action;\n"
+			"\tuint64_t Params[%u];\n} %s%sEntry;\n\n"
+			"typedef struct {\n\tuint32_t NumEntries;\n"
+			"\tconst %s%sEntry *Entries;\n} %s%sTable;\n",
+			(unsigned)L.NumWords, (unsigned)L.NumWords,
+			(unsigned)TableParams(Prog, Tbl), G->Prefix, Camel,
+			G->Prefix, Camel, G->Prefix, Camel);
+	}
+
+	if (Prog->NumCounters != 0) {
+		fprintf(G->F,
+			"\n/* One counter extern cell */\ntypedef struct {\n"
+			"\tuint64_t Packets;\n\tuint64_t Bytes;\n} %sCounter;\n\n",
+			G->Prefix);
+		for (I = 0; I < Prog->NumCounters; I++) {
+			MacroName(Name, ShortName(Prog->Counters[I].Name));
+			fprintf(G->F, "#define %s_%s_SIZE\t%u\n", G->Macro, Name,
+				(unsigned)Prog->Counters[I].Size);
+		}
+	}
+
+	if (Prog->NumMeters != 0) {
+		fprintf(G->F,
+			"\n/*\n * One two-rate three-color meter cell. The caller"
+			" sets Cir/Pir (bit/s,\n * or packet/s for packet meters)"
+			" and Cbs/Pbs (bytes or packets); the\n * rest is bucket"
+			" state and starts zeroed. Pir == 0 colors everything\n"
+			" * green.\n */\ntypedef struct {\n"
+			"\tuint64_t Cir;\n\tuint64_t Cbs;\n\tuint64_t Pir;\n"
+			"\tuint64_t Pbs;\n\tuint64_t Tc;\n\tuint64_t Tp;\n"
+			"\tuint64_t Last;\n\tuint32_t Primed;\n} %sMeter;\n\n"
+			"#define %s_COLOR_GREEN\t%u\n#define %s_COLOR_YELLOW\t%u\n"
+			"#define %s_COLOR_RED\t%u\n",
+			G->Prefix, G->Macro, P4_COLOR_GREEN, G->Macro,
+			P4_COLOR_YELLOW, G->Macro, P4_COLOR_RED);
+		for (I = 0; I < Prog->NumMeters; I++) {
+			MacroName(Name, ShortName(Prog->Meters[I].Name));
+			fprintf(G->F, "#define %s_%s_SIZE\t%u\n", G->Macro, Name,
+				(unsigned)Prog->Meters[I].Size);
+		}
+	}
+
+	fprintf(G->F,
+		"\n/*\n * Everything the pipeline matches against or updates."
+		" Counter and meter\n * arrays may be left null to skip counting"
+		" and metering.\n */\n"
+		"typedef struct {\n");
+	for (I = 0; I < Prog->NumTables; I++) {
+		CamelName(Camel, ShortName(Prog->Tables[I].Name));
+		fprintf(G->F, "\t%s%sTable %s;\n", G->Prefix, Camel, Camel);
+	}
+	for (I = 0; I < Prog->NumCounters; I++) {
+		CamelName(Camel, ShortName(Prog->Counters[I].Name));
+		fprintf(G->F, "\t%sCounter *%s;\n", G->Prefix, Camel);
+	}
+	for (I = 0; I < Prog->NumMeters; I++) {
+		CamelName(Camel, ShortName(Prog->Meters[I].Name));
+		fprintf(G->F, "\t%sMeter *%s;\n", G->Prefix, Camel);
+	}
+	fprintf(G->F, "} %sTables;\n", G->Prefix);
+}
+
+static void EmitDefaults(P4Gen *G)
+{
+	const P4Program *Prog = G->Prog;
+	char Camel[P4GEN_NAME_MAX];
+	char Macro[P4GEN_NAME_MAX];
+	uint32_t I;
+	uint32_t J;
+	uint32_t K;
+
+	for (I = 0; I < Prog->NumTables; I++) {
+		const P4Table *Tbl = &Prog->Tables[I];
+		uint32_t NumParams = TableParams(Prog, Tbl);
+		P4GenKeyLayout L;
+
+		KeyLayout(Tbl, &L);
+		CamelName(Camel, ShortName(Tbl->Name));
+
+		fprintf(G->F, "\nstatic const uint64_t %s%sDefaultParams[%u] = {",
+			G->Prefix, Camel, (unsigned)NumParams);
+		for (J = 0; J < NumParams; J++) {
+			fprintf(G->F, "%s0x%" PRIx64, J ? ", " : " ",
+				Tbl->DefaultParams[J]);
+		}
+		fprintf(G->F, " };\n");
+
+		if (Tbl->NumEntries == 0) {
+			continue;
+		}
+		fprintf(G->F, "\nstatic const %s%sEntry %s%sDefaults[%u] = {\n",
+			G->Prefix, Camel, G->Prefix, Camel,
+			(unsigned)Tbl->NumEntries);
+		for (J = 0; J < Tbl->NumEntries; J++) {
+			const P4Entry *E = &Tbl->Entries[J];
+			uint64_t Value[P4GEN_MAX_WORDS] = { 0 };
+			uint64_t Mask[P4GEN_MAX_WORDS] = { 0 };
+			uint32_t W;
+
+			for (K = 0; K < Tbl->NumKeys; K++) {
+				Value[L.Word[K]] |= (E->Key[K] & E->Mask[K]) <<
+						    L.Shift[K];
+				Mask[L.Word[K]] |= E->Mask[K] << L.Shift[K];
+			}
+			MacroName(Macro, ShortName(Prog->Actions[E->Action].Name));
+			fprintf(G->F, "\t/* priority %u */\n\t{ {",
+				(unsigned)E->Priority);
+			for (W = 0; W < L.NumWords; W++) {
+				fprintf(G->F, "%s0x%" PRIx64, W ? ", " : " ",
+					Value[W]);
+			}
+			fprintf(G->F, " }, {");
+			for (W = 0; W < L.NumWords; W++) {
+				fprintf(G->F, "%s0x%" PRIx64, W ? ", " : " ",
+					Mask[W]);
+			}
+			fprintf(G->F, " },\n\t  %s_ACTION_%s, {", G->Macro,
+				Macro);
+			for (K = 0; K < NumParams; K++) {
+				fprintf(G->F, "%s0x%" PRIx64, K ? ", " : " ",
+					E->Params[K]);
+			}
+			fprintf(G->F, " } },\n");
+		}
+		fprintf(G->F, "};\n");
+	}
+
+	fprintf(G->F, "\n/* Tables as loaded by p4gen -e */\n"
+		"static const %sTables %sDefaultTables = {\n", G->Prefix,
+		G->Prefix);
+	for (I = 0; I < Prog->NumTables; I++) {
+		CamelName(Camel, ShortName(Prog->Tables[I].Name));
+		if (Prog->Tables[I].NumEntries == 0) {
+			fprintf(G->F, "\t{ 0, 0 },\n");
+		} else {
+			fprintf(G->F, "\t{ %u, %s%sDefaults },\n",
+				(unsigned)Prog->Tables[I].NumEntries, G->Prefix,
+				Camel);
+		}
+	}
+	for (I = 0; I < Prog->NumCounters + Prog->NumMeters; I++) {
+		fprintf(G->F, "\t0,\n");
+	}
+	fprintf(G->F, "};\n");
+}
+
+static void EmitHelpers(P4Gen *G)
+{
+	fprintf(G->F,
+		"\n/* Big-endian load of N (1..8) bytes */\n"
+		"static inline uint64_t %sLoad(const uint8_t *P, unsigned N)\n"
+		"{\n\tuint64_t V = 0;\n\tunsigned I;\n\n"
+		"\tfor (I = 0; I < N; I++) {\n\t\tV = (V << 8) | P[I];\n\t}\n"
+		"\treturn V;\n}\n", G->Prefix);
+	fprintf(G->F,
+		"\nstatic inline uint64_t %sShl(uint64_t A, uint64_t B)\n"
+		"{\n\treturn (B >= 64) ? 0 : A << B;\n}\n"
+		"\nstatic inline uint64_t %sShr(uint64_t A, uint64_t B)\n"
+		"{\n\treturn (B >= 64) ? 0 : A >> B;\n}\n",
+		G->Prefix, G->Prefix);
+
+	if (G->Prog->NumMeters == 0) {
+		return;
+	}
+	/* Same arithmetic as P4MeterColor in p4sim.c */
+	fprintf(G->F,
+		"\nstatic inline void %sRefill(uint64_t *T, uint64_t Rate,"
+		" uint64_t Cap,\n\t\tuint64_t Dt)\n{\n"
+		"\tif (*T >= Cap || Rate == 0) {\n\t\treturn;\n\t}\n"
+		"\t*T = (Dt > (Cap - *T) / Rate) ? Cap : *T + Rate * Dt;\n}\n",
+		G->Prefix);
+	fprintf(G->F,
+		"\n/*\n * RFC 2698 color-blind marking. Size is the frame in"
+		" bits or packets,\n * Unit what one burst unit is in the same"
+		" terms, Now the time in ns.\n */\n"
+		"static inline uint64_t %sMeterColor(%sMeter *M,\n"
+		"\t\tuint64_t Size, uint64_t Unit, uint64_t Now)\n{\n"
+		"\tconst uint64_t NsPerS = UINT64_C(1000000000);\n"
+		"\tuint64_t Cbs = M->Cbs * Unit * NsPerS;\n"
+		"\tuint64_t Pbs = M->Pbs * Unit * NsPerS;\n"
+		"\tuint64_t Dt = 0;\n\n"
+		"\tif (M->Pir == 0) {\n\t\treturn %s_COLOR_GREEN;\n\t}\n"
+		"\tSize *= NsPerS;\n"
+		"\tif (!M->Primed) {\n\t\tM->Tc = Cbs;\n\t\tM->Tp = Pbs;\n"
+		"\t\tM->Primed = 1;\n\t} else if (Now > M->Last) {\n"
+		"\t\tDt = Now - M->Last;\n\t}\n\tM->Last = Now;\n"
+		"\t%sRefill(&M->Tc, M->Cir, Cbs, Dt);\n"
+		"\t%sRefill(&M->Tp, M->Pir, Pbs, Dt);\n\n"
+		"\tif (M->Tp < Size) {\n\t\treturn %s_COLOR_RED;\n\t}\n"
+		"\tM->Tp -= Size;\n"
+		"\tif (M->Tc < Size) {\n\t\treturn %s_COLOR_YELLOW;\n\t}\n"
+		"\tM->Tc -= Size;\n\treturn %s_COLOR_GREEN;\n}\n",
+		G->Prefix, G->Prefix, G->Macro, G->Prefix, G->Prefix, G->Macro,
+		G->Macro, G->Macro);
+}
+
+static void EmitFunction(P4Gen *G)
+{
+	const P4Program *Prog = G->Prog;
+	char Var[P4GEN_NAME_MAX];
+	char Member[P4GEN_NAME_MAX];
+	uint32_t I;
+	uint32_t J;
+
+	fprintf(G->F,
+		"\n/*\n * Runs a frame through the parser and the ingress"
+		" pipeline.\n *\n * Pkt/Len is the frame from the destination"
+		" MAC on, Tables the entries\n * to match (%sDefaultTables or"
+		" the caller's), Meta the metadata\n * in and out. Returns the"
+		" parser error code, also left in\n * Meta->parser_error when"
+		" the program declares that field.\n */\n"
+		"static inline uint32_t %s(const uint8_t *Pkt, uint32_t Len,\n"
+		"\t\tconst %sTables *Tables, %sMeta *Meta)\n{\n",
+		G->Prefix, G->Prefix, G->Prefix, G->Prefix);
+
+	fprintf(G->F, "\tuint32_t Off = 0;\n\tuint32_t Err = 0;\n"
+		"\tuint32_t Steps = 0;\n\tuint64_t Key;\n");
+	if (G->UsesVarbit) {
+		fprintf(G->F, "\tuint32_t VlBits;\n");
+	}
+	for (I = 0; I < Prog->NumStacks; I++) {
+		CName(Var, Prog->Stacks[I].Name);
+		fprintf(G->F, "\tuint32_t n_%s = 0;\n", Var);
+	}
+	for (I = 0; I < Prog->NumHeaders; I++) {
+		if (G->UsedValid[I]) {
+			CName(Var, Prog->Headers[I].Name);
+			fprintf(G->F, "\tuint8_t v_%s = %d;\n", Var,
+				Prog->Headers[I].Metadata ||
+				strcmp(Prog->Headers[I].Name, "scalars") == 0);
+		}
+		for (J = 0; J < HType(G, I)->NumFields; J++) {
+			if (!G->UsedField[Prog->Headers[I].ValueBase + J]) {
+				continue;
+			}
+			FieldVar(Var, G, I, J);
+			if (IsMetaField(G, I, J)) {
+				MetaMember(Member, G, I, J);
+				fprintf(G->F, "\tuint64_t %s = Meta->%s & "
+					"UINT64_C(0x%" PRIx64 ");\n", Var, Member,
+					WidthMask(HType(G, I)->Fields[J].Width));
+			} else {
+				fprintf(G->F, "\tuint64_t %s = 0;\n", Var);
+			}
+		}
+	}
+	fprintf(G->F, "\n\t(void)Key;\n\n");
+
+	EmitParser(G);
+
+	fprintf(G->F, "\nParsed:\n");
+	if (Prog->ParserErrorField != P4_NONE) {
+		FieldVar(Var, G, Prog->StdMetaHeader, Prog->ParserErrorField);
+		fprintf(G->F, "\tif (Err != 0) {\n\t\t%s = Err & UINT64_C(0x%"
+			PRIx64 ");\n\t}\n", Var,
+			WidthMask(HType(G, Prog->StdMetaHeader)->Fields[
+				Prog->ParserErrorField].Width));
+	}
+
+	EmitPipeline(G);
+
+	fprintf(G->F, "\nDone:\n");
+	for (I = 0; I < Prog->NumHeaders; I++) {
+		for (J = 0; J < HType(G, I)->NumFields; J++) {
+			if (IsMetaField(G, I, J)) {
+				FieldVar(Var, G, I, J);
+				MetaMember(Member, G, I, J);
+				fprintf(G->F, "\tMeta->%s = (%s)%s;\n", Member,
+					CType(HType(G, I)->Fields[J].Width), Var);
+			}
+		}
+	}
+	fprintf(G->F, "\treturn Err;\n}\n");
+}
+
+static void Generate(P4Gen *G, const char *Source)
+{
+	fprintf(G->F,
+		"/******************************************************************************\n"
+		"* SPDX-License-Identifier: MIT\n"
+		"******************************************************************************/\n\n"
+		"/*\n * Generated by p4gen from %s. Do not edit; regenerate"
+		" after changing\n * the P4 program or the default entries.\n */\n"
+		"#ifndef %s_H\n#define %s_H\n\n#include <stdint.h>\n\n",
+		Source, G->Macro, G->Macro);
+
+	EmitTypes(G);
+	EmitDefaults(G);
+	EmitHelpers(G);
+	EmitFunction(G);
+
+	fprintf(G->F, "\n#endif /* %s_H */\n", G->Macro);
+}
+
+int main(int argc, char *argv[])
+{
+	const char *ProgPath = NULL;
+	const char *OutPath = NULL;
+	const char *Entries[16];
+	uint32_t NumEntries = 0;
+	P4Program Prog;
+	P4Gen G;
+	char Err[256];
+	uint32_t I;
+	int A;
+
+	memset(&G, 0, sizeof(G));
+	G.Prefix = "P4Classify";
+	for (A = 1; A + 1 < argc; A += 2) {
+		if (strcmp(argv[A], "-p") == 0) {
+			ProgPath = argv[A + 1];
+		} else if (strcmp(argv[A], "-e") == 0 && NumEntries < 16) {
+			Entries[NumEntries++] = argv[A + 1];
+		} else if (strcmp(argv[A], "-n") == 0) {
+			G.Prefix = argv[A + 1];
+		} else if (strcmp(argv[A], "-o") == 0) {
+			OutPath = argv[A + 1];
+		} else {
+			Usage();
+		}
+	}
+	if (A != argc || ProgPath == NULL) {
+		Usage();
+	}
+	MacroName(G.Macro, G.Prefix);
+
+	if (P4ProgramLoad(&Prog, ProgPath, Err, sizeof(Err)) != 0) {
+		fprintf(stderr, "p4gen: %s: %s\n", ProgPath, Err);
+		return 1;
+	}
+	for (I = 0; I < NumEntries; I++) {
+		if (P4LoadEntries(&Prog, Entries[I], Err, sizeof(Err)) != 0) {
+			fprintf(stderr, "p4gen: %s\n", Err);
+			return 1;
+		}
+	}
+
+	G.Prog = &Prog;
+	G.UsedField = calloc(Prog.NumValues + 1, 1);
+	G.UsedValid = calloc(Prog.NumHeaders + 1, 1);
+	G.F = (OutPath != NULL) ? fopen(OutPath, "w") : stdout;
+	if (G.UsedField == NULL || G.UsedValid == NULL || G.F == NULL) {
+		fprintf(stderr, "p4gen: cannot write %s\n",
+			OutPath ? OutPath : "output");
+		return 1;
+	}
+
+	MarkUsed(&G);
+	Generate(&G, strrchr(ProgPath, '/') ? strrchr(ProgPath, '/') + 1 :
+					      ProgPath);
+
+	if (G.F != stdout && fclose(G.F) != 0) {
+		G.Failed = 1;
+	}
+	if (G.Failed && OutPath != NULL) {
+		remove(OutPath);
+	}
+	free(G.UsedField);
+	free(G.UsedValid);
+	P4ProgramFree(&Prog);
+	return G.Failed ? 1 : 0;
+}
@@ -0,0 +1,1443 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file p4prog.c
+*
+* Loads main.json into a P4Program. Anything the interpreter cannot model
+* exactly is rejected here with a message naming the construct, rather
+* than being silently approximated at run time.
+*
+*****************************************************************************/
+
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "p4prog.h"
+
+typedef struct {
+	P4Program *Prog;
+	char *ErrBuf;
+	size_t ErrLen;
+	int Failed;
+} P4Loader;
+
+static void P4Fail(P4Loader *L, const char *Fmt, ...)
+{
+	va_list Args;
+
+	if (L->Failed) {
+		return;
+	}
+	L->Failed = 1;
+	va_start(Args, Fmt);
+	vsnprintf(L->ErrBuf, L->ErrLen, Fmt, Args);
+	va_end(Args);
+}
+
+static char *P4Strdup(const char *S)
+{
+	size_t N = strlen(S) + 1;
+	char *D = malloc(N);
+
+	if (D != NULL) {
+		memcpy(D, S, N);
+	}
+	return D;
+}
+
+static uint64_t P4WidthMask(uint32_t Width)
+{
+	return (Width >= 64) ? UINT64_MAX : ((1ULL << Width) - 1);
+}
+
+static int P4ParseHex(const char *S, uint64_t *ValuePtr)
+{
+	const char *Digits = S;
+	size_t N;
+	char *End;
+
+	if (S == NULL) {
+		return -1;
+	}
+	if (S[0] == '0' && (S[1] == 'x' || S[1] == 'X')) {
+		Digits = S + 2;
+	}
+	while (*Digits == '0' && Digits[1] != '\0') {
+		Digits++;
+	}
+	N = strlen(Digits);
+	if (N == 0 || N > 16) {
+		return -1;
+	}
+	*ValuePtr = strtoull(Digits, &End, 16);
+	return (*End == '\0') ? 0 : -1;
+}
+
+/*****************************************************************************/
+/*
+ * Name lookups
+ */
+uint32_t P4FindHeader(const P4Program *Prog, const char *Name)
+{
+	uint32_t I;
+
+	for (I = 0; I < Prog->NumHeaders; I++) {
+		if (strcmp(Prog->Headers[I].Name, Name) == 0) {
+			return I;
+		}
+	}
+	return P4_NONE;
+}
+
+static uint32_t P4FindStack(const P4Program *Prog, const char *Name)
+{
+	uint32_t I;
+
+	for (I = 0; I < Prog->NumStacks; I++) {
+		if (strcmp(Prog->Stacks[I].Name, Name) == 0) {
+			return I;
+		}
+	}
+	return P4_NONE;
+}
+
+static uint32_t P4FindFieldIndex(const P4HeaderType *Type, const char *Name)
+{
+	uint32_t I;
+
+	for (I = 0; I < Type->NumFields; I++) {
+		if (strcmp(Type->Fields[I].Name, Name) == 0) {
+			return I;
+		}
+	}
+	return P4_NONE;
+}
+
+/****************************************************************************/
+/**
+*
+* Resolves "header.field" to indices. The header part may itself contain
+* dots or brackets (e.g. "vlan[0].pcp"); the field is after the last dot.
+*
+* @return	0 on success, -1 if either part is unknown.
+*
+*****************************************************************************/
+int P4FindField(const P4Program *Prog, const char *Dotted,
+		uint32_t *HeaderPtr, uint32_t *FieldPtr)
+{
+	const char *Dot = strrchr(Dotted, '.');
+	char Header[128];
+	size_t N;
+
+	if (Dot == NULL || (N = (size_t)(Dot - Dotted)) >= sizeof(Header)) {
+		return -1;
+	}
+	memcpy(Header, Dotted, N);
+	Header[N] = '\0';
+
+	*HeaderPtr = P4FindHeader(Prog, Header);
+	if (*HeaderPtr == P4_NONE) {
+		return -1;
+	}
+	*FieldPtr = P4FindFieldIndex(
+		&Prog->HeaderTypes[Prog->Headers[*HeaderPtr].Type], Dot + 1);
+	return (*FieldPtr == P4_NONE) ? -1 : 0;
+}
+
+uint32_t P4FindTable(const P4Program *Prog, const char *Name)
+{
+	uint32_t I;
+	size_t N = strlen(Name);
+
+	for (I = 0; I < Prog->NumTables; I++) {
+		if (strcmp(Prog->Tables[I].Name, Name) == 0) {
+			return I;
+		}
+	}
+	/* Allow the control prefix to be left out ("plane_classify") */
+	for (I = 0; I < Prog->NumTables; I++) {
+		size_t M = strlen(Prog->Tables[I].Name);
+
+		if (M > N && Prog->Tables[I].Name[M - N - 1] == '.' &&
+		    strcmp(Prog->Tables[I].Name + M - N, Name) == 0) {
+			return I;
+		}
+	}
+	return P4_NONE;
+}
+
+uint32_t P4FindCounter(const P4Program *Prog, const char *Name)
+{
+	uint32_t I;
+	size_t N = strlen(Name);
+
+	for (I = 0; I < Prog->NumCounters; I++) {
+		size_t M = strlen(Prog->Counters[I].Name);
+
+		if (strcmp(Prog->Counters[I].Name, Name) == 0 ||
+		    (M > N && Prog->Counters[I].Name[M - N - 1] == '.' &&
+		     strcmp(Prog->Counters[I].Name + M - N, Name) == 0)) {
+			return I;
+		}
+	}
+	return P4_NONE;
+}
+
+uint32_t P4FindMeter(const P4Program *Prog, const char *Name)
+{
+	uint32_t I;
+	size_t N = strlen(Name);
+
+	for (I = 0; I < Prog->NumMeters; I++) {
+		size_t M = strlen(Prog->Meters[I].Name);
+
+		if (strcmp(Prog->Meters[I].Name, Name) == 0 ||
+		    (M > N && Prog->Meters[I].Name[M - N - 1] == '.' &&
+		     strcmp(Prog->Meters[I].Name + M - N, Name) == 0)) {
+			return I;
+		}
+	}
+	return P4_NONE;
+}
+
+uint32_t P4FindAction(const P4Program *Prog, const char *Name)
+{
+	uint32_t I;
+	size_t N = strlen(Name);
+
+	for (I = 0; I < Prog->NumActions; I++) {
+		if (strcmp(Prog->Actions[I].Name, Name) == 0) {
+			return I;
+		}
+	}
+	for (I = 0; I < Prog->NumActions; I++) {
+		size_t M = strlen(Prog->Actions[I].Name);
+
+		if (M > N && Prog->Actions[I].Name[M - N - 1] == '.' &&
+		    strcmp(Prog->Actions[I].Name + M - N, Name) == 0) {
+			return I;
+		}
+	}
+	return P4_NONE;
+}
+
+uint32_t P4ErrorCode(const P4Program *Prog, const char *Name)
+{
+	uint32_t I;
+
+	for (I = 0; I < Prog->NumErrors; I++) {
+		if (strcmp(Prog->ErrorNames[I], Name) == 0) {
+			return Prog->ErrorCodes[I];
+		}
+	}
+	return P4_NONE;
+}
+
+/*****************************************************************************/
+/*
+ * Expressions
+ */
+static const struct {
+	const char *Name;
+	P4Op Op;
+} P4OpNames[] = {
+	{ "+", P4OP_ADD }, { "-", P4OP_SUB }, { "*", P4OP_MUL },
+	{ "<<", P4OP_SHL }, { ">>", P4OP_SHR }, { "&", P4OP_AND },
+	{ "|", P4OP_OR }, { "^", P4OP_XOR }, { "~", P4OP_NOT },
+	{ "==", P4OP_EQ }, { "!=", P4OP_NE }, { "<", P4OP_LT },
+	{ "<=", P4OP_LE }, { ">", P4OP_GT }, { ">=", P4OP_GE },
+	{ "and", P4OP_LAND }, { "or", P4OP_LOR }, { "not", P4OP_LNOT },
+	{ "b2d", P4OP_B2D }, { "d2b", P4OP_D2B }, { "?", P4OP_COND },
+};
+
+static P4Expr *P4NewExpr(P4Loader *L, P4ExprKind Kind)
+{
+	P4Expr *E = calloc(1, sizeof(*E));
+
+	if (E == NULL) {
+		P4Fail(L, "out of memory");
+	} else {
+		E->Kind = Kind;
+	}
+	return E;
+}
+
+static void P4FreeExpr(P4Expr *E)
+{
+	if (E != NULL) {
+		P4FreeExpr(E->Left);
+		P4FreeExpr(E->Right);
+		P4FreeExpr(E->Cond);
+		free(E);
+	}
+}
+
+static P4Expr *P4CompileExpr(P4Loader *L, const JsonValue *J);
+
+static P4Expr *P4CompileFieldRef(P4Loader *L, const char *HeaderName,
+				 const char *FieldName)
+{
+	P4Program *Prog = L->Prog;
+	uint32_t H = P4FindHeader(Prog, HeaderName);
+	P4HeaderType *Type;
+	P4Expr *E;
+
+	if (H == P4_NONE) {
+		P4Fail(L, "unknown header '%s'", HeaderName);
+		return NULL;
+	}
+	if (strcmp(FieldName, "$valid$") == 0) {
+		E = P4NewExpr(L, P4E_VALID);
+		if (E != NULL) {
+			E->Header = H;
+			E->Width = 1;
+		}
+		return E;
+	}
+
+	Type = &Prog->HeaderTypes[Prog->Headers[H].Type];
+	E = P4NewExpr(L, P4E_FIELD);
+	if (E == NULL) {
+		return NULL;
+	}
+	E->Header = H;
+	E->Field = P4FindFieldIndex(Type, FieldName);
+	if (E->Field == P4_NONE) {
+		P4Fail(L, "unknown field '%s.%s'", HeaderName, FieldName);
+		free(E);
+		return NULL;
+	}
+	E->Width = Type->Fields[E->Field].Width;
+	return E;
+}
+
+static P4Expr *P4CompileOp(P4Loader *L, const JsonValue *J)
+{
+	const char *OpName = JsonStr(JsonGet(J, "op"));
+	const JsonValue *Left = JsonGet(J, "left");
+	const JsonValue *Right = JsonGet(J, "right");
+	P4Expr *E;
+	size_t I;
+
+	if (OpName != NULL && strcmp(OpName, "valid") == 0) {
+		if (Right == NULL || JsonStr(JsonGet(Right, "value")) == NULL) {
+			P4Fail(L, "malformed valid() expression");
+			return NULL;
+		}
+		return P4CompileFieldRef(L, JsonStr(JsonGet(Right, "value")),
+					 "$valid$");
+	}
+
+	E = P4NewExpr(L, P4E_OP);
+	if (E == NULL) {
+		return NULL;
+	}
+	for (I = 0; I < sizeof(P4OpNames) / sizeof(P4OpNames[0]); I++) {
+		if (OpName != NULL && strcmp(OpName, P4OpNames[I].Name) == 0) {
+			break;
+		}
+	}
+	if (I == sizeof(P4OpNames) / sizeof(P4OpNames[0])) {
+		P4Fail(L, "unsupported expression operator '%s'",
+		       OpName ? OpName : "?");
+		free(E);
+		return NULL;
+	}
+	E->Op = P4OpNames[I].Op;
+
+	if (Left != NULL && Left->Type != JSON_NULL) {
+		E->Left = P4CompileExpr(L, Left);
+	}
+	if (Right != NULL && Right->Type != JSON_NULL) {
+		E->Right = P4CompileExpr(L, Right);
+	}
+	if (E->Op == P4OP_COND) {
+		E->Cond = P4CompileExpr(L, JsonGet(J, "cond"));
+	}
+	if (L->Failed) {
+		P4FreeExpr(E);
+		return NULL;
+	}
+	return E;
+}
+
+static P4Expr *P4CompileExpr(P4Loader *L, const JsonValue *J)
+{
+	const char *Type;
+	const JsonValue *Value;
+	P4Expr *E;
+
+	if (J == NULL || L->Failed) {
+		P4Fail(L, "missing expression");
+		return NULL;
+	}
+	if (JsonGet(J, "op") != NULL) {
+		return P4CompileOp(L, J);
+	}
+
+	Type = JsonStr(JsonGet(J, "type"));
+	Value = JsonGet(J, "value");
+	if (Type == NULL || Value == NULL) {
+		P4Fail(L, "malformed expression");
+		return NULL;
+	}
+
+	if (strcmp(Type, "expression") == 0) {
+		return P4CompileExpr(L, Value);
+	}
+	if (strcmp(Type, "field") == 0) {
+		return P4CompileFieldRef(L, JsonStr(JsonAt(Value, 0)),
+					 JsonStr(JsonAt(Value, 1)));
+	}
+	if (strcmp(Type, "stack_field") == 0) {
+		uint32_t S = P4FindStack(L->Prog, JsonStr(JsonAt(Value, 0)));
+		P4HeaderType *HType;
+
+		if (S == P4_NONE) {
+			P4Fail(L, "unknown header stack");
+			return NULL;
+		}
+		HType = &L->Prog->HeaderTypes[
+			L->Prog->Headers[L->Prog->Stacks[S].Headers[0]].Type];
+		E = P4NewExpr(L, P4E_STACK_FIELD);
+		if (E == NULL) {
+			return NULL;
+		}
+		E->Header = S;
+		E->Field = P4FindFieldIndex(HType, JsonStr(JsonAt(Value, 1)));
+		if (E->Field == P4_NONE) {
+			P4Fail(L, "unknown stack field");
+			free(E);
+			return NULL;
+		}
+		E->Width = HType->Fields[E->Field].Width;
+		return E;
+	}
+	if (strcmp(Type, "hexstr") == 0) {
+		E = P4NewExpr(L, P4E_CONST);
+		if (E != NULL && P4ParseHex(JsonStr(Value), &E->Const) != 0) {
+			P4Fail(L, "constant '%s' wider than 64 bits",
+			       JsonStr(Value) ? JsonStr(Value) : "?");
+			free(E);
+			return NULL;
+		}
+		return E;
+	}
+	if (strcmp(Type, "bool") == 0) {
+		E = P4NewExpr(L, P4E_CONST);
+		if (E != NULL) {
+			E->Const = (uint64_t)Value->Bool;
+		}
+		return E;
+	}
+	if (strcmp(Type, "runtime_data") == 0) {
+		E = P4NewExpr(L, P4E_RUNTIME);
+		if (E != NULL) {
+			E->Field = (uint32_t)JsonInt(Value);
+		}
+		return E;
+	}
+
+	P4Fail(L, "unsupported expression type '%s'", Type);
+	return NULL;
+}
+
+/*****************************************************************************/
+/*
+ * Headers
+ */
+static void P4LoadHeaders(P4Loader *L, const JsonValue *Root)
+{
+	P4Program *Prog = L->Prog;
+	const JsonValue *Types = JsonGet(Root, "header_types");
+	const JsonValue *Headers = JsonGet(Root, "headers");
+	const JsonValue *Stacks = JsonGet(Root, "header_stacks");
+	const JsonValue *Errors = JsonGet(Root, "errors");
+	uint32_t I;
+	uint32_t J;
+
+	if (Types == NULL || Headers == NULL) {
+		P4Fail(L, "no header_types/headers");
+		return;
+	}
+
+	Prog->NumHeaderTypes = (uint32_t)Types->Count;
+	Prog->HeaderTypes = calloc(Types->Count, sizeof(P4HeaderType));
+	for (I = 0; I < Prog->NumHeaderTypes && !L->Failed; I++) {
+		const JsonValue *T = JsonAt(Types, I);
+		const JsonValue *Fields = JsonGet(T, "fields");
+		P4HeaderType *HT = &Prog->HeaderTypes[I];
+
+		HT->Name = P4Strdup(JsonStr(JsonGet(T, "name")));
+		HT->NumFields = (uint32_t)Fields->Count;
+		HT->Fields = calloc(Fields->Count, sizeof(P4Field));
+		HT->VarField = P4_NONE;
+		for (J = 0; J < HT->NumFields; J++) {
+			const JsonValue *F = JsonAt(Fields, J);
+			const JsonValue *W = JsonAt(F, 1);
+
+			HT->Fields[J].Name = P4Strdup(JsonStr(JsonAt(F, 0)));
+			if (W->Type == JSON_STRING) {
+				HT->Fields[J].MaxBytes = (uint32_t)JsonInt(
+					JsonGet(T, "max_length"));
+				HT->VarField = J;
+			} else if (JsonInt(W) > 64) {
+				P4Fail(L, "field %s.%s wider than 64 bits",
+				       HT->Name, HT->Fields[J].Name);
+			} else {
+				HT->Fields[J].Width = (uint32_t)JsonInt(W);
+				HT->FixedBits += HT->Fields[J].Width;
+			}
+		}
+	}
+
+	Prog->NumHeaders = (uint32_t)Headers->Count;
+	Prog->Headers = calloc(Headers->Count, sizeof(P4Header));
+	for (I = 0; I < Prog->NumHeaders && !L->Failed; I++) {
+		const JsonValue *H = JsonAt(Headers, I);
+		P4Header *Hdr = &Prog->Headers[I];
+
+		Hdr->Name = P4Strdup(JsonStr(JsonGet(H, "name")));
+		Hdr->Type = (uint32_t)JsonInt(JsonGet(H, "header_type")) ;
+		for (J = 0; J < Prog->NumHeaderTypes; J++) {
+			if (strcmp(Prog->HeaderTypes[J].Name,
+				   JsonStr(JsonGet(H, "header_type"))) == 0) {
+				Hdr->Type = J;
+			}
+		}
+		Hdr->Metadata = JsonGet(H, "metadata")->Bool;
+		Hdr->ValueBase = Prog->NumValues;
+		Prog->NumValues += Prog->HeaderTypes[Hdr->Type].NumFields;
+	}
+
+	Prog->NumStacks = Stacks ? (uint32_t)Stacks->Count : 0;
+	Prog->Stacks = calloc(Prog->NumStacks + 1, sizeof(P4Stack));
+	for (I = 0; I < Prog->NumStacks; I++) {
+		const JsonValue *S = JsonAt(Stacks, I);
+		const JsonValue *Ids = JsonGet(S, "header_ids");
+
+		Prog->Stacks[I].Name = P4Strdup(JsonStr(JsonGet(S, "name")));
+		Prog->Stacks[I].Size = (uint32_t)Ids->Count;
+		Prog->Stacks[I].Headers = calloc(Ids->Count, sizeof(uint32_t));
+		for (J = 0; J < Ids->Count; J++) {
+			Prog->Stacks[I].Headers[J] =
+				(uint32_t)JsonInt(JsonAt(Ids, J));
+		}
+	}
+
+	Prog->NumErrors = Errors ? (uint32_t)Errors->Count : 0;
+	Prog->ErrorNames = calloc(Prog->NumErrors + 1, sizeof(char *));
+	Prog->ErrorCodes = calloc(Prog->NumErrors + 1, sizeof(uint32_t));
+	for (I = 0; I < Prog->NumErrors; I++) {
+		Prog->ErrorNames[I] =
+			P4Strdup(JsonStr(JsonAt(JsonAt(Errors, I), 0)));
+		Prog->ErrorCodes[I] =
+			(uint32_t)JsonInt(JsonAt(JsonAt(Errors, I), 1));
+	}
+
+	Prog->StdMetaHeader = P4_NONE;
+	Prog->DropField = P4_NONE;
+	Prog->ParserErrorField = P4_NONE;
+	Prog->TimestampField = P4_NONE;
+	for (I = 0; I < Prog->NumHeaders; I++) {
+		P4HeaderType *HT = &Prog->HeaderTypes[Prog->Headers[I].Type];
+
+		if (strncmp(HT->Name, "standard_metadata", 17) == 0) {
+			Prog->StdMetaHeader = I;
+			Prog->DropField = P4FindFieldIndex(HT, "drop");
+			Prog->ParserErrorField =
+				P4FindFieldIndex(HT, "parser_error");
+			Prog->TimestampField =
+				P4FindFieldIndex(HT, "ingress_timestamp");
+		}
+	}
+}
+
+/*****************************************************************************/
+/*
+ * Parser
+ */
+static uint32_t P4FindState(const JsonValue *States, const char *Name)
+{
+	size_t I;
+
+	if (Name == NULL) {
+		return P4_NONE;
+	}
+	for (I = 0; I < States->Count; I++) {
+		if (strcmp(JsonStr(JsonGet(JsonAt(States, I), "name")),
+			   Name) == 0) {
+			return (uint32_t)I;
+		}
+	}
+	return P4_NONE;
+}
+
+static void P4LoadParserOp(P4Loader *L, const JsonValue *J, P4ParserOp *Op)
+{
+	P4Program *Prog = L->Prog;
+	const char *Name = JsonStr(JsonGet(J, "op"));
+	const JsonValue *Params = JsonGet(J, "parameters");
+	const JsonValue *P0 = JsonAt(Params, 0);
+	const char *P0Type = JsonStr(JsonGet(P0, "type"));
+
+	if (strcmp(Name, "extract") == 0 && strcmp(P0Type, "regular") == 0) {
+		Op->Kind = P4P_EXTRACT;
+		Op->Header = P4FindHeader(Prog, JsonStr(JsonGet(P0, "value")));
+	} else if (strcmp(Name, "extract") == 0 &&
+		   strcmp(P0Type, "stack") == 0) {
+		Op->Kind = P4P_EXTRACT_STACK;
+		Op->Header = P4FindStack(Prog, JsonStr(JsonGet(P0, "value")));
+	} else if (strcmp(Name, "extract_VL") == 0) {
+		Op->Kind = P4P_EXTRACT_VL;
+		Op->Header = P4FindHeader(Prog, JsonStr(JsonGet(P0, "value")));
+		Op->Expr = P4CompileExpr(L, JsonAt(Params, 1));
+	} else if (strcmp(Name, "set") == 0) {
+		P4Expr *Dst = P4CompileExpr(L, P0);
+
+		Op->Kind = P4P_SET;
+		if (Dst != NULL && Dst->Kind == P4E_FIELD) {
+			Op->Header = Dst->Header;
+			Op->Field = Dst->Field;
+		} else {
+			P4Fail(L, "unsupported set destination");
+		}
+		P4FreeExpr(Dst);
+		Op->Expr = P4CompileExpr(L, JsonAt(Params, 1));
+	} else if (strcmp(Name, "verify") == 0) {
+		Op->Kind = P4P_VERIFY;
+		Op->Expr = P4CompileExpr(L, P0);
+		Op->Error = P4CompileExpr(L, JsonAt(Params, 1));
+	} else {
+		P4Fail(L, "unsupported parser op '%s'", Name);
+		return;
+	}
+	if (Op->Header == P4_NONE && Op->Kind != P4P_SET &&
+	    Op->Kind != P4P_VERIFY) {
+		P4Fail(L, "parser op '%s' on unknown header", Name);
+	}
+}
+
+static void P4LoadParser(P4Loader *L, const JsonValue *Root)
+{
+	P4Program *Prog = L->Prog;
+	const JsonValue *Parser = JsonAt(JsonGet(Root, "parsers"), 0);
+	const JsonValue *States = JsonGet(Parser, "parse_states");
+	uint32_t I;
+	uint32_t J;
+
+	if (States == NULL) {
+		P4Fail(L, "no parser");
+		return;
+	}
+
+	Prog->NumStates = (uint32_t)States->Count;
+	Prog->States = calloc(States->Count, sizeof(P4ParseState));
+	Prog->InitState = P4FindState(States,
+				      JsonStr(JsonGet(Parser, "init_state")));
+
+	for (I = 0; I < Prog->NumStates && !L->Failed; I++) {
+		const JsonValue *S = JsonAt(States, I);
+		const JsonValue *Ops = JsonGet(S, "parser_ops");
+		const JsonValue *Trans = JsonGet(S, "transitions");
+		const JsonValue *Keys = JsonGet(S, "transition_key");
+		P4ParseState *St = &Prog->States[I];
+		uint64_t FullMask;
+
+		St->Name = P4Strdup(JsonStr(JsonGet(S, "name")));
+		St->NumOps = (uint32_t)Ops->Count;
+		St->Ops = calloc(Ops->Count + 1, sizeof(P4ParserOp));
+		for (J = 0; J < St->NumOps && !L->Failed; J++) {
+			P4LoadParserOp(L, JsonAt(Ops, J), &St->Ops[J]);
+		}
+
+		if (Keys->Count > P4_MAX_KEY_FIELDS) {
+			P4Fail(L, "state %s: too many key fields", St->Name);
+			return;
+		}
+		St->NumKeys = (uint32_t)Keys->Count;
+		for (J = 0; J < St->NumKeys && !L->Failed; J++) {
+			St->Keys[J] = P4CompileExpr(L, JsonAt(Keys, J));
+			if (St->Keys[J] != NULL) {
+				St->KeyBits += St->Keys[J]->Width;
+			}
+		}
+		if (St->KeyBits > 64) {
+			P4Fail(L, "state %s: select key wider than 64 bits",
+			       St->Name);
+			return;
+		}
+		FullMask = P4WidthMask(St->KeyBits);
+
+		St->NumTransitions = (uint32_t)Trans->Count;
+		St->Transitions = calloc(Trans->Count + 1, sizeof(P4Transition));
+		for (J = 0; J < St->NumTransitions && !L->Failed; J++) {
+			const JsonValue *T = JsonAt(Trans, J);
+			const JsonValue *Mask = JsonGet(T, "mask");
+			const char *Type = JsonStr(JsonGet(T, "type"));
+			P4Transition *Tr = &St->Transitions[J];
+
+			Tr->Next = P4FindState(States,
+					       JsonStr(JsonGet(T, "next_state")));
+			if (Type == NULL) {
+				Tr->IsDefault = 1;
+				continue;
+			}
+			if (strcmp(Type, "hexstr") != 0 ||
+			    P4ParseHex(JsonStr(JsonGet(T, "value")),
+				       &Tr->Value) != 0) {
+				P4Fail(L, "state %s: unsupported transition",
+				       St->Name);
+				return;
+			}
+			Tr->Mask = FullMask;
+			if (Mask != NULL && Mask->Type != JSON_NULL &&
+			    P4ParseHex(JsonStr(Mask), &Tr->Mask) != 0) {
+				P4Fail(L, "state %s: bad mask", St->Name);
+				return;
+			}
+			Tr->Value &= Tr->Mask;
+		}
+	}
+}
+
+/*****************************************************************************/
+/*
+ * Actions and pipeline
+ */
+static void P4LoadCounters(P4Loader *L, const JsonValue *Root)
+{
+	P4Program *Prog = L->Prog;
+	const JsonValue *Arrays = JsonGet(Root, "counter_arrays");
+	uint32_t I;
+
+	if (Arrays == NULL) {
+		return;
+	}
+	Prog->NumCounters = (uint32_t)Arrays->Count;
+	Prog->Counters = calloc(Arrays->Count + 1, sizeof(P4CounterArray));
+	for (I = 0; I < Prog->NumCounters && !L->Failed; I++) {
+		const JsonValue *C = JsonAt(Arrays, I);
+		const JsonValue *Direct = JsonGet(C, "is_direct");
+		P4CounterArray *Ctr = &Prog->Counters[I];
+
+		Ctr->Name = P4Strdup(JsonStr(JsonGet(C, "name")));
+		if (Direct != NULL && Direct->Type == JSON_BOOL && Direct->Bool) {
+			P4Fail(L, "counter %s: direct counters are not supported",
+			       Ctr->Name);
+			return;
+		}
+		Ctr->Size = (uint32_t)JsonInt(JsonGet(C, "size"));
+		Ctr->CellBase = Prog->NumCounterCells;
+		Prog->NumCounterCells += Ctr->Size;
+	}
+}
+
+static void P4LoadMeters(P4Loader *L, const JsonValue *Root)
+{
+	P4Program *Prog = L->Prog;
+	const JsonValue *Arrays = JsonGet(Root, "meter_arrays");
+	uint32_t I;
+
+	if (Arrays == NULL) {
+		return;
+	}
+	Prog->NumMeters = (uint32_t)Arrays->Count;
+	Prog->Meters = calloc(Arrays->Count + 1, sizeof(P4MeterArray));
+	for (I = 0; I < Prog->NumMeters && !L->Failed; I++) {
+		const JsonValue *M = JsonAt(Arrays, I);
+		const JsonValue *Direct = JsonGet(M, "is_direct");
+		P4MeterArray *Mtr = &Prog->Meters[I];
+
+		Mtr->Name = P4Strdup(JsonStr(JsonGet(M, "name")));
+		if (Direct != NULL && Direct->Type == JSON_BOOL && Direct->Bool) {
+			P4Fail(L, "meter %s: direct meters are not supported",
+			       Mtr->Name);
+			return;
+		}
+		if (JsonInt(JsonGet(M, "rate_count")) != 2) {
+			P4Fail(L, "meter %s: only two-rate meters are supported",
+			       Mtr->Name);
+			return;
+		}
+		Mtr->Packets = strcmp(JsonStr(JsonGet(M, "type")), "packets") == 0;
+		Mtr->Size = (uint32_t)JsonInt(JsonGet(M, "size"));
+		Mtr->Rates = calloc(Mtr->Size + 1, sizeof(P4MeterRate));
+		Mtr->CellBase = Prog->NumMeterCells;
+		Prog->NumMeterCells += Mtr->Size;
+	}
+}
+
+static void P4LoadActions(P4Loader *L, const JsonValue *Root)
+{
+	P4Program *Prog = L->Prog;
+	const JsonValue *Actions = JsonGet(Root, "actions");
+	uint32_t I;
+	uint32_t J;
+
+	Prog->NumActions = (uint32_t)Actions->Count;
+	Prog->Actions = calloc(Actions->Count + 1, sizeof(P4Action));
+	for (I = 0; I < Prog->NumActions && !L->Failed; I++) {
+		const JsonValue *A = JsonAt(Actions, I);
+		const JsonValue *Data = JsonGet(A, "runtime_data");
+		const JsonValue *Prims = JsonGet(A, "primitives");
+		P4Action *Act = &Prog->Actions[JsonInt(JsonGet(A, "id"))];
+
+		Act->Name = P4Strdup(JsonStr(JsonGet(A, "name")));
+		if (Data->Count > P4_MAX_PARAMS) {
+			P4Fail(L, "action %s: too many parameters", Act->Name);
+			return;
+		}
+		Act->NumParams = (uint32_t)Data->Count;
+		for (J = 0; J < Act->NumParams; J++) {
+			Act->ParamWidth[J] = (uint32_t)JsonInt(
+				JsonGet(JsonAt(Data, J), "bitwidth"));
+			if (Act->ParamWidth[J] > 64) {
+				P4Fail(L, "action %s: parameter wider than 64 bits",
+				       Act->Name);
+			}
+		}
+
+		Act->NumPrims = (uint32_t)Prims->Count;
+		Act->Prims = calloc(Prims->Count + 1, sizeof(P4Primitive));
+		for (J = 0; J < Act->NumPrims && !L->Failed; J++) {
+			const JsonValue *P = JsonAt(Prims, J);
+			const JsonValue *Params = JsonGet(P, "parameters");
+			const char *Op = JsonStr(JsonGet(P, "op"));
+			P4Primitive *Prim = &Act->Prims[J];
+
+			if (strcmp(Op, "assign") == 0) {
+				P4Expr *Dst = P4CompileExpr(L, JsonAt(Params, 0));
+
+				Prim->Kind = P4A_ASSIGN;
+				if (Dst == NULL || Dst->Kind != P4E_FIELD) {
+					P4Fail(L, "action %s: unsupported assign",
+					       Act->Name);
+				} else {
+					Prim->Header = Dst->Header;
+					Prim->Field = Dst->Field;
+				}
+				P4FreeExpr(Dst);
+				Prim->Src = P4CompileExpr(L, JsonAt(Params, 1));
+			} else if (strcmp(Op, "mark_to_drop") == 0 ||
+				   strcmp(Op, "drop") == 0) {
+				Prim->Kind = P4A_DROP;
+			} else if (strcmp(Op, "add_header") == 0 ||
+				   strcmp(Op, "remove_header") == 0) {
+				Prim->Kind = (Op[0] == 'a') ? P4A_ADD_HEADER :
+							      P4A_REMOVE_HEADER;
+				Prim->Header = P4FindHeader(Prog, JsonStr(
+					JsonGet(JsonAt(Params, 0), "value")));
+			} else if (strcmp(Op, "count") == 0) {
+				Prim->Kind = P4A_COUNT;
+				Prim->Extern = P4FindCounter(Prog, JsonStr(
+					JsonGet(JsonAt(Params, 0), "value")));
+				if (Prim->Extern == P4_NONE) {
+					P4Fail(L, "action %s: unknown counter",
+					       Act->Name);
+				}
+				Prim->Src = P4CompileExpr(L, JsonAt(Params, 1));
+			} else if (strcmp(Op, "execute_meter") == 0) {
+				P4Expr *Dst = P4CompileExpr(L, JsonAt(Params, 2));
+
+				Prim->Kind = P4A_METER;
+				Prim->Extern = P4FindMeter(Prog, JsonStr(
+					JsonGet(JsonAt(Params, 0), "value")));
+				if (Prim->Extern == P4_NONE) {
+					P4Fail(L, "action %s: unknown meter",
+					       Act->Name);
+				} else if (Dst == NULL || Dst->Kind != P4E_FIELD) {
+					P4Fail(L, "action %s: unsupported meter "
+					       "result", Act->Name);
+				} else {
+					Prim->Header = Dst->Header;
+					Prim->Field = Dst->Field;
+				}
+				P4FreeExpr(Dst);
+				Prim->Src = P4CompileExpr(L, JsonAt(Params, 1));
+			} else {
+				P4Fail(L, "action %s: unsupported primitive '%s'",
+				       Act->Name, Op);
+			}
+		}
+	}
+}
+
+static uint32_t P4ResolveNode(P4Loader *L, const JsonValue *Pipe,
+			      const JsonValue *NameJ)
+{
+	const JsonValue *Tables = JsonGet(Pipe, "tables");
+	const JsonValue *Conds = JsonGet(Pipe, "conditionals");
+	const char *Name = JsonStr(NameJ);
+	size_t I;
+
+	if (Name == NULL) {
+		return P4_NONE;
+	}
+	for (I = 0; I < Tables->Count; I++) {
+		if (strcmp(JsonStr(JsonGet(JsonAt(Tables, I), "name")),
+			   Name) == 0) {
+			return P4_NODE_TABLE((uint32_t)I);
+		}
+	}
+	for (I = 0; I < Conds->Count; I++) {
+		if (strcmp(JsonStr(JsonGet(JsonAt(Conds, I), "name")),
+			   Name) == 0) {
+			return P4_NODE_COND((uint32_t)I);
+		}
+	}
+	P4Fail(L, "unknown pipeline node '%s'", Name);
+	return P4_NONE;
+}
+
+static void P4LoadPipeline(P4Loader *L, const JsonValue *Root)
+{
+	P4Program *Prog = L->Prog;
+	const JsonValue *Pipe = JsonAt(JsonGet(Root, "pipelines"), 0);
+	const JsonValue *Tables = JsonGet(Pipe, "tables");
+	const JsonValue *Conds = JsonGet(Pipe, "conditionals");
+	uint32_t I;
+	uint32_t J;
+
+	if (Tables == NULL || Conds == NULL) {
+		P4Fail(L, "no ingress pipeline");
+		return;
+	}
+	if (JsonGet(Root, "pipelines")->Count > 1) {
+		P4Fail(L, "only a single pipeline is supported");
+		return;
+	}
+
+	Prog->InitNode = P4ResolveNode(L, Pipe, JsonGet(Pipe, "init_table"));
+
+	Prog->NumTables = (uint32_t)Tables->Count;
+	Prog->Tables = calloc(Tables->Count + 1, sizeof(P4Table));
+	for (I = 0; I < Prog->NumTables && !L->Failed; I++) {
+		const JsonValue *T = JsonAt(Tables, I);
+		const JsonValue *Keys = JsonGet(T, "key");
+		const JsonValue *Ids = JsonGet(T, "action_ids");
+		const JsonValue *Names = JsonGet(T, "actions");
+		const JsonValue *Next = JsonGet(T, "next_tables");
+		const JsonValue *Def = JsonGet(T, "default_entry");
+		P4Table *Tbl = &Prog->Tables[I];
+
+		Tbl->Name = P4Strdup(JsonStr(JsonGet(T, "name")));
+		if (strcmp(JsonStr(JsonGet(T, "type")), "simple") != 0) {
+			P4Fail(L, "table %s: only simple tables are supported",
+			       Tbl->Name);
+			return;
+		}
+		if (Keys->Count > P4_MAX_KEY_FIELDS) {
+			P4Fail(L, "table %s: too many key fields", Tbl->Name);
+			return;
+		}
+		Tbl->MaxSize = (uint32_t)JsonInt(JsonGet(T, "max_size"));
+		Tbl->NumKeys = (uint32_t)Keys->Count;
+		for (J = 0; J < Tbl->NumKeys && !L->Failed; J++) {
+			const JsonValue *K = JsonAt(Keys, J);
+			const char *Match = JsonStr(JsonGet(K, "match_type"));
+			const JsonValue *Target = JsonGet(K, "target");
+			const JsonValue *Mask = JsonGet(K, "mask");
+
+			if (strcmp(Match, "valid") == 0) {
+				Tbl->Keys[J] = P4CompileFieldRef(L,
+					JsonStr(Target), "$valid$");
+				Tbl->Match[J] = P4M_VALID;
+			} else {
+				Tbl->Keys[J] = P4CompileFieldRef(L,
+					JsonStr(JsonAt(Target, 0)),
+					JsonStr(JsonAt(Target, 1)));
+				Tbl->Match[J] =
+					strcmp(Match, "exact") == 0 ? P4M_EXACT :
+					strcmp(Match, "lpm") == 0 ? P4M_LPM :
+					P4M_TERNARY;
+				if (strcmp(Match, "range") == 0) {
+					P4Fail(L, "table %s: range keys are not supported",
+					       Tbl->Name);
+				}
+			}
+			if (Tbl->Keys[J] == NULL) {
+				return;
+			}
+			Tbl->KeyWidth[J] = Tbl->Keys[J]->Width;
+			if (Mask != NULL && Mask->Type != JSON_NULL) {
+				P4Expr *Masked = P4NewExpr(L, P4E_OP);
+				P4Expr *Const = P4NewExpr(L, P4E_CONST);
+
+				if (Masked == NULL || Const == NULL ||
+				    P4ParseHex(JsonStr(Mask), &Const->Const)) {
+					P4Fail(L, "table %s: bad key mask",
+					       Tbl->Name);
+					return;
+				}
+				Masked->Op = P4OP_AND;
+				Masked->Left = Tbl->Keys[J];
+				Masked->Right = Const;
+				Tbl->Keys[J] = Masked;
+			}
+		}
+
+		Tbl->NumActions = (uint32_t)Ids->Count;
+		Tbl->Actions = calloc(Ids->Count + 1, sizeof(uint32_t));
+		Tbl->ActionNext = calloc(Ids->Count + 1, sizeof(uint32_t));
+		for (J = 0; J < Tbl->NumActions; J++) {
+			Tbl->Actions[J] = (uint32_t)JsonInt(JsonAt(Ids, J));
+			Tbl->ActionNext[J] = P4ResolveNode(L, Pipe,
+				JsonGet(Next, JsonStr(JsonAt(Names, J))));
+		}
+		Tbl->BaseDefaultNext = P4ResolveNode(L, Pipe,
+					JsonGet(T, "base_default_next"));
+
+		Tbl->DefaultAction = P4_NONE;
+		if (Def != NULL && Def->Type == JSON_OBJECT) {
+			const JsonValue *Data = JsonGet(Def, "action_data");
+
+			Tbl->DefaultAction =
+				(uint32_t)JsonInt(JsonGet(Def, "action_id"));
+			for (J = 0; J < Data->Count && J < P4_MAX_PARAMS; J++) {
+				P4ParseHex(JsonStr(JsonAt(Data, J)),
+					   &Tbl->DefaultParams[J]);
+			}
+		}
+	}
+
+	Prog->NumConds = (uint32_t)Conds->Count;
+	Prog->Conds = calloc(Conds->Count + 1, sizeof(P4Cond));
+	for (I = 0; I < Prog->NumConds && !L->Failed; I++) {
+		const JsonValue *C = JsonAt(Conds, I);
+		P4Cond *Cond = &Prog->Conds[I];
+
+		Cond->Name = P4Strdup(JsonStr(JsonGet(C, "name")));
+		Cond->Expr = P4CompileExpr(L, JsonGet(C, "expression"));
+		Cond->TrueNext = P4ResolveNode(L, Pipe, JsonGet(C, "true_next"));
+		Cond->FalseNext = P4ResolveNode(L, Pipe,
+						JsonGet(C, "false_next"));
+	}
+}
+
+static void P4LoadDeparser(P4Loader *L, const JsonValue *Root)
+{
+	P4Program *Prog = L->Prog;
+	const JsonValue *Dep = JsonAt(JsonGet(Root, "deparsers"), 0);
+	const JsonValue *Emits = JsonGet(Dep, "emits");
+	const JsonValue *Order = JsonGet(Dep, "order");
+	uint32_t I;
+
+	if (Emits != NULL) {
+		Prog->NumEmits = (uint32_t)Emits->Count;
+		Prog->Emits = calloc(Emits->Count + 1, sizeof(uint32_t));
+		for (I = 0; I < Prog->NumEmits; I++) {
+			Prog->Emits[I] = P4FindHeader(Prog,
+				JsonStr(JsonGet(JsonAt(Emits, I), "header")));
+		}
+	} else if (Order != NULL) {
+		/* bmv2-style deparser */
+		Prog->NumEmits = (uint32_t)Order->Count;
+		Prog->Emits = calloc(Order->Count + 1, sizeof(uint32_t));
+		for (I = 0; I < Prog->NumEmits; I++) {
+			Prog->Emits[I] = P4FindHeader(Prog,
+						      JsonStr(JsonAt(Order, I)));
+		}
+	}
+	for (I = 0; I < Prog->NumEmits; I++) {
+		if (Prog->Emits[I] == P4_NONE) {
+			P4Fail(L, "deparser emits an unknown header");
+		}
+	}
+}
+
+/****************************************************************************/
+/**
+*
+* Loads and compiles a p4c-sdnet JSON program.
+*
+* @param	Prog is zero-initialized by the call and filled in.
+* @param	Path is the main.json to load.
+* @param	ErrBuf receives a message on failure.
+* @param	ErrLen is the size of ErrBuf.
+*
+* @return	0 on success, -1 on failure.
+*
+*****************************************************************************/
+int P4ProgramLoad(P4Program *Prog, const char *Path, char *ErrBuf,
+		  size_t ErrLen)
+{
+	P4Loader L = { Prog, ErrBuf, ErrLen, 0 };
+
+	memset(Prog, 0, sizeof(*Prog));
+	Prog->Json = JsonLoadFile(Path, ErrBuf, ErrLen);
+	if (Prog->Json == NULL) {
+		return -1;
+	}
+
+	P4LoadHeaders(&L, Prog->Json);
+	if (!L.Failed) {
+		P4LoadParser(&L, Prog->Json);
+	}
+	if (!L.Failed) {
+		P4LoadCounters(&L, Prog->Json);
+	}
+	if (!L.Failed) {
+		P4LoadMeters(&L, Prog->Json);
+	}
+	if (!L.Failed) {
+		P4LoadActions(&L, Prog->Json);
+	}
+	if (!L.Failed) {
+		P4LoadPipeline(&L, Prog->Json);
+	}
+	if (!L.Failed) {
+		P4LoadDeparser(&L, Prog->Json);
+	}
+	if (!L.Failed && Prog->InitState == P4_NONE) {
+		P4Fail(&L, "parser has no init_state");
+	}
+
+	if (L.Failed) {
+		P4ProgramFree(Prog);
+		return -1;
+	}
+	return 0;
+}
+
+void P4ProgramFree(P4Program *Prog)
+{
+	uint32_t I;
+	uint32_t J;
+
+	for (I = 0; I < Prog->NumHeaderTypes; I++) {
+		for (J = 0; J < Prog->HeaderTypes[I].NumFields; J++) {
+			free(Prog->HeaderTypes[I].Fields[J].Name);
+		}
+		free(Prog->HeaderTypes[I].Fields);
+		free(Prog->HeaderTypes[I].Name);
+	}
+	for (I = 0; I < Prog->NumHeaders; I++) {
+		free(Prog->Headers[I].Name);
+	}
+	for (I = 0; I < Prog->NumStacks; I++) {
+		free(Prog->Stacks[I].Name);
+		free(Prog->Stacks[I].Headers);
+	}
+	for (I = 0; I < Prog->NumErrors; I++) {
+		free(Prog->ErrorNames[I]);
+	}
+	for (I = 0; I < Prog->NumStates; I++) {
+		P4ParseState *St = &Prog->States[I];
+
+		for (J = 0; J < St->NumOps; J++) {
+			P4FreeExpr(St->Ops[J].Expr);
+			P4FreeExpr(St->Ops[J].Error);
+		}
+		for (J = 0; J < St->NumKeys; J++) {
+			P4FreeExpr(St->Keys[J]);
+		}
+		free(St->Ops);
+		free(St->Transitions);
+		free(St->Name);
+	}
+	for (I = 0; I < Prog->NumActions; I++) {
+		for (J = 0; J < Prog->Actions[I].NumPrims; J++) {
+			P4FreeExpr(Prog->Actions[I].Prims[J].Src);
+		}
+		free(Prog->Actions[I].Prims);
+		free(Prog->Actions[I].Name);
+	}
+	for (I = 0; I < Prog->NumTables; I++) {
+		for (J = 0; J < Prog->Tables[I].NumKeys; J++) {
+			P4FreeExpr(Prog->Tables[I].Keys[J]);
+		}
+		free(Prog->Tables[I].Actions);
+		free(Prog->Tables[I].ActionNext);
+		free(Prog->Tables[I].Entries);
+		free(Prog->Tables[I].Name);
+	}
+	for (I = 0; I < Prog->NumCounters; I++) {
+		free(Prog->Counters[I].Name);
+	}
+	free(Prog->Counters);
+	for (I = 0; I < Prog->NumMeters; I++) {
+		free(Prog->Meters[I].Rates);
+		free(Prog->Meters[I].Name);
+	}
+	free(Prog->Meters);
+	for (I = 0; I < Prog->NumConds; I++) {
+		P4FreeExpr(Prog->Conds[I].Expr);
+		free(Prog->Conds[I].Name);
+	}
+	free(Prog->HeaderTypes);
+	free(Prog->Headers);
+	free(Prog->Stacks);
+	free(Prog->ErrorNames);
+	free(Prog->ErrorCodes);
+	free(Prog->States);
+	free(Prog->Actions);
+	free(Prog->Tables);
+	free(Prog->Conds);
+	free(Prog->Emits);
+	JsonFree(Prog->Json);
+	memset(Prog, 0, sizeof(*Prog));
+}
+
+/*****************************************************************************/
+/*
+ * Table entries
+ */
+
+/****************************************************************************/
+/**
+*
+* Adds an entry to a table, keeping entries ordered by priority. Entries
+* with equal priority keep insertion order, so the first one added wins.
+*
+* @return	0 on success, -1 if the table is full or the action is not
+*		allowed in this table.
+*
+*****************************************************************************/
+int P4TableAddEntry(P4Program *Prog, uint32_t Table, const P4Entry *Entry)
+{
+	P4Table *Tbl = &Prog->Tables[Table];
+	P4Entry *Entries;
+	uint32_t Pos;
+	uint32_t I;
+	int Allowed = 0;
+
+	for (I = 0; I < Tbl->NumActions; I++) {
+		Allowed |= (Tbl->Actions[I] == Entry->Action);
+	}
+	if (!Allowed || Tbl->NumEntries >= Tbl->MaxSize) {
+		return -1;
+	}
+
+	Entries = realloc(Tbl->Entries,
+			  (Tbl->NumEntries + 1) * sizeof(P4Entry));
+	if (Entries == NULL) {
+		return -1;
+	}
+	Tbl->Entries = Entries;
+
+	Pos = Tbl->NumEntries;
+	while (Pos > 0 && Entries[Pos - 1].Priority > Entry->Priority) {
+		Entries[Pos] = Entries[Pos - 1];
+		Pos--;
+	}
+	Entries[Pos] = *Entry;
+	for (I = 0; I < Tbl->NumKeys; I++) {
+		Entries[Pos].Key[I] &= Entries[Pos].Mask[I];
+	}
+	Tbl->NumEntries++;
+	return 0;
+}
+
+static int P4ParseNumber(const char *S, uint64_t *ValuePtr)
+{
+	char *End;
+
+	if (S[0] == '0' && (S[1] == 'x' || S[1] == 'X')) {
+		return P4ParseHex(S, ValuePtr);
+	}
+	*ValuePtr = strtoull(S, &End, 10);
+	return (End != S && *End == '\0') ? 0 : -1;
+}
+
+static int P4ParseKey(const char *Tok, P4MatchKind Match, uint32_t Width,
+		      uint64_t *KeyPtr, uint64_t *MaskPtr)
+{
+	char Buf[64];
+	char *Sep;
+	uint64_t Full = P4WidthMask(Width);
+
+	if (strlen(Tok) >= sizeof(Buf)) {
+		return -1;
+	}
+	strcpy(Buf, Tok);
+
+	if (strcmp(Buf, "*") == 0) {
+		*KeyPtr = 0;
+		*MaskPtr = 0;
+		return (Match == P4M_EXACT) ? -1 : 0;
+	}
+	if ((Sep = strstr(Buf, "&&&")) != NULL) {
+		*Sep = '\0';
+		if (P4ParseNumber(Buf, KeyPtr) || P4ParseNumber(Sep + 3, MaskPtr)) {
+			return -1;
+		}
+		*MaskPtr &= Full;
+		return (Match == P4M_TERNARY) ? 0 : -1;
+	}
+	if ((Sep = strchr(Buf, '/')) != NULL) {
+		uint64_t Len;
+
+		*Sep = '\0';
+		if (P4ParseNumber(Buf, KeyPtr) || P4ParseNumber(Sep + 1, &Len) ||
+		    Len > Width) {
+			return -1;
+		}
+		*MaskPtr = (Len == 0) ? 0 : (Full & ~P4WidthMask(Width - (uint32_t)Len));
+		return (Match == P4M_EXACT) ? -1 : 0;
+	}
+	*MaskPtr = Full;
+	return P4ParseNumber(Buf, KeyPtr);
+}
+
+static int P4ParseMeter(P4Program *Prog, char **Tok, uint32_t NumTok)
+{
+	uint32_t Meter;
+	uint64_t Index;
+	P4MeterRate Rate;
+
+	if (NumTok != 7) {
+		return -1;
+	}
+	Meter = P4FindMeter(Prog, Tok[1]);
+	if (Meter == P4_NONE || P4ParseNumber(Tok[2], &Index) ||
+	    Index >= Prog->Meters[Meter].Size ||
+	    P4ParseNumber(Tok[3], &Rate.Cir) || P4ParseNumber(Tok[4], &Rate.Cbs) ||
+	    P4ParseNumber(Tok[5], &Rate.Pir) || P4ParseNumber(Tok[6], &Rate.Pbs)) {
+		return -1;
+	}
+	/* RFC 2698 requires PIR >= CIR; a zero burst could never pass */
+	if (Rate.Pir < Rate.Cir || Rate.Cbs == 0 || Rate.Pbs == 0) {
+		return -1;
+	}
+	Prog->Meters[Meter].Rates[Index] = Rate;
+	return 0;
+}
+
+/****************************************************************************/
+/**
+*
+* Loads table entries from a text file. Each non-empty line that does not
+* start with '#' reads
+*
+*	<table> <priority> <key>... => <action> [<param>...]
+*
+* with one key token per table key field: "V" (exact), "V&&&M" (ternary),
+* "V/L" (prefix) or "*" (don't care). Numbers are decimal or 0x-prefixed.
+* Table and action names may omit the control prefix. Entries with the
+* lowest priority win, as on the SDNet TCAM.
+*
+* Meter cells are configured with
+*
+*	meter <array> <index> <cir> <cbs> <pir> <pbs>
+*
+* in the units of P4MeterRate.
+*
+* @return	0 on success, -1 on failure with a message in ErrBuf.
+*
+*****************************************************************************/
+int P4LoadEntries(P4Program *Prog, const char *Path, char *ErrBuf,
+		  size_t ErrLen)
+{
+	FILE *F = fopen(Path, "r");
+	char Line[1024];
+	int LineNo = 0;
+
+	if (F == NULL) {
+		snprintf(ErrBuf, ErrLen, "cannot open %s", Path);
+		return -1;
+	}
+
+	while (fgets(Line, sizeof(Line), F) != NULL) {
+		char *Tok[64];
+		uint32_t NumTok = 0;
+		uint32_t Table;
+		uint32_t Arrow;
+		uint32_t I;
+		uint64_t Prio;
+		P4Table *Tbl;
+		P4Action *Act;
+		P4Entry Entry;
+		char *Save = NULL;
+		char *T;
+
+		LineNo++;
+		if ((T = strchr(Line, '#')) != NULL) {
+			*T = '\0';
+		}
+		for (T = strtok_r(Line, " \t\r\n", &Save);
+		     T != NULL && NumTok < 64;
+		     T = strtok_r(NULL, " \t\r\n", &Save)) {
+			Tok[NumTok++] = T;
+		}
+		if (NumTok == 0) {
+			continue;
+		}
+		if (strcmp(Tok[0], "meter") == 0) {
+			if (P4ParseMeter(Prog, Tok, NumTok) != 0) {
+				snprintf(ErrBuf, ErrLen, "%s:%d: expected meter "
+					 "<array> <index> <cir> <cbs> <pir> <pbs>",
+					 Path, LineNo);
+				goto Fail;
+			}
+			continue;
+		}
+
+		memset(&Entry, 0, sizeof(Entry));
+		Table = P4FindTable(Prog, Tok[0]);
+		if (Table == P4_NONE || NumTok < 2 ||
+		    P4ParseNumber(Tok[1], &Prio) != 0) {
+			snprintf(ErrBuf, ErrLen, "%s:%d: bad table or priority",
+				 Path, LineNo);
+			goto Fail;
+		}
+		Tbl = &Prog->Tables[Table];
+		Entry.Priority = (uint32_t)Prio;
+
+		Arrow = 2 + Tbl->NumKeys;
+		if (NumTok <= Arrow + 1 || strcmp(Tok[Arrow], "=>") != 0) {
+			snprintf(ErrBuf, ErrLen, "%s:%d: expected %u keys then '=>'",
+				 Path, LineNo, (unsigned)Tbl->NumKeys);
+			goto Fail;
+		}
+		for (I = 0; I < Tbl->NumKeys; I++) {
+			if (P4ParseKey(Tok[2 + I], Tbl->Match[I], Tbl->KeyWidth[I],
+				       &Entry.Key[I], &Entry.Mask[I]) != 0) {
+				snprintf(ErrBuf, ErrLen, "%s:%d: bad key '%s'",
+					 Path, LineNo, Tok[2 + I]);
+				goto Fail;
+			}
+		}
+
+		Entry.Action = P4FindAction(Prog, Tok[Arrow + 1]);
+		if (Entry.Action == P4_NONE) {
+			snprintf(ErrBuf, ErrLen, "%s:%d: unknown action '%s'",
+				 Path, LineNo, Tok[Arrow + 1]);
+			goto Fail;
+		}
+		Act = &Prog->Actions[Entry.Action];
+		if (NumTok - Arrow - 2 != Act->NumParams) {
+			snprintf(ErrBuf, ErrLen, "%s:%d: %s takes %u parameters",
+				 Path, LineNo, Act->Name, (unsigned)Act->NumParams);
+			goto Fail;
+		}
+		for (I = 0; I < Act->NumParams; I++) {
+			if (P4ParseNumber(Tok[Arrow + 2 + I], &Entry.Params[I])) {
+				snprintf(ErrBuf, ErrLen, "%s:%d: bad parameter",
+					 Path, LineNo);
+				goto Fail;
+			}
+			Entry.Params[I] &= P4WidthMask(Act->ParamWidth[I]);
+		}
+
+		if (P4TableAddEntry(Prog, Table, &Entry) != 0) {
+			snprintf(ErrBuf, ErrLen,
+				 "%s:%d: table full or action not allowed",
+				 Path, LineNo);
+			goto Fail;
+		}
+	}
+
+	fclose(F);
+	return 0;
+
+Fail:
+	fclose(F);
+	return -1;
+}
@@ -0,0 +1,290 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file p4prog.h
+*
+* In-memory form of a p4c-sdnet program (main.json). The loader resolves
+* every header, field, action and pipeline node name to an index once, so
+* the interpreter never touches the JSON or compares strings per packet.
+*
+*****************************************************************************/
+#ifndef P4_PROG_H
+#define P4_PROG_H
+
+#include <stdint.h>
+#include "json.h"
+
+#define P4_NONE			UINT32_MAX
+#define P4_MAX_KEY_FIELDS	16
+#define P4_MAX_PARAMS		16
+
+/**************************** Type Definitions ******************************/
+
+typedef struct {
+	char *Name;
+	uint32_t Width;		/* bits, 0 for a varbit field */
+	uint32_t MaxBytes;	/* varbit only */
+} P4Field;
+
+typedef struct {
+	char *Name;
+	uint32_t NumFields;
+	P4Field *Fields;
+	uint32_t FixedBits;	/* sum of all fixed-width fields */
+	uint32_t VarField;	/* index of the varbit field or P4_NONE */
+} P4HeaderType;
+
+typedef struct {
+	char *Name;
+	uint32_t Type;
+	int Metadata;
+	uint32_t ValueBase;	/* first slot of this header in P4State.Values */
+} P4Header;
+
+typedef struct {
+	char *Name;
+	uint32_t Size;
+	uint32_t *Headers;
+} P4Stack;
+
+typedef enum {
+	P4E_CONST,
+	P4E_FIELD,		/* Header.Field */
+	P4E_VALID,		/* Header.$valid$ */
+	P4E_STACK_FIELD,	/* field of the last extracted stack element */
+	P4E_RUNTIME,		/* action parameter */
+	P4E_OP
+} P4ExprKind;
+
+typedef enum {
+	P4OP_ADD, P4OP_SUB, P4OP_MUL, P4OP_SHL, P4OP_SHR,
+	P4OP_AND, P4OP_OR, P4OP_XOR, P4OP_NOT,
+	P4OP_EQ, P4OP_NE, P4OP_LT, P4OP_LE, P4OP_GT, P4OP_GE,
+	P4OP_LAND, P4OP_LOR, P4OP_LNOT,
+	P4OP_B2D, P4OP_D2B, P4OP_COND
+} P4Op;
+
+typedef struct P4Expr P4Expr;
+
+struct P4Expr {
+	P4ExprKind Kind;
+	P4Op Op;
+	uint64_t Const;
+	uint32_t Header;	/* P4E_FIELD / P4E_VALID, stack for STACK_FIELD */
+	uint32_t Field;
+	uint32_t Width;		/* field width, 0 if unknown */
+	P4Expr *Left;
+	P4Expr *Right;
+	P4Expr *Cond;
+};
+
+typedef enum {
+	P4P_EXTRACT,
+	P4P_EXTRACT_STACK,
+	P4P_EXTRACT_VL,
+	P4P_SET,
+	P4P_VERIFY
+} P4ParserOpKind;
+
+typedef struct {
+	P4ParserOpKind Kind;
+	uint32_t Header;	/* header, or stack for EXTRACT_STACK */
+	uint32_t Field;		/* SET destination field */
+	P4Expr *Expr;		/* SET source, VERIFY condition, VL bits */
+	P4Expr *Error;		/* VERIFY error code */
+} P4ParserOp;
+
+typedef struct {
+	int IsDefault;
+	uint64_t Value;
+	uint64_t Mask;
+	uint32_t Next;		/* parse state or P4_NONE for accept */
+} P4Transition;
+
+typedef struct {
+	char *Name;
+	uint32_t NumOps;
+	P4ParserOp *Ops;
+	uint32_t NumKeys;
+	P4Expr *Keys[P4_MAX_KEY_FIELDS];
+	uint32_t KeyBits;
+	uint32_t NumTransitions;
+	P4Transition *Transitions;
+} P4ParseState;
+
+typedef enum {
+	P4A_ASSIGN,
+	P4A_DROP,
+	P4A_ADD_HEADER,
+	P4A_REMOVE_HEADER,
+	P4A_COUNT,
+	P4A_METER
+} P4PrimKind;
+
+typedef struct {
+	P4PrimKind Kind;
+	uint32_t Header;	/* destination, meter color for P4A_METER */
+	uint32_t Field;
+	uint32_t Extern;	/* counter or meter array */
+	P4Expr *Src;		/* assigned value, or counter/meter index */
+} P4Primitive;
+
+typedef struct {
+	char *Name;
+	uint32_t NumParams;
+	uint32_t ParamWidth[P4_MAX_PARAMS];
+	uint32_t NumPrims;
+	P4Primitive *Prims;
+} P4Action;
+
+typedef enum {
+	P4M_EXACT,
+	P4M_TERNARY,
+	P4M_LPM,
+	P4M_VALID
+} P4MatchKind;
+
+typedef struct {
+	uint32_t Priority;
+	uint64_t Key[P4_MAX_KEY_FIELDS];
+	uint64_t Mask[P4_MAX_KEY_FIELDS];
+	uint32_t Action;
+	uint64_t Params[P4_MAX_PARAMS];
+} P4Entry;
+
+/*
+ * Pipeline nodes are tables and conditionals in one index space: the low
+ * bit of a node reference tells which, see P4_NODE_* below.
+ */
+#define P4_NODE_TABLE(i)	((i) << 1)
+#define P4_NODE_COND(i)		(((i) << 1) | 1)
+#define P4_NODE_IS_COND(n)	((n) & 1)
+#define P4_NODE_INDEX(n)	((n) >> 1)
+
+typedef struct {
+	char *Name;
+	uint32_t NumKeys;
+	P4Expr *Keys[P4_MAX_KEY_FIELDS];
+	P4MatchKind Match[P4_MAX_KEY_FIELDS];
+	uint32_t KeyWidth[P4_MAX_KEY_FIELDS];
+	uint32_t MaxSize;
+	uint32_t NumActions;
+	uint32_t *Actions;	/* action ids allowed in this table */
+	uint32_t *ActionNext;	/* next node per allowed action */
+	uint32_t BaseDefaultNext;
+	uint32_t DefaultAction;
+	uint64_t DefaultParams[P4_MAX_PARAMS];
+	uint32_t NumEntries;	/* sorted by Priority, lowest first */
+	P4Entry *Entries;
+} P4Table;
+
+typedef struct {
+	char *Name;
+	P4Expr *Expr;
+	uint32_t TrueNext;
+	uint32_t FalseNext;
+} P4Cond;
+
+/* Indirect counter extern; every cell counts packets and bytes */
+typedef struct {
+	char *Name;
+	uint32_t Size;
+	uint32_t CellBase;	/* first cell of this array in P4State */
+} P4CounterArray;
+
+/* Meter colors as written by execute_meter */
+#define P4_COLOR_GREEN		0
+#define P4_COLOR_YELLOW		1
+#define P4_COLOR_RED		2
+
+/*
+ * Rates of one two-rate three-color meter cell (RFC 2698). Rates are in
+ * bit/s for byte meters and packet/s for packet meters, bursts in bytes or
+ * packets. A cell with Pir == 0 is unconfigured and colors everything
+ * green.
+ */
+typedef struct {
+	uint64_t Cir;
+	uint64_t Cbs;
+	uint64_t Pir;
+	uint64_t Pbs;
+} P4MeterRate;
+
+/* Indirect meter extern */
+typedef struct {
+	char *Name;
+	uint32_t Size;
+	int Packets;		/* meters packets rather than bytes */
+	uint32_t CellBase;	/* first cell of this array in P4State */
+	P4MeterRate *Rates;	/* per cell, set by P4LoadEntries */
+} P4MeterArray;
+
+typedef struct {
+	JsonValue *Json;
+
+	uint32_t NumHeaderTypes;
+	P4HeaderType *HeaderTypes;
+	uint32_t NumHeaders;
+	P4Header *Headers;
+	uint32_t NumStacks;
+	P4Stack *Stacks;
+	uint32_t NumValues;	/* total field slots across all headers */
+
+	uint32_t NumErrors;
+	char **ErrorNames;
+	uint32_t *ErrorCodes;
+
+	uint32_t NumStates;
+	P4ParseState *States;
+	uint32_t InitState;
+
+	uint32_t NumActions;
+	P4Action *Actions;
+	uint32_t NumTables;
+	P4Table *Tables;
+	uint32_t NumConds;
+	P4Cond *Conds;
+	uint32_t InitNode;
+
+	uint32_t NumCounters;
+	P4CounterArray *Counters;
+	uint32_t NumCounterCells;	/* sum of all counter array sizes */
+
+	uint32_t NumMeters;
+	P4MeterArray *Meters;
+	uint32_t NumMeterCells;		/* sum of all meter array sizes */
+
+	uint32_t NumEmits;
+	uint32_t *Emits;	/* deparser header order */
+
+	/* Well-known fields, P4_NONE when absent */
+	uint32_t StdMetaHeader;
+	uint32_t DropField;
+	uint32_t ParserErrorField;
+	uint32_t TimestampField;	/* standard_metadata ingress_timestamp */
+} P4Program;
+
+/************************** Function Prototypes *****************************/
+
+int P4ProgramLoad(P4Program *Prog, const char *Path, char *ErrBuf,
+		  size_t ErrLen);
+void P4ProgramFree(P4Program *Prog);
+
+uint32_t P4FindHeader(const P4Program *Prog, const char *Name);
+int P4FindField(const P4Program *Prog, const char *Dotted,
+		uint32_t *HeaderPtr, uint32_t *FieldPtr);
+uint32_t P4FindTable(const P4Program *Prog, const char *Name);
+uint32_t P4FindAction(const P4Program *Prog, const char *Name);
+uint32_t P4FindCounter(const P4Program *Prog, const char *Name);
+uint32_t P4FindMeter(const P4Program *Prog, const char *Name);
+uint32_t P4ErrorCode(const P4Program *Prog, const char *Name);
+
+int P4TableAddEntry(P4Program *Prog, uint32_t Table, const P4Entry *Entry);
+int P4LoadEntries(P4Program *Prog, const char *Path, char *ErrBuf,
+		  size_t ErrLen);
+
+#endif /* P4_PROG_H */
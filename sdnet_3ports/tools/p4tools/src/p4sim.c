@@ -0,0 +1,654 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file p4sim.c
+*
+* Bit-accurate interpreter for the parser, ingress pipeline and deparser
+* of a P4Program. Fields are kept as 64-bit values masked to their declared
+* width; arithmetic is done in 64 bits and relies on the masks that p4c
+* already inserts into the expressions, as the SDNet pipeline does.
+*
+* Parser errors follow the SDNet behaviour: the error code is written to
+* standard_metadata.parser_error, parsing stops and the packet still goes
+* through the pipeline.
+*
+*****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "p4sim.h"
+
+#define P4_NS_PER_S		1000000000ULL
+
+static inline uint64_t P4Mask(uint32_t Width)
+{
+	return (Width >= 64) ? UINT64_MAX : ((1ULL << Width) - 1);
+}
+
+/* Reads Width (1..64) bits starting Off bits into P, network order */
+static uint64_t P4ReadBits(const uint8_t *P, uint32_t Off, uint32_t Width)
+{
+	const uint8_t *B = P + (Off >> 3);
+	uint32_t Shift = Off & 7;
+	uint32_t NBytes = (Shift + Width + 7) >> 3;
+	uint64_t V = 0;
+	uint32_t I;
+
+	if (NBytes <= 8) {
+		for (I = 0; I < NBytes; I++) {
+			V = (V << 8) | B[I];
+		}
+		V >>= NBytes * 8 - Shift - Width;
+	} else {
+		uint32_t Drop = 72 - Shift - Width;
+
+		for (I = 0; I < 8; I++) {
+			V = (V << 8) | B[I];
+		}
+		V = (V << (8 - Drop)) | (uint64_t)(B[8] >> Drop);
+	}
+	return V & P4Mask(Width);
+}
+
+static void P4WriteBits(uint8_t *P, uint32_t Off, uint32_t Width,
+			uint64_t V)
+{
+	uint32_t I;
+
+	for (I = 0; I < Width; I++) {
+		uint32_t Bit = Off + I;
+		uint8_t M = (uint8_t)(0x80 >> (Bit & 7));
+
+		if ((V >> (Width - 1 - I)) & 1) {
+			P[Bit >> 3] |= M;
+		} else {
+			P[Bit >> 3] &= (uint8_t)~M;
+		}
+	}
+}
+
+static uint32_t P4ErrorOr(const P4Program *Prog, const char *Name,
+			  uint32_t Fallback)
+{
+	uint32_t Code = P4ErrorCode(Prog, Name);
+
+	return (Code == P4_NONE) ? Fallback : Code;
+}
+
+/****************************************************************************/
+/**
+*
+* Allocates the per-packet state for a program.
+*
+* @return	0 on success, -1 if out of memory.
+*
+*****************************************************************************/
+int P4StateInit(P4State *St, const P4Program *Prog)
+{
+	uint32_t I;
+
+	memset(St, 0, sizeof(*St));
+	St->Prog = Prog;
+	St->Values = calloc(Prog->NumValues + 1, sizeof(uint64_t));
+	St->Valid = calloc(Prog->NumHeaders + 1, sizeof(uint8_t));
+	St->ValidInit = calloc(Prog->NumHeaders + 1, sizeof(uint8_t));
+	St->VarOffset = calloc(Prog->NumHeaders + 1, sizeof(uint32_t));
+	St->VarBytes = calloc(Prog->NumHeaders + 1, sizeof(uint32_t));
+	St->StackNext = calloc(Prog->NumStacks + 1, sizeof(uint32_t));
+	St->CounterPackets = calloc(Prog->NumCounterCells + 1, sizeof(uint64_t));
+	St->CounterBytes = calloc(Prog->NumCounterCells + 1, sizeof(uint64_t));
+	St->MeterTc = calloc(Prog->NumMeterCells + 1, sizeof(uint64_t));
+	St->MeterTp = calloc(Prog->NumMeterCells + 1, sizeof(uint64_t));
+	St->MeterLast = calloc(Prog->NumMeterCells + 1, sizeof(uint64_t));
+	if (St->Values == NULL || St->Valid == NULL || St->ValidInit == NULL ||
+	    St->VarOffset == NULL || St->VarBytes == NULL ||
+	    St->StackNext == NULL || St->CounterPackets == NULL ||
+	    St->CounterBytes == NULL || St->MeterTc == NULL ||
+	    St->MeterTp == NULL || St->MeterLast == NULL) {
+		P4StateFree(St);
+		return -1;
+	}
+	/* Buckets start full on the first packet that reaches them */
+	for (I = 0; I < Prog->NumMeterCells; I++) {
+		St->MeterLast[I] = UINT64_MAX;
+	}
+
+	/* Metadata and the compiler's scalars are never extracted */
+	for (I = 0; I < Prog->NumHeaders; I++) {
+		St->ValidInit[I] = (uint8_t)(Prog->Headers[I].Metadata ||
+			strcmp(Prog->Headers[I].Name, "scalars") == 0);
+	}
+
+	/* Codes of the P4 core errors, in core.p4 order if not declared */
+	St->ErrPacketTooShort = P4ErrorOr(Prog, "PacketTooShort", 1);
+	St->ErrNoMatch = P4ErrorOr(Prog, "NoMatch", 2);
+	St->ErrStackOutOfBounds = P4ErrorOr(Prog, "StackOutOfBounds", 3);
+	St->ErrHeaderTooShort = P4ErrorOr(Prog, "HeaderTooShort", 4);
+	St->ErrParserTimeout = P4ErrorOr(Prog, "ParserTimeout", 5);
+	return 0;
+}
+
+void P4StateFree(P4State *St)
+{
+	free(St->Values);
+	free(St->Valid);
+	free(St->ValidInit);
+	free(St->VarOffset);
+	free(St->VarBytes);
+	free(St->StackNext);
+	free(St->CounterPackets);
+	free(St->CounterBytes);
+	free(St->MeterTc);
+	free(St->MeterTp);
+	free(St->MeterLast);
+	memset(St, 0, sizeof(*St));
+}
+
+/*****************************************************************************/
+/*
+ * Expressions
+ */
+static uint32_t P4StackLast(const P4State *St, uint32_t Stack)
+{
+	const P4Stack *S = &St->Prog->Stacks[Stack];
+	uint32_t Next = St->StackNext[Stack];
+
+	return S->Headers[(Next == 0) ? 0 : Next - 1];
+}
+
+static uint64_t P4Eval(const P4State *St, const P4Expr *E,
+		       const uint64_t *Params)
+{
+	const P4Program *Prog = St->Prog;
+	uint64_t L;
+	uint64_t R;
+
+	switch (E->Kind) {
+	case P4E_CONST:
+		return E->Const;
+	case P4E_FIELD:
+		return St->Values[Prog->Headers[E->Header].ValueBase + E->Field];
+	case P4E_VALID:
+		return St->Valid[E->Header];
+	case P4E_STACK_FIELD:
+		return St->Values[Prog->Headers[P4StackLast(St, E->Header)].ValueBase +
+				  E->Field];
+	case P4E_RUNTIME:
+		return (Params != NULL) ? Params[E->Field] : 0;
+	case P4E_OP:
+		break;
+	}
+
+	if (E->Op == P4OP_COND) {
+		return P4Eval(St, E->Cond, Params) ? P4Eval(St, E->Left, Params) :
+						     P4Eval(St, E->Right, Params);
+	}
+	if (E->Op == P4OP_LAND) {
+		return P4Eval(St, E->Left, Params) && P4Eval(St, E->Right, Params);
+	}
+	if (E->Op == P4OP_LOR) {
+		return P4Eval(St, E->Left, Params) || P4Eval(St, E->Right, Params);
+	}
+
+	L = (E->Left != NULL) ? P4Eval(St, E->Left, Params) : 0;
+	R = (E->Right != NULL) ? P4Eval(St, E->Right, Params) : 0;
+	switch (E->Op) {
+	case P4OP_ADD: return L + R;
+	case P4OP_SUB: return L - R;
+	case P4OP_MUL: return L * R;
+	case P4OP_SHL: return (R >= 64) ? 0 : L << R;
+	case P4OP_SHR: return (R >= 64) ? 0 : L >> R;
+	case P4OP_AND: return L & R;
+	case P4OP_OR: return L | R;
+	case P4OP_XOR: return L ^ R;
+	case P4OP_NOT: return ~R;
+	case P4OP_EQ: return L == R;
+	case P4OP_NE: return L != R;
+	case P4OP_LT: return L < R;
+	case P4OP_LE: return L <= R;
+	case P4OP_GT: return L > R;
+	case P4OP_GE: return L >= R;
+	case P4OP_LNOT: return !R;
+	case P4OP_B2D:
+	case P4OP_D2B: return R != 0;
+	default: return 0;
+	}
+}
+
+static void P4SetField(P4State *St, uint32_t Header, uint32_t Field,
+		       uint64_t Value)
+{
+	const P4Program *Prog = St->Prog;
+	const P4Header *H = &Prog->Headers[Header];
+
+	St->Values[H->ValueBase + Field] = Value &
+		P4Mask(Prog->HeaderTypes[H->Type].Fields[Field].Width);
+}
+
+uint64_t P4GetField(const P4State *St, uint32_t Header, uint32_t Field)
+{
+	return St->Values[St->Prog->Headers[Header].ValueBase + Field];
+}
+
+/*****************************************************************************/
+/*
+ * Parser
+ */
+
+/* Extracts one header at bit offset *CursorPtr, VarBits for a varbit field */
+static uint32_t P4Extract(P4State *St, uint32_t Header, uint32_t *CursorPtr,
+			  uint32_t VarBits)
+{
+	const P4Program *Prog = St->Prog;
+	const P4Header *H = &Prog->Headers[Header];
+	const P4HeaderType *T = &Prog->HeaderTypes[H->Type];
+	uint32_t Cursor = *CursorPtr;
+	uint32_t I;
+
+	if (T->VarField != P4_NONE &&
+	    (VarBits & 7 || VarBits > T->Fields[T->VarField].MaxBytes * 8)) {
+		return St->ErrHeaderTooShort;
+	}
+	if ((uint64_t)Cursor + T->FixedBits + VarBits >
+	    (uint64_t)St->PktLen * 8) {
+		return St->ErrPacketTooShort;
+	}
+
+	for (I = 0; I < T->NumFields; I++) {
+		uint32_t W = T->Fields[I].Width;
+
+		if (I == T->VarField) {
+			St->VarOffset[Header] = Cursor >> 3;
+			St->VarBytes[Header] = VarBits >> 3;
+			Cursor += VarBits;
+			continue;
+		}
+		St->Values[H->ValueBase + I] = P4ReadBits(St->Pkt, Cursor, W);
+		Cursor += W;
+	}
+	St->Valid[Header] = 1;
+	*CursorPtr = Cursor;
+	return 0;
+}
+
+static uint32_t P4Parse(P4State *St)
+{
+	const P4Program *Prog = St->Prog;
+	uint32_t State = Prog->InitState;
+	uint32_t Cursor = 0;
+	uint32_t Steps = 0;
+	uint32_t Err = 0;
+	uint32_t I;
+
+	while (State != P4_NONE) {
+		const P4ParseState *S = &Prog->States[State];
+		uint64_t Key = 0;
+
+		if (++Steps > P4_MAX_PARSE_STEPS) {
+			Err = St->ErrParserTimeout;
+			break;
+		}
+
+		for (I = 0; I < S->NumOps && Err == 0; I++) {
+			const P4ParserOp *Op = &S->Ops[I];
+			uint32_t Idx;
+
+			switch (Op->Kind) {
+			case P4P_EXTRACT:
+				Err = P4Extract(St, Op->Header, &Cursor, 0);
+				break;
+			case P4P_EXTRACT_STACK:
+				Idx = St->StackNext[Op->Header];
+				if (Idx >= Prog->Stacks[Op->Header].Size) {
+					Err = St->ErrStackOutOfBounds;
+					break;
+				}
+				Err = P4Extract(St,
+					Prog->Stacks[Op->Header].Headers[Idx],
+					&Cursor, 0);
+				if (Err == 0) {
+					St->StackNext[Op->Header]++;
+				}
+				break;
+			case P4P_EXTRACT_VL:
+				Err = P4Extract(St, Op->Header, &Cursor,
+					(uint32_t)P4Eval(St, Op->Expr, NULL));
+				break;
+			case P4P_SET:
+				P4SetField(St, Op->Header, Op->Field,
+					   P4Eval(St, Op->Expr, NULL));
+				break;
+			case P4P_VERIFY:
+				if (!P4Eval(St, Op->Expr, NULL)) {
+					Err = (uint32_t)P4Eval(St, Op->Error, NULL);
+				}
+				break;
+			}
+		}
+		if (Err != 0) {
+			break;
+		}
+
+		for (I = 0; I < S->NumKeys; I++) {
+			uint32_t W = S->Keys[I]->Width;
+
+			Key = (W >= 64 ? 0 : Key << W) |
+			      (P4Eval(St, S->Keys[I], NULL) & P4Mask(W));
+		}
+
+		for (I = 0; I < S->NumTransitions; I++) {
+			const P4Transition *T = &S->Transitions[I];
+
+			if (T->IsDefault || (Key & T->Mask) == T->Value) {
+				break;
+			}
+		}
+		if (I == S->NumTransitions) {
+			Err = St->ErrNoMatch;
+			break;
+		}
+		State = S->Transitions[I].Next;
+	}
+
+	St->PayloadOffset = (Cursor + 7) >> 3;
+	return Err;
+}
+
+/*****************************************************************************/
+/*
+ * Pipeline
+ */
+static void P4Refill(uint64_t *TokensPtr, uint64_t Rate, uint64_t Cap,
+		     uint64_t Dt)
+{
+	/* Checked by division first so that long idle gaps cannot overflow */
+	if (*TokensPtr >= Cap || Rate == 0) {
+		return;
+	}
+	if (Dt > (Cap - *TokensPtr) / Rate) {
+		*TokensPtr = Cap;
+	} else {
+		*TokensPtr += Rate * Dt;
+	}
+}
+
+/*
+ * Color-blind two-rate three-color marker, RFC 2698 section 3
+ */
+static uint32_t P4MeterColor(P4State *St, const P4MeterArray *M,
+			     uint64_t Index)
+{
+	const P4MeterRate *R;
+	uint64_t Unit = M->Packets ? 1 : 8;
+	uint64_t Size = (M->Packets ? 1 : 8 * (uint64_t)St->PktLen) *
+			P4_NS_PER_S;
+	uint64_t Cbs;
+	uint64_t Pbs;
+	uint64_t Dt = 0;
+	uint32_t Cell;
+
+	if (Index >= M->Size || M->Rates[Index].Pir == 0) {
+		return P4_COLOR_GREEN;
+	}
+	R = &M->Rates[Index];
+	Cell = M->CellBase + (uint32_t)Index;
+	Cbs = R->Cbs * Unit * P4_NS_PER_S;
+	Pbs = R->Pbs * Unit * P4_NS_PER_S;
+
+	if (St->MeterLast[Cell] == UINT64_MAX) {
+		St->MeterTc[Cell] = Cbs;
+		St->MeterTp[Cell] = Pbs;
+	} else if (St->Now > St->MeterLast[Cell]) {
+		Dt = St->Now - St->MeterLast[Cell];
+	}
+	St->MeterLast[Cell] = St->Now;
+	P4Refill(&St->MeterTc[Cell], R->Cir, Cbs, Dt);
+	P4Refill(&St->MeterTp[Cell], R->Pir, Pbs, Dt);
+
+	if (St->MeterTp[Cell] < Size) {
+		return P4_COLOR_RED;
+	}
+	St->MeterTp[Cell] -= Size;
+	if (St->MeterTc[Cell] < Size) {
+		return P4_COLOR_YELLOW;
+	}
+	St->MeterTc[Cell] -= Size;
+	return P4_COLOR_GREEN;
+}
+
+static void P4Execute(P4State *St, uint32_t ActionId, const uint64_t *Params)
+{
+	const P4Program *Prog = St->Prog;
+	const P4Action *A = &Prog->Actions[ActionId];
+	uint32_t I;
+
+	for (I = 0; I < A->NumPrims; I++) {
+		const P4Primitive *P = &A->Prims[I];
+		const P4HeaderType *T;
+		const P4Header *H;
+		const P4CounterArray *C;
+		uint64_t Index;
+
+		switch (P->Kind) {
+		case P4A_ASSIGN:
+			P4SetField(St, P->Header, P->Field,
+				   P4Eval(St, P->Src, Params));
+			break;
+		case P4A_DROP:
+			if (Prog->DropField != P4_NONE) {
+				P4SetField(St, Prog->StdMetaHeader,
+					   Prog->DropField, 1);
+			}
+			break;
+		case P4A_ADD_HEADER:
+			H = &Prog->Headers[P->Header];
+			T = &Prog->HeaderTypes[H->Type];
+			memset(&St->Values[H->ValueBase], 0,
+			       T->NumFields * sizeof(uint64_t));
+			St->VarBytes[P->Header] = 0;
+			St->Valid[P->Header] = 1;
+			break;
+		case P4A_REMOVE_HEADER:
+			St->Valid[P->Header] = 0;
+			break;
+		case P4A_COUNT:
+			/* Indices past the end of the array are not counted */
+			C = &Prog->Counters[P->Extern];
+			Index = P4Eval(St, P->Src, Params);
+			if (Index < C->Size) {
+				St->CounterPackets[C->CellBase + Index]++;
+				St->CounterBytes[C->CellBase + Index] += St->PktLen;
+			}
+			break;
+		case P4A_METER:
+			/* Unconfigured cells and out of range indices are green */
+			Index = P4Eval(St, P->Src, Params);
+			P4SetField(St, P->Header, P->Field,
+				   P4MeterColor(St, &Prog->Meters[P->Extern],
+						Index));
+			break;
+		}
+	}
+}
+
+static uint32_t P4ApplyTable(P4State *St, const P4Table *Tbl)
+{
+	uint64_t Key[P4_MAX_KEY_FIELDS];
+	const uint64_t *Params = Tbl->DefaultParams;
+	uint32_t Action = Tbl->DefaultAction;
+	uint32_t I;
+	uint32_t K;
+
+	for (K = 0; K < Tbl->NumKeys; K++) {
+		Key[K] = P4Eval(St, Tbl->Keys[K], NULL) & P4Mask(Tbl->KeyWidth[K]);
+	}
+
+	for (I = 0; I < Tbl->NumEntries; I++) {
+		const P4Entry *E = &Tbl->Entries[I];
+
+		for (K = 0; K < Tbl->NumKeys; K++) {
+			if ((Key[K] & E->Mask[K]) != E->Key[K]) {
+				break;
+			}
+		}
+		if (K == Tbl->NumKeys) {
+			Action = E->Action;
+			Params = E->Params;
+			break;
+		}
+	}
+
+	if (Action == P4_NONE) {
+		return Tbl->BaseDefaultNext;
+	}
+	P4Execute(St, Action, Params);
+	for (I = 0; I < Tbl->NumActions; I++) {
+		if (Tbl->Actions[I] == Action) {
+			return Tbl->ActionNext[I];
+		}
+	}
+	return Tbl->BaseDefaultNext;
+}
+
+static void P4RunPipeline(P4State *St)
+{
+	const P4Program *Prog = St->Prog;
+	uint32_t Node = Prog->InitNode;
+
+	while (Node != P4_NONE) {
+		if (P4_NODE_IS_COND(Node)) {
+			const P4Cond *C = &Prog->Conds[P4_NODE_INDEX(Node)];
+
+			Node = P4Eval(St, C->Expr, NULL) ? C->TrueNext :
+							   C->FalseNext;
+		} else {
+			Node = P4ApplyTable(St,
+					    &Prog->Tables[P4_NODE_INDEX(Node)]);
+		}
+	}
+}
+
+/****************************************************************************/
+/**
+*
+* Runs one packet through the parser and the ingress pipeline. The result
+* stays in St until the next call: read metadata with P4GetField and the
+* rewritten frame with P4Deparse.
+*
+* @param	St is the state of the calling thread.
+* @param	Pkt is the frame, starting at the destination MAC. It must stay
+*		valid until P4Deparse has been called.
+* @param	Len is the frame length in bytes.
+* @param	Presets are metadata values (e.g. metadata.axis_tid) set before
+*		the parser runs, as the AXI-Stream sideband would.
+* @param	NumPresets is the number of presets.
+*
+*****************************************************************************/
+void P4Process(P4State *St, const uint8_t *Pkt, uint32_t Len,
+	       const P4Preset *Presets, uint32_t NumPresets)
+{
+	const P4Program *Prog = St->Prog;
+	uint32_t I;
+
+	memset(St->Values, 0, Prog->NumValues * sizeof(uint64_t));
+	memset(St->StackNext, 0, Prog->NumStacks * sizeof(uint32_t));
+	memcpy(St->Valid, St->ValidInit, Prog->NumHeaders);
+	if (Prog->TimestampField != P4_NONE) {
+		P4SetField(St, Prog->StdMetaHeader, Prog->TimestampField,
+			   St->Now);
+	}
+	for (I = 0; I < NumPresets; I++) {
+		P4SetField(St, Presets[I].Header, Presets[I].Field,
+			   Presets[I].Value);
+	}
+
+	St->Pkt = Pkt;
+	St->PktLen = Len;
+	St->ParserError = P4Parse(St);
+	if (St->ParserError != 0 && Prog->ParserErrorField != P4_NONE) {
+		P4SetField(St, Prog->StdMetaHeader, Prog->ParserErrorField,
+			   St->ParserError);
+	}
+
+	P4RunPipeline(St);
+}
+
+/****************************************************************************/
+/**
+*
+* Serializes the valid headers in deparser order followed by the part of
+* the frame the parser did not consume.
+*
+* @return	Length written to Out, or 0 if OutLen is too small.
+*
+*****************************************************************************/
+uint32_t P4Deparse(const P4State *St, uint8_t *Out, uint32_t OutLen)
+{
+	const P4Program *Prog = St->Prog;
+	uint32_t Cursor = 0;
+	uint32_t I;
+	uint32_t J;
+
+	for (I = 0; I < Prog->NumEmits; I++) {
+		uint32_t Hi = Prog->Emits[I];
+		const P4Header *H = &Prog->Headers[Hi];
+		const P4HeaderType *T = &Prog->HeaderTypes[H->Type];
+
+		if (!St->Valid[Hi]) {
+			continue;
+		}
+		if ((uint64_t)Cursor + T->FixedBits + St->VarBytes[Hi] * 8 >
+		    (uint64_t)OutLen * 8) {
+			return 0;
+		}
+		for (J = 0; J < T->NumFields; J++) {
+			if (J == T->VarField) {
+				/* Varbit data must stay byte aligned */
+				memcpy(Out + (Cursor >> 3),
+				       St->Pkt + St->VarOffset[Hi],
+				       St->VarBytes[Hi]);
+				Cursor += St->VarBytes[Hi] * 8;
+				continue;
+			}
+			P4WriteBits(Out, Cursor, T->Fields[J].Width,
+				    St->Values[H->ValueBase + J]);
+			Cursor += T->Fields[J].Width;
+		}
+	}
+
+	Cursor = (Cursor + 7) >> 3;
+	if (St->PayloadOffset < St->PktLen) {
+		uint32_t Rest = St->PktLen - St->PayloadOffset;
+
+		if (Cursor + Rest > OutLen) {
+			return 0;
+		}
+		memcpy(Out + Cursor, St->Pkt + St->PayloadOffset, Rest);
+		Cursor += Rest;
+	}
+	return Cursor;
+}
+
+int P4Dropped(const P4State *St)
+{
+	const P4Program *Prog = St->Prog;
+
+	return Prog->DropField != P4_NONE &&
+	       P4GetField(St, Prog->StdMetaHeader, Prog->DropField) != 0;
+}
+
+const char *P4ErrorName(const P4Program *Prog, uint32_t Code)
+{
+	uint32_t I;
+
+	for (I = 0; I < Prog->NumErrors; I++) {
+		if (Prog->ErrorCodes[I] == Code) {
+			return Prog->ErrorNames[I];
+		}
+	}
+	return "?";
+}
@@ -0,0 +1,88 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file p4sim.h
+*
+* Packet interpreter for a loaded P4Program: parser, ingress pipeline and
+* deparser. A P4State holds everything that changes per packet, so one
+* program can be shared read-only by several threads, each with its own
+* state. Counter and meter externs are kept per state too; add counters up
+* across threads when reporting. Meters only see the packets of their own
+* state, so give each thread its own meter configuration if it matters.
+*
+*****************************************************************************/
+#ifndef P4_SIM_H
+#define P4_SIM_H
+
+#include <stdint.h>
+#include "p4prog.h"
+
+/* Upper bound on parse state visits per packet before ParserTimeout */
+#define P4_MAX_PARSE_STEPS	64
+
+/**************************** Type Definitions ******************************/
+
+typedef struct {
+	const P4Program *Prog;
+	uint64_t *Values;	/* one slot per header field, see ValueBase */
+	uint8_t *Valid;		/* per header */
+	uint8_t *ValidInit;	/* per header, validity before parsing */
+	uint32_t *VarOffset;	/* per header, byte offset of varbit data */
+	uint32_t *VarBytes;	/* per header, varbit length in bytes */
+	uint32_t *StackNext;	/* per stack, next element to extract */
+	const uint8_t *Pkt;
+	uint32_t PktLen;
+	uint32_t PayloadOffset;	/* first byte not consumed by the parser */
+	uint32_t ParserError;
+
+	/*
+	 * Counter extern cells, see P4CounterArray.CellBase. Unlike the
+	 * rest of the state they accumulate across packets.
+	 */
+	uint64_t *CounterPackets;
+	uint64_t *CounterBytes;
+
+	/*
+	 * Meter buckets, see P4MeterArray.CellBase. Tokens are in rate units
+	 * times ns, so a refill is a single multiply. Set Now to the arrival
+	 * time of each packet before P4Process; it also becomes
+	 * standard_metadata.ingress_timestamp.
+	 */
+	uint64_t *MeterTc;
+	uint64_t *MeterTp;
+	uint64_t *MeterLast;	/* time of the last update, or UINT64_MAX */
+	uint64_t Now;		/* ns */
+
+	/* Error codes resolved once from the program's error table */
+	uint32_t ErrPacketTooShort;
+	uint32_t ErrNoMatch;
+	uint32_t ErrStackOutOfBounds;
+	uint32_t ErrHeaderTooShort;
+	uint32_t ErrParserTimeout;
+} P4State;
+
+/* Metadata preset applied before parsing each packet */
+typedef struct {
+	uint32_t Header;
+	uint32_t Field;
+	uint64_t Value;
+} P4Preset;
+
+/************************** Function Prototypes *****************************/
+
+int P4StateInit(P4State *St, const P4Program *Prog);
+void P4StateFree(P4State *St);
+
+void P4Process(P4State *St, const uint8_t *Pkt, uint32_t Len,
+	       const P4Preset *Presets, uint32_t NumPresets);
+uint32_t P4Deparse(const P4State *St, uint8_t *Out, uint32_t OutLen);
+
+uint64_t P4GetField(const P4State *St, uint32_t Header, uint32_t Field);
+int P4Dropped(const P4State *St);
+const char *P4ErrorName(const P4Program *Prog, uint32_t Code);
+
+#endif /* P4_SIM_H */
@@ -0,0 +1,620 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file p4sim_main.c
+*
+* p4sim: runs pcap captures through the compiled SDNet program (main.json)
+* on a host, so classification changes can be checked without a board.
+*
+*	p4sim -p main.json -e plane_policy.txt -o out \
+*	      --set metadata.axis_tid=0 -i ru.pcap \
+*	      --set metadata.axis_tid=2 -i cpu.pcap
+*
+* Every frame is written to out/tdest_<n>.pcap (or out/dropped.pcap) as
+* rewritten by the deparser, and out/metadata.csv gets one row per frame
+* with all user metadata fields and the parser error. --set applies to the
+* inputs that follow it, mirroring the AXI-Stream sideband of each port.
+* If the program has counter externs, out/counters.csv holds their final
+* packet and byte counts. Meters are configured with "meter" lines in the
+* entries files and run on the capture timestamps, which also become
+* standard_metadata.ingress_timestamp; inputs are processed one after the
+* other, not merged by time.
+*
+* With --bench <iterations> the inputs are loaded into memory and replayed
+* by --threads workers, each with its own interpreter state, and the rate
+* is reported in Mpps against 10G line rate for the same frame mix.
+*
+*****************************************************************************/
+
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include "p4prog.h"
+#include "p4sim.h"
+#include "pcap.h"
+
+#define P4SIM_MAX_INPUTS	32
+#define P4SIM_MAX_PRESETS	16
+#define P4SIM_MAX_THREADS	64
+#define P4SIM_MAX_TDEST		256
+#define P4SIM_FRAME_MAX		65536
+/* Preamble, SFD, FCS and minimum IFG on the wire per frame */
+#define P4SIM_WIRE_OVERHEAD	24
+
+/**************************** Type Definitions ******************************/
+
+typedef struct {
+	const char *Path;
+	uint32_t NumPresets;
+	P4Preset Presets[P4SIM_MAX_PRESETS];
+} P4SimInput;
+
+typedef struct {
+	uint8_t *Data;
+	uint32_t Len;
+	uint64_t TsNs;
+	const P4SimInput *Input;
+} P4SimFrame;
+
+typedef struct {
+	const P4Program *Prog;
+	const P4SimFrame *Frames;
+	uint32_t NumFrames;
+	uint64_t Iterations;
+	uint32_t TdestHeader;
+	uint32_t TdestField;
+	uint64_t Digest;
+	int Status;
+} P4SimWorker;
+
+/************************** Variable Definitions ****************************/
+
+static P4SimInput Inputs[P4SIM_MAX_INPUTS];
+static uint32_t NumInputs;
+
+/****************************************************************************/
+
+static void Usage(void)
+{
+	fprintf(stderr,
+		"usage: p4sim -p main.json [-e entries]... [-o outdir]\n"
+		"             [--tdest header.field] [--bench iterations]"
+		" [--threads n]\n"
+		"             {[--set header.field=value]... -i in.pcap}...\n");
+	exit(2);
+}
+
+static double NowSec(void)
+{
+	struct timespec Ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &Ts);
+	return (double)Ts.tv_sec + (double)Ts.tv_nsec * 1e-9;
+}
+
+/* Mixes the forwarding decision of one frame into a digest */
+static uint64_t Digest(uint64_t D, uint64_t Tdest, uint32_t Dropped,
+		       uint32_t Err)
+{
+	D ^= Tdest + ((uint64_t)Dropped << 40) + ((uint64_t)Err << 48);
+	return D * 0x100000001b3ULL;
+}
+
+static int ParsePreset(const P4Program *Prog, const char *Arg,
+		       P4Preset *Preset)
+{
+	char Name[128];
+	const char *Eq = strchr(Arg, '=');
+	char *End;
+
+	if (Eq == NULL || (size_t)(Eq - Arg) >= sizeof(Name)) {
+		return -1;
+	}
+	memcpy(Name, Arg, (size_t)(Eq - Arg));
+	Name[Eq - Arg] = '\0';
+	if (P4FindField(Prog, Name, &Preset->Header, &Preset->Field) != 0) {
+		return -1;
+	}
+	Preset->Value = strtoull(Eq + 1, &End, 0);
+	return (End != Eq + 1 && *End == '\0') ? 0 : -1;
+}
+
+/*****************************************************************************/
+/*
+ * File mode
+ */
+static int IsCsvField(const P4Program *Prog, uint32_t H)
+{
+	return Prog->Headers[H].Metadata && H != Prog->StdMetaHeader;
+}
+
+static void WriteCsvHeader(FILE *Csv, const P4Program *Prog)
+{
+	uint32_t H;
+	uint32_t F;
+
+	fprintf(Csv, "frame,input,len");
+	for (H = 0; H < Prog->NumHeaders; H++) {
+		const P4HeaderType *T = &Prog->HeaderTypes[Prog->Headers[H].Type];
+
+		if (!IsCsvField(Prog, H)) {
+			continue;
+		}
+		for (F = 0; F < T->NumFields; F++) {
+			if (strncmp(T->Fields[F].Name, "_padding", 8) != 0) {
+				fprintf(Csv, ",%s.%s", Prog->Headers[H].Name,
+					T->Fields[F].Name);
+			}
+		}
+	}
+	fprintf(Csv, ",parser_error,drop\n");
+}
+
+static void WriteCsvRow(FILE *Csv, const P4State *St, uint64_t Index,
+			const char *Input, uint32_t Len)
+{
+	const P4Program *Prog = St->Prog;
+	uint32_t H;
+	uint32_t F;
+
+	fprintf(Csv, "%" PRIu64 ",%s,%u", Index, Input, (unsigned)Len);
+	for (H = 0; H < Prog->NumHeaders; H++) {
+		const P4HeaderType *T = &Prog->HeaderTypes[Prog->Headers[H].Type];
+
+		if (!IsCsvField(Prog, H)) {
+			continue;
+		}
+		for (F = 0; F < T->NumFields; F++) {
+			if (strncmp(T->Fields[F].Name, "_padding", 8) != 0) {
+				fprintf(Csv, ",%" PRIu64, P4GetField(St, H, F));
+			}
+		}
+	}
+	fprintf(Csv, ",%s,%d\n", P4ErrorName(Prog, St->ParserError),
+		P4Dropped(St));
+}
+
+static int WriteCounters(const P4State *St, const char *OutDir)
+{
+	const P4Program *Prog = St->Prog;
+	char Path[4096];
+	FILE *F;
+	uint32_t I;
+	uint32_t J;
+
+	if (Prog->NumCounters == 0) {
+		return 0;
+	}
+	snprintf(Path, sizeof(Path), "%s/counters.csv", OutDir);
+	F = fopen(Path, "w");
+	if (F == NULL) {
+		fprintf(stderr, "p4sim: cannot write %s\n", Path);
+		return -1;
+	}
+	fprintf(F, "counter,index,packets,bytes\n");
+	for (I = 0; I < Prog->NumCounters; I++) {
+		const P4CounterArray *C = &Prog->Counters[I];
+
+		for (J = 0; J < C->Size; J++) {
+			fprintf(F, "%s,%u,%" PRIu64 ",%" PRIu64 "\n", C->Name,
+				(unsigned)J, St->CounterPackets[C->CellBase + J],
+				St->CounterBytes[C->CellBase + J]);
+		}
+	}
+	fclose(F);
+	return 0;
+}
+
+static int RunFiles(const P4Program *Prog, const char *OutDir,
+		    uint32_t TdestHeader, uint32_t TdestField)
+{
+	static PcapFile Out[P4SIM_MAX_TDEST];
+	static uint64_t OutCount[P4SIM_MAX_TDEST];
+	static uint8_t InBuf[P4SIM_FRAME_MAX];
+	static uint8_t OutBuf[P4SIM_FRAME_MAX + 1024];
+	PcapFile Dropped;
+	uint64_t NumDropped = 0;
+	uint64_t NumErrors = 0;
+	uint64_t Index = 0;
+	char Path[4096];
+	P4State St;
+	FILE *Csv;
+	uint32_t I;
+	int Status = 0;
+
+	if (mkdir(OutDir, 0777) != 0 && errno != EEXIST) {
+		fprintf(stderr, "p4sim: cannot create %s\n", OutDir);
+		return -1;
+	}
+	snprintf(Path, sizeof(Path), "%s/metadata.csv", OutDir);
+	Csv = fopen(Path, "w");
+	snprintf(Path, sizeof(Path), "%s/dropped.pcap", OutDir);
+	if (Csv == NULL ||
+	    PcapOpenWrite(&Dropped, Path, PCAP_LINKTYPE_ETHERNET) != 0 ||
+	    P4StateInit(&St, Prog) != 0) {
+		fprintf(stderr, "p4sim: cannot write to %s\n", OutDir);
+		return -1;
+	}
+	WriteCsvHeader(Csv, Prog);
+
+	for (I = 0; I < NumInputs && Status == 0; I++) {
+		PcapFile In;
+		PcapPacket Pkt;
+		int Rc;
+
+		if (PcapOpenRead(&In, Inputs[I].Path) != 0) {
+			fprintf(stderr, "p4sim: %s is not a pcap file\n",
+				Inputs[I].Path);
+			Status = -1;
+			break;
+		}
+		if (In.LinkType != PCAP_LINKTYPE_ETHERNET) {
+			fprintf(stderr, "p4sim: %s: link type %u is not "
+				"Ethernet\n", Inputs[I].Path,
+				(unsigned)In.LinkType);
+			PcapClose(&In);
+			Status = -1;
+			break;
+		}
+
+		while ((Rc = PcapRead(&In, &Pkt, InBuf, sizeof(InBuf))) == 1) {
+			PcapFile *Dst = &Dropped;
+			PcapPacket OutPkt = Pkt;
+			uint64_t Tdest;
+
+			St.Now = Pkt.TsNs;
+			P4Process(&St, InBuf, Pkt.CapLen, Inputs[I].Presets,
+				  Inputs[I].NumPresets);
+			WriteCsvRow(Csv, &St, Index++, Inputs[I].Path,
+				    Pkt.CapLen);
+			NumErrors += (St.ParserError != 0);
+
+			OutPkt.CapLen = P4Deparse(&St, OutBuf, sizeof(OutBuf));
+			OutPkt.OrigLen = OutPkt.CapLen + (Pkt.OrigLen - Pkt.CapLen);
+
+			Tdest = P4GetField(&St, TdestHeader, TdestField);
+			if (P4Dropped(&St)) {
+				NumDropped++;
+			} else if (Tdest >= P4SIM_MAX_TDEST) {
+				fprintf(stderr, "p4sim: frame %" PRIu64
+					": tdest %" PRIu64 " out of range\n",
+					Index - 1, Tdest);
+				NumDropped++;
+			} else {
+				Dst = &Out[Tdest];
+				if (Dst->F == NULL) {
+					snprintf(Path, sizeof(Path),
+						 "%s/tdest_%u.pcap", OutDir,
+						 (unsigned)Tdest);
+					if (PcapOpenWrite(Dst, Path,
+						PCAP_LINKTYPE_ETHERNET) != 0) {
+						Status = -1;
+						break;
+					}
+				}
+				OutCount[Tdest]++;
+			}
+			if (PcapWrite(Dst, &OutPkt, OutBuf) != 0) {
+				Status = -1;
+				break;
+			}
+		}
+		if (Rc < 0) {
+			fprintf(stderr, "p4sim: %s: truncated record\n",
+				Inputs[I].Path);
+			Status = -1;
+		}
+		PcapClose(&In);
+	}
+
+	printf("%" PRIu64 " frames, %" PRIu64 " parser errors, %" PRIu64
+	       " dropped\n", Index, NumErrors, NumDropped);
+	for (I = 0; I < P4SIM_MAX_TDEST; I++) {
+		if (Out[I].F != NULL) {
+			printf("  tdest %3u: %" PRIu64 "\n", (unsigned)I,
+			       OutCount[I]);
+			PcapClose(&Out[I]);
+		}
+	}
+
+	if (Status == 0) {
+		Status = WriteCounters(&St, OutDir);
+	}
+
+	PcapClose(&Dropped);
+	fclose(Csv);
+	P4StateFree(&St);
+	return Status;
+}
+
+/*****************************************************************************/
+/*
+ * Benchmark mode
+ */
+static void *BenchWorker(void *Arg)
+{
+	P4SimWorker *W = Arg;
+	uint64_t D = 0xcbf29ce484222325ULL;
+	uint64_t It;
+	uint32_t I;
+	P4State St;
+
+	if (P4StateInit(&St, W->Prog) != 0) {
+		W->Status = -1;
+		return NULL;
+	}
+	for (It = 0; It < W->Iterations; It++) {
+		for (I = 0; I < W->NumFrames; I++) {
+			const P4SimFrame *F = &W->Frames[I];
+
+			St.Now = F->TsNs;
+			P4Process(&St, F->Data, F->Len, F->Input->Presets,
+				  F->Input->NumPresets);
+			D = Digest(D, P4GetField(&St, W->TdestHeader,
+						 W->TdestField),
+				   (uint32_t)P4Dropped(&St), St.ParserError);
+		}
+	}
+	W->Digest = D;
+	P4StateFree(&St);
+	return NULL;
+}
+
+static int LoadFrames(P4SimFrame **FramesPtr, uint32_t *NumPtr,
+		      uint64_t *BytesPtr)
+{
+	static uint8_t Buf[P4SIM_FRAME_MAX];
+	P4SimFrame *Frames = NULL;
+	uint32_t Num = 0;
+	uint32_t Cap = 0;
+	uint32_t I;
+
+	*BytesPtr = 0;
+	for (I = 0; I < NumInputs; I++) {
+		PcapFile In;
+		PcapPacket Pkt;
+		int Rc;
+
+		if (PcapOpenRead(&In, Inputs[I].Path) != 0) {
+			fprintf(stderr, "p4sim: %s is not a pcap file\n",
+				Inputs[I].Path);
+			return -1;
+		}
+		while ((Rc = PcapRead(&In, &Pkt, Buf, sizeof(Buf))) == 1) {
+			if (Num == Cap) {
+				P4SimFrame *N;
+
+				Cap = Cap ? Cap * 2 : 1024;
+				N = realloc(Frames, Cap * sizeof(*Frames));
+				if (N == NULL) {
+					PcapClose(&In);
+					return -1;
+				}
+				Frames = N;
+			}
+			Frames[Num].Data = malloc(Pkt.CapLen + 1);
+			if (Frames[Num].Data == NULL) {
+				PcapClose(&In);
+				return -1;
+			}
+			memcpy(Frames[Num].Data, Buf, Pkt.CapLen);
+			Frames[Num].Len = Pkt.CapLen;
+			Frames[Num].TsNs = Pkt.TsNs;
+			Frames[Num].Input = &Inputs[I];
+			*BytesPtr += Pkt.OrigLen;
+			Num++;
+		}
+		PcapClose(&In);
+		if (Rc < 0) {
+			fprintf(stderr, "p4sim: %s: truncated record\n",
+				Inputs[I].Path);
+			return -1;
+		}
+	}
+
+	*FramesPtr = Frames;
+	*NumPtr = Num;
+	return 0;
+}
+
+static int RunBench(const P4Program *Prog, uint64_t Iterations,
+		    uint32_t NumThreads, uint32_t TdestHeader,
+		    uint32_t TdestField)
+{
+	static P4SimWorker Workers[P4SIM_MAX_THREADS];
+	static pthread_t Threads[P4SIM_MAX_THREADS];
+	P4SimFrame *Frames = NULL;
+	uint32_t NumFrames = 0;
+	uint64_t Bytes;
+	double Start;
+	double Elapsed;
+	double Mpps;
+	double LineMpps;
+	uint32_t I;
+	int Status = 0;
+
+	if (LoadFrames(&Frames, &NumFrames, &Bytes) != 0) {
+		return -1;
+	}
+	if (NumFrames == 0) {
+		fprintf(stderr, "p4sim: no frames to replay\n");
+		return -1;
+	}
+
+	Start = NowSec();
+	for (I = 0; I < NumThreads; I++) {
+		Workers[I].Prog = Prog;
+		Workers[I].Frames = Frames;
+		Workers[I].NumFrames = NumFrames;
+		Workers[I].Iterations = Iterations;
+		Workers[I].TdestHeader = TdestHeader;
+		Workers[I].TdestField = TdestField;
+		if (pthread_create(&Threads[I], NULL, BenchWorker,
+				   &Workers[I]) != 0) {
+			NumThreads = I;
+			Status = -1;
+			break;
+		}
+	}
+	for (I = 0; I < NumThreads; I++) {
+		pthread_join(Threads[I], NULL);
+	}
+	Elapsed = NowSec() - Start;
+
+	/* Every worker replays the same frames, so all must agree */
+	for (I = 0; I < NumThreads; I++) {
+		if (Workers[I].Status != 0 ||
+		    Workers[I].Digest != Workers[0].Digest) {
+			fprintf(stderr, "p4sim: worker %u diverged\n",
+				(unsigned)I);
+			Status = -1;
+		}
+	}
+
+	Mpps = (double)NumFrames * (double)Iterations * NumThreads /
+	       Elapsed / 1e6;
+	LineMpps = 10e9 / (((double)Bytes / NumFrames + P4SIM_WIRE_OVERHEAD) *
+			   8) / 1e6;
+	printf("%u frames x %" PRIu64 " iterations x %u threads in %.3f s\n",
+	       (unsigned)NumFrames, Iterations, (unsigned)NumThreads, Elapsed);
+	printf("%.2f Mpps total, %.2f Mpps per thread\n", Mpps,
+	       Mpps / NumThreads);
+	printf("10G line rate for this mix (avg %.1f B): %.2f Mpps, %.2fx\n",
+	       (double)Bytes / NumFrames, LineMpps, Mpps / LineMpps);
+	printf("digest %016" PRIx64 "\n", Workers[0].Digest);
+
+	for (I = 0; I < NumFrames; I++) {
+		free(Frames[I].Data);
+	}
+	free(Frames);
+	return Status;
+}
+
+/****************************************************************************/
+
+int main(int argc, char *argv[])
+{
+	const char *ProgPath = NULL;
+	const char *Entries[P4SIM_MAX_INPUTS];
+	const char *OutDir = ".";
+	const char *TdestName = "metadata.axis_tdest";
+	const char *PendingSet[P4SIM_MAX_INPUTS * P4SIM_MAX_PRESETS];
+	uint32_t NumPendingSet = 0;
+	uint32_t NumEntries = 0;
+	uint32_t NumThreads = 1;
+	uint64_t Iterations = 0;
+	uint32_t TdestHeader;
+	uint32_t TdestField;
+	P4Program Prog;
+	char Err[256];
+	int InputSet[P4SIM_MAX_INPUTS][P4SIM_MAX_PRESETS];
+	uint32_t InputNumSet[P4SIM_MAX_INPUTS];
+	int Status;
+	int A;
+	uint32_t I;
+	uint32_t J;
+
+	/*
+	 * The program is only known once -p has been seen, so record the
+	 * --set arguments and resolve them after loading it.
+	 */
+	for (A = 1; A < argc; A++) {
+		const char *Opt = argv[A];
+
+		if (A + 1 >= argc) {
+			Usage();
+		}
+		if (strcmp(Opt, "-p") == 0) {
+			ProgPath = argv[++A];
+		} else if (strcmp(Opt, "-e") == 0 &&
+			   NumEntries < P4SIM_MAX_INPUTS) {
+			Entries[NumEntries++] = argv[++A];
+		} else if (strcmp(Opt, "-o") == 0) {
+			OutDir = argv[++A];
+		} else if (strcmp(Opt, "--tdest") == 0) {
+			TdestName = argv[++A];
+		} else if (strcmp(Opt, "--bench") == 0) {
+			Iterations = strtoull(argv[++A], NULL, 0);
+		} else if (strcmp(Opt, "--threads") == 0) {
+			NumThreads = (uint32_t)strtoul(argv[++A], NULL, 0);
+		} else if (strcmp(Opt, "--set") == 0 &&
+			   NumPendingSet < P4SIM_MAX_INPUTS * P4SIM_MAX_PRESETS) {
+			/* Later --set of the same field replaces the earlier */
+			PendingSet[NumPendingSet++] = argv[++A];
+		} else if (strcmp(Opt, "-i") == 0 &&
+			   NumInputs < P4SIM_MAX_INPUTS) {
+			Inputs[NumInputs].Path = argv[++A];
+			InputNumSet[NumInputs] = 0;
+			for (I = 0; I < NumPendingSet &&
+			     InputNumSet[NumInputs] < P4SIM_MAX_PRESETS; I++) {
+				InputSet[NumInputs][InputNumSet[NumInputs]++] =
+					(int)I;
+			}
+			NumInputs++;
+		} else {
+			Usage();
+		}
+	}
+	if (ProgPath == NULL || NumInputs == 0 || NumThreads == 0 ||
+	    NumThreads > P4SIM_MAX_THREADS) {
+		Usage();
+	}
+
+	if (P4ProgramLoad(&Prog, ProgPath, Err, sizeof(Err)) != 0) {
+		fprintf(stderr, "p4sim: %s: %s\n", ProgPath, Err);
+		return 1;
+	}
+	for (I = 0; I < NumEntries; I++) {
+		if (P4LoadEntries(&Prog, Entries[I], Err, sizeof(Err)) != 0) {
+			fprintf(stderr, "p4sim: %s\n", Err);
+			return 1;
+		}
+	}
+	if (P4FindField(&Prog, TdestName, &TdestHeader, &TdestField) != 0) {
+		fprintf(stderr, "p4sim: unknown tdest field %s\n", TdestName);
+		return 1;
+	}
+
+	for (I = 0; I < NumInputs; I++) {
+		for (J = 0; J < InputNumSet[I]; J++) {
+			P4Preset P;
+			uint32_t K;
+
+			if (ParsePreset(&Prog, PendingSet[InputSet[I][J]],
+					&P) != 0) {
+				fprintf(stderr, "p4sim: bad --set %s\n",
+					PendingSet[InputSet[I][J]]);
+				return 1;
+			}
+			for (K = 0; K < Inputs[I].NumPresets; K++) {
+				if (Inputs[I].Presets[K].Header == P.Header &&
+				    Inputs[I].Presets[K].Field == P.Field) {
+					break;
+				}
+			}
+			Inputs[I].Presets[K] = P;
+			if (K == Inputs[I].NumPresets) {
+				Inputs[I].NumPresets++;
+			}
+		}
+	}
+
+	if (Iterations != 0) {
+		Status = RunBench(&Prog, Iterations, NumThreads, TdestHeader,
+				  TdestField);
+	} else {
+		Status = RunFiles(&Prog, OutDir, TdestHeader, TdestField);
+	}
+
+	P4ProgramFree(&Prog);
+	return (Status == 0) ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file pcap.c
+*
+* Classic libpcap file I/O for the p4tools.
+*
+*****************************************************************************/
+
+#include <string.h>
+#include "pcap.h"
+
+#define PCAP_MAGIC_US		0xa1b2c3d4U
+#define PCAP_MAGIC_NS		0xa1b23c4dU
+#define PCAP_SNAPLEN		65535U
+
+static uint32_t PcapSwap32(uint32_t V)
+{
+	return (V >> 24) | ((V >> 8) & 0xff00U) | ((V << 8) & 0xff0000U) |
+	       (V << 24);
+}
+
+static uint32_t PcapGet32(const PcapFile *Pcap, uint32_t V)
+{
+	return Pcap->Swap ? PcapSwap32(V) : V;
+}
+
+/****************************************************************************/
+/**
+*
+* Opens a capture for reading and checks its global header.
+*
+* @return	0 on success, -1 if the file cannot be opened or is not a
+*		classic pcap file.
+*
+*****************************************************************************/
+int PcapOpenRead(PcapFile *Pcap, const char *Path)
+{
+	uint32_t Hdr[6];
+
+	memset(Pcap, 0, sizeof(*Pcap));
+	Pcap->F = fopen(Path, "rb");
+	if (Pcap->F == NULL) {
+		return -1;
+	}
+	if (fread(Hdr, sizeof(Hdr), 1, Pcap->F) != 1) {
+		goto Fail;
+	}
+
+	if (Hdr[0] == PCAP_MAGIC_US || Hdr[0] == PCAP_MAGIC_NS) {
+		Pcap->Swap = 0;
+	} else if (PcapSwap32(Hdr[0]) == PCAP_MAGIC_US ||
+		   PcapSwap32(Hdr[0]) == PCAP_MAGIC_NS) {
+		Pcap->Swap = 1;
+	} else {
+		goto Fail;
+	}
+	Pcap->Nano = (PcapGet32(Pcap, Hdr[0]) == PCAP_MAGIC_NS);
+	Pcap->SnapLen = PcapGet32(Pcap, Hdr[4]);
+	Pcap->LinkType = PcapGet32(Pcap, Hdr[5]);
+	return 0;
+
+Fail:
+	fclose(Pcap->F);
+	Pcap->F = NULL;
+	return -1;
+}
+
+/****************************************************************************/
+/**
+*
+* Reads the next record. Frames longer than BufLen are truncated; CapLen
+* then reports the truncated length.
+*
+* @return	1 if a packet was read, 0 at end of file, -1 on a short or
+*		corrupt record.
+*
+*****************************************************************************/
+int PcapRead(PcapFile *Pcap, PcapPacket *Pkt, uint8_t *Buf, uint32_t BufLen)
+{
+	uint32_t Rec[4];
+	uint32_t Len;
+
+	if (fread(Rec, sizeof(Rec), 1, Pcap->F) != 1) {
+		return feof(Pcap->F) ? 0 : -1;
+	}
+
+	Len = PcapGet32(Pcap, Rec[2]);
+	Pkt->OrigLen = PcapGet32(Pcap, Rec[3]);
+	Pkt->TsNs = (uint64_t)PcapGet32(Pcap, Rec[0]) * 1000000000ULL +
+		    (uint64_t)PcapGet32(Pcap, Rec[1]) * (Pcap->Nano ? 1 : 1000);
+	if (Len > 0x4000000U) {
+		return -1;
+	}
+
+	Pkt->CapLen = (Len < BufLen) ? Len : BufLen;
+	if (fread(Buf, 1, Pkt->CapLen, Pcap->F) != Pkt->CapLen) {
+		return -1;
+	}
+	if (Len > Pkt->CapLen && fseek(Pcap->F, (long)(Len - Pkt->CapLen),
+				       SEEK_CUR) != 0) {
+		return -1;
+	}
+	return 1;
+}
+
+int PcapOpenWrite(PcapFile *Pcap, const char *Path, uint32_t LinkType)
+{
+	uint32_t Hdr[6] = { PCAP_MAGIC_US, 0x00040002U, 0, 0, PCAP_SNAPLEN,
+			    LinkType };
+
+	memset(Pcap, 0, sizeof(*Pcap));
+	Pcap->F = fopen(Path, "wb");
+	if (Pcap->F == NULL) {
+		return -1;
+	}
+	Pcap->LinkType = LinkType;
+	Pcap->SnapLen = PCAP_SNAPLEN;
+	if (fwrite(Hdr, sizeof(Hdr), 1, Pcap->F) != 1) {
+		PcapClose(Pcap);
+		return -1;
+	}
+	return 0;
+}
+
+int PcapWrite(PcapFile *Pcap, const PcapPacket *Pkt, const uint8_t *Data)
+{
+	uint32_t Rec[4];
+
+	Rec[0] = (uint32_t)(Pkt->TsNs / 1000000000ULL);
+	Rec[1] = (uint32_t)((Pkt->TsNs % 1000000000ULL) / 1000);
+	Rec[2] = Pkt->CapLen;
+	Rec[3] = Pkt->OrigLen;
+	if (fwrite(Rec, sizeof(Rec), 1, Pcap->F) != 1 ||
+	    fwrite(Data, 1, Pkt->CapLen, Pcap->F) != Pkt->CapLen) {
+		return -1;
+	}
+	return 0;
+}
+
+void PcapClose(PcapFile *Pcap)
+{
+	if (Pcap->F != NULL) {
+		fclose(Pcap->F);
+		Pcap->F = NULL;
+	}
+}
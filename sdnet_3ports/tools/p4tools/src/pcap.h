@@ -0,0 +1,47 @@
+/******************************************************************************
+* SPDX-License-Identifier: MIT
+******************************************************************************/
+
+/****************************************************************************/
+/**
+*
+* @file pcap.h
+*
+* Classic libpcap file reader/writer (no pcapng). Both byte orders and the
+* nanosecond variant are accepted on input; output is always native order
+* with microsecond timestamps.
+*
+*****************************************************************************/
+#ifndef P4_PCAP_H
+#define P4_PCAP_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define PCAP_LINKTYPE_ETHERNET	1
+
+/**************************** Type Definitions ******************************/
+
+typedef struct {
+	FILE *F;
+	int Swap;		/* file byte order differs from ours */
+	int Nano;		/* timestamps are in ns rather than us */
+	uint32_t LinkType;
+	uint32_t SnapLen;
+} PcapFile;
+
+typedef struct {
+	uint64_t TsNs;
+	uint32_t CapLen;
+	uint32_t OrigLen;
+} PcapPacket;
+
+/************************** Function Prototypes *****************************/
+
+int PcapOpenRead(PcapFile *Pcap, const char *Path);
+int PcapRead(PcapFile *Pcap, PcapPacket *Pkt, uint8_t *Buf, uint32_t BufLen);
+int PcapOpenWrite(PcapFile *Pcap, const char *Path, uint32_t LinkType);
+int PcapWrite(PcapFile *Pcap, const PcapPacket *Pkt, const uint8_t *Data);
+void PcapClose(PcapFile *Pcap);
+
+#endif /* P4_PCAP_H */